@@ -183,6 +183,14 @@ void BTManager::send_feedback_cb(void* context)
     }
 }
 
+//Runs on the i2c task
+void BTManager::read_feedback_cb(const I2CDriver::PacketOut& packet_out, void* context)
+{
+    FBContext* fb_context = reinterpret_cast<FBContext*>(context);
+    fb_context->packet_out->store(packet_out);
+    btstack_run_loop_execute_on_main_thread(&fb_context->cb_reg);
+}
+
 //This will have to be changed once full support for multiple devices is added
 void BTManager::feedback_timer_cb(btstack_timer_source *ts)
 {
@@ -203,12 +211,7 @@ void BTManager::feedback_timer_cb(btstack_timer_source *ts)
         fb_context.cb_reg.context = reinterpret_cast<void*>(&fb_context);
 
         //Register a read on i2c thread, with callback to send feedback on btstack thread
-        bt_manager.i2c_driver_.read_packet(I2CDriver::MULTI_SLAVE ? i + 1 : 0x01,
-            [&fb_context](const I2CDriver::PacketOut& packet_out)
-            {
-                fb_context.packet_out->store(packet_out);
-                btstack_run_loop_execute_on_main_thread(&fb_context.cb_reg);
-            });
+        bt_manager.i2c_driver_.read_packet(I2CDriver::MULTI_SLAVE ? i + 1 : 0x01, read_feedback_cb, &fb_context);
     }
 
     btstack_run_loop_set_timer(ts, FEEDBACK_TIME_MS);
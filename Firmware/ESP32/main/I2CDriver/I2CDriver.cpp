@@ -38,35 +38,109 @@ void I2CDriver::initialize_i2c(i2c_port_t i2c_port, gpio_num_t sda, gpio_num_t s
 
 void I2CDriver::run_tasks()
 {
-    std::function<void()> task;
+    task_handle_.store(xTaskGetCurrentTaskHandle());
+
+    Command command;
 
     while (true)
     {   
-        while (task_queue_.pop(task))
+        //Anything pushed since the last pass is picked up here, the notification only wakes us
+        while (command_queue_.pop(command))
+        {
+            run_command(command);
+        }
+        if (write_pad_slots())
         {
-            task();
+            continue;
         }
 
-        vTaskDelay(1);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     }
 }
 
-void I2CDriver::write_packet(uint8_t address, const PacketIn& data_in) 
+void I2CDriver::notify_task()
+{
+    TaskHandle_t task_handle = task_handle_.load();
+    if (task_handle)
+    {
+        xTaskNotifyGive(task_handle);
+    }
+}
+
+void I2CDriver::run_command(const Command& command)
 {
-    task_queue_.push([this, address, data_in]() 
+    switch (command.type)
     {
-        i2c_write_blocking(address, reinterpret_cast<const uint8_t*>(&data_in), sizeof(PacketIn));
-    });
+        case Command::Type::WRITE:
+            i2c_write_blocking(command.address, reinterpret_cast<const uint8_t*>(&command.packet_in), sizeof(PacketIn));
+            break;
+
+        case Command::Type::READ:
+            {
+                PacketOut data_out;
+                if (i2c_read_blocking(command.address, reinterpret_cast<uint8_t*>(&data_out), sizeof(PacketOut)) == ESP_OK)
+                {
+                    command.callback(data_out, command.context);
+                }
+            }
+            break;
+    }
 }
 
-void I2CDriver::read_packet(uint8_t address, std::function<void(const PacketOut&)> callback) 
+//Returns true if anything was written, so the queue is checked again before sleeping
+bool I2CDriver::write_pad_slots()
 {
-    task_queue_.push([this, address, callback]() 
+    bool written = false;
+
+    for (auto& slot : pad_slots_)
     {
-        PacketOut data_out;
-        if (i2c_read_blocking(address, reinterpret_cast<uint8_t*>(&data_out), sizeof(PacketOut)) == ESP_OK)
+        if (!slot.pending.load())
         {
-            callback(data_out);
+            continue;
         }
-    });
-}
\ No newline at end of file
+
+        portENTER_CRITICAL(&slot.lock);
+        PacketIn packet_in = slot.packet_in;
+        uint8_t address = slot.address;
+        slot.pending.store(false);
+        portEXIT_CRITICAL(&slot.lock);
+
+        i2c_write_blocking(address, reinterpret_cast<const uint8_t*>(&packet_in), sizeof(PacketIn));
+        written = true;
+    }
+    return written;
+}
+
+void I2CDriver::write_packet(uint8_t address, const PacketIn& data_in) 
+{
+    if (data_in.packet_id == PacketID::SET_PAD && data_in.index < NUM_PAD_SLOTS)
+    {
+        PadSlot& slot = pad_slots_[data_in.index];
+
+        portENTER_CRITICAL(&slot.lock);
+        slot.address = address;
+        slot.packet_in = data_in;
+        slot.pending.store(true);
+        portEXIT_CRITICAL(&slot.lock);
+    }
+    else
+    {
+        Command command;
+        command.type = Command::Type::WRITE;
+        command.address = address;
+        command.packet_in = data_in;
+        command_queue_.push(command);
+    }
+    notify_task();
+}
+
+void I2CDriver::read_packet(uint8_t address, ReadCallback callback, void* context) 
+{
+    Command command;
+    command.type = Command::Type::READ;
+    command.address = address;
+    command.callback = callback;
+    command.context = context;
+    command_queue_.push(command);
+    notify_task();
+}
@@ -3,8 +3,11 @@
 
 #include <cstdint>
 #include <cstring>
-#include <functional>
+#include <array>
+#include <atomic>
 #include <driver/i2c.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 #include "sdkconfig.h"
 #include "RingBuffer.h"
@@ -54,6 +57,9 @@ public:
     static_assert(sizeof(PacketOut) == 8, "PacketOut is misaligned");
     #pragma pack(pop)
 
+    //Runs on the i2c task, keep it short
+    using ReadCallback = void(*)(const PacketOut& packet_out, void* context);
+
     I2CDriver() = default;
     ~I2CDriver();
 
@@ -62,16 +68,47 @@ public:
     //Does not return
     void run_tasks();
 
+    //SET_PAD packets replace any unsent pad state for the same index, everything else is queued in order
     void write_packet(uint8_t address, const PacketIn& data_in);
-    void read_packet(uint8_t address, std::function<void(const PacketOut&)> callback);
+    void read_packet(uint8_t address, ReadCallback callback, void* context);
 
 private:
-    using TaskQueue = RingBuffer<std::function<void()>, CONFIG_I2C_RING_BUFFER_SIZE>;
+    static constexpr size_t NUM_PAD_SLOTS = CONFIG_BLUEPAD32_MAX_DEVICES;
+
+    struct Command
+    {
+        enum class Type : uint8_t { WRITE, READ };
+
+        Type type{Type::WRITE};
+        uint8_t address{0};
+        PacketIn packet_in;
+        ReadCallback callback{nullptr};
+        void* context{nullptr};
+    };
+
+    //Latest state wins, a report that arrives before the last one was sent replaces it
+    struct PadSlot
+    {
+        portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+        std::atomic<bool> pending{false};
+        uint8_t address{0};
+        PacketIn packet_in;
+    };
+
+    //Commands are dropped when full rather than overwriting one the i2c task may be reading.
+    //Every write_packet/read_packet caller runs on the btstack run loop, so one producer is enough
+    using CommandQueue = RingBuffer<Command, CONFIG_I2C_RING_BUFFER_SIZE, RingPolicy::DROP_NEWEST>;
     
-    TaskQueue task_queue_;
+    CommandQueue command_queue_;
+    std::array<PadSlot, NUM_PAD_SLOTS> pad_slots_;
+    std::atomic<TaskHandle_t> task_handle_{nullptr};
     i2c_port_t i2c_port_ = I2C_NUM_0;
     bool initialized_ = false;
 
+    void notify_task();
+    void run_command(const Command& command);
+    bool write_pad_slots();
+
     static inline esp_err_t i2c_write_blocking(uint8_t address, const uint8_t* buffer, size_t len) 
     {
         i2c_cmd_handle_t cmd = i2c_cmd_link_create();
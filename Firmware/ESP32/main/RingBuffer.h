@@ -2,54 +2,239 @@
 #define _RING_BUFFER_H_
 
 #include <cstdint>
+#include <cstddef>
 #include <atomic>
 #include <array>
+#include <type_traits>
 
-template<typename Type, size_t SIZE>
+enum class RingPolicy
+{
+    DROP_NEWEST,     //push fails when full, nothing that was queued is lost
+    OVERWRITE_OLDEST //push always succeeds, the consumer skips what was overwritten
+};
+
+enum class RingProducers
+{
+    SINGLE, //one producer owns head_, no atomic read-modify-write on push
+    MULTI   //any number of producers claim slots with a CAS on head_, DROP_NEWEST only
+};
+
+//Lock-free, one consumer and one or more producers, they can be on different cores.
+//head_ and tail_ are free running counters, producers write head_ and only the consumer writes tail_.
+//MULTI uses a per slot sequence: a slot is free for position p when its sequence is p and holds
+//an item once it's p + 1, so a producer claiming a slot never exposes it before its copy is done.
+//OVERWRITE_OLDEST stays single producer, overwriting needs head_ and the slot write to move together.
+template<typename Type, size_t SIZE, RingPolicy POLICY = RingPolicy::DROP_NEWEST, RingProducers PRODUCERS = RingProducers::SINGLE>
 class RingBuffer
 {
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "RingBuffer SIZE must be a power of two");
+    static_assert(POLICY != RingPolicy::OVERWRITE_OLDEST || std::is_trivially_copyable_v<Type>,
+                  "RingBuffer OVERWRITE_OLDEST Type must be trivially copyable, the consumer can read a slot while it's being overwritten");
+    static_assert(POLICY != RingPolicy::OVERWRITE_OLDEST || PRODUCERS == RingProducers::SINGLE,
+                  "RingBuffer OVERWRITE_OLDEST only supports a single producer");
+
+    static constexpr bool MULTI_PRODUCER = (PRODUCERS == RingProducers::MULTI);
+
 public:
-    RingBuffer() : head_(0), tail_(0) {}
+    RingBuffer()
+    {
+        if constexpr (MULTI_PRODUCER)
+        {
+            for (size_t i = 0; i < SIZE; ++i)
+            {
+                seq_[i].store(i, std::memory_order_relaxed);
+            }
+        }
+    }
 
     RingBuffer(const RingBuffer&) = delete;
     RingBuffer& operator=(const RingBuffer&) = delete;
 
-    RingBuffer(RingBuffer&&) = default;
-    RingBuffer& operator=(RingBuffer&&) = default;
-
+    //Producer only, any producer with MULTI
     bool push(const Type& item)
     {
-        size_t head = head_.load(std::memory_order_relaxed);
-        size_t next_head = (head + 1) % SIZE;
+        if constexpr (MULTI_PRODUCER)
+        {
+            size_t head = head_.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                std::atomic<size_t>& seq = seq_[head & MASK];
+                const intptr_t diff = static_cast<intptr_t>(seq.load(std::memory_order_acquire) - head);
+
+                if (diff == 0)
+                {
+                    if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+                    {
+                        buffer_[head & MASK] = item;
+                        seq.store(head + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    //The consumer hasn't freed this slot from the last lap
+                    return false;
+                }
+                else
+                {
+                    //Another producer claimed it first
+                    head = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        const size_t head = head_.load(std::memory_order_relaxed);
 
-        if (next_head == tail_.load(std::memory_order_acquire))
+        if constexpr (POLICY == RingPolicy::DROP_NEWEST)
         {
-            tail_.store((tail_.load(std::memory_order_relaxed) + 1) % SIZE, std::memory_order_release);
+            if (head - tail_.load(std::memory_order_acquire) >= SIZE)
+            {
+                return false;
+            }
+            buffer_[head & MASK] = item;
+        }
+        else
+        {
+            //Per slot seqlock, odd while the slot is being written
+            std::atomic<size_t>& seq = seq_[head & MASK];
+            seq.store(head * 2 + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            buffer_[head & MASK] = item;
+            seq.store(head * 2 + 2, std::memory_order_release);
         }
 
-        buffer_[head] = item;
-        head_.store(next_head, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_release);
         return true;
     }
 
+    //Consumer only
     bool pop(Type& item)
     {
-        size_t tail = tail_.load(std::memory_order_relaxed);
+        if constexpr (MULTI_PRODUCER)
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            std::atomic<size_t>& seq = seq_[tail & MASK];
 
-        if (tail == head_.load(std::memory_order_acquire))
+            //Claimed but still being written counts as empty, items come out in claim order
+            if (seq.load(std::memory_order_acquire) != tail + 1)
+            {
+                return false;
+            }
+            item = buffer_[tail & MASK];
+            seq.store(tail + SIZE, std::memory_order_release);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+        else if constexpr (POLICY == RingPolicy::DROP_NEWEST)
         {
-            return false;
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = buffer_[tail & MASK];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
         }
+        else
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
 
-        item = buffer_[tail];
-        tail_.store((tail + 1) % SIZE, std::memory_order_release);
-        return true;
+            while (true)
+            {
+                const size_t head = head_.load(std::memory_order_acquire);
+                if (tail == head)
+                {
+                    tail_.store(tail, std::memory_order_release);
+                    return false;
+                }
+                if (head - tail > SIZE)
+                {
+                    tail = head - SIZE;
+                }
+
+                const std::atomic<size_t>& seq = seq_[tail & MASK];
+                const size_t expected = tail * 2 + 2;
+
+                //Anything else means the producer has lapped this slot
+                if (seq.load(std::memory_order_acquire) != expected)
+                {
+                    ++tail;
+                    continue;
+                }
+                item = buffer_[tail & MASK];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) != expected)
+                {
+                    ++tail;
+                    continue;
+                }
+
+                tail_.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    //Consumer only, pops up to max_items in one pass, returns the number popped
+    size_t pop_n(Type* items, size_t max_items)
+    {
+        if constexpr (POLICY == RingPolicy::DROP_NEWEST && !MULTI_PRODUCER)
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            const size_t available = head_.load(std::memory_order_acquire) - tail;
+            const size_t count = (available < max_items) ? available : max_items;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                items[i] = buffer_[(tail + i) & MASK];
+            }
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+        else
+        {
+            size_t count = 0;
+            while (count < max_items && pop(items[count]))
+            {
+                ++count;
+            }
+            return count;
+        }
+    }
+
+    //Either side, only a snapshot
+    size_t size() const
+    {
+        //tail_ first, head_ only grows so it can't be read behind it
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t available = head_.load(std::memory_order_acquire) - tail;
+        return (available < SIZE) ? available : SIZE;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity()
+    {
+        return SIZE;
     }
 
 private:
-    std::array<Type, SIZE> buffer_;
-    std::atomic<size_t> head_;
-    std::atomic<size_t> tail_;
+    static constexpr size_t MASK = SIZE - 1;
+
+    //Only needed when the producer can overwrite a slot the consumer is reading, or with several producers
+    using SeqArray = std::conditional_t<POLICY == RingPolicy::OVERWRITE_OLDEST || MULTI_PRODUCER,
+                                        std::array<std::atomic<size_t>, SIZE>,
+                                        std::array<uint8_t, 0>>;
+
+    std::array<Type, SIZE> buffer_{};
+    SeqArray seq_{};
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
 };
 
-#endif // _RING_BUFFER_H_
\ No newline at end of file
+#endif // _RING_BUFFER_H_
@@ -1,6 +1,8 @@
 #include <cstring>
 #include <string>
+#include <array>
 #include <algorithm>
+#include <atomic>
 
 #include "att_delayed_response.h"
 #include "btstack.h"
@@ -12,7 +14,15 @@
 
 namespace BLEServer {
 
-static constexpr uint16_t PACKET_LEN_MAX = 20;
+//ATT header on writes and notifications, a read response has 2 bytes less but MTU sized reads use the write size
+static constexpr uint16_t ATT_HEADER_LEN = 3;
+static constexpr uint16_t ATT_DEFAULT_MTU = 23;
+//What existing clients read profiles in, larger reads are opt in with StreamConfig::flags
+static constexpr uint16_t PROFILE_READ_LEN_DEFAULT = ATT_DEFAULT_MTU - ATT_HEADER_LEN;
+
+static constexpr uint16_t STREAM_INTERVAL_MIN_MS = 8; //About the shortest LE connection interval
+static constexpr uint16_t STREAM_INTERVAL_DEFAULT_MS = 20;
+static constexpr uint8_t STREAM_FLAG_MTU_PROFILE_READS = 0x01; //Profile reads come in MTU sized chunks on this connection
 
 namespace Handle {
     static constexpr uint16_t FW_VERSION    = ATT_CHARACTERISTIC_12345678_1234_1234_1234_123456789020_01_VALUE_HANDLE;
@@ -25,6 +35,10 @@ namespace Handle {
     static constexpr uint16_t PROFILE  = ATT_CHARACTERISTIC_12345678_1234_1234_1234_123456789040_01_VALUE_HANDLE;
 
     static constexpr uint16_t GAMEPAD  = ATT_CHARACTERISTIC_12345678_1234_1234_1234_123456789050_01_VALUE_HANDLE;
+
+    static constexpr uint16_t GAMEPAD_NOTIFY     = ATT_CHARACTERISTIC_12345678_1234_1234_1234_123456789051_01_VALUE_HANDLE;
+    static constexpr uint16_t GAMEPAD_NOTIFY_CCC = ATT_CHARACTERISTIC_12345678_1234_1234_1234_123456789051_01_CLIENT_CONFIGURATION_HANDLE;
+    static constexpr uint16_t STREAM_CONFIG      = ATT_CHARACTERISTIC_12345678_1234_1234_1234_123456789052_01_VALUE_HANDLE;
 }
 
 namespace ADV {
@@ -59,8 +73,37 @@ struct SetupPacket {
     uint8_t profile_id{0};
 };
 static_assert(sizeof(SetupPacket) == 4, "BLEServer::SetupPacket struct size mismatch");
+
+//Written to Handle::STREAM_CONFIG, notifications start when the client enables them on Handle::GAMEPAD_NOTIFY
+struct StreamConfig {
+    uint8_t gamepad_mask{0x01};
+    uint8_t flags{0};
+    uint16_t interval_ms{STREAM_INTERVAL_DEFAULT_MS};
+};
+static_assert(sizeof(StreamConfig) == 4, "BLEServer::StreamConfig struct size mismatch");
+
+//A notification holds as many of these as the MTU allows
+struct PadRecord {
+    uint8_t player_idx{0};
+    Gamepad::PadIn pad_in;
+};
 #pragma pack(pop)
 
+//Largest chunk of a value that fits in one ATT op on this connection
+static uint16_t max_payload_len(hci_con_handle_t connection_handle) {
+    const uint16_t mtu = std::max(att_server_get_mtu(connection_handle), ATT_DEFAULT_MTU);
+    return static_cast<uint16_t>(mtu - ATT_HEADER_LEN);
+}
+
+std::array<Gamepad*, MAX_GAMEPADS> gamepads_;
+
+//Connection that set STREAM_FLAG_MTU_PROFILE_READS, cleared when it disconnects
+hci_con_handle_t mtu_profile_reads_{HCI_CON_HANDLE_INVALID};
+
+static uint16_t profile_read_len(hci_con_handle_t connection_handle) {
+    return (connection_handle == mtu_profile_reads_) ? max_payload_len(connection_handle) : PROFILE_READ_LEN_DEFAULT;
+}
+
 class ProfileReader {
 public:
     ProfileReader() = default;
@@ -75,12 +118,12 @@ public:
         return setup_packet_;
     }
 
-    uint16_t get_xfer_len() {
-        return static_cast<uint16_t>(std::min(static_cast<size_t>(PACKET_LEN_MAX), sizeof(UserProfile) - current_offset_));
+    uint16_t get_xfer_len(uint16_t payload_len) {
+        return static_cast<uint16_t>(std::min(static_cast<size_t>(payload_len), sizeof(UserProfile) - current_offset_));
     }
 
-    uint16_t get_profile_data(uint8_t* buffer, uint16_t buffer_len) {
-        size_t copy_len = get_xfer_len();
+    uint16_t get_profile_data(uint8_t* buffer, uint16_t buffer_len, uint16_t payload_len) {
+        size_t copy_len = get_xfer_len(payload_len);
         if (!buffer || buffer_len < copy_len) {
             return 0;
         }
@@ -131,12 +174,12 @@ public:
         return setup_packet_;
     }
 
-    uint16_t get_xfer_len() {
-        return static_cast<uint16_t>(std::min(static_cast<size_t>(PACKET_LEN_MAX), sizeof(UserProfile) - current_offset_));
+    uint16_t get_xfer_len(uint16_t payload_len) {
+        return static_cast<uint16_t>(std::min(static_cast<size_t>(payload_len), sizeof(UserProfile) - current_offset_));
     }
 
-    size_t set_profile_data(const uint8_t* buffer, uint16_t buffer_len) {
-        size_t copy_len = get_xfer_len();
+    size_t set_profile_data(const uint8_t* buffer, uint16_t buffer_len, uint16_t payload_len) {
+        size_t copy_len = get_xfer_len(payload_len);
         if (!buffer || buffer_len < copy_len) {
             return 0;
         }
@@ -152,34 +195,190 @@ public:
         return ret;
     }
 
+    //Set from commit_profile() until the core0 task has stored commit_profile_
+    bool commit_pending() const {
+        return commit_pending_.load(std::memory_order_acquire);
+    }
+
     bool commit_profile() {
+        if (commit_pending_.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
         bool success = false;
+        //Profile is too large to capture in a task, keep a copy here until it's stored
+        commit_profile_ = profile_;
         if (setup_packet_.device_type != DeviceDriverType::NONE) {
             success = TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), 1000, false,
-                [driver_type = setup_packet_.device_type, profile = profile_, index = setup_packet_.player_idx]
+                [this, driver_type = setup_packet_.device_type, index = setup_packet_.player_idx]
                 {
-                    UserSettings::get_instance().store_profile_and_driver_type(driver_type, index, profile);
+                    UserSettings::get_instance().store_profile_and_driver_type(driver_type, index, commit_profile_);
+                    commit_pending_.store(false, std::memory_order_release);
                 });
         } else {
-            success = TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), 1000, false,
-                [index = setup_packet_.player_idx, profile = profile_]
+            //Applied live, no reboot to wait for
+            success = TaskQueue::Core0::queue_task(
+                [this, index = setup_packet_.player_idx]
                 {
-                    UserSettings::get_instance().store_profile(index, profile);
+                    UserSettings::get_instance().store_profile(index, commit_profile_);
+                    commit_pending_.store(false, std::memory_order_release);
                 });
         }
+        if (!success) {
+            commit_pending_.store(false, std::memory_order_release);
+        }
         return success;
     }
 
 private:
     SetupPacket setup_packet_;
     UserProfile profile_;
+    UserProfile commit_profile_;
+    std::atomic<bool> commit_pending_{false};
     size_t current_offset_ = 0;
 };
 
-std::array<Gamepad*, MAX_GAMEPADS> gamepads_;
 ProfileReader profile_reader_;
 ProfileWriter profile_writer_;
 
+//Pushes PadIn to one client with notifications, runs on the btstack run loop.
+//Pads are sampled every interval_ms and only the ones that changed since they were last sent go out.
+//A pad that changes again before there's room to send is coalesced, only its latest state is sent.
+class PadStreamer {
+public:
+    PadStreamer() = default;
+    ~PadStreamer() = default;
+
+    const StreamConfig& get_config() const {
+        return config_;
+    }
+
+    bool enabled() const {
+        return (connection_handle_ != HCI_CON_HANDLE_INVALID);
+    }
+
+    void set_config(const StreamConfig& config) {
+        config_ = config;
+        config_.gamepad_mask &= static_cast<uint8_t>((1 << MAX_GAMEPADS) - 1);
+        config_.interval_ms = std::max(config_.interval_ms, STREAM_INTERVAL_MIN_MS);
+    }
+
+    void enable(hci_con_handle_t connection_handle) {
+        disable();
+        connection_handle_ = connection_handle;
+        //Everything selected goes out once so the client starts with a full picture
+        pending_mask_ = config_.gamepad_mask;
+        for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
+            pending_[i] = gamepads_[i]->peek_pad_in();
+        }
+        request_send();
+
+        btstack_run_loop_set_timer_handler(&timer_, timer_cb);
+        btstack_run_loop_set_timer(&timer_, config_.interval_ms);
+        btstack_run_loop_add_timer(&timer_);
+    }
+
+    void disable() {
+        if (!enabled()) {
+            return;
+        }
+        btstack_run_loop_remove_timer(&timer_);
+        connection_handle_ = HCI_CON_HANDLE_INVALID;
+        pending_mask_ = 0;
+        send_requested_ = false;
+    }
+
+    void disconnected(hci_con_handle_t connection_handle) {
+        if (connection_handle == connection_handle_) {
+            disable();
+        }
+    }
+
+    void can_send_now() {
+        send_requested_ = false;
+        if (!enabled() || !pending_mask_) {
+            return;
+        }
+
+        //Needs an MTU of at least sizeof(PadRecord) + 3, clients on the default MTU poll Handle::GAMEPAD instead
+        const uint16_t max_len = std::min(max_payload_len(connection_handle_), static_cast<uint16_t>(sizeof(buffer_)));
+        uint16_t len = 0;
+
+        for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
+            if (!(pending_mask_ & (1 << i))) {
+                continue;
+            }
+            if (len + sizeof(PadRecord) > max_len) {
+                break;
+            }
+            PadRecord record;
+            record.player_idx = i;
+            record.pad_in = pending_[i];
+            std::memcpy(buffer_ + len, &record, sizeof(PadRecord));
+            len += sizeof(PadRecord);
+
+            last_sent_[i] = pending_[i];
+            pending_mask_ &= ~(1 << i);
+        }
+
+        if (len) {
+            att_server_notify(connection_handle_, Handle::GAMEPAD_NOTIFY, buffer_, len);
+        }
+        if (len && pending_mask_) {
+            request_send();
+        }
+    }
+
+private:
+    StreamConfig config_;
+    hci_con_handle_t connection_handle_{HCI_CON_HANDLE_INVALID};
+    btstack_timer_source_t timer_;
+    bool send_requested_{false};
+    uint8_t pending_mask_{0};
+    std::array<Gamepad::PadIn, MAX_GAMEPADS> pending_;
+    std::array<Gamepad::PadIn, MAX_GAMEPADS> last_sent_;
+    uint8_t buffer_[sizeof(PadRecord) * MAX_GAMEPADS];
+
+    static void timer_cb(btstack_timer_source_t* ts);
+
+    void sample() {
+        for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
+            if (!(config_.gamepad_mask & (1 << i))) {
+                continue;
+            }
+            //Peek so the USB device driver on core0 still sees new_pad_in()
+            Gamepad::PadIn pad_in = gamepads_[i]->peek_pad_in();
+            if (std::memcmp(&pad_in, &last_sent_[i], sizeof(Gamepad::PadIn)) != 0) {
+                pending_[i] = pad_in;
+                pending_mask_ |= (1 << i);
+            }
+        }
+        if (pending_mask_) {
+            request_send();
+        }
+    }
+
+    void request_send() {
+        if (max_payload_len(connection_handle_) < sizeof(PadRecord)) {
+            return;
+        }
+        if (!send_requested_) {
+            send_requested_ = true;
+            att_server_request_can_send_now_event(connection_handle_);
+        }
+    }
+};
+
+PadStreamer pad_streamer_;
+
+void PadStreamer::timer_cb(btstack_timer_source_t* ts) {
+    if (!pad_streamer_.enabled()) {
+        return;
+    }
+    pad_streamer_.sample();
+    btstack_run_loop_set_timer(ts, pad_streamer_.config_.interval_ms);
+    btstack_run_loop_add_timer(ts);
+}
+
 static int verify_write(const uint16_t buffer_size, const uint16_t expected_size) {
     if (buffer_size != expected_size) {
         return ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LENGTH;
@@ -187,22 +386,32 @@ static int verify_write(const uint16_t buffer_size, const uint16_t expected_size
     return 0;
 }
 
-static void disconnect_client_cb(btstack_timer_source_t *ts) {
-    hci_con_handle_t connection_handle = *static_cast<hci_con_handle_t*>(ts->context);
-    hci_send_cmd(&hci_disconnect, connection_handle);
-    delete static_cast<hci_con_handle_t*>(ts->context);
+static int verify_chunk(const uint16_t buffer_size, const uint16_t max_size) {
+    if (buffer_size == 0 || buffer_size > max_size) {
+        return ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LENGTH;
+    }
+    return 0;
 }
 
-static void queue_disconnect(hci_con_handle_t connection_handle, uint32_t dealy_ms) {
-    static btstack_timer_source_t disconnect_timer;
-
-    hci_con_handle_t* connection_handle_ptr = new hci_con_handle_t(connection_handle);
+static void att_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size) {
+    if (packet_type != HCI_EVENT_PACKET) {
+        return;
+    }
+    switch (hci_event_packet_get_type(packet)) {
+        case ATT_EVENT_CAN_SEND_NOW:
+            pad_streamer_.can_send_now();
+            break;
 
-    disconnect_timer.process = disconnect_client_cb;
-    disconnect_timer.context = connection_handle_ptr;
+        case ATT_EVENT_DISCONNECTED:
+            pad_streamer_.disconnected(att_event_disconnected_get_handle(packet));
+            if (att_event_disconnected_get_handle(packet) == mtu_profile_reads_) {
+                mtu_profile_reads_ = HCI_CON_HANDLE_INVALID;
+            }
+            break;
 
-    btstack_run_loop_set_timer(&disconnect_timer, dealy_ms);
-    btstack_run_loop_add_timer(&disconnect_timer);
+        default:
+            break;
+    }
 }
 
 static uint16_t att_read_callback(  hci_con_handle_t connection_handle,
@@ -240,17 +449,31 @@ static uint16_t att_read_callback(  hci_con_handle_t connection_handle,
 
         case Handle::PROFILE:
             if (buffer) {
-                return profile_reader_.get_profile_data(buffer, buffer_size);
+                return profile_reader_.get_profile_data(buffer, buffer_size, profile_read_len(connection_handle));
             }
-            return profile_reader_.get_xfer_len();
+            return profile_reader_.get_xfer_len(profile_read_len(connection_handle));
 
         case Handle::GAMEPAD:
+        case Handle::GAMEPAD_NOTIFY:
             if (buffer) {
-                pad_in = gamepads_.front()->get_pad_in();
+                //Peek so the USB device driver on core0 still sees new_pad_in()
+                pad_in = gamepads_.front()->peek_pad_in();
                 std::memcpy(buffer, &pad_in, sizeof(Gamepad::PadIn));
             }
             return static_cast<uint16_t>(sizeof(Gamepad::PadIn));
 
+        case Handle::GAMEPAD_NOTIFY_CCC:
+            if (buffer) {
+                little_endian_store_16(buffer, 0, pad_streamer_.enabled() ? GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION : 0);
+            }
+            return 2;
+
+        case Handle::STREAM_CONFIG:
+            if (buffer) {
+                std::memcpy(buffer, &pad_streamer_.get_config(), sizeof(StreamConfig));
+            }
+            return static_cast<uint16_t>(sizeof(StreamConfig));
+
         default:
             break;
     }
@@ -281,12 +504,43 @@ static int att_write_callback(  hci_con_handle_t connection_handle,
             break;
 
         case Handle::PROFILE:
-            if ((ret = verify_write(buffer_size, profile_writer_.get_xfer_len())) != 0) {
+            //Clients pick their own chunk size up to the MTU, the offset advances by what was written
+            if ((ret = verify_chunk(buffer_size, profile_writer_.get_xfer_len(max_payload_len(connection_handle)))) != 0) {
+                break;
+            }
+            //The last profile is still waiting to be stored, the client retries the same chunk
+            if (profile_writer_.commit_pending()) {
+                ret = ATT_ERROR_INSUFFICIENT_RESOURCES;
+                break;
+            }
+            //The client stays connected, a reboot for a driver change drops it anyway
+            if (profile_writer_.set_profile_data(buffer, buffer_size, buffer_size) == sizeof(UserProfile) &&
+                !profile_writer_.commit_profile()) {
+                ret = ATT_ERROR_INSUFFICIENT_RESOURCES;
+            }
+            break;
+
+        case Handle::GAMEPAD_NOTIFY_CCC:
+            if ((ret = verify_write(buffer_size, 2)) != 0) {
+                break;
+            }
+            if (little_endian_read_16(buffer, 0) & GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION) {
+                pad_streamer_.enable(connection_handle);
+            } else {
+                pad_streamer_.disable();
+            }
+            break;
+
+        case Handle::STREAM_CONFIG:
+            if ((ret = verify_write(buffer_size, sizeof(StreamConfig))) != 0) {
                 break;
             }
-            if (profile_writer_.set_profile_data(buffer, buffer_size) == sizeof(UserProfile)) {
-                queue_disconnect(connection_handle, 500);
-                profile_writer_.commit_profile();
+            pad_streamer_.set_config(*reinterpret_cast<StreamConfig*>(buffer));
+            mtu_profile_reads_ = (pad_streamer_.get_config().flags & STREAM_FLAG_MTU_PROFILE_READS)
+                ? connection_handle : HCI_CON_HANDLE_INVALID;
+            //Picks up the new rate and mask
+            if (pad_streamer_.enabled()) {
+                pad_streamer_.enable(connection_handle);
             }
             break;
 
@@ -305,6 +559,7 @@ void init_server(Gamepad(&gamepads)[MAX_GAMEPADS]) {
 
     // setup ATT server
     att_server_init(profile_data, att_read_callback, att_write_callback);
+    att_server_register_packet_handler(att_packet_handler);
 
     // setup advertisements
     uint16_t adv_int_min = 0x0030;
@@ -11,6 +11,7 @@
 #include "Bluepad32/Bluepad32.h"
 #include "Board/board_api.h"
 #include "Board/ogxm_log.h"
+#include "Gamepad/ButtonLut.h"
 
 #ifndef CONFIG_BLUEPAD32_PLATFORM_CUSTOM
     #error "Pico W must use BLUEPAD32_PLATFORM_CUSTOM"
@@ -23,6 +24,27 @@ namespace bluepad32 {
 static constexpr uint32_t FEEDBACK_TIME_MS = 250;
 static constexpr uint32_t LED_CHECK_TIME_MS = 500;
 
+static constexpr auto DPAD_LUT = ButtonLut<8>()
+    .map(DPAD_UP,    Gamepad::DPAD_UP)
+    .map(DPAD_DOWN,  Gamepad::DPAD_DOWN)
+    .map(DPAD_LEFT,  Gamepad::DPAD_LEFT)
+    .map(DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
+static constexpr auto BUTTON_LUT = ButtonLut<16>()
+    .map(BUTTON_A,          Gamepad::BUTTON_A)
+    .map(BUTTON_B,          Gamepad::BUTTON_B)
+    .map(BUTTON_X,          Gamepad::BUTTON_X)
+    .map(BUTTON_Y,          Gamepad::BUTTON_Y)
+    .map(BUTTON_SHOULDER_L, Gamepad::BUTTON_LB)
+    .map(BUTTON_SHOULDER_R, Gamepad::BUTTON_RB)
+    .map(BUTTON_THUMB_L,    Gamepad::BUTTON_L3)
+    .map(BUTTON_THUMB_R,    Gamepad::BUTTON_R3);
+
+static constexpr auto MISC_BUTTON_LUT = ButtonLut<8>()
+    .map(MISC_BUTTON_BACK,   Gamepad::BUTTON_BACK)
+    .map(MISC_BUTTON_START,  Gamepad::BUTTON_START)
+    .map(MISC_BUTTON_SYSTEM, Gamepad::BUTTON_SYS);
+
 struct BTDevice {
     bool connected{false};
     Gamepad* gamepad{nullptr};
@@ -203,47 +225,8 @@ static void controller_data_cb(uni_hid_device_t* device, uni_controller_t* contr
     Gamepad* gamepad = bt_devices_[idx].gamepad;
     Gamepad::PadIn gp_in;
 
-    switch (uni_gp->dpad) 
-    {
-        case DPAD_UP:
-            gp_in.dpad = gamepad->MAP_DPAD_UP;
-            break;
-        case DPAD_DOWN:
-            gp_in.dpad = gamepad->MAP_DPAD_DOWN;
-            break;
-        case DPAD_LEFT:
-            gp_in.dpad = gamepad->MAP_DPAD_LEFT;
-            break;
-        case DPAD_RIGHT:
-            gp_in.dpad = gamepad->MAP_DPAD_RIGHT;
-            break;
-        case DPAD_UP | DPAD_RIGHT:
-            gp_in.dpad = gamepad->MAP_DPAD_UP_RIGHT;
-            break;
-        case DPAD_DOWN | DPAD_RIGHT:
-            gp_in.dpad = gamepad->MAP_DPAD_DOWN_RIGHT;
-            break;
-        case DPAD_DOWN | DPAD_LEFT:
-            gp_in.dpad = gamepad->MAP_DPAD_DOWN_LEFT;
-            break;
-        case DPAD_UP | DPAD_LEFT:
-            gp_in.dpad = gamepad->MAP_DPAD_UP_LEFT;
-            break;
-        default:
-            break;
-    }
-
-    if (uni_gp->buttons & BUTTON_A) gp_in.buttons |= gamepad->MAP_BUTTON_A;
-    if (uni_gp->buttons & BUTTON_B) gp_in.buttons |= gamepad->MAP_BUTTON_B;
-    if (uni_gp->buttons & BUTTON_X) gp_in.buttons |= gamepad->MAP_BUTTON_X;
-    if (uni_gp->buttons & BUTTON_Y) gp_in.buttons |= gamepad->MAP_BUTTON_Y;
-    if (uni_gp->buttons & BUTTON_SHOULDER_L) gp_in.buttons |= gamepad->MAP_BUTTON_LB;
-    if (uni_gp->buttons & BUTTON_SHOULDER_R) gp_in.buttons |= gamepad->MAP_BUTTON_RB;
-    if (uni_gp->buttons & BUTTON_THUMB_L)    gp_in.buttons |= gamepad->MAP_BUTTON_L3;  
-    if (uni_gp->buttons & BUTTON_THUMB_R)    gp_in.buttons |= gamepad->MAP_BUTTON_R3;
-    if (uni_gp->misc_buttons & MISC_BUTTON_BACK)    gp_in.buttons |= gamepad->MAP_BUTTON_BACK;
-    if (uni_gp->misc_buttons & MISC_BUTTON_START)   gp_in.buttons |= gamepad->MAP_BUTTON_START;
-    if (uni_gp->misc_buttons & MISC_BUTTON_SYSTEM)  gp_in.buttons |= gamepad->MAP_BUTTON_SYS;
+    gp_in.dpad = gamepad->map_dpad(DPAD_LUT(uni_gp->dpad));
+    gp_in.buttons = gamepad->map_buttons(BUTTON_LUT(uni_gp->buttons) | MISC_BUTTON_LUT(uni_gp->misc_buttons));
 
     gp_in.trigger_l = gamepad->scale_trigger_l<10>(static_cast<uint16_t>(uni_gp->brake));
     gp_in.trigger_r = gamepad->scale_trigger_r<10>(static_cast<uint16_t>(uni_gp->throttle));
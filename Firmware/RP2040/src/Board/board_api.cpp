@@ -8,12 +8,14 @@
 #include "Board/Config.h"
 #include "Board/board_api.h"
 #include "Board/ogxm_log.h"
+#include "Board/ogxm_trace.h"
 #include "Board/board_api_private/board_api_private.h"
 #include "TaskQueue/TaskQueue.h"
 
 namespace board_api {
 
 mutex_t gpio_mutex_;
+static bool core1_launched_{false};
 
 bool usb::host_connected() {
     if (board_api_usbh::host_connected) {
@@ -28,6 +30,7 @@ void usb::disconnect_all() {
 
     TaskQueue::suspend_delayed_tasks();
     multicore_reset_core1();
+    core1_launched_ = false;
     sleep_ms(500);
     tud_disconnect();
     sleep_ms(500);
@@ -65,6 +68,24 @@ uint32_t ms_since_boot() {
     return to_ms_since_boot(get_absolute_time());
 }
 
+void wait_for_event(uint32_t timeout_us) {
+    //Hands queued log records to DMA, they go out while this core sleeps
+    OGXM_LOG_FLUSH();
+    //Returns immediately if an event was signaled since the last wait, so none are missed
+    best_effort_wfe_or_timeout(make_timeout_time_us(timeout_us));
+}
+
+//Only call this from core0
+void launch_core1(void (*core1_task)(void)) {
+    multicore_reset_core1();
+    multicore_launch_core1(core1_task);
+    core1_launched_ = true;
+}
+
+bool core1_launched() {
+    return core1_launched_;
+}
+
 //Call after board is initialized
 void init_bluetooth() {
     if (board_api_bt::init) {
@@ -98,10 +119,15 @@ void init_board() {
         if (board_api_usbh::init) {
             board_api_usbh::init();
         }
+        if (ogxm_trace::init) {
+            ogxm_trace::init();
+        }
 
         mutex_exit(&gpio_mutex_);
     }
     OGXM_LOG("Board initialized\n");
+    //Nothing else sends the log until the main loop starts waiting for events
+    OGXM_LOG_FLUSH();
 }
 
 } // namespace board_api
\ No newline at end of file
@@ -10,6 +10,11 @@ namespace board_api {
     void reboot();
     void set_led(bool state);
     uint32_t ms_since_boot();
+    //Sleeps until an interrupt, an event from the other core (__sev) or the timeout
+    void wait_for_event(uint32_t timeout_us = 1000);
+    //Resets and starts core1, flash is only written while it can be paused after this
+    void launch_core1(void (*core1_task)(void));
+    bool core1_launched();
 
     namespace usb {
         bool host_connected();
@@ -0,0 +1,184 @@
+#include "Board/Config.h"
+#if defined(CONFIG_EN_4CH)
+
+#include <atomic>
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+#include <hardware/irq.h>
+
+#include "Board/i2c_master.h"
+
+namespace i2c_master {
+
+static constexpr uint32_t FIFO_DEPTH = 16;
+
+enum class Phase : uint8_t { WRITE, READ };
+
+//Owned by start() while idle, by the IRQ while busy
+static const uint8_t* tx_{nullptr};
+static uint8_t* rx_{nullptr};
+static size_t tx_len_{0};
+static size_t rx_len_{0};
+static size_t cmd_pos_{0};
+static size_t rx_pos_{0};
+static Phase phase_{Phase::WRITE};
+static bool aborted_{false};
+static uint32_t abort_source_{0};
+static uint32_t start_us_{0};
+
+static std::atomic<Result> result_{Result::IDLE};
+
+static inline i2c_hw_t* hw() {
+    return i2c_get_hw(I2C_PORT);
+}
+
+static inline uint32_t irq_num() {
+    return I2C0_IRQ + i2c_get_index(I2C_PORT);
+}
+
+static inline size_t phase_len() {
+    return (phase_ == Phase::WRITE) ? tx_len_ : rx_len_;
+}
+
+//Queues as many data/read commands as the FIFOs allow, STOP goes on the last one
+static void fill_fifo() {
+    i2c_hw_t* i2c = hw();
+    const size_t len = phase_len();
+
+    while ((cmd_pos_ < len) && (i2c->txflr < FIFO_DEPTH)) {
+        const uint32_t stop = (cmd_pos_ == len - 1) ? I2C_IC_DATA_CMD_STOP_BITS : 0;
+
+        if (phase_ == Phase::WRITE) {
+            i2c->data_cmd = tx_[cmd_pos_] | stop;
+        } else {
+            //Don't request more bytes than the RX FIFO can hold
+            if ((cmd_pos_ - rx_pos_) >= FIFO_DEPTH) {
+                break;
+            }
+            i2c->data_cmd = I2C_IC_DATA_CMD_CMD_BITS | stop;
+        }
+        ++cmd_pos_;
+    }
+
+    //Reads are limited by RX FIFO space so they're refilled as bytes come in, not on TX_EMPTY
+    uint32_t mask = I2C_IC_INTR_MASK_M_TX_ABRT_BITS | I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+    if (phase_ == Phase::READ) {
+        mask |= I2C_IC_INTR_MASK_M_RX_FULL_BITS;
+    } else if (cmd_pos_ < len) {
+        mask |= I2C_IC_INTR_MASK_M_TX_EMPTY_BITS;
+    }
+    i2c->intr_mask = mask;
+}
+
+static void begin_phase(Phase phase) {
+    phase_ = phase;
+    cmd_pos_ = 0;
+    fill_fifo();
+}
+
+static void finish(Result result) {
+    hw()->intr_mask = 0;
+    result_.store(result, std::memory_order_release);
+}
+
+static void drain_rx() {
+    i2c_hw_t* i2c = hw();
+    while (i2c->rxflr && (rx_pos_ < rx_len_)) {
+        rx_[rx_pos_++] = static_cast<uint8_t>(i2c->data_cmd);
+    }
+}
+
+static void irq_handler() {
+    i2c_hw_t* i2c = hw();
+    const uint32_t status = i2c->intr_stat;
+
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        //The controller flushes the FIFO and sends STOP, finish on STOP_DET
+        abort_source_ = i2c->tx_abrt_source;
+        (void)i2c->clr_tx_abrt;
+        aborted_ = true;
+        i2c->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+    }
+
+    if (!aborted_) {
+        if (status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) {
+            drain_rx();
+        }
+        if (status & (I2C_IC_INTR_STAT_R_TX_EMPTY_BITS | I2C_IC_INTR_STAT_R_RX_FULL_BITS)) {
+            fill_fifo();
+        }
+    }
+
+    if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)i2c->clr_stop_det;
+
+        if (aborted_) {
+            finish((abort_source_ & I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS) ? Result::NAK : Result::ERROR);
+        } else if ((phase_ == Phase::WRITE) && rx_len_) {
+            begin_phase(Phase::READ);
+        } else {
+            drain_rx();
+            finish((rx_pos_ == rx_len_) ? Result::OK : Result::ERROR);
+        }
+    }
+}
+
+void init() {
+    i2c_hw_t* i2c = hw();
+    i2c->intr_mask = 0;
+    i2c->tx_tl = FIFO_DEPTH / 2;
+    i2c->rx_tl = 0;
+
+    irq_set_exclusive_handler(irq_num(), irq_handler);
+    irq_set_enabled(irq_num(), true);
+}
+
+bool start(uint8_t address, const void* tx, size_t tx_len, void* rx, size_t rx_len) {
+    if (busy() || (tx_len == 0 && rx_len == 0)) {
+        return false;
+    }
+
+    tx_ = static_cast<const uint8_t*>(tx);
+    rx_ = static_cast<uint8_t*>(rx);
+    tx_len_ = tx_len;
+    rx_len_ = rx_len;
+    rx_pos_ = 0;
+    aborted_ = false;
+    abort_source_ = 0;
+    start_us_ = time_us_32();
+    result_.store(Result::BUSY, std::memory_order_relaxed);
+
+    i2c_hw_t* i2c = hw();
+    i2c->enable = 0;
+    i2c->tar = address;
+    i2c->enable = I2C_IC_ENABLE_ENABLE_BITS;
+    (void)i2c->clr_intr;
+
+    irq_set_enabled(irq_num(), false);
+    begin_phase(tx_len ? Phase::WRITE : Phase::READ);
+    irq_set_enabled(irq_num(), true);
+    return true;
+}
+
+Result result(uint32_t timeout_us) {
+    const Result result = result_.load(std::memory_order_acquire);
+
+    if ((result == Result::BUSY) && ((time_us_32() - start_us_) > timeout_us)) {
+        //Slave is holding the bus, abort and let the next start() reset the controller
+        irq_set_enabled(irq_num(), false);
+        hw()->intr_mask = 0;
+        hw()->enable = I2C_IC_ENABLE_ABORT_BITS | I2C_IC_ENABLE_ENABLE_BITS;
+        result_.store(Result::ERROR, std::memory_order_relaxed);
+        irq_set_enabled(irq_num(), true);
+        return Result::ERROR;
+    }
+    return result;
+}
+
+bool busy() {
+    return (result_.load(std::memory_order_acquire) == Result::BUSY);
+}
+
+} // namespace i2c_master
+
+#endif // defined(CONFIG_EN_4CH)
@@ -0,0 +1,36 @@
+#ifndef BOARD_API_I2C_MASTER_H
+#define BOARD_API_I2C_MASTER_H
+
+#include "Board/Config.h"
+#if defined(CONFIG_EN_4CH)
+
+#include <cstdint>
+#include <cstddef>
+
+/*  Non-blocking I2C master, transfers are driven by the I2C IRQ from the hardware FIFOs.
+    One transfer is on the bus at a time, start one, keep running the core0 loop and
+    check result() until it's no longer BUSY. Core0 only. */
+namespace i2c_master {
+    enum class Result : uint8_t {
+        IDLE = 0,
+        BUSY,
+        OK,
+        NAK,    // Address wasn't acknowledged, slave isn't there
+        ERROR   // Aborted after the address or timed out
+    };
+
+    //Call after i2c_init, installs the IRQ handler on the calling core
+    void init();
+
+    //Writes tx_len bytes then reads rx_len bytes in a separate transfer, either length can be 0 but not both.
+    //Buffers must stay valid until the result is no longer BUSY, returns false if a transfer is in flight.
+    bool start(uint8_t address, const void* tx, size_t tx_len, void* rx, size_t rx_len);
+
+    //Aborts the transfer if it's been on the bus longer than timeout_us, call from the loop
+    Result result(uint32_t timeout_us = 10000);
+    bool busy();
+} // namespace i2c_master
+
+#endif // defined(CONFIG_EN_4CH)
+
+#endif // BOARD_API_I2C_MASTER_H
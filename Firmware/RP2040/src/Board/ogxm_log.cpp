@@ -2,88 +2,217 @@
 #if defined(CONFIG_OGXM_DEBUG)
 
 #include <cstdint>
-#include <string>
-#include <sstream>
-#include <iostream>
-#include <iomanip>
-#include <pico/mutex.h>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <pico/platform.h>
+#include <pico/stdio/driver.h>
+#include <pico/stdio.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
 #include <hardware/uart.h>
 #include <hardware/gpio.h>
+#include <hardware/dma.h>
 
-#include "USBDevice/DeviceDriver/DeviceDriverTypes.h"
 #include "Board/ogxm_log.h"
 
-std::ostream& operator<<(std::ostream& os, DeviceDriverType type) {
-    switch (type) {
-        case DeviceDriverType::NONE:          os << "NONE"; break;
-        case DeviceDriverType::XBOXOG:        os << "XBOXOG"; break;
-        case DeviceDriverType::XBOXOG_SB:     os << "XBOXOG_SB"; break;
-        case DeviceDriverType::XBOXOG_XR:     os << "XBOXOG_XR"; break;
-        case DeviceDriverType::XINPUT:        os << "XINPUT"; break;
-        case DeviceDriverType::PS3:           os << "PS3"; break;
-        case DeviceDriverType::DINPUT:        os << "DINPUT"; break;
-        case DeviceDriverType::PSCLASSIC:     os << "PSCLASSIC"; break;
-        case DeviceDriverType::SWITCH:        os << "SWITCH"; break;
-        case DeviceDriverType::WEBAPP:        os << "WEBAPP"; break;
-        case DeviceDriverType::UART_BRIDGE:   os << "UART_BRIDGE"; break;
-        default:                              os << "UNKNOWN"; break;
+namespace ogxm_log {
+
+static constexpr size_t NUM_CORES = 2;
+static constexpr size_t RING_SIZE = 64; //Power of 2
+static constexpr size_t TX_BUFFER_SIZE = 512;
+
+struct Record {
+    RecordHeader header;
+    std::array<uint8_t, MAX_PAYLOAD> payload;
+};
+
+//SPSC, the core produces, flush consumes on core0.
+//Interrupts are off while a record is written so an IRQ on the same core can log too
+struct CoreLog {
+    std::array<Record, RING_SIZE> ring;
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+    uint16_t seq{0};
+};
+
+static CoreLog logs_[NUM_CORES];
+
+//Only touched by flush, the DMA reads from it while a transfer is running
+static std::array<uint8_t, TX_BUFFER_SIZE> tx_buffer_;
+static int dma_channel_{-1};
+static size_t first_core_{0};
+
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint8_t>((crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1));
+        }
     }
-    return os;
+    return crc;
 }
 
-namespace ogxm_log {
+static void stdio_out_chars(const char* buf, int len);
+
+//Takes stdio's place on the debug UART so its text can't land in the middle of a DMA'd record
+static stdio_driver_t stdio_driver_;
 
 void init() {
     uart_init(DEBUG_UART_PORT, PICO_DEFAULT_UART_BAUD_RATE);
     gpio_set_function(PICO_DEFAULT_UART_TX_PIN, GPIO_FUNC_UART);
     gpio_set_function(PICO_DEFAULT_UART_RX_PIN, GPIO_FUNC_UART);
+
+    dma_channel_ = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(static_cast<uint>(dma_channel_));
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, uart_get_dreq(DEBUG_UART_PORT, true));
+    dma_channel_configure(static_cast<uint>(dma_channel_), &config, &uart_get_hw(DEBUG_UART_PORT)->dr, tx_buffer_.data(), 0, false);
+
+    stdio_driver_.out_chars = stdio_out_chars;
+    stdio_set_driver_enabled(&stdio_driver_, true);
 }
 
-void log(const std::string& message) {
-    static mutex_t log_mutex;
+static void write_record(uint32_t fmt, const void* payload, size_t len) {
+    const uint32_t time_us = time_us_32();
+    const uint32_t irq_state = save_and_disable_interrupts();
 
-    if (!mutex_is_initialized(&log_mutex)) {
-        mutex_init(&log_mutex);
-    }
+    const uint8_t core = static_cast<uint8_t>(get_core_num());
+    CoreLog& log = logs_[core];
+    const uint16_t seq = log.seq++;
+    const uint32_t head = log.head.load(std::memory_order_relaxed);
 
-    mutex_enter_blocking(&log_mutex);
+    if (head - log.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        //Drop the newest, the seq gap tells the decoder
+        log.dropped.store(log.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        restore_interrupts(irq_state);
+        return;
+    }
 
-    std::string formatted_msg = "OGXM: " + message;
+    Record& record = log.ring[head & (RING_SIZE - 1)];
+    len = std::min(len, MAX_PAYLOAD);
+    record.header.sync = RECORD_SYNC;
+    record.header.info = static_cast<uint8_t>((core << 7) | len);
+    record.header.seq = seq;
+    record.header.time_us = time_us;
+    record.header.fmt = fmt;
+    if (len) {
+        std::memcpy(record.payload.data(), payload, len);
+    }
+    log.head.store(head + 1, std::memory_order_release);
 
-    uart_puts(DEBUG_UART_PORT, formatted_msg.c_str());
+    restore_interrupts(irq_state);
+}
 
-    mutex_exit(&log_mutex);
+void write(const char* fmt, const void* payload, size_t len) {
+    write_record(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(fmt)), payload, len);
 }
 
-void log(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
+void write_hex(const uint8_t* data, size_t size) {
+    for (size_t offset = 0; offset < size; offset += MAX_PAYLOAD) {
+        write_record(FMT_HEX, data + offset, std::min(size - offset, MAX_PAYLOAD));
+    }
+}
 
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
+static void stdio_out_chars(const char* buf, int len) {
+    const size_t size = static_cast<size_t>(std::max(len, 0));
+    for (size_t offset = 0; offset < size; offset += MAX_PAYLOAD) {
+        write_record(FMT_TEXT, buf + offset, std::min(size - offset, MAX_PAYLOAD));
+    }
+}
 
-    std::string formatted_msg = std::string(buffer);
+//Copies records into tx_buffer_ until it's full, returns the bytes used.
+//The core that goes first alternates so a busy core can't starve the other one
+static size_t fill_tx_buffer() {
+    size_t len = 0;
+
+    for (size_t i = 0; i < NUM_CORES; ++i) {
+        CoreLog& log = logs_[(first_core_ + i) % NUM_CORES];
+        uint32_t tail = log.tail.load(std::memory_order_relaxed);
+        const uint32_t head = log.head.load(std::memory_order_acquire);
+
+        while (tail != head) {
+            const Record& record = log.ring[tail & (RING_SIZE - 1)];
+            const size_t payload_len = record.header.info & 0x3F;
+            const size_t record_len = sizeof(RecordHeader) + payload_len + 1;
+
+            if (len + record_len > tx_buffer_.size()) {
+                break;
+            }
+            std::memcpy(tx_buffer_.data() + len, &record.header, sizeof(RecordHeader));
+            std::memcpy(tx_buffer_.data() + len + sizeof(RecordHeader), record.payload.data(), payload_len);
+            tx_buffer_[len + record_len - 1] = crc8(tx_buffer_.data() + len, record_len - 1);
+
+            len += record_len;
+            ++tail;
+        }
+        log.tail.store(tail, std::memory_order_release);
+    }
+    first_core_ = (first_core_ + 1) % NUM_CORES;
+    return len;
+}
 
-    log(formatted_msg);
+void flush(bool blocking) {
+    if (dma_channel_ < 0) {
+        return;
+    }
+    const uint channel = static_cast<uint>(dma_channel_);
+
+    do {
+        if (dma_channel_is_busy(channel)) {
+            if (!blocking) {
+                return;
+            }
+            dma_channel_wait_for_finish_blocking(channel);
+        }
+        const size_t len = fill_tx_buffer();
+        if (len == 0) {
+            break;
+        }
+        dma_channel_transfer_from_buffer_now(channel, tx_buffer_.data(), static_cast<uint32_t>(len));
+    } while (blocking);
 
-    va_end(args);
+    if (blocking) {
+        dma_channel_wait_for_finish_blocking(channel);
+        uart_tx_wait_blocking(DEBUG_UART_PORT);
+    }
 }
 
-void log_hex(const uint8_t* data, size_t size) {
-    std::ostringstream hex_stream;
-    hex_stream << std::hex << std::setfill('0');
-    int count = 0;
-    for (uint16_t i = 0; i < size; ++i) {
-        hex_stream << std::setw(2) << static_cast<int>(data[i]) << " ";
-        if (++count == 16) {
-            hex_stream << "\n";
-            count = 0;
-        }
+uint32_t dropped_records() {
+    uint32_t dropped = 0;
+    for (auto& log : logs_) {
+        dropped += log.dropped.load(std::memory_order_relaxed);
     }
-    hex_stream << "\n";
-    log(hex_stream.str());
+    return dropped;
 }
 
 } // namespace ogxm_log
 
-#endif // defined(CONFIG_OGXM_DEBUG)
\ No newline at end of file
+//PICO_PANIC_FUNCTION in a Debug build. The SDK's panic prints to stdio and stops, 
+//here stdio only queues records so they're sent before stopping
+extern "C" void __attribute__((noreturn)) ogxm_panic(const char* fmt, ...) {
+    ogxm_log::flush(true);
+
+    std::puts("\n*** PANIC ***\n");
+    if (fmt) {
+        va_list args;
+        va_start(args, fmt);
+        std::vprintf(fmt, args);
+        va_end(args);
+        std::puts("\n");
+    }
+    ogxm_log::flush(true);
+
+    while (true) {
+        __breakpoint();
+    }
+}
+
+#endif // defined(CONFIG_OGXM_DEBUG)
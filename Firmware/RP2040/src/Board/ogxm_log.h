@@ -2,41 +2,87 @@
 #define BOARD_API_LOG_H
 
 #include <cstdint>
+#include <cstddef>
 
 #include "Board/Config.h"
-#if defined(CONFIG_OGXM_DEBUG)
 
-#include <string>
-#include <sstream>
-#include <iostream>
-#include <stdarg.h>
+/*  Deferred binary logging. OGXM_LOG doesn't format anything, it copies the format string's address,
+    the raw arguments, a timestamp and the core number into that core's ring and returns. The core0 loop
+    hands queued records to DMA, which feeds the debug UART. Tools/ogxm_log_decode.py rebuilds the text
+    using the firmware ELF.
+    The format string must be a literal, %s arguments must point to strings that are in the ELF.
+    stdio (printf, panic, TinyUSB debug) is a driver that queues its text as records too, nothing else 
+    writes to the UART while DMA is feeding it. */
+namespace ogxm_log {
+    static constexpr uint8_t  RECORD_SYNC = 0xA5;
+    static constexpr uint32_t FMT_HEX = 0;  // Payload is a hex dump
+    static constexpr uint32_t FMT_TEXT = 1; // Payload is text from stdio, never a string's address
+    static constexpr size_t   MAX_ARGS = 8;
+    static constexpr size_t   MAX_PAYLOAD = MAX_ARGS * sizeof(uint32_t);
 
-#include "USBDevice/DeviceDriver/DeviceDriverTypes.h"
+    #pragma pack(push, 1)
+    //On the wire it's followed by 'len' payload bytes and a CRC-8 of everything before it
+    struct RecordHeader {
+        uint8_t  sync{RECORD_SYNC};
+        uint8_t  info{0};    // Bit 7 core, bits 0-5 payload length in bytes
+        uint16_t seq{0};     // Per core, a gap means records were dropped
+        uint32_t time_us{0};
+        uint32_t fmt{0};     // Address of the format string, or FMT_HEX/FMT_TEXT
+    };
+    static_assert(sizeof(RecordHeader) == 12, "Log record header size mismatch");
+    #pragma pack(pop)
+}
 
-std::ostream& operator<<(std::ostream& os, DeviceDriverType type);
+#if defined(CONFIG_OGXM_DEBUG)
+
+#include <cstring>
+#include <type_traits>
 
 namespace ogxm_log {
     void init() __attribute__((weak));
-    //Don't use this directly, use the OGXM_LOG macro
-    void log(const std::string& message);
-    //Don't use this directly, use the OGXM_LOG macro
-    void log(const char* fmt, ...);
-    //Don't use this directly, use the OGXM_LOG_HEX macro
-    void log_hex(const uint8_t* data, size_t size);
 
+    //Don't use these directly, use the OGXM_LOG macros
+    void write(const char* fmt, const void* payload, size_t len);
+    void write_hex(const uint8_t* data, size_t size);
+
+    //Starts a DMA transfer of whatever is queued if the last one finished, core0 only.
+    //Blocking waits until both rings are empty and sent, for fatal errors.
+    void flush(bool blocking = false);
+    uint32_t dropped_records();
+
+    //Every argument is sent as one 32 bit word, floats as their float bits
     template <typename T>
-    std::string to_string(const T& value) {
-        std::ostringstream stream;
-        stream << value;
-        return stream.str();
+    inline uint32_t to_arg(T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            const float value_f = static_cast<float>(value);
+            uint32_t bits;
+            std::memcpy(&bits, &value_f, sizeof(bits));
+            return bits;
+        } else if constexpr (std::is_pointer_v<T>) {
+            return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value));
+        } else {
+            return static_cast<uint32_t>(value);
+        }
+    }
+
+    //Don't use this directly, use the OGXM_LOG macro
+    template <typename... Args>
+    inline void log(const char* fmt, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "OGXM_LOG takes at most MAX_ARGS arguments");
+        if constexpr (sizeof...(Args) == 0) {
+            write(fmt, nullptr, 0);
+        } else {
+            const uint32_t words[] = { to_arg(args)... };
+            write(fmt, words, sizeof(words));
+        }
     }
 }
 
 #define OGXM_LOG ogxm_log::log
-#define OGXM_LOG_HEX ogxm_log::log_hex
-#define OGXM_ASSERT(x) if (!(x)) { OGXM_LOG("Assertion failed: " #x); while(1); }
-#define OGXM_ASSERT_MSG(x, msg) if (!(x)) { OGXM_LOG("Assertion failed: " #x " " msg); while(1); }
-#define OGXM_TO_STRING ogxm_log::to_string
+#define OGXM_LOG_HEX ogxm_log::write_hex
+#define OGXM_LOG_FLUSH() ogxm_log::flush()
+#define OGXM_ASSERT(x) if (!(x)) { OGXM_LOG("Assertion failed: " #x "\n"); ogxm_log::flush(true); while(1); }
+#define OGXM_ASSERT_MSG(x, msg) if (!(x)) { OGXM_LOG("Assertion failed: " #x " " msg "\n"); ogxm_log::flush(true); while(1); }
 
 #else // CONFIG_OGXM_DEBUG
 
@@ -46,10 +92,10 @@ namespace ogxm_log {
 
 #define OGXM_LOG(...)
 #define OGXM_LOG_HEX(...)
+#define OGXM_LOG_FLUSH()
 #define OGXM_ASSERT(x)
 #define OGXM_ASSERT_MSG(x, msg)
-#define OGXM_TO_STRING(x)
-    
+
 #endif // CONFIG_OGXM_DEBUG
 
-#endif // BOARD_API_LOG_H
\ No newline at end of file
+#endif // BOARD_API_LOG_H
@@ -0,0 +1,328 @@
+#include "Board/Config.h"
+#if defined(CONFIG_OGXM_TRACE)
+
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <pico/platform.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+
+#include "TaskQueue/TaskQueue.h"
+#include "Board/ogxm_log.h"
+#include "Board/ogxm_trace.h"
+
+namespace ogxm_trace {
+
+static constexpr size_t NUM_CORES = 2;
+static constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::COUNT);
+static constexpr size_t RING_SIZE = 128; //Power of 2
+static constexpr size_t NUM_BUCKETS = 64;
+static constexpr uint32_t DUMP_INTERVAL_MS = 5000;
+
+//Histograms and rings are only written by their own core, the atomics are plain ldr/str on the M0+.
+//IRQs trace too (set_pad_in from an I2C slave handler), so writers run with interrupts off
+struct Histogram {
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> min_us{UINT32_MAX};
+    std::atomic<uint32_t> max_us{0};
+    std::atomic<uint32_t> sum_lo{0};
+    std::atomic<uint32_t> sum_hi{0};
+    std::array<std::atomic<uint32_t>, NUM_BUCKETS> buckets{};
+};
+
+struct CoreTrace {
+    //Owned by the core, no sharing
+    uint32_t origin_us{0};
+    uint32_t submit_origin_us{0};
+    uint32_t last_rx_us{0};
+
+    //Readers retry if a histogram update overlaps, same as SeqLock
+    std::atomic<uint32_t> hist_seq{0};
+    std::array<Histogram, NUM_STAGES> histograms;
+    std::atomic<bool> reset_pending{false};
+
+    //SPSC, this core produces, read_events consumes
+    std::array<Event, RING_SIZE> ring;
+    std::atomic<uint32_t> ring_head{0};
+    std::atomic<uint32_t> ring_tail{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
+static CoreTrace traces_[NUM_CORES];
+
+static inline uint32_t timestamp() {
+    //0 marks "no origin"
+    return std::max(time_us_32(), static_cast<uint32_t>(1));
+}
+
+//Log-linear buckets, exact below 16us then 4 buckets per power of 2 up to 65ms
+static inline size_t bucket_index(uint32_t us) {
+    if (us < 16) {
+        return us;
+    }
+    size_t msb = 31 - static_cast<size_t>(__builtin_clz(us));
+    size_t idx = 16 + (msb - 4) * 4 + ((us >> (msb - 2)) & 3);
+    return std::min(idx, NUM_BUCKETS - 1);
+}
+
+static inline uint32_t bucket_upper_us(size_t idx) {
+    if (idx < 16) {
+        return static_cast<uint32_t>(idx);
+    }
+    uint32_t msb = static_cast<uint32_t>(4 + (idx - 16) / 4);
+    uint32_t sub = static_cast<uint32_t>((idx - 16) % 4);
+    return (1u << msb) + (sub + 1) * (1u << (msb - 2)) - 1;
+}
+
+static void reset_histograms(CoreTrace& trace) {
+    for (auto& histogram : trace.histograms) {
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.min_us.store(UINT32_MAX, std::memory_order_relaxed);
+        histogram.max_us.store(0, std::memory_order_relaxed);
+        histogram.sum_lo.store(0, std::memory_order_relaxed);
+        histogram.sum_hi.store(0, std::memory_order_relaxed);
+        for (auto& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+//Interrupts must be off, see above
+static void add_sample(Stage stage, uint32_t now, uint32_t latency_us) {
+    const uint8_t core = static_cast<uint8_t>(get_core_num());
+    CoreTrace& trace = traces_[core];
+
+    const uint32_t seq = trace.hist_seq.load(std::memory_order_relaxed);
+    trace.hist_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (trace.reset_pending.load(std::memory_order_relaxed)) {
+        reset_histograms(trace);
+        trace.reset_pending.store(false, std::memory_order_relaxed);
+    }
+
+    Histogram& histogram = trace.histograms[static_cast<size_t>(stage)];
+    const uint32_t sum_lo = histogram.sum_lo.load(std::memory_order_relaxed);
+
+    histogram.count.store(histogram.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    histogram.min_us.store(std::min(histogram.min_us.load(std::memory_order_relaxed), latency_us), std::memory_order_relaxed);
+    histogram.max_us.store(std::max(histogram.max_us.load(std::memory_order_relaxed), latency_us), std::memory_order_relaxed);
+    histogram.sum_lo.store(sum_lo + latency_us, std::memory_order_relaxed);
+    if (sum_lo + latency_us < sum_lo) {
+        histogram.sum_hi.store(histogram.sum_hi.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    auto& bucket = histogram.buckets[bucket_index(latency_us)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    trace.hist_seq.store(seq + 2, std::memory_order_release);
+
+    const uint32_t head = trace.ring_head.load(std::memory_order_relaxed);
+    if (head - trace.ring_tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        //Drop the newest, the reader owns the old entries
+        trace.dropped.store(trace.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& event = trace.ring[head & (RING_SIZE - 1)];
+    event.time_us = now;
+    event.latency_us = static_cast<uint16_t>(std::min(latency_us, static_cast<uint32_t>(UINT16_MAX)));
+    event.stage = stage;
+    event.core = core;
+    trace.ring_head.store(head + 1, std::memory_order_release);
+}
+
+void begin() {
+    const uint32_t irq_state = save_and_disable_interrupts();
+    CoreTrace& trace = traces_[get_core_num()];
+    const uint32_t now = timestamp();
+
+    if (trace.last_rx_us) {
+        add_sample(Stage::HOST_RX, now, now - trace.last_rx_us);
+    }
+    trace.last_rx_us = now;
+    trace.origin_us = now;
+    restore_interrupts(irq_state);
+}
+
+uint32_t take_origin() {
+    const uint32_t irq_state = save_and_disable_interrupts();
+    CoreTrace& trace = traces_[get_core_num()];
+    //Hosts that don't call begin (Bluetooth, I2C) are measured from set_pad_in
+    const uint32_t origin = trace.origin_us ? trace.origin_us : timestamp();
+    trace.origin_us = 0;
+    restore_interrupts(irq_state);
+    return origin;
+}
+
+void process(uint32_t origin_us) {
+    const uint32_t irq_state = save_and_disable_interrupts();
+    traces_[get_core_num()].origin_us = origin_us;
+    record(Stage::DEVICE_PROCESS);
+    restore_interrupts(irq_state);
+}
+
+void record(Stage stage) {
+    const uint32_t irq_state = save_and_disable_interrupts();
+    CoreTrace& trace = traces_[get_core_num()];
+    const uint32_t now = timestamp();
+    uint32_t origin = trace.origin_us;
+
+    switch (stage) {
+        case Stage::DEVICE_SUBMIT:
+            //Drivers that resend the last report every loop only count the first submit
+            if (origin) {
+                trace.submit_origin_us = origin;
+                trace.origin_us = 0;
+            }
+            break;
+        case Stage::DEVICE_COMPLETE:
+            //Assumes one report in flight per core, good enough for a single IN endpoint
+            origin = trace.submit_origin_us;
+            trace.submit_origin_us = 0;
+            break;
+        default:
+            break;
+    }
+
+    if (origin) {
+        add_sample(stage, now, now - origin);
+    }
+    restore_interrupts(irq_state);
+}
+
+Stats get_stats(Stage stage) {
+    uint32_t count = 0;
+    uint32_t min_us = UINT32_MAX;
+    uint32_t max_us = 0;
+    uint64_t sum_us = 0;
+    std::array<uint32_t, NUM_BUCKETS> buckets{0};
+
+    for (auto& trace : traces_) {
+        const Histogram& histogram = trace.histograms[static_cast<size_t>(stage)];
+        uint32_t seq_start = 0;
+        uint32_t seq_end = 0;
+        uint32_t core_count, core_min, core_max, core_sum_lo, core_sum_hi;
+        std::array<uint32_t, NUM_BUCKETS> core_buckets;
+
+        do {
+            seq_start = trace.hist_seq.load(std::memory_order_acquire);
+
+            core_count = histogram.count.load(std::memory_order_relaxed);
+            core_min = histogram.min_us.load(std::memory_order_relaxed);
+            core_max = histogram.max_us.load(std::memory_order_relaxed);
+            core_sum_lo = histogram.sum_lo.load(std::memory_order_relaxed);
+            core_sum_hi = histogram.sum_hi.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+                core_buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq_end = trace.hist_seq.load(std::memory_order_relaxed);
+        } while ((seq_start & 1) || (seq_start != seq_end));
+
+        if (core_count == 0) {
+            continue;
+        }
+        count += core_count;
+        min_us = std::min(min_us, core_min);
+        max_us = std::max(max_us, core_max);
+        sum_us += (static_cast<uint64_t>(core_sum_hi) << 32) | core_sum_lo;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            buckets[i] += core_buckets[i];
+        }
+    }
+
+    Stats stats;
+    if (count == 0) {
+        return stats;
+    }
+
+    stats.count = count;
+    stats.min_us = min_us;
+    stats.max_us = max_us;
+    stats.avg_us = static_cast<uint32_t>(sum_us / count);
+
+    const uint32_t p99_rank = count - (count / 100);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= p99_rank) {
+            stats.p99_us = std::min(bucket_upper_us(i), max_us);
+            break;
+        }
+    }
+    return stats;
+}
+
+size_t read_events(Event* events, size_t max_events) {
+    size_t read = 0;
+    for (auto& trace : traces_) {
+        uint32_t tail = trace.ring_tail.load(std::memory_order_relaxed);
+        const uint32_t head = trace.ring_head.load(std::memory_order_acquire);
+
+        while (tail != head && read < max_events) {
+            events[read++] = trace.ring[tail & (RING_SIZE - 1)];
+            ++tail;
+        }
+        trace.ring_tail.store(tail, std::memory_order_release);
+    }
+    return read;
+}
+
+uint32_t dropped_events() {
+    uint32_t dropped = 0;
+    for (auto& trace : traces_) {
+        dropped += trace.dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void reset() {
+    for (auto& trace : traces_) {
+        trace.reset_pending.store(true, std::memory_order_relaxed);
+        //Reader side owns the tail, emptying the ring from here is safe
+        trace.ring_tail.store(trace.ring_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+}
+
+#if defined(CONFIG_OGXM_DEBUG)
+
+static const char* stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::HOST_RX:         return "HOST_RX";
+        case Stage::HOST_PROCESS:    return "HOST_PROCESS";
+        case Stage::PAD_IN_SET:      return "PAD_IN_SET";
+        case Stage::DEVICE_PROCESS:  return "DEVICE_PROCESS";
+        case Stage::DEVICE_SUBMIT:   return "DEVICE_SUBMIT";
+        case Stage::DEVICE_COMPLETE: return "DEVICE_COMPLETE";
+        default:                     return "UNKNOWN";
+    }
+}
+
+void dump() {
+    OGXM_LOG("Latency (us) count/min/avg/p99/max, dropped events: %u\n", dropped_events());
+    for (size_t i = 0; i < NUM_STAGES; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        const Stats stats = get_stats(stage);
+        OGXM_LOG("  %-16s %8u %6u %6u %6u %6u\n", stage_name(stage),
+            stats.count, stats.min_us, stats.avg_us, stats.p99_us, stats.max_us);
+    }
+}
+
+void init() {
+    TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), DUMP_INTERVAL_MS, true, [] {
+        dump();
+    });
+}
+
+#else // CONFIG_OGXM_DEBUG
+
+void dump() {}
+
+#endif // CONFIG_OGXM_DEBUG
+
+} // namespace ogxm_trace
+
+#endif // defined(CONFIG_OGXM_TRACE)
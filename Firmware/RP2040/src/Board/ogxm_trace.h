@@ -0,0 +1,86 @@
+#ifndef BOARD_API_TRACE_H
+#define BOARD_API_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "Board/Config.h"
+
+/*  Per-report latency tracing, host IN transfer to device IN transfer.
+    Enable with -DOGXM_TRACE=TRUE. Every stage is timestamped relative to the moment the
+    host report arrived (the report's origin), each core writes its own event ring and
+    histograms so nothing is shared between producers and nothing blocks. */
+namespace ogxm_trace {
+    enum class Stage : uint8_t {
+        HOST_RX = 0,     // Host xfer complete, histogram holds the interval between host reports
+        HOST_PROCESS,    // HostDriver::process_report called
+        PAD_IN_SET,      // Gamepad::set_pad_in
+        DEVICE_PROCESS,  // DeviceDriver::process picked up the new PadIn
+        DEVICE_SUBMIT,   // Device IN xfer queued
+        DEVICE_COMPLETE, // Device IN xfer completed
+        COUNT
+    };
+
+    #pragma pack(push, 1)
+    struct Event {
+        uint32_t time_us{0};
+        uint16_t latency_us{0};
+        Stage stage{Stage::COUNT};
+        uint8_t core{0};
+    };
+    static_assert(sizeof(Event) == 8, "Trace event size mismatch");
+
+    struct Stats {
+        uint32_t count{0};
+        uint32_t min_us{0};
+        uint32_t avg_us{0};
+        uint32_t p99_us{0};
+        uint32_t max_us{0};
+    };
+    static_assert(sizeof(Stats) == 20, "Trace stats size mismatch");
+    #pragma pack(pop)
+}
+
+#if defined(CONFIG_OGXM_TRACE)
+
+namespace ogxm_trace {
+    void init() __attribute__((weak));
+
+    //Don't use these directly, use the OGXM_TRACE macros
+    void begin();
+    uint32_t take_origin();
+    void process(uint32_t origin_us);
+    void record(Stage stage);
+
+    //Merged over both cores, p99 is the upper bound of the bucket it falls in
+    Stats get_stats(Stage stage);
+    //Drains both event rings, only one context may read events
+    size_t read_events(Event* events, size_t max_events);
+    uint32_t dropped_events();
+    //Empties the rings, histograms are cleared by each core the next time it records
+    void reset();
+    //Prints stats for all stages over the debug UART
+    void dump();
+}
+
+#define OGXM_TRACE_BEGIN() ogxm_trace::begin()
+#define OGXM_TRACE(stage) ogxm_trace::record(ogxm_trace::Stage::stage)
+//Called on the host side, hands the current origin to the gamepad
+#define OGXM_TRACE_TAKE_ORIGIN() ogxm_trace::take_origin()
+//Called on the device side, adopts the origin of the report just read and records DEVICE_PROCESS
+#define OGXM_TRACE_PROCESS(origin) ogxm_trace::process(origin)
+
+#else // CONFIG_OGXM_TRACE
+
+namespace ogxm_trace {
+    void init() __attribute__((weak));
+}
+
+#define OGXM_TRACE_BEGIN()
+#define OGXM_TRACE(stage)
+#define OGXM_TRACE_TAKE_ORIGIN() 0
+#define OGXM_TRACE_PROCESS(origin)
+
+#endif // CONFIG_OGXM_TRACE
+
+#endif // BOARD_API_TRACE_H
@@ -0,0 +1,116 @@
+#ifndef _BUTTON_LUT_H_
+#define _BUTTON_LUT_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#include "Gamepad/Gamepad.h"
+
+/*  Translates button bits from one layout to another. Host drivers build one per report 
+    format to get Gamepad::BUTTON_* or DPAD_* bits, device drivers build one per report format 
+    to go from Gamepad::BUTTON_* bits back to report bits. Built at compile time, a lookup is 
+    one 16 entry table per source nibble ORed together, no branches. */
+template <size_t BITS, typename OutType = uint16_t>
+class ButtonLut
+{
+public:
+    static_assert(BITS > 0 && BITS <= 32 && (BITS % 8) == 0, "ButtonLut source must be 1 to 4 bytes");
+
+    static constexpr size_t NIBBLES = BITS / 4;
+
+    //Any bit of source_mask set in the source sets button
+    constexpr ButtonLut& map(uint32_t source_mask, OutType button)
+    {
+        for (size_t nibble = 0; nibble < NIBBLES; ++nibble)
+        {
+            const uint32_t nibble_mask = (source_mask >> (nibble * 4)) & 0x0F;
+            for (uint32_t value = 0; value < 16; ++value)
+            {
+                if (value & nibble_mask)
+                {
+                    tables_[nibble][value] |= button;
+                }
+            }
+        }
+        return *this;
+    }
+
+    //Same as above for sources split into bytes, byte 0 is the low byte
+    constexpr ButtonLut& map(size_t byte, uint8_t source_mask, OutType button)
+    {
+        return map(static_cast<uint32_t>(source_mask) << (byte * 8), button);
+    }
+
+    //For destinations split into bytes, button is set in byte out_byte of the result
+    constexpr ButtonLut& map_to(uint32_t source_mask, size_t out_byte, uint8_t button)
+    {
+        return map(source_mask, static_cast<OutType>(static_cast<OutType>(button) << (out_byte * 8)));
+    }
+
+    inline OutType operator()(uint32_t source) const
+    {
+        OutType buttons = 0;
+        for (size_t nibble = 0; nibble < NIBBLES; ++nibble)
+        {
+            buttons |= tables_[nibble][(source >> (nibble * 4)) & 0x0F];
+        }
+        return buttons;
+    }
+
+    inline OutType operator()(const uint8_t* source) const
+    {
+        OutType buttons = 0;
+        for (size_t byte = 0; byte < (BITS / 8); ++byte)
+        {
+            buttons |= tables_[byte * 2][source[byte] & 0x0F];
+            buttons |= tables_[byte * 2 + 1][source[byte] >> 4];
+        }
+        return buttons;
+    }
+
+private:
+    std::array<std::array<OutType, 16>, NIBBLES> tables_{};
+};
+
+/*  Encodes Gamepad::DPAD_* bits for a device report, indexed by the dpad value.
+    Opposing directions pressed together aren't a valid state and encode as centered. */
+template <typename OutType>
+class DPadLut
+{
+public:
+    //For reports with a hat switch
+    static constexpr DPadLut hat(   OutType up, OutType up_right, OutType right, OutType down_right,
+                                    OutType down, OutType down_left, OutType left, OutType up_left,
+                                    OutType center)
+    {
+        DPadLut lut;
+        lut.table_.fill(center);
+        lut.table_[Gamepad::DPAD_UP]         = up;
+        lut.table_[Gamepad::DPAD_UP_RIGHT]   = up_right;
+        lut.table_[Gamepad::DPAD_RIGHT]      = right;
+        lut.table_[Gamepad::DPAD_DOWN_RIGHT] = down_right;
+        lut.table_[Gamepad::DPAD_DOWN]       = down;
+        lut.table_[Gamepad::DPAD_DOWN_LEFT]  = down_left;
+        lut.table_[Gamepad::DPAD_LEFT]       = left;
+        lut.table_[Gamepad::DPAD_UP_LEFT]    = up_left;
+        return lut;
+    }
+
+    //For reports with a bit per direction
+    static constexpr DPadLut bits(OutType up, OutType down, OutType left, OutType right)
+    {
+        return hat( up, up | right, right, down | right, 
+                    down, down | left, left, up | left, 0);
+    }
+
+    inline OutType operator()(uint8_t dpad) const
+    {
+        return table_[dpad & 0x0F];
+    }
+
+private:
+    std::array<OutType, 16> table_{};
+};
+
+#endif // _BUTTON_LUT_H_
@@ -7,16 +7,20 @@
 #include <cstring>
 #include <array>
 #include <cmath>
-#include <pico/mutex.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
 
 #include "libfixmath/fix16.hpp"
 
 #include "Gamepad/Range.h"
+#include "Gamepad/SeqLock.h"
 #include "Gamepad/fix16ext.h"
+#include "Gamepad/JoystickShaper.h"
 #include "UserSettings/UserProfile.h"
 #include "UserSettings/JoystickSettings.h"
 #include "UserSettings/TriggerSettings.h"
 #include "Board/ogxm_log.h"
+#include "Board/ogxm_trace.h"
 
 class Gamepad 
 {
@@ -57,41 +61,24 @@ public:
     static constexpr uint8_t ANALOG_OFF_LB    = 8;
     static constexpr uint8_t ANALOG_OFF_RB    = 9;
 
-    //Mappings used by host to set buttons
-
-    uint8_t MAP_DPAD_UP         = DPAD_UP        ;
-    uint8_t MAP_DPAD_DOWN       = DPAD_DOWN      ;
-    uint8_t MAP_DPAD_LEFT       = DPAD_LEFT      ;
-    uint8_t MAP_DPAD_RIGHT      = DPAD_RIGHT     ;
-    uint8_t MAP_DPAD_UP_LEFT    = DPAD_UP_LEFT   ;
-    uint8_t MAP_DPAD_UP_RIGHT   = DPAD_UP_RIGHT  ;
-    uint8_t MAP_DPAD_DOWN_LEFT  = DPAD_DOWN_LEFT ;
-    uint8_t MAP_DPAD_DOWN_RIGHT = DPAD_DOWN_RIGHT;
-    uint8_t MAP_DPAD_NONE       = DPAD_NONE      ;
-
-    uint16_t MAP_BUTTON_A     = BUTTON_A    ;
-    uint16_t MAP_BUTTON_B     = BUTTON_B    ;
-    uint16_t MAP_BUTTON_X     = BUTTON_X    ;
-    uint16_t MAP_BUTTON_Y     = BUTTON_Y    ;
-    uint16_t MAP_BUTTON_L3    = BUTTON_L3   ;
-    uint16_t MAP_BUTTON_R3    = BUTTON_R3   ;
-    uint16_t MAP_BUTTON_BACK  = BUTTON_BACK ;
-    uint16_t MAP_BUTTON_START = BUTTON_START;
-    uint16_t MAP_BUTTON_LB    = BUTTON_LB   ;
-    uint16_t MAP_BUTTON_RB    = BUTTON_RB   ;
-    uint16_t MAP_BUTTON_SYS   = BUTTON_SYS  ;
-    uint16_t MAP_BUTTON_MISC  = BUTTON_MISC ;
-
-    uint8_t MAP_ANALOG_OFF_UP    = ANALOG_OFF_UP   ;
-    uint8_t MAP_ANALOG_OFF_DOWN  = ANALOG_OFF_DOWN ;
-    uint8_t MAP_ANALOG_OFF_LEFT  = ANALOG_OFF_LEFT ;
-    uint8_t MAP_ANALOG_OFF_RIGHT = ANALOG_OFF_RIGHT;
-    uint8_t MAP_ANALOG_OFF_A     = ANALOG_OFF_A    ;
-    uint8_t MAP_ANALOG_OFF_B     = ANALOG_OFF_B    ;
-    uint8_t MAP_ANALOG_OFF_X     = ANALOG_OFF_X    ;
-    uint8_t MAP_ANALOG_OFF_Y     = ANALOG_OFF_Y    ;
-    uint8_t MAP_ANALOG_OFF_LB    = ANALOG_OFF_LB   ;
-    uint8_t MAP_ANALOG_OFF_RB    = ANALOG_OFF_RB   ;
+    //PadIn fields, as returned by changed_fields
+
+    static constexpr uint8_t PAD_IN_DPAD       = 0x01;
+    static constexpr uint8_t PAD_IN_BUTTONS    = 0x02;
+    static constexpr uint8_t PAD_IN_TRIGGERS   = 0x04;
+    static constexpr uint8_t PAD_IN_JOYSTICK_L = 0x08;
+    static constexpr uint8_t PAD_IN_JOYSTICK_R = 0x10;
+    static constexpr uint8_t PAD_IN_ANALOG     = 0x20;
+
+    //Standard hat switch, 0 is up going clockwise, 8 and above is centered
+
+    static constexpr std::array<uint8_t, 16> HAT_DPAD = 
+    {
+        DPAD_UP, DPAD_UP_RIGHT, DPAD_RIGHT, DPAD_DOWN_RIGHT, 
+        DPAD_DOWN, DPAD_DOWN_LEFT, DPAD_LEFT, DPAD_UP_LEFT,
+        DPAD_NONE, DPAD_NONE, DPAD_NONE, DPAD_NONE, 
+        DPAD_NONE, DPAD_NONE, DPAD_NONE, DPAD_NONE
+    };
 
 #pragma pack(push, 1)
     struct PadIn
@@ -127,11 +114,27 @@ public:
 
 #pragma pack(pop)
 
+    //Mask of PAD_IN_* fields that differ between two PadIns, 0 if they're identical
+    static inline uint8_t changed_fields(const PadIn& a, const PadIn& b)
+    {
+        uint8_t changed = 0;
+        if (a.dpad != b.dpad) changed |= PAD_IN_DPAD;
+        if (a.buttons != b.buttons) changed |= PAD_IN_BUTTONS;
+        if (a.trigger_l != b.trigger_l || a.trigger_r != b.trigger_r) changed |= PAD_IN_TRIGGERS;
+        if (a.joystick_lx != b.joystick_lx || a.joystick_ly != b.joystick_ly) changed |= PAD_IN_JOYSTICK_L;
+        if (a.joystick_rx != b.joystick_rx || a.joystick_ry != b.joystick_ry) changed |= PAD_IN_JOYSTICK_R;
+        if (std::memcmp(a.analog, b.analog, sizeof(a.analog)) != 0) changed |= PAD_IN_ANALOG;
+        return changed;
+    }
+
+    static inline uint8_t hat_to_dpad(uint32_t hat)
+    {
+        return (hat < HAT_DPAD.size()) ? HAT_DPAD[hat] : DPAD_NONE;
+    }
+
     Gamepad()
     {
-        mutex_init(&pad_in_mutex_);
-        mutex_init(&pad_out_mutex_);
-        mutex_init(&chatpad_in_mutex_);
+        set_profile(UserProfile());
         reset_pad_in();
         reset_pad_out();
         reset_chatpad_in();
@@ -141,110 +144,150 @@ public:
 
     //Get
     inline bool new_pad_in() const { return new_pad_in_.load(); }
+
+    //BUTTON_* and DPAD_* bits to the ones set by the profile, host drivers translate
+    //their report to the default bits first, then remap with these
+    inline uint16_t map_buttons(uint16_t buttons) const 
+    { 
+        const ProfileSettings& settings = active_settings();
+        return settings.button_map_lo[buttons & 0xFF] | settings.button_map_hi[(buttons >> 8) & 0x0F]; 
+    }
+    inline uint8_t map_dpad(uint8_t dpad) const 
+    { 
+        return active_settings().dpad_map[dpad & 0x0F]; 
+    }
+    //ANALOG_OFF_* to the PadIn::analog offset set by the profile
+    inline uint8_t map_analog_off(uint8_t offset) const
+    {
+        return active_settings().analog_map[offset];
+    }
     inline bool new_pad_out() const { return new_pad_out_.load(); }
 
     //True if both host and device have enabled analog
     inline bool analog_enabled() const { return analog_enabled_.load(std::memory_order_relaxed); }
 
+    //Flag is cleared before the read so a report published during the copy is never lost
     inline PadIn get_pad_in()
     {
-        mutex_enter_blocking(&pad_in_mutex_);
-        PadIn pad_in = pad_in_;
         new_pad_in_.store(false);
-        mutex_exit(&pad_in_mutex_);
-
-        return pad_in;
+        const TimedPadIn timed = pad_in_.load();
+        pad_in_time_us_ = timed.time_us;
+        return timed.pad_in;
     }
 
+    //When the host core set the PadIn last returned by get_pad_in, same clock as time_us_32
+    inline uint32_t get_pad_in_time() const { return pad_in_time_us_; }
+
     inline PadOut get_pad_out()
     {
-        mutex_enter_blocking(&pad_out_mutex_);
-        PadOut pad_out = pad_out_;
         new_pad_out_.store(false);
-        mutex_exit(&pad_out_mutex_);
-
-        return pad_out;
+        return pad_out_.load();
     }
 
+    //Leave new_pad_in()/new_pad_out() set for whoever consumes them
+    inline PadIn peek_pad_in() const { return pad_in_.load().pad_in; }
+    inline PadOut peek_pad_out() const { return pad_out_.load(); }
+
     inline ChatpadIn get_chatpad_in()
     {
-        mutex_enter_blocking(&chatpad_in_mutex_);
-        ChatpadIn chatpad_in = chatpad_in_;
-        mutex_exit(&chatpad_in_mutex_);
-
-        return chatpad_in;
+        return chatpad_in_.load();
     }
 
+#if defined(CONFIG_OGXM_TRACE)
+    //Host arrival time of the latest PadIn, for ogxm_trace
+    inline uint32_t get_trace_origin() const { return trace_origin_.load(std::memory_order_relaxed); }
+#endif
+
     //Set
 
     void set_analog_device(bool value) 
     { 
         analog_device_.store(value); 
-        if (analog_host_.load() && analog_device_.load() && profile_analog_enabled_)
-        {
-            analog_enabled_.store(true);
-        }
+        update_analog_enabled();
     }
 
     void set_analog_host(bool value) 
     { 
         analog_host_.store(value); 
-        if (analog_host_.load() && analog_device_.load() && profile_analog_enabled_)
-        {
-            analog_enabled_.store(true);
-        }
+        update_analog_enabled();
     }
 
+    //Applies the profile immediately, only while the host core isn't running yet
     void set_profile(const UserProfile& user_profile) 
     { 
-        set_profile_mappings(user_profile);
-        set_profile_settings(user_profile);
+        const uint8_t shadow = (settings_state_.load(std::memory_order_relaxed) & SETTINGS_ACTIVE) ^ 1;
+        compile_settings(settings_[shadow], user_profile);
+        settings_state_.store(shadow, std::memory_order_release);
+    }
+
+    //Compiles the profile into the inactive settings, the host core swaps it in at its next report.
+    //Call from core0 while the host is running, a profile staged before the last one was swapped in replaces it
+    void stage_profile(const UserProfile& user_profile)
+    {
+        //Take back a swap the host hasn't done yet so the inactive copy is free to rebuild, 
+        //if the CAS loses the host has already swapped and the old active copy is the inactive one now
+        uint8_t state = settings_state_.load(std::memory_order_acquire);
+        while ((state & SETTINGS_PENDING) && 
+               !settings_state_.compare_exchange_weak(state, state & SETTINGS_ACTIVE, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        const uint8_t active = state & SETTINGS_ACTIVE;
+        compile_settings(settings_[active ^ 1], user_profile);
+        settings_state_.store(active | SETTINGS_PENDING, std::memory_order_release);
     }
 
-    inline void set_pad_in(PadIn pad_in)
+    //PadIn and ChatpadIn have a single writer (the host driver), no locking needed.
+    //Signals an event so the device loop waiting in board_api::wait_for_event wakes immediately.
+    //A PadIn identical to the last one is dropped, the device side never sees a no-op update.
+    //This is also the report boundary where a staged profile is swapped in.
+    inline void set_pad_in(const PadIn& pad_in)
     {
-        mutex_enter_blocking(&pad_in_mutex_);
-        pad_in_ = pad_in;
+        swap_settings();
+
+        if (changed_fields(last_pad_in_, pad_in) == 0)
+        {
+            return;
+        }
+        last_pad_in_ = pad_in;
+
+        OGXM_TRACE(PAD_IN_SET);
+        pad_in_.store({ pad_in, time_us_32() });
+#if defined(CONFIG_OGXM_TRACE)
+        trace_origin_.store(OGXM_TRACE_TAKE_ORIGIN(), std::memory_order_relaxed);
+#endif
         new_pad_in_.store(true);
-        mutex_exit(&pad_in_mutex_);
+        __sev();
     }
 
+    //PadOut is written by both the device driver and the host driver (manage_rumble) 
+    //so writers are serialized, readers never take the lock
     inline void set_pad_out(const PadOut& pad_out)
     {
-        mutex_enter_blocking(&pad_out_mutex_);
-        pad_out_ = pad_out;
+        uint32_t irq_state = spin_lock_blocking(pad_out_lock_);
+        pad_out_.store(pad_out);
+        spin_unlock(pad_out_lock_, irq_state);
         new_pad_out_.store(true);
-        mutex_exit(&pad_out_mutex_);
     }
 
     inline void set_chatpad_in(const ChatpadIn& chatpad_in)
     {
-        mutex_enter_blocking(&chatpad_in_mutex_);
-        chatpad_in_ = chatpad_in;
-        mutex_exit(&chatpad_in_mutex_);
+        chatpad_in_.store(chatpad_in);
     }
 
     inline void reset_pad_in() 
 	{ 
-        mutex_enter_blocking(&pad_in_mutex_);
-        pad_in_ = PadIn();
-        mutex_exit(&pad_in_mutex_);
+        last_pad_in_ = PadIn();
+        pad_in_.store({ last_pad_in_, time_us_32() });
         new_pad_in_.store(true);
     }
     
     inline void reset_pad_out()
     {
-        mutex_enter_blocking(&pad_out_mutex_);
-        pad_out_ = PadOut();
-        new_pad_out_.store(true);
-        mutex_exit(&pad_out_mutex_);
+        set_pad_out(PadOut());
     }
 
     inline void reset_chatpad_in()
     {
-        mutex_enter_blocking(&chatpad_in_mutex_);
-        chatpad_in_.fill(0);
-        mutex_exit(&chatpad_in_mutex_);
+        chatpad_in_.store(ChatpadIn{0});
     }
 
     template <uint8_t bits = 0, typename T>
@@ -268,8 +311,9 @@ public:
             joy_y = y;
         }
 
-        return  joy_settings_r_en_ 
-                    ? apply_joystick_settings(joy_x, joy_y, joy_settings_r_, invert_y) 
+        const ProfileSettings& settings = active_settings();
+        return  settings.joy_settings_r_en 
+                    ? settings.joy_shaper_r.apply(joy_x, joy_y, invert_y) 
                     : std::make_pair(joy_x, invert_y ? Range::invert(joy_y) : joy_y);
     }
 
@@ -294,8 +338,9 @@ public:
             joy_y = y;
         }
 
-        return  joy_settings_l_en_ 
-                    ? apply_joystick_settings(joy_x, joy_y, joy_settings_l_, invert_y) 
+        const ProfileSettings& settings = active_settings();
+        return  settings.joy_settings_l_en 
+                    ? settings.joy_shaper_l.apply(joy_x, joy_y, invert_y) 
                     : std::make_pair(joy_x, invert_y ? Range::invert(joy_y) : joy_y);
     }
 
@@ -315,8 +360,9 @@ public:
         {
             trigger_value = value;
         }
-        return  trig_settings_l_en_ 
-                    ? apply_trigger_settings(trigger_value, trig_settings_l_) 
+        const ProfileSettings& settings = active_settings();
+        return  settings.trig_settings_l_en 
+                    ? apply_trigger_settings(trigger_value, settings.trig_settings_l) 
                     : trigger_value;
     }
 
@@ -336,270 +382,192 @@ public:
         {
             trigger_value = value;
         }
-        return  trig_settings_r_en_ 
-                    ? apply_trigger_settings(trigger_value, trig_settings_r_) 
+        const ProfileSettings& settings = active_settings();
+        return  settings.trig_settings_r_en 
+                    ? apply_trigger_settings(trigger_value, settings.trig_settings_r) 
                     : trigger_value;
     }
 
 private:    
-    mutex_t pad_in_mutex_;
-    mutex_t pad_out_mutex_;
-    mutex_t chatpad_in_mutex_;
+    spin_lock_t* pad_out_lock_{spin_lock_instance(static_cast<uint>(spin_lock_claim_unused(true)))};
 
-    PadOut pad_out_;
-    PadIn pad_in_;
-    ChatpadIn chatpad_in_{0};
+    //PadIn with the time it was set, so the device side can tell how old its input is
+    struct TimedPadIn
+    {
+        PadIn pad_in;
+        uint32_t time_us{0};
+    };
+
+    SeqLock<TimedPadIn> pad_in_;
+    SeqLock<PadOut> pad_out_;
+    SeqLock<ChatpadIn> chatpad_in_;
+
+    //Writer side copy of the last published PadIn, only touched by the host core
+    PadIn last_pad_in_;
+    //Reader side, only touched by core0
+    uint32_t pad_in_time_us_{0};
 
     std::atomic<bool> new_pad_in_{false};
     std::atomic<bool> new_pad_out_{false};
 
+#if defined(CONFIG_OGXM_TRACE)
+    std::atomic<uint32_t> trace_origin_{0};
+#endif
+
     std::atomic<bool> analog_enabled_{false};
     std::atomic<bool> analog_host_{false};
     std::atomic<bool> analog_device_{false};
 
-    bool profile_analog_enabled_{false};
+    //Everything compiled from a UserProfile. Two copies, the host core reads the active one 
+    //while core0 compiles a new profile into the other, then the host swaps them between reports
+    struct ProfileSettings
+    {
+        bool analog_enabled{false};
+
+        //Indexed by default BUTTON_* / DPAD_* bits and ANALOG_OFF_*
+        std::array<uint16_t, 256> button_map_lo;
+        std::array<uint16_t, 16> button_map_hi;
+        std::array<uint8_t, 16> dpad_map;
+        std::array<uint8_t, 10> analog_map;
+
+        JoystickSettings joy_settings_l;
+        JoystickSettings joy_settings_r;
+        JoystickShaper joy_shaper_l;
+        JoystickShaper joy_shaper_r;
+        TriggerSettings trig_settings_l;
+        TriggerSettings trig_settings_r;
+
+        bool joy_settings_l_en{false};
+        bool joy_settings_r_en{false};
+        bool trig_settings_l_en{false};
+        bool trig_settings_r_en{false};
+    };
 
-    JoystickSettings joy_settings_l_;
-    JoystickSettings joy_settings_r_;
-    TriggerSettings trig_settings_l_;
-    TriggerSettings trig_settings_r_;
+    static constexpr uint8_t SETTINGS_ACTIVE  = 0x01; //Index of the copy the host reads
+    static constexpr uint8_t SETTINGS_PENDING = 0x02; //The other copy is ready to swap in
 
-    bool joy_settings_l_en_{false};
-    bool joy_settings_r_en_{false};
-    bool trig_settings_l_en_{false};
-    bool trig_settings_r_en_{false};
+    std::array<ProfileSettings, 2> settings_;
+    std::atomic<uint8_t> settings_state_{0};
 
-    void set_profile_settings(const UserProfile& profile)
+    inline const ProfileSettings& active_settings() const
     {
-        profile_analog_enabled_ = profile.analog_enabled ? true : false;
-        OGXM_LOG("profile_analog_enabled_: %d\n", profile_analog_enabled_);
+        return settings_[settings_state_.load(std::memory_order_acquire) & SETTINGS_ACTIVE];
+    }
 
-        if ((joy_settings_l_en_ = !joy_settings_l_.is_same(profile.joystick_settings_l)))
-        {
-            joy_settings_l_.set_from_raw(profile.joystick_settings_l);
-            //This needs to be addressed in the webapp, just multiply here for now
-            joy_settings_l_.axis_restrict *= static_cast<int16_t>(100);
-            joy_settings_l_.angle_restrict *= static_cast<int16_t>(100);
-            joy_settings_l_.anti_dz_angular *= static_cast<int16_t>(100);
-        }
-        if ((joy_settings_r_en_ = !joy_settings_r_.is_same(profile.joystick_settings_r)))
-        {
-            joy_settings_r_.set_from_raw(profile.joystick_settings_r);
-            //This needs to be addressed in the webapp, just multiply here for now
-            joy_settings_r_.axis_restrict *= static_cast<int16_t>(100);
-            joy_settings_r_.angle_restrict *= static_cast<int16_t>(100);
-            joy_settings_r_.anti_dz_angular *= static_cast<int16_t>(100);
-        }
-        if ((trig_settings_l_en_ = !trig_settings_l_.is_same(profile.trigger_settings_l)))
-        {
-            trig_settings_l_.set_from_raw(profile.trigger_settings_l);
-        }
-        if ((trig_settings_r_en_ = !trig_settings_r_.is_same(profile.trigger_settings_r)))
+    //Host side, the only place the active copy changes while the host is running
+    inline void swap_settings()
+    {
+        uint8_t state = settings_state_.load(std::memory_order_relaxed);
+        if (!(state & SETTINGS_PENDING) ||
+            !settings_state_.compare_exchange_strong(state, (state & SETTINGS_ACTIVE) ^ 1, std::memory_order_acq_rel, std::memory_order_relaxed))
         {
-            trig_settings_r_.set_from_raw(profile.trigger_settings_r);
+            return;
         }
-
-        OGXM_LOG("GamepadMapper: JoyL: %s, JoyR: %s, TrigL: %s, TrigR: %s\n",
-            joy_settings_l_en_ ? "Enabled" : "Disabled",
-            joy_settings_r_en_ ? "Enabled" : "Disabled",
-            trig_settings_l_en_ ? "Enabled" : "Disabled",
-            trig_settings_r_en_ ? "Enabled" : "Disabled");
+        update_analog_enabled();
     }
 
-    void set_profile_mappings(const UserProfile& profile)
+    //Device drivers can change at runtime so this is recomputed, not just latched on
+    inline void update_analog_enabled()
     {
-        MAP_DPAD_UP         = profile.dpad_up;
-        MAP_DPAD_DOWN       = profile.dpad_down;
-        MAP_DPAD_LEFT       = profile.dpad_left;
-        MAP_DPAD_RIGHT      = profile.dpad_right;
-        MAP_DPAD_UP_LEFT    = profile.dpad_up | profile.dpad_left;
-        MAP_DPAD_UP_RIGHT   = profile.dpad_up | profile.dpad_right;
-        MAP_DPAD_DOWN_LEFT  = profile.dpad_down | profile.dpad_left;
-        MAP_DPAD_DOWN_RIGHT = profile.dpad_down | profile.dpad_right;
-        MAP_DPAD_NONE       = 0;
-
-        MAP_BUTTON_A     = profile.button_a;
-        MAP_BUTTON_B     = profile.button_b;
-        MAP_BUTTON_X     = profile.button_x;
-        MAP_BUTTON_Y     = profile.button_y;
-        MAP_BUTTON_L3    = profile.button_l3;
-        MAP_BUTTON_R3    = profile.button_r3;
-        MAP_BUTTON_BACK  = profile.button_back;
-        MAP_BUTTON_START = profile.button_start;
-        MAP_BUTTON_LB    = profile.button_lb;
-        MAP_BUTTON_RB    = profile.button_rb;
-        MAP_BUTTON_SYS   = profile.button_sys;
-        MAP_BUTTON_MISC  = profile.button_misc;
-
-        MAP_ANALOG_OFF_UP    = profile.analog_off_up;
-        MAP_ANALOG_OFF_DOWN  = profile.analog_off_down;
-        MAP_ANALOG_OFF_LEFT  = profile.analog_off_left;
-        MAP_ANALOG_OFF_RIGHT = profile.analog_off_right;
-        MAP_ANALOG_OFF_A     = profile.analog_off_a;
-        MAP_ANALOG_OFF_B     = profile.analog_off_b;
-        MAP_ANALOG_OFF_X     = profile.analog_off_x;
-        MAP_ANALOG_OFF_Y     = profile.analog_off_y;
-        MAP_ANALOG_OFF_LB    = profile.analog_off_lb;
-        MAP_ANALOG_OFF_RB    = profile.analog_off_rb;
+        analog_enabled_.store(analog_host_.load() && analog_device_.load() && active_settings().analog_enabled);
     }
 
-    static inline std::pair<int16_t, int16_t> apply_joystick_settings(
-        int16_t gp_joy_x, 
-        int16_t gp_joy_y, 
-        const JoystickSettings& set,
-        bool invert_y)
+    void compile_settings(ProfileSettings& settings, const UserProfile& profile)
     {
-        static const Fix16 
-            FIX_0(0.0f),
-            FIX_1(1.0f),
-            FIX_2(2.0f),
-            FIX_45(45.0f),
-            FIX_90(90.0f),
-            FIX_100(100.0f),
-            FIX_180(180.0f),
-            FIX_EPSILON(0.0001f),
-            FIX_EPSILON2(0.001f),
-            FIX_ELLIPSE_DEF(1.570796f),
-            FIX_DIAG_DIVISOR(0.29289f);
-
-        Fix16 x = (set.invert_x ? Fix16(Range::invert(gp_joy_x)) : Fix16(gp_joy_x)) / Range::MAX<int16_t>;
-        Fix16 y = ((set.invert_y ^ invert_y) ? Fix16(Range::invert(gp_joy_y)) : Fix16(gp_joy_y)) / Range::MAX<int16_t>;
-
-        const Fix16 abs_x = fix16::abs(x);
-        const Fix16 abs_y = fix16::abs(y);
-        const Fix16 inv_axis_restrict = FIX_1 / (FIX_1 - set.axis_restrict);
-
-        Fix16 rAngle = (abs_x < FIX_EPSILON) 
-            ? FIX_90 
-            : fix16::rad2deg(fix16::abs(fix16::atan(y / x)));
-
-        Fix16 axial_x = (abs_x <= set.axis_restrict && rAngle > FIX_45) 
-            ? FIX_0 
-            : ((abs_x - set.axis_restrict) * inv_axis_restrict);
-                
-        Fix16 axial_y = (abs_y <= set.axis_restrict && rAngle <= FIX_45) 
-            ? FIX_0 
-            : ((abs_y - set.axis_restrict) * inv_axis_restrict);
-
-        Fix16 in_magnitude = fix16::sqrt(fix16::sq(axial_x) + fix16::sq(axial_y));
-
-        if (in_magnitude < set.dz_inner)
-        {
-            return { 0, 0 };
-        }
+        compile_mappings(settings, profile);
 
-        Fix16 angle = 
-            fix16::abs(axial_x) < FIX_EPSILON 
-                ? FIX_90 
-                : fix16::rad2deg(fix16::abs(fix16::atan(axial_y / axial_x)));
+        settings.analog_enabled = profile.analog_enabled ? true : false;
+        OGXM_LOG("Profile analog enabled: %d\n", settings.analog_enabled);
 
-        Fix16 anti_r_scale = (set.anti_dz_square_y_scale == FIX_0) ? set.anti_dz_square : set.anti_dz_square_y_scale;
-        Fix16 anti_dz_c = set.anti_dz_circle;
+        //Compared against defaults, the copy may still hold an older profile
+        settings.joy_settings_l = JoystickSettings();
+        settings.joy_settings_r = JoystickSettings();
+        settings.trig_settings_l = TriggerSettings();
+        settings.trig_settings_r = TriggerSettings();
 
-        if (anti_r_scale > FIX_0 && anti_dz_c > FIX_0)
+        if ((settings.joy_settings_l_en = !settings.joy_settings_l.is_same(profile.joystick_settings_l)))
         {
-            Fix16 anti_ellip_scale = anti_ellip_scale / anti_dz_c;
-            Fix16 ellipse_angle = fix16::atan((FIX_1 / anti_ellip_scale) * fix16::tan(fix16::rad2deg(rAngle)));
-            ellipse_angle = (ellipse_angle < FIX_0) ? FIX_ELLIPSE_DEF : ellipse_angle;
-
-            Fix16 ellipse_x = fix16::cos(ellipse_angle);
-            Fix16 ellipse_y = fix16::sqrt(fix16::sq(anti_ellip_scale) * (FIX_1 - fix16::sq(ellipse_x)));
-            anti_dz_c *= fix16::sqrt(fix16::sq(ellipse_x) + fix16::sq(ellipse_y));
+            settings.joy_settings_l.set_from_raw(profile.joystick_settings_l);
+            //This needs to be addressed in the webapp, just multiply here for now
+            settings.joy_settings_l.axis_restrict *= static_cast<int16_t>(100);
+            settings.joy_settings_l.angle_restrict *= static_cast<int16_t>(100);
+            settings.joy_settings_l.anti_dz_angular *= static_cast<int16_t>(100);
+            settings.joy_shaper_l.compile(settings.joy_settings_l);
         }
-
-        if (anti_dz_c > FIX_0)
+        if ((settings.joy_settings_r_en = !settings.joy_settings_r.is_same(profile.joystick_settings_r)))
         {
-            anti_dz_c = anti_dz_c / ((anti_dz_c * (FIX_1 - set.anti_dz_circle / set.dz_outer)) / (anti_dz_c * (FIX_1 - set.anti_dz_square)));
+            settings.joy_settings_r.set_from_raw(profile.joystick_settings_r);
+            //This needs to be addressed in the webapp, just multiply here for now
+            settings.joy_settings_r.axis_restrict *= static_cast<int16_t>(100);
+            settings.joy_settings_r.angle_restrict *= static_cast<int16_t>(100);
+            settings.joy_settings_r.anti_dz_angular *= static_cast<int16_t>(100);
+            settings.joy_shaper_r.compile(settings.joy_settings_r);
         }
-
-        if (abs_x > set.axis_restrict && abs_y > set.axis_restrict)
+        if ((settings.trig_settings_l_en = !settings.trig_settings_l.is_same(profile.trigger_settings_l)))
         {
-            const Fix16 FIX_ANGLE_MAX = set.angle_restrict / 2.0f;
-
-            if (angle > FIX_0 && angle < FIX_ANGLE_MAX)
-            {
-                angle = FIX_0;
-            }
-            if (angle > (FIX_90 - FIX_ANGLE_MAX))
-            {
-                angle = FIX_90;
-            }
-            if (angle > FIX_ANGLE_MAX && angle < (FIX_90 - FIX_ANGLE_MAX))
-            {
-                angle = ((angle - FIX_ANGLE_MAX) * FIX_90) / ((FIX_90 - FIX_ANGLE_MAX) - FIX_ANGLE_MAX);
-            }
+            settings.trig_settings_l.set_from_raw(profile.trigger_settings_l);
         }
-
-        Fix16 ref_angle = (angle < FIX_EPSILON2) ? FIX_0 : angle;
-        Fix16 diagonal = (angle > FIX_45) ? (((angle - FIX_45) * (-FIX_45)) / FIX_45) + FIX_45 : angle;
-
-        const Fix16 angle_comp = set.angle_restrict / FIX_2;
-
-        if (angle < FIX_90 && angle > FIX_0)
+        if ((settings.trig_settings_r_en = !settings.trig_settings_r.is_same(profile.trigger_settings_r)))
         {
-            angle = ((angle * ((FIX_90 - angle_comp) - angle_comp)) / FIX_90) + angle_comp;
+            settings.trig_settings_r.set_from_raw(profile.trigger_settings_r);
         }
 
-        if (axial_x < FIX_0 && axial_y > FIX_0)
-        {
-            angle = -angle;
-        }
-        if (axial_x > FIX_0 && axial_y < FIX_0)
-        {
-            angle = angle - FIX_180;
-        }
-        if (axial_x < FIX_0 && axial_y < FIX_0)
-        {
-            angle = angle + FIX_180;
-        }
+        OGXM_LOG("GamepadMapper: JoyL: %s, JoyR: %s, TrigL: %s, TrigR: %s\n",
+            settings.joy_settings_l_en ? "Enabled" : "Disabled",
+            settings.joy_settings_r_en ? "Enabled" : "Disabled",
+            settings.trig_settings_l_en ? "Enabled" : "Disabled",
+            settings.trig_settings_r_en ? "Enabled" : "Disabled");
+    }
 
-        //Deadzone Warp
-        Fix16 out_magnitude = (in_magnitude - set.dz_inner) / (set.anti_dz_outer - set.dz_inner);
-        out_magnitude = fix16::pow(out_magnitude, (FIX_1 / set.curve)) * (set.dz_outer - anti_dz_c) + anti_dz_c;
-        out_magnitude = (out_magnitude > set.dz_outer && !set.uncap_radius) ? set.dz_outer : out_magnitude;
-
-		Fix16 d_scale = (((out_magnitude - anti_dz_c) * (set.diag_scale_max - set.diag_scale_min)) / (set.dz_outer - anti_dz_c)) + set.diag_scale_min;		
-		Fix16 c_scale = (diagonal * (FIX_1 / fix16::sqrt(FIX_2))) / FIX_45; //Both these lines scale the intensity of the warping
-		c_scale       = FIX_1 - fix16::sqrt(FIX_1 - c_scale * c_scale);     //based on a circular curve to the perfect diagonal
-		d_scale       = (c_scale * (d_scale - FIX_1)) / FIX_DIAG_DIVISOR + FIX_1;
-
-		out_magnitude = out_magnitude * d_scale;
-
-		//Scaling values for square antideadzone
-		Fix16 new_x = fix16::cos(fix16::deg2rad(angle)) * out_magnitude;
-		Fix16 new_y = fix16::sin(fix16::deg2rad(angle)) * out_magnitude;
-		
-		//Magic angle wobble fix by user ME.
-		// if (angle > 45.0 && angle < 225.0) {
-		// 	newX = inv(Math.sin(deg2rad(angle - 90.0)))*outputMagnitude;
-		// 	newY = inv(Math.cos(deg2rad(angle - 270.0)))*outputMagnitude;
-		// }
-		
-		//Square antideadzone scaling
-		Fix16 output_x = fix16::abs(new_x) * (FIX_1 - set.anti_dz_square / set.dz_outer) + set.anti_dz_square;
-		if (x < FIX_0)
-        {
-            output_x = -output_x;
-        }
-		if (ref_angle == FIX_90)
-        {
-            output_x = FIX_0;
+    void compile_mappings(ProfileSettings& settings, const UserProfile& profile)
+    {
+        //Same order as the BUTTON_* and DPAD_* bits
+        const std::array<uint16_t, 12> buttons = 
+        {
+            profile.button_a, profile.button_b, profile.button_x, profile.button_y,
+            profile.button_l3, profile.button_r3, profile.button_back, profile.button_start,
+            profile.button_lb, profile.button_rb, profile.button_sys, profile.button_misc
+        };
+        const std::array<uint8_t, 4> dpads = 
+        { 
+            profile.dpad_up, profile.dpad_down, profile.dpad_left, profile.dpad_right 
+        };
+
+        for (size_t value = 0; value < settings.button_map_lo.size(); ++value)
+        {
+            uint16_t mapped = 0;
+            for (size_t bit = 0; bit < 8; ++bit)
+            {
+                if (value & (1 << bit)) mapped |= buttons[bit];
+            }
+            settings.button_map_lo[value] = mapped;
         }
-		
-		Fix16 output_y = fix16::abs(new_y) * (FIX_1 - anti_r_scale / set.dz_outer) + anti_r_scale;
-		if (y < FIX_0)
+        for (size_t value = 0; value < settings.button_map_hi.size(); ++value)
         {
-            output_y = -output_y;
+            uint16_t mapped = 0;
+            for (size_t bit = 0; bit < 4; ++bit)
+            {
+                if (value & (1 << bit)) mapped |= buttons[bit + 8];
+            }
+            settings.button_map_hi[value] = mapped;
         }
-		if (ref_angle == FIX_0)
+        for (size_t value = 0; value < settings.dpad_map.size(); ++value)
         {
-            output_y = FIX_0;
+            uint8_t mapped = 0;
+            for (size_t bit = 0; bit < 4; ++bit)
+            {
+                if (value & (1 << bit)) mapped |= dpads[bit];
+            }
+            settings.dpad_map[value] = mapped;
         }
 
-        output_x = fix16::clamp(output_x, -FIX_1, FIX_1) * Range::MAX<int16_t>;
-        output_y = fix16::clamp(output_y, -FIX_1, FIX_1) * Range::MAX<int16_t>;
-
-        return { static_cast<int16_t>(fix16_to_int(output_x)), static_cast<int16_t>(fix16_to_int(output_y)) };
+        //Same order as the ANALOG_OFF_* offsets
+        settings.analog_map = 
+        {
+            profile.analog_off_up, profile.analog_off_down, profile.analog_off_left, profile.analog_off_right,
+            profile.analog_off_a, profile.analog_off_b, profile.analog_off_x, profile.analog_off_y,
+            profile.analog_off_lb, profile.analog_off_rb
+        };
     }
 
     uint8_t apply_trigger_settings(uint8_t value, const TriggerSettings& set) const
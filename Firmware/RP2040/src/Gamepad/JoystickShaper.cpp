@@ -0,0 +1,403 @@
+#include <cmath>
+
+#include "Gamepad/Range.h"
+#include "Gamepad/fix16ext.h"
+#include "Gamepad/JoystickShaper.h"
+
+namespace
+{
+    //Compile time math for the tables, doubles never make it into the binary
+    namespace cmath
+    {
+        constexpr double sqrt(double x)
+        {
+            if (x <= 0.0)
+            {
+                return 0.0;
+            }
+            double r = (x > 1.0) ? x : 1.0;
+            for (int i = 0; i < 64; ++i)
+            {
+                r = 0.5 * (r + x / r);
+            }
+            return r;
+        }
+
+        constexpr int32_t to_fixed(double value, int frac_bits)
+        {
+            const double scaled = value * static_cast<double>(1ll << frac_bits);
+            return static_cast<int32_t>((scaled >= 0.0) ? (scaled + 0.5) : (scaled - 0.5));
+        }
+
+        constexpr fix16_t to_fix16(double value)
+        {
+            return to_fixed(value, 16);
+        }
+    }
+
+    constexpr size_t SQRT_LUT_BITS = 8;
+    constexpr size_t SQRT_LUT_STEPS = 1 << SQRT_LUT_BITS;
+    using SqrtLut = std::array<fix16_t, SQRT_LUT_STEPS + 1>;
+
+    //Indexed by the normalized mantissa, 1 to 4
+    constexpr SqrtLut make_sqrt_lut()
+    {
+        SqrtLut lut{};
+        for (size_t i = 0; i < lut.size(); ++i)
+        {
+            lut[i] = cmath::to_fix16(cmath::sqrt(1.0 + 3.0 * static_cast<double>(i) / SQRT_LUT_STEPS));
+        }
+        return lut;
+    }
+    constexpr SqrtLut SQRT_LUT = make_sqrt_lut();
+
+    //Same values Fix16 rounds the original float constants to
+    constexpr fix16_t FIX_EPSILON      = cmath::to_fix16(0.0001);
+    constexpr fix16_t FIX_EPSILON2     = cmath::to_fix16(0.001);
+    constexpr fix16_t FIX_45           = cmath::to_fix16(45.0);
+    constexpr fix16_t FIX_90           = cmath::to_fix16(90.0);
+    constexpr fix16_t FIX_DIAG_DIVISOR = cmath::to_fix16(0.29289);
+    constexpr fix16_t FIX_INV_SQRT_2   = cmath::to_fix16(1.0 / cmath::sqrt(2.0));
+
+    //fix16_atan2's cubic approximation
+    constexpr fix16_t ATAN_K1      = 0x0000FB50;
+    constexpr fix16_t ATAN_K3      = 0x00003240;
+    constexpr fix16_t FIX_PI_DIV_4 = 0x0000C90F;
+
+    //pos is the Q16.16 table position, 0 to SQRT_LUT_STEPS
+    inline fix16_t lerp(const SqrtLut& lut, uint32_t pos)
+    {
+        const uint32_t idx = pos >> 16;
+        if (idx >= SQRT_LUT_STEPS)
+        {
+            return lut[SQRT_LUT_STEPS];
+        }
+        const int32_t frac = static_cast<int32_t>(pos & 0xFFFF);
+        return lut[idx] + static_cast<int32_t>((static_cast<int64_t>(lut[idx + 1] - lut[idx]) * frac) >> 16);
+    }
+
+    //fix16_sqrt, the table gets within an LSB and the integer check rounds it the same way
+    inline fix16_t fix_sqrt(uint32_t value)
+    {
+        if (value == 0)
+        {
+            return 0;
+        }
+        const int32_t half_exp = (31 - __builtin_clz(value)) / 2 - 8;
+        const uint32_t mantissa = (half_exp > 0) ? (value >> (2 * half_exp)) : (value << (-2 * half_exp));
+        const fix16_t root = lerp(SQRT_LUT, static_cast<uint32_t>(((mantissa - fix16_one) * SQRT_LUT_STEPS) / 3));
+
+        uint64_t result = (half_exp >= 0)
+            ? (static_cast<uint64_t>(root) << half_exp)
+            : ((root + (1 << (-half_exp - 1))) >> -half_exp);
+
+        //Round to nearest, (2r - 1)^2 < 4 * value * 2^16 < (2r + 1)^2
+        const uint64_t target = static_cast<uint64_t>(value) << 18;
+        while ((2 * result + 1) * (2 * result + 1) < target)
+        {
+            ++result;
+        }
+        while (result > 0 && (2 * result - 1) * (2 * result - 1) > target)
+        {
+            --result;
+        }
+        return static_cast<fix16_t>(result);
+    }
+
+    //fix16_div with the same rounding, libfixmath is built with FIXMATH_NO_HARD_DIVISION and
+    //divides bit by bit, the SDK routes this through the hardware divider instead
+    inline fix16_t fix_div(fix16_t a, fix16_t b)
+    {
+        if (b == 0)
+        {
+            return fix16_minimum;
+        }
+        const uint64_t num = static_cast<uint64_t>(static_cast<uint32_t>(fix16_abs(a))) << 16;
+        const uint32_t den = static_cast<uint32_t>(fix16_abs(b));
+        uint64_t quot = num / den;
+        if ((num - quot * den) * 2 >= den)
+        {
+            ++quot;
+        }
+        const fix16_t result = static_cast<fix16_t>(quot);
+        return ((a ^ b) < 0) ? -result : result;
+    }
+
+    //fix16_sqrt, which takes the root of the magnitude and keeps the sign
+    inline fix16_t fix_sqrt_signed(fix16_t value)
+    {
+        return (value < 0) ? -fix_sqrt(static_cast<uint32_t>(-value)) : fix_sqrt(static_cast<uint32_t>(value));
+    }
+
+    //fix16_atan done exactly like libfixmath, sin/cos amplify any difference near 90 degrees
+    inline fix16_t fix_atan(fix16_t ratio)
+    {
+        const fix16_t abs_ratio = fix16_abs(ratio);
+        const fix16_t r = fix_div(fix16_one - abs_ratio, fix16_one + abs_ratio);
+        const fix16_t r_3 = fix16_mul(fix16_mul(r, r), r);
+        const fix16_t angle = fix16_mul(ATAN_K3, r_3) - fix16_mul(ATAN_K1, r) + FIX_PI_DIV_4;
+        return (ratio < 0) ? -angle : angle;
+    }
+
+    //rad2deg(abs(atan(y / x)))
+    inline fix16_t atan_deg(fix16_t y, fix16_t x)
+    {
+        return fix16_rad_to_deg(fix16_abs(fix_atan(fix_div(y, x))));
+    }
+
+    inline uint32_t saturate_u32(float value)
+    {
+        return (value >= 4294967295.0f) ? UINT32_MAX : static_cast<uint32_t>(value + 0.5f);
+    }
+
+    //Integer exponents are exact in fix16::pow, repeated squaring
+    inline fix16_t pow_int(fix16_t base, int32_t exponent)
+    {
+        if (exponent == 0)
+        {
+            return fix16_one;
+        }
+        if (base == 0)
+        {
+            return 0;
+        }
+        fix16_t result = fix16_one;
+        if (exponent < 0)
+        {
+            base = fix_div(fix16_one, base);
+            exponent = -exponent;
+        }
+        while (exponent)
+        {
+            if (exponent & 1)
+            {
+                result = fix16_mul(result, base);
+            }
+            base = fix16_mul(base, base);
+            exponent >>= 1;
+        }
+        return result;
+    }
+}
+
+void JoystickShaper::compile(const JoystickSettings& set)
+{
+    static const Fix16
+        FIX_0(0.0f),
+        FIX_1(1.0f),
+        FIX_2(2.0f);
+
+    invert_x_ = set.invert_x;
+    invert_y_ = set.invert_y;
+    uncap_radius_ = set.uncap_radius;
+
+    axis_restrict_ = set.axis_restrict.value;
+    inv_axis_restrict_ = (FIX_1 / (FIX_1 - set.axis_restrict)).value;
+
+    dz_inner_ = set.dz_inner.value;
+    dz_outer_ = set.dz_outer.value;
+    radial_range_ = (set.anti_dz_outer - set.dz_inner).value;
+
+    const Fix16 exponent = FIX_1 / set.curve;
+    exponent_ = exponent.value;
+    exponent_int_ = fix16_to_int(exponent.value);
+    exponent_is_int_ = (fix16_from_int(exponent_int_) == exponent.value);
+
+    //Once per profile, powf is fast enough here and exact to well under a Q16.16 LSB, unlike fix16::pow
+    if (!exponent_is_int_)
+    {
+        const float exponent_f = static_cast<float>(exponent);
+        for (uint32_t i = 0; i <= CURVE_STEPS; ++i)
+        {
+            const float mantissa = static_cast<float>(CURVE_STEPS + i) / static_cast<float>(2 * CURVE_STEPS);
+            curve_mantissa_[i] = saturate_u32(std::pow(mantissa, exponent_f) * 2147483648.0f);
+        }
+        for (uint32_t octave = 0; octave < CURVE_OCTAVES; ++octave)
+        {
+            const float scale = std::pow(2.0f, (static_cast<float>(octave) - 15.0f) * exponent_f);
+            curve_octave_[octave] = saturate_u32(scale * 65536.0f);
+        }
+    }
+
+    const Fix16 anti_r_scale = (set.anti_dz_square_y_scale == FIX_0) ? set.anti_dz_square : set.anti_dz_square_y_scale;
+
+    anti_dz_circle_ = set.anti_dz_circle.value;
+    anti_dz_outer_k_ = (FIX_1 - set.anti_dz_circle / set.dz_outer).value;
+    anti_dz_square_k_ = (FIX_1 - set.anti_dz_square).value;
+    ellipse_ = (anti_r_scale > FIX_0 && set.anti_dz_circle > FIX_0);
+    ellipse_scale_ = ellipse_ ? (anti_r_scale / set.anti_dz_circle).value : 0;
+    inv_ellipse_scale_ = ellipse_ ? (FIX_1 / Fix16(ellipse_scale_)).value : 0;
+    anti_dz_c_ = ellipse_ ? 0 : scale_anti_dz_c(anti_dz_circle_);
+
+    diag_scale_min_ = set.diag_scale_min.value;
+    diag_scale_range_ = (set.diag_scale_max - set.diag_scale_min).value;
+
+    angle_max_ = (set.angle_restrict / FIX_2).value;
+    angle_span_ = (FIX_90 - angle_max_) - angle_max_;
+
+    anti_dz_square_x_ = set.anti_dz_square.value;
+    anti_dz_square_y_ = anti_r_scale.value;
+    square_scale_x_ = (FIX_1 - set.anti_dz_square / set.dz_outer).value;
+    square_scale_y_ = (FIX_1 - anti_r_scale / set.dz_outer).value;
+}
+
+fix16_t JoystickShaper::curve(fix16_t base) const
+{
+    if (exponent_is_int_)
+    {
+        return pow_int(base, exponent_int_);
+    }
+    if (base <= 0)
+    {
+        return 0;
+    }
+
+    //Octave from the top bit, mantissa position from the next CURVE_STEP_BITS and the rest
+    const uint32_t octave = 31 - __builtin_clz(static_cast<uint32_t>(base));
+    const uint32_t shift = (octave > CURVE_STEP_BITS) ? (octave - CURVE_STEP_BITS) : 0;
+    const uint32_t pos = (octave > CURVE_STEP_BITS)
+        ? (static_cast<uint32_t>(base) >> shift)
+        : (static_cast<uint32_t>(base) << (CURVE_STEP_BITS - octave));
+    const uint32_t idx = pos - CURVE_STEPS;
+    const int64_t frac = static_cast<uint32_t>(base) & ((1u << shift) - 1);
+
+    const int64_t delta = static_cast<int64_t>(curve_mantissa_[idx + 1]) - curve_mantissa_[idx];
+    const uint64_t mantissa = curve_mantissa_[idx] + ((delta * frac + ((1ll << shift) >> 1)) >> shift);
+
+    const uint64_t result = (static_cast<uint64_t>(curve_octave_[octave]) * mantissa + (1ull << 30)) >> 31;
+    return (result > static_cast<uint64_t>(fix16_maximum)) ? fix16_maximum : static_cast<fix16_t>(result);
+}
+
+fix16_t JoystickShaper::scale_anti_dz_c(fix16_t anti_dz_c) const
+{
+    if (anti_dz_c <= 0)
+    {
+        return anti_dz_c;
+    }
+    return fix_div(anti_dz_c, fix_div(fix16_mul(anti_dz_c, anti_dz_outer_k_), fix16_mul(anti_dz_c, anti_dz_square_k_)));
+}
+
+//The original ellipse math op for op, only runs with both a circle and a square antideadzone
+fix16_t JoystickShaper::ellipse_anti_dz_c(fix16_t raw_angle) const
+{
+    static const fix16_t FIX_ELLIPSE_DEF = Fix16(1.570796f).value;
+
+    const fix16_t raw_angle_rad = fix16_deg_to_rad(raw_angle);
+    const fix16_t tan = fix_div(fix16_sin(raw_angle_rad), fix16_cos(raw_angle_rad));
+
+    fix16_t ellipse_angle = fix_atan(fix16_mul(inv_ellipse_scale_, tan));
+    ellipse_angle = (ellipse_angle < 0) ? FIX_ELLIPSE_DEF : ellipse_angle;
+
+    const fix16_t ellipse_x = fix16_cos(ellipse_angle);
+    const fix16_t ellipse_y = fix_sqrt_signed(fix16_mul(fix16_sq(ellipse_scale_), fix16_one - fix16_sq(ellipse_x)));
+    return fix16_mul(anti_dz_circle_, fix_sqrt_signed(fix16_sq(ellipse_x) + fix16_sq(ellipse_y)));
+}
+
+std::pair<int16_t, int16_t> JoystickShaper::apply(int16_t gp_joy_x, int16_t gp_joy_y, bool invert_y) const
+{
+    //Same truncating Fix16 / int16_t division as before
+    const fix16_t x = fix16_from_int(invert_x_ ? Range::invert(gp_joy_x) : gp_joy_x) / Range::MAX<int16_t>;
+    const fix16_t y = fix16_from_int((invert_y_ ^ invert_y) ? Range::invert(gp_joy_y) : gp_joy_y) / Range::MAX<int16_t>;
+
+    const fix16_t abs_x = fix16_abs(x);
+    const fix16_t abs_y = fix16_abs(y);
+
+    //The raw angle only decides which axis gets restricted, and shapes the ellipse.
+    //atan of anything up to one LSB over a ratio of 1.0 comes out at exactly 45 degrees
+    const bool restrict_x = (abs_x <= axis_restrict_);
+    const bool restrict_y = (abs_y <= axis_restrict_);
+    const fix16_t raw_ratio = (abs_x < FIX_EPSILON) ? fix16_maximum : fix_div(abs_y, abs_x);
+    const bool above_45 = (raw_ratio > fix16_one + 1);
+
+    const fix16_t axial_x = (restrict_x && above_45) ? 0 : fix16_mul(abs_x - axis_restrict_, inv_axis_restrict_);
+    const fix16_t axial_y = (restrict_y && !above_45) ? 0 : fix16_mul(abs_y - axis_restrict_, inv_axis_restrict_);
+
+    const fix16_t in_magnitude = fix_sqrt(static_cast<uint32_t>(fix16_sq(axial_x) + fix16_sq(axial_y)));
+    if (in_magnitude < dz_inner_)
+    {
+        return { 0, 0 };
+    }
+
+    //axial_x can only go negative while axial_y is 0, so the angle stays in the first quadrant
+    fix16_t angle = (fix16_abs(axial_x) < FIX_EPSILON) ? FIX_90 : atan_deg(axial_y, axial_x);
+
+    fix16_t anti_dz_c = anti_dz_c_;
+    if (ellipse_)
+    {
+        const fix16_t raw_angle = (abs_x < FIX_EPSILON) ? FIX_90 : fix16_rad_to_deg(fix16_abs(fix_atan(raw_ratio)));
+        anti_dz_c = scale_anti_dz_c(ellipse_anti_dz_c(raw_angle));
+    }
+
+    //Angle restriction and compensation, both are exact no-ops at 0
+    if (angle_max_ > 0 && !restrict_x && !restrict_y)
+    {
+        if (angle > 0 && angle < angle_max_)
+        {
+            angle = 0;
+        }
+        if (angle > (FIX_90 - angle_max_))
+        {
+            angle = FIX_90;
+        }
+        if (angle > angle_max_ && angle < (FIX_90 - angle_max_))
+        {
+            angle = fix_div(fix16_mul(angle - angle_max_, FIX_90), angle_span_);
+        }
+    }
+
+    const fix16_t ref_angle = (angle < FIX_EPSILON2) ? 0 : angle;
+    const fix16_t diagonal = (angle > FIX_45) ? (FIX_90 - angle) : angle;
+
+    if (angle_max_ > 0 && angle < FIX_90 && angle > 0)
+    {
+        angle = fix_div(fix16_mul(angle, angle_span_), FIX_90) + angle_max_;
+    }
+
+    //Deadzone warp
+    fix16_t out_magnitude = fix16_mul(curve(fix_div(in_magnitude - dz_inner_, radial_range_)), dz_outer_ - anti_dz_c) + anti_dz_c;
+    if (out_magnitude > dz_outer_ && !uncap_radius_)
+    {
+        out_magnitude = dz_outer_;
+    }
+
+    //Diagonal scaling, an exact no-op at the default 1.0
+    if (diag_scale_range_ != 0 || diag_scale_min_ != fix16_one)
+    {
+        fix16_t d_scale = fix_div(fix16_mul(out_magnitude - anti_dz_c, diag_scale_range_), dz_outer_ - anti_dz_c) + diag_scale_min_;
+        fix16_t c_scale = fix_div(fix16_mul(diagonal, FIX_INV_SQRT_2), FIX_45);
+        c_scale = fix16_one - fix_sqrt_signed(fix16_one - fix16_mul(c_scale, c_scale));
+        d_scale = fix_div(fix16_mul(c_scale, d_scale - fix16_one), FIX_DIAG_DIVISOR) + fix16_one;
+        out_magnitude = fix16_mul(out_magnitude, d_scale);
+    }
+
+    //FIXMATH_FAST_SIN's polynomial, its rounding shows in the output
+    const fix16_t angle_rad = fix16_deg_to_rad(angle);
+    const fix16_t new_x = fix16_mul(fix16_cos(angle_rad), out_magnitude);
+    const fix16_t new_y = fix16_mul(fix16_sin(angle_rad), out_magnitude);
+
+    //Square antideadzone scaling
+    fix16_t output_x = fix16_mul(fix16_abs(new_x), square_scale_x_) + anti_dz_square_x_;
+    if (x < 0)
+    {
+        output_x = -output_x;
+    }
+    if (ref_angle == FIX_90)
+    {
+        output_x = 0;
+    }
+
+    fix16_t output_y = fix16_mul(fix16_abs(new_y), square_scale_y_) + anti_dz_square_y_;
+    if (y < 0)
+    {
+        output_y = -output_y;
+    }
+    if (ref_angle == 0)
+    {
+        output_y = 0;
+    }
+
+    output_x = fix16_clamp(output_x, -fix16_one, fix16_one) * Range::MAX<int16_t>;
+    output_y = fix16_clamp(output_y, -fix16_one, fix16_one) * Range::MAX<int16_t>;
+
+    return { static_cast<int16_t>(fix16_to_int(output_x)), static_cast<int16_t>(fix16_to_int(output_y)) };
+}
@@ -0,0 +1,72 @@
+#ifndef _JOYSTICK_SHAPER_H_
+#define _JOYSTICK_SHAPER_H_
+
+#include <cstdint>
+#include <array>
+#include <utility>
+
+#include "libfixmath/fix16.hpp"
+#include "UserSettings/JoystickSettings.h"
+
+/*  JoystickSettings compiled once per profile. Non integer curves become a table of the curve's mantissa
+    and octave factors, so the per report path has no pow, just a lookup and one interpolation. The table
+    follows a correctly rounded pow rather than fix16::pow, whose exp/log series is off by up to thousands of
+    LSB for small bases, so non integer curves only match the old output where fix16::pow got it right. Divisions
+    use the hardware divider with fix16_div's rounding. The angle path keeps libfixmath's atan and FAST_SIN polynomials:
+    they're a few multiplies, and their rounding steps the output by more than a table could follow. */
+class JoystickShaper
+{
+public:
+    //base^e with e = 1 / curve is 2^(octave * e) * mantissa^e, the mantissa part is linearly interpolated
+    //between CURVE_STEPS entries. Relative error is about e * (e - 1) / (8 * CURVE_STEPS^2), within an LSB
+    //for curves down to 0.4
+    static constexpr uint32_t CURVE_STEP_BITS = 8;
+    static constexpr uint32_t CURVE_STEPS = 1 << CURVE_STEP_BITS;
+    static constexpr uint32_t CURVE_OCTAVES = 31;
+
+    void compile(const JoystickSettings& settings);
+    std::pair<int16_t, int16_t> apply(int16_t gp_joy_x, int16_t gp_joy_y, bool invert_y) const;
+
+    //base^(1 / curve), base being the distance past dz_inner over the radial range
+    fix16_t curve(fix16_t base) const;
+
+private:
+    //Compiled settings, all Q16.16
+    fix16_t axis_restrict_{0};
+    fix16_t inv_axis_restrict_{fix16_one};
+    fix16_t dz_inner_{0};
+    fix16_t dz_outer_{fix16_one};
+    fix16_t radial_range_{fix16_one};
+    fix16_t exponent_{fix16_one};
+    int32_t exponent_int_{1};
+    fix16_t anti_dz_circle_{0};
+    fix16_t anti_dz_c_{0};
+    fix16_t anti_dz_outer_k_{fix16_one};
+    fix16_t anti_dz_square_k_{fix16_one};
+    fix16_t ellipse_scale_{0};
+    fix16_t inv_ellipse_scale_{0};
+    fix16_t diag_scale_min_{fix16_one};
+    fix16_t diag_scale_range_{0};
+    fix16_t angle_max_{0};
+    fix16_t angle_span_{0};
+    fix16_t anti_dz_square_x_{0};
+    fix16_t anti_dz_square_y_{0};
+    fix16_t square_scale_x_{fix16_one};
+    fix16_t square_scale_y_{fix16_one};
+
+    bool ellipse_{false};
+    bool exponent_is_int_{true};
+    bool uncap_radius_{true};
+    bool invert_x_{false};
+    bool invert_y_{false};
+
+    //Only built for non integer exponents. (m / 2)^e for m in [1, 2] as Q1.31, and 2^((octave - 15) * e)
+    //as Q16.16 saturated to 32 bits, octave being the top bit of the Q16.16 base
+    std::array<uint32_t, CURVE_STEPS + 1> curve_mantissa_{};
+    std::array<uint32_t, CURVE_OCTAVES> curve_octave_{};
+
+    fix16_t scale_anti_dz_c(fix16_t anti_dz_c) const;
+    fix16_t ellipse_anti_dz_c(fix16_t raw_angle) const;
+};
+
+#endif // _JOYSTICK_SHAPER_H_
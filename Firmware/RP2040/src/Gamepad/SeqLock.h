@@ -0,0 +1,74 @@
+#ifndef _SEQ_LOCK_H_
+#define _SEQ_LOCK_H_
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <type_traits>
+
+/*  Single writer, multiple reader snapshot of a trivially copyable type.
+    The writer never waits, readers retry if they overlap a write so they never see a torn value.
+    Data is held in 32 bit atomic words, on the M0+ these are plain ldr/str so no library atomics are pulled in. */
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+class SeqLock
+{
+public:
+    SeqLock() = default;
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    //Only one context may call this at a time
+    inline void store(const T& value)
+    {
+        std::array<uint32_t, NUM_WORDS> words{0};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < NUM_WORDS; ++i)
+        {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    inline T load() const
+    {
+        std::array<uint32_t, NUM_WORDS> words;
+        uint32_t seq_start = 0;
+        uint32_t seq_end = 0;
+
+        do
+        {
+            seq_start = seq_.load(std::memory_order_acquire);
+
+            for (size_t i = 0; i < NUM_WORDS; ++i)
+            {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq_end = seq_.load(std::memory_order_relaxed);
+        }
+        while ((seq_start & 1) || (seq_start != seq_end));
+
+        //bit_cast rather than memcpy into a T, payloads like PadIn have a constructor of their own
+        std::array<uint8_t, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), words.data(), sizeof(T));
+        return std::bit_cast<T>(bytes);
+    }
+
+private:
+    static constexpr size_t NUM_WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::atomic<uint32_t>, NUM_WORDS> data_{};
+};
+
+#endif // _SEQ_LOCK_H_
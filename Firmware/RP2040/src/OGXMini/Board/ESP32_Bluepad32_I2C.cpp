@@ -4,6 +4,7 @@
 
 #include <cstring>
 #include <pico/multicore.h>
+#include <pico/flash.h>
 #include <pico/i2c_slave.h>
 #include <hardware/gpio.h>
 #include <hardware/i2c.h>
@@ -12,6 +13,7 @@
 #include "bsp/board_api.h"
 
 #include "USBDevice/DeviceManager.h"
+#include "USBDevice/SOFSync.h"
 #include "UserSettings/UserSettings.h"
 #include "Board/board_api.h"
 #include "Board/esp32_api.h"
@@ -80,6 +82,8 @@ static inline void slave_handler(i2c_inst_t *i2c, i2c_slave_event_t event) {
                     if (packet_in.device_type != DeviceDriverType::NONE &&
                         packet_in.device_type != current_device_type) {
                         OGXM_LOG("I2C: Driver change detected.\n");
+                        //Switched without a reboot now, only queue the change once
+                        current_device_type = packet_in.device_type;
                         //Any writes to flash should be done on Core0
                         TaskQueue::Core0::queue_delayed_task(
                             TaskQueue::Core0::get_new_task_id(), 1000, false, 
@@ -109,6 +113,9 @@ static inline void slave_handler(i2c_inst_t *i2c, i2c_slave_event_t event) {
 }
 
 static void core1_task() {
+    //Lets core0 pause this core while settings are written to flash
+    flash_safe_execute_core_init();
+
     i2c_init(I2C_PORT, I2C_BAUDRATE);
 
     gpio_init(I2C_SDA_PIN);
@@ -173,23 +180,23 @@ void esp32_bp32_i2c::run() {
         return;
     }
 
-    multicore_reset_core1();
-    multicore_launch_core1(core1_task);
+    board_api::launch_core1(core1_task);
 
     esp32_api::reset();
 
-    DeviceDriver* device_driver = DeviceManager::get_instance().get_driver();
-
-    tud_init(BOARD_TUD_RHPORT);
+    //Mode switches replace the driver from a core0 task, get it again after process_tasks
+    DeviceManager& device_manager = DeviceManager::get_instance();
+    device_manager.start_usb();
 
     while (true) {
         TaskQueue::Core0::process_tasks();
+        DeviceDriver* device_driver = device_manager.get_driver();
 
         for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
             device_driver->process(i, _gamepads[i]);
             tud_task();
         }
-        sleep_ms(1);
+        board_api::wait_for_event(sof_sync::wait_us());
     }
 }
 
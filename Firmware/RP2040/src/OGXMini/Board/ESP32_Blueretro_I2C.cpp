@@ -3,6 +3,7 @@
 #if (OGXM_BOARD == ESP32_BLUERETRO_I2C)
 
 #include <pico/multicore.h>
+#include <pico/flash.h>
 #include <hardware/gpio.h>
 #include <hardware/i2c.h>
 
@@ -11,6 +12,7 @@
 
 #include "UserSettings/UserSettings.h"
 #include "USBDevice/DeviceManager.h"
+#include "USBDevice/SOFSync.h"
 #include "Board/board_api.h"
 #include "Board/esp32_api.h"
 #include "Gamepad/Gamepad.h"
@@ -41,6 +43,9 @@ static Gamepad _gamepads[MAX_GAMEPADS];
 static bool _uart_bridge_mode = false;
 
 static void core1_task() {
+    //Lets core0 pause this core while settings are written to flash
+    flash_safe_execute_core_init();
+
     i2c_init(I2C_PORT, I2C_BAUDRATE);
 
     gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
@@ -120,7 +125,7 @@ void set_gp_check_timer(uint32_t task_id) {
         //Check gamepad inputs for button combo to change usb device driver
         if (user_settings.check_for_driver_change(_gamepads[0])) {
             OGXM_LOG("Driver change detected, storing new driver.\n");
-            //This will store the new mode and reboot the pico
+            //Stores the new mode and switches to it, reboots only if it can't switch in place
             user_settings.store_driver_type(user_settings.get_current_driver());
         }
     });
@@ -174,21 +179,21 @@ void esp32_br_i2c::run() {
 
     esp32_api::reset();
 
-    multicore_reset_core1();
-    multicore_launch_core1(core1_task);
+    board_api::launch_core1(core1_task);
 
     uint32_t tid_gp_check = TaskQueue::Core0::get_new_task_id();
     set_gp_check_timer(tid_gp_check);
 
-    DeviceDriver* device_driver = DeviceManager::get_instance().get_driver();
-
-    tud_init(BOARD_TUD_RHPORT);
+    //Mode switches replace the driver from a core0 task, get it again after process_tasks
+    DeviceManager& device_manager = DeviceManager::get_instance();
+    device_manager.start_usb();
 
     while (true) {
         TaskQueue::Core0::process_tasks();
+        DeviceDriver* device_driver = device_manager.get_driver();
         device_driver->process(0, _gamepads[0]);
         tud_task();
-        sleep_ms(1);
+        board_api::wait_for_event(sof_sync::wait_us());
     }
 }
 
@@ -4,7 +4,11 @@
 
 #include <atomic>
 #include <cstring>
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <pico/multicore.h>
+#include <pico/flash.h>
 #include <hardware/gpio.h>
 #include <hardware/i2c.h>
 #include <pico/i2c_slave.h>
@@ -14,9 +18,11 @@
 #include "pio_usb.h"
 
 #include "USBDevice/DeviceManager.h"
+#include "USBDevice/SOFSync.h"
 #include "USBHost/HostManager.h"
 #include "Board/board_api.h"
 #include "Board/ogxm_log.h"
+#include "Board/i2c_master.h"
 #include "UserSettings/UserSettings.h"
 #include "Gamepad/Gamepad.h"
 #include "TaskQueue/TaskQueue.h"
@@ -33,12 +39,14 @@ namespace I2C {
     enum class PacketID : uint8_t { 
         UNKNOWN = 0, 
         PAD, 
-        COMMAND 
+        COMMAND,
+        FRAME
     };
     enum class Command : uint8_t { 
         UNKNOWN = 0, 
         STATUS, 
-        DISABLE 
+        DISABLE,
+        VERSION
     };
     enum class Status : uint8_t { 
         UNKNOWN = 0, 
@@ -49,6 +57,10 @@ namespace I2C {
         NOT_READY 
     };
 
+    //v1 is PacketCMD STATUS then PacketIn/PacketOut, v2 is a single FrameIn/FrameOut exchange.
+    //Slaves keep answering v1 so either side can be on older firmware.
+    static constexpr uint8_t PROTOCOL_VERSION = 2;
+
     #pragma pack(push, 1)
     struct PacketIn {
         uint8_t             packet_len{sizeof(PacketIn)};
@@ -72,12 +84,131 @@ namespace I2C {
         PacketID    packet_id{PacketID::COMMAND};
         Command     command{Command::UNKNOWN};
         Status      status{Status::UNKNOWN};
-        uint8_t     reserved[4]{0};
+        uint8_t     version{0}; // Command::VERSION only, 0 from v1 firmware
+        uint8_t     reserved[3]{0};
     };
     static_assert(sizeof(PacketCMD) == 8, "I2CDriver::PacketCMD is misaligned");
+
+    //Followed by the PadIn fields set in 'fields' in FRAME_FIELDS order, then a CRC8 of everything before it
+    struct FrameInHeader {
+        uint8_t     packet_len{0};
+        PacketID    packet_id{PacketID::FRAME};
+        uint8_t     seq{0};
+        uint8_t     fields{0}; // Gamepad::PAD_IN_* and FRAME_CHATPAD
+    };
+    static_assert(sizeof(FrameInHeader) == 4, "I2CDriver::FrameInHeader is misaligned");
+
+    //Slave reply to a FrameIn, rumble is always included so a lost reply can't drop an update
+    struct FrameOut {
+        uint8_t         packet_len{sizeof(FrameOut)};
+        PacketID        packet_id{PacketID::FRAME};
+        uint8_t         seq{0};
+        Status          status{Status::UNKNOWN};
+        Gamepad::PadOut pad_out{Gamepad::PadOut()};
+        uint8_t         reserved{0};
+        uint8_t         crc{0};
+    };
+    static_assert(sizeof(FrameOut) == 8, "I2CDriver::FrameOut is misaligned");
     #pragma pack(pop)
 
-    constexpr size_t MAX_PACKET_SIZE = sizeof(PacketIn);
+    static constexpr uint8_t FRAME_CHATPAD = 0x40;
+
+    struct FrameField {
+        uint8_t field;
+        uint8_t offset;
+        uint8_t size;
+    };
+
+    //PadIn byte spans for each field, chatpad is handled separately
+    static constexpr std::array<FrameField, 6> FRAME_FIELDS = {{
+        { Gamepad::PAD_IN_DPAD,       offsetof(Gamepad::PadIn, dpad),        1 },
+        { Gamepad::PAD_IN_BUTTONS,    offsetof(Gamepad::PadIn, buttons),     2 },
+        { Gamepad::PAD_IN_TRIGGERS,   offsetof(Gamepad::PadIn, trigger_l),   2 },
+        { Gamepad::PAD_IN_JOYSTICK_L, offsetof(Gamepad::PadIn, joystick_lx), 4 },
+        { Gamepad::PAD_IN_JOYSTICK_R, offsetof(Gamepad::PadIn, joystick_rx), 4 },
+        { Gamepad::PAD_IN_ANALOG,     offsetof(Gamepad::PadIn, analog),      sizeof(Gamepad::PadIn::analog) }
+    }};
+
+    static constexpr size_t MAX_FRAME_SIZE = sizeof(FrameInHeader) + sizeof(Gamepad::PadIn) + sizeof(Gamepad::ChatpadIn) + 1;
+    constexpr size_t MAX_PACKET_SIZE = std::max(sizeof(PacketIn), MAX_FRAME_SIZE);
+
+    //CRC-8, poly 0x07
+    static constexpr std::array<uint8_t, 256> CRC8_TABLE = [] {
+        std::array<uint8_t, 256> table{};
+        for (size_t i = 0; i < 256; ++i) {
+            uint8_t crc = static_cast<uint8_t>(i);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+    static inline uint8_t crc8(const uint8_t* data, size_t len) {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < len; ++i) {
+            crc = CRC8_TABLE[crc ^ data[i]];
+        }
+        return crc;
+    }
+
+    //Writes the fields set in 'fields' and the CRC after the header, returns the frame length
+    static uint8_t encode_frame(uint8_t* frame, uint8_t seq, uint8_t fields, 
+                                const Gamepad::PadIn& pad_in, const Gamepad::ChatpadIn& chatpad_in) {
+        const uint8_t* pad_bytes = reinterpret_cast<const uint8_t*>(&pad_in);
+        uint8_t len = sizeof(FrameInHeader);
+
+        for (const FrameField& span : FRAME_FIELDS) {
+            if (fields & span.field) {
+                std::memcpy(frame + len, pad_bytes + span.offset, span.size);
+                len += span.size;
+            }
+        }
+        if (fields & FRAME_CHATPAD) {
+            std::memcpy(frame + len, chatpad_in.data(), chatpad_in.size());
+            len += chatpad_in.size();
+        }
+
+        FrameInHeader* header = reinterpret_cast<FrameInHeader*>(frame);
+        header->packet_len = len + 1;
+        header->packet_id = PacketID::FRAME;
+        header->seq = seq;
+        header->fields = fields;
+        frame[len] = crc8(frame, len);
+        return len + 1;
+    }
+
+    //Applies a received frame on top of the previous state, false if it's malformed or corrupted
+    static bool decode_frame(const uint8_t* frame, size_t len, 
+                             Gamepad::PadIn& pad_in, Gamepad::ChatpadIn& chatpad_in) {
+        const FrameInHeader* header = reinterpret_cast<const FrameInHeader*>(frame);
+        if ((len < sizeof(FrameInHeader) + 1) || (header->packet_len != len) || 
+            (crc8(frame, len - 1) != frame[len - 1])) {
+            return false;
+        }
+
+        uint8_t* pad_bytes = reinterpret_cast<uint8_t*>(&pad_in);
+        size_t pos = sizeof(FrameInHeader);
+
+        for (const FrameField& span : FRAME_FIELDS) {
+            if (header->fields & span.field) {
+                if (pos + span.size > len - 1) {
+                    return false;
+                }
+                std::memcpy(pad_bytes + span.offset, frame + pos, span.size);
+                pos += span.size;
+            }
+        }
+        if (header->fields & FRAME_CHATPAD) {
+            if (pos + chatpad_in.size() > len - 1) {
+                return false;
+            }
+            std::memcpy(chatpad_in.data(), frame + pos, chatpad_in.size());
+            pos += chatpad_in.size();
+        }
+        return (pos == len - 1);
+    }
 
     static Role _i2c_role = Role::SLAVE;
 
@@ -94,6 +225,11 @@ namespace I2C {
                         return PacketID::COMMAND;
                     }
                     break;
+                case PacketID::FRAME:
+                    if (buffer_in[0] > sizeof(FrameInHeader) && buffer_in[0] <= MAX_FRAME_SIZE) {
+                        return PacketID::FRAME;
+                    }
+                    break;
                 default:
                     break;
             }
@@ -105,11 +241,15 @@ namespace I2C {
             static bool enabled = false;
             static uint8_t buffer_in[MAX_PACKET_SIZE];
             static uint8_t buffer_out[MAX_PACKET_SIZE];
+            //Frames are deltas against this
+            static Gamepad::PadIn frame_pad_in;
+            static Gamepad::ChatpadIn frame_chatpad_in{0};
 
             PacketIn  *packet_in_p = reinterpret_cast<PacketIn*>(buffer_in);
             PacketOut *packet_out_p = reinterpret_cast<PacketOut*>(buffer_out);
             PacketCMD *packet_cmd_in_p = reinterpret_cast<PacketCMD*>(buffer_in);
             PacketCMD *packet_cmd_out_p = reinterpret_cast<PacketCMD*>(buffer_out);
+            FrameOut  *frame_out_p = reinterpret_cast<FrameOut*>(buffer_out);
 
             switch (event) {
                 case I2C_SLAVE_RECEIVE: // master has written
@@ -133,6 +273,34 @@ namespace I2C {
                             }
                             break;
 
+                        case PacketID::FRAME: {
+                            //Status and pad in one exchange, the pad is only used while our own host port is free
+                            const bool ready = !tuh_mounted(BOARD_TUH_RHPORT);
+                            const uint8_t fields = reinterpret_cast<FrameInHeader*>(buffer_in)->fields;
+
+                            *frame_out_p = FrameOut();
+                            frame_out_p->seq = reinterpret_cast<FrameInHeader*>(buffer_in)->seq;
+
+                            if (!decode_frame(buffer_in, count, frame_pad_in, frame_chatpad_in)) {
+                                frame_out_p->status = Status::ERROR;
+                            } else if (ready) {
+                                frame_out_p->status = Status::READY;
+                                _gamepads[0].set_pad_in(frame_pad_in);
+                                if (fields & FRAME_CHATPAD) {
+                                    _gamepads[0].set_chatpad_in(frame_chatpad_in);
+                                }
+                                if (!enabled) {
+                                    enabled = true;
+                                    four_ch_i2c::host_mounted(true);
+                                }
+                            } else {
+                                frame_out_p->status = Status::NOT_READY;
+                            }
+                            frame_out_p->pad_out = _gamepads[0].get_pad_out();
+                            frame_out_p->crc = crc8(buffer_out, sizeof(FrameOut) - 1);
+                            break;
+                        }
+
                         case PacketID::COMMAND:
                             switch (packet_cmd_in_p->command) {
                                 case Command::DISABLE:
@@ -159,10 +327,24 @@ namespace I2C {
                                     }
                                     break;
 
+                                case Command::VERSION:
+                                    packet_cmd_out_p->packet_len = sizeof(PacketCMD);
+                                    packet_cmd_out_p->packet_id = PacketID::COMMAND;
+                                    packet_cmd_out_p->command = Command::VERSION;
+                                    packet_cmd_out_p->status = Status::OK;
+                                    packet_cmd_out_p->version = PROTOCOL_VERSION;
+                                    //Master starts sending full frames after this
+                                    frame_pad_in = Gamepad::PadIn();
+                                    frame_chatpad_in.fill(0);
+                                    break;
+
                                 default:
                                     break;
                             }
                             break;
+
+                        default:
+                            break;
                     }
                     count = 0;
                     std::memset(buffer_in, 0, sizeof(buffer_in));
@@ -179,89 +361,307 @@ namespace I2C {
     } // namespace Slave
 
     namespace Master {
+        enum class Stage : uint8_t {
+            STATUS = 0,
+            VERSION,
+            PAD,
+            FRAME,
+            DISABLE
+        };
+
         struct Slave {
             uint8_t address{0xFF};
-            Status  status{Status::NC};
             bool    enabled{false};
+            Stage   stage{Stage::STATUS};
+            uint8_t version{0}; // 0 until negotiated
+            uint8_t disable_retries{0};
+            //Missing slaves are retried with exponential backoff instead of probed every pass
+            uint32_t backoff_ms{0};
+            uint32_t next_ms{0};
+
+            //v2, what the slave has acknowledged and what's in flight
+            uint8_t seq{0};
+            bool    synced{false};
+            uint8_t sent_fields{0};
+            uint32_t last_frame_ms{0};
+            Gamepad::PadIn     acked_pad_in;
+            Gamepad::ChatpadIn acked_chatpad_in{0};
+            Gamepad::PadIn     sent_pad_in;
+            Gamepad::ChatpadIn sent_chatpad_in{0};
+            Gamepad::PadOut    last_pad_out;
+
+            //Owned by the transfer while it's in flight
+            PacketCMD packet_cmd;
+            PacketIn  packet_in;
+            PacketOut packet_out;
+            uint8_t   frame_in[MAX_FRAME_SIZE];
+            uint8_t   frame_in_len{0};
+            FrameOut  frame_out;
+        };
+
+        //Bus usage over the last window, logged in debug builds
+        struct Stats {
+            uint32_t transfers{0};
+            uint32_t bytes{0};
+            uint32_t updates{0};
+            uint32_t full_frames{0};
+            uint32_t crc_errors{0};
         };
 
         static constexpr size_t NUM_SLAVES = MAX_GAMEPADS - 1;
         static_assert(NUM_SLAVES > 0, "I2CMaster::NUM_SLAVES must be greater than 0 to use I2C");
 
+        static constexpr uint32_t MAX_BACKOFF_MS = 512;
+        static constexpr uint32_t STATUS_POLL_MS = 1;
+        //v2 frames are only sent on a change, or this often for status and rumble
+        static constexpr uint32_t KEEPALIVE_MS = 4;
+        static constexpr uint8_t DISABLE_RETRIES = 10;
+        static constexpr uint32_t STATS_INTERVAL_MS = 5000;
+
         std::array<Slave, NUM_SLAVES> _slaves; 
+        static Slave* _active{nullptr};
+        static uint8_t _next_slave{0};
+        static Stats _stats;
+
+        static inline Gamepad& gamepad(const Slave& slave) {
+            return _gamepads[(&slave - _slaves.data()) + 1];
+        }
+
+        static inline bool due(const Slave& slave, uint32_t now) {
+            return (slave.enabled || slave.stage == Stage::DISABLE) && 
+                   (static_cast<int32_t>(now - slave.next_ms) >= 0);
+        }
 
-        static inline bool read_blocking(uint8_t address, void* buffer, size_t len) {
-            return (i2c_read_blocking(  I2C_PORT, address, reinterpret_cast<uint8_t*>(buffer), 
-                                        len, false) == static_cast<int>(len));
+        static bool start(Slave& slave, const void* tx, size_t tx_len, void* rx, size_t rx_len) {
+            if (!i2c_master::start(slave.address, tx, tx_len, rx, rx_len)) {
+                return false;
+            }
+            //Address byte for each direction
+            ++_stats.transfers;
+            _stats.bytes += tx_len + rx_len + 2;
+            return true;
         }
 
-        static inline bool write_blocking(uint8_t address, void* buffer, size_t len) {
-            return (i2c_write_blocking( I2C_PORT, address, reinterpret_cast<uint8_t*>(buffer), 
-                                        len, false) == static_cast<int>(len));
+        static inline bool send_command(Slave& slave, Command command) {
+            slave.packet_cmd = PacketCMD();
+            slave.packet_cmd.command = command;
+            slave.packet_cmd.version = PROTOCOL_VERSION;
+            return start(slave, &slave.packet_cmd, sizeof(PacketCMD), &slave.packet_cmd, sizeof(PacketCMD));
         }
 
-        static inline bool slave_detected(uint8_t address) {
-            uint8_t dummy = 0;
-            int result = i2c_write_timeout_us(I2C_PORT, address, &dummy, 0, false, 1000);
-            return (result >= 0);
+        //Sends whatever changed since the slave last acknowledged, everything if it's out of sync
+        static bool send_frame(Slave& slave, uint32_t now) {
+            Gamepad& gp = gamepad(slave);
+            slave.sent_pad_in = gp.get_pad_in();
+            slave.sent_chatpad_in = gp.get_chatpad_in();
+
+            uint8_t fields = 0;
+            if (!slave.synced) {
+                fields = Gamepad::PAD_IN_DPAD | Gamepad::PAD_IN_BUTTONS | Gamepad::PAD_IN_TRIGGERS |
+                         Gamepad::PAD_IN_JOYSTICK_L | Gamepad::PAD_IN_JOYSTICK_R | Gamepad::PAD_IN_ANALOG | 
+                         FRAME_CHATPAD;
+                ++_stats.full_frames;
+            } else {
+                fields = Gamepad::changed_fields(slave.acked_pad_in, slave.sent_pad_in);
+                if (slave.acked_chatpad_in != slave.sent_chatpad_in) {
+                    fields |= FRAME_CHATPAD;
+                }
+                if (!fields && (now - slave.last_frame_ms) < KEEPALIVE_MS) {
+                    return false;
+                }
+            }
+
+            slave.sent_fields = fields;
+            slave.frame_in_len = encode_frame(slave.frame_in, ++slave.seq, fields, slave.sent_pad_in, slave.sent_chatpad_in);
+            slave.last_frame_ms = now;
+            return start(slave, slave.frame_in, slave.frame_in_len, &slave.frame_out, sizeof(FrameOut));
         }
 
-        static void notify_disable(uint8_t address) {
-            if (!slave_detected(address)) {
+        static bool start_transfer(Slave& slave, uint32_t now) {
+            switch (slave.stage) {
+                case Stage::STATUS:
+                    return send_command(slave, Command::STATUS);
+
+                case Stage::VERSION:
+                    return send_command(slave, Command::VERSION);
+
+                case Stage::PAD: {
+                    //Latest state at the moment it goes on the bus
+                    Gamepad& gp = gamepad(slave);
+                    slave.packet_in.pad_in = gp.get_pad_in();
+                    slave.packet_in.chatpad_in = gp.get_chatpad_in();
+                    return start(slave, &slave.packet_in, sizeof(PacketIn), &slave.packet_out, sizeof(PacketOut));
+                }
+                case Stage::FRAME:
+                    return send_frame(slave, now);
+
+                case Stage::DISABLE:
+                    return send_command(slave, Command::DISABLE);
+            }
+            return false;
+        }
+
+        static void frame_complete(Slave& slave, uint32_t now) {
+            const FrameOut& frame_out = slave.frame_out;
+
+            if ((frame_out.packet_len != sizeof(FrameOut)) || (frame_out.packet_id != PacketID::FRAME) ||
+                (frame_out.seq != slave.seq) || (crc8(reinterpret_cast<const uint8_t*>(&frame_out), sizeof(FrameOut) - 1) != frame_out.crc)) {
+                ++_stats.crc_errors;
+                slave.synced = false;
                 return;
             }
-            int retries = 10;
 
-            while (retries--) {
-                PacketCMD packet_cmd;
-                packet_cmd.packet_id = PacketID::COMMAND;
-                packet_cmd.command = Command::DISABLE;
+            if (std::memcmp(&frame_out.pad_out, &slave.last_pad_out, sizeof(Gamepad::PadOut)) != 0) {
+                slave.last_pad_out = frame_out.pad_out;
+                gamepad(slave).set_pad_out(frame_out.pad_out);
+            }
 
-                if (write_blocking(address, &packet_cmd, sizeof(PacketCMD))) {
-                    if (read_blocking(address, &packet_cmd, sizeof(PacketCMD))) {
-                        if (packet_cmd.status == Status::OK) {
-                            break;
-                        }
+            switch (frame_out.status) {
+                case Status::READY:
+                    slave.acked_pad_in = slave.sent_pad_in;
+                    slave.acked_chatpad_in = slave.sent_chatpad_in;
+                    slave.synced = true;
+                    if (slave.sent_fields) {
+                        ++_stats.updates;
                     }
+                    break;
+
+                case Status::ERROR:
+                    ++_stats.crc_errors;
+                    slave.synced = false;
+                    break;
+
+                default:
+                    //Slave has its own controller, it didn't take the pad
+                    slave.synced = false;
+                    slave.next_ms = now + STATUS_POLL_MS;
+                    break;
+            }
+        }
+
+        static void transfer_complete(Slave& slave, i2c_master::Result result, uint32_t now) {
+            if (result != i2c_master::Result::OK) {
+                if (slave.stage == Stage::DISABLE) {
+                    //Nobody there to disable
+                    if (result == i2c_master::Result::NAK || --slave.disable_retries == 0) {
+                        slave.stage = Stage::STATUS;
+                    }
+                    slave.next_ms = now + 1;
+                    return;
                 }
-                sleep_ms(1);
+                slave.backoff_ms = std::min(std::max(slave.backoff_ms * 2, static_cast<uint32_t>(1)), MAX_BACKOFF_MS);
+                slave.next_ms = now + slave.backoff_ms;
+                //Could have been swapped for a board on other firmware
+                slave.stage = Stage::STATUS;
+                slave.version = 0;
+                slave.synced = false;
+                return;
+            }
+
+            slave.backoff_ms = 0;
+
+            switch (slave.stage) {
+                case Stage::STATUS:
+                    if (slave.version == 0) {
+                        slave.stage = Stage::VERSION;
+                    } else if (slave.packet_cmd.status == Status::READY) {
+                        slave.stage = Stage::PAD;
+                    } else {
+                        slave.next_ms = now + STATUS_POLL_MS;
+                    }
+                    break;
+
+                case Stage::VERSION:
+                    //v1 slaves don't know the command and reply with the last STATUS packet
+                    if ((slave.packet_cmd.command == Command::VERSION) && (slave.packet_cmd.status == Status::OK)) {
+                        slave.version = std::min(std::max(slave.packet_cmd.version, static_cast<uint8_t>(1)), PROTOCOL_VERSION);
+                    } else {
+                        slave.version = 1;
+                    }
+                    OGXM_LOG("I2C slave %u protocol v%u\n", slave.address, slave.version);
+                    slave.stage = (slave.version >= 2) ? Stage::FRAME : Stage::STATUS;
+                    slave.synced = false;
+                    break;
+
+                case Stage::PAD:
+                    gamepad(slave).set_pad_out(slave.packet_out.pad_out);
+                    ++_stats.updates;
+                    slave.stage = Stage::STATUS;
+                    break;
+
+                case Stage::FRAME:
+                    frame_complete(slave, now);
+                    break;
+
+                case Stage::DISABLE:
+                    if (slave.packet_cmd.status == Status::OK || --slave.disable_retries == 0) {
+                        slave.stage = (slave.version >= 2) ? Stage::FRAME : Stage::STATUS;
+                        slave.synced = false;
+                    } else {
+                        slave.next_ms = now + 1;
+                    }
+                    break;
             }
         }
 
-        static void process() {
-            for (uint8_t i = 0; i < NUM_SLAVES; ++i) {
-                Slave& slave = _slaves[i];
+        static void notify_disable(Slave& slave) {
+            slave.stage = Stage::DISABLE;
+            slave.disable_retries = DISABLE_RETRIES;
+            slave.backoff_ms = 0;
+            slave.next_ms = 0;
+        }
 
-                if (!slave.enabled || !slave_detected(slave.address)) {
-                    continue;
-                }
+#if defined(CONFIG_OGXM_DEBUG)
+        static void dump_stats() {
+            const Stats stats = _stats;
+            _stats = Stats();
 
-                PacketCMD packet_cmd;
-                packet_cmd.packet_id = PacketID::COMMAND;
-                packet_cmd.command = Command::STATUS;
+            const uint32_t seconds = STATS_INTERVAL_MS / 1000;
+            OGXM_LOG("I2C %u updates/s, %u transfers/s, %u bytes/s, %u bytes/update, %u full frames, %u errors\n",
+                stats.updates / seconds, stats.transfers / seconds, stats.bytes / seconds,
+                stats.updates ? (stats.bytes / stats.updates) : 0, stats.full_frames, stats.crc_errors);
+        }
+#endif
+
+        //Never blocks, finishes the transfer on the bus if there is one and starts the next.
+        //Slaves are served round robin so one that's slow to become ready can't starve the others.
+        static void process() {
+            const uint32_t now = board_api::ms_since_boot();
 
-                if (!write_blocking(slave.address, &packet_cmd, sizeof(PacketCMD)) ||
-                    !read_blocking(slave.address, &packet_cmd, sizeof(PacketCMD))) {
-                    continue;
+            if (_active) {
+                const i2c_master::Result result = i2c_master::result();
+                if (result == i2c_master::Result::BUSY) {
+                    return;
                 }
+                transfer_complete(*_active, result, now);
+                _active = nullptr;
+            }
 
-                if (packet_cmd.status == Status::READY) {
-                    Gamepad& gamepad = _gamepads[i + 1];
-                    PacketIn packet_in;
-                    packet_in.pad_in = gamepad.get_pad_in();
-                    packet_in.chatpad_in = gamepad.get_chatpad_in();
+            for (uint8_t i = 0; i < NUM_SLAVES; ++i) {
+                Slave& slave = _slaves[_next_slave];
+                _next_slave = (_next_slave + 1) % NUM_SLAVES;
 
-                    if (write_blocking(slave.address, &packet_in, sizeof(PacketIn))) {
-                        PacketOut packet_out;
-                        if (read_blocking(slave.address, &packet_out, sizeof(PacketOut))) {
-                            gamepad.set_pad_out(packet_out.pad_out);
-                        }
-                    }
+                if (due(slave, now) && start_transfer(slave, now)) {
+                    _active = &slave;
+                    return;
                 }
-                sleep_ms(1);
             }
         }
 
+        static void initialize() {
+            for (uint8_t i = 0; i < NUM_SLAVES; ++i) {
+                _slaves[i].address = i + 1;
+            }
+            i2c_master::init();
+
+#if defined(CONFIG_OGXM_DEBUG)
+            TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), STATS_INTERVAL_MS, true, 
+            [] {
+                dump_stats();
+            });
+#endif
+        }
+
         static void xbox360w_connect(bool connected, uint8_t idx) {
             if (idx < 1 || idx >= MAX_GAMEPADS) {
                 return;
@@ -272,7 +672,7 @@ namespace I2C {
             [&slave = _slaves[idx - 1], connected]() {
                 slave.enabled = connected;
                 if (!connected) {
-                    notify_disable(slave.address);
+                    notify_disable(slave);
                 }
             });
         }
@@ -287,7 +687,7 @@ namespace I2C {
                 []() {
                     for (auto& slave : _slaves) {
                         slave.enabled = false;
-                        notify_disable(slave.address);
+                        notify_disable(slave);
                     }
                 });
             }
@@ -321,7 +721,8 @@ namespace I2C {
 
     void initialize() {
         uint8_t i2c_address = get_address();
-        _i2c_role = (i2c_address == 0xFF) ? Role::MASTER : _i2c_role = Role::SLAVE;
+        //No address jumpers is the master, slaves are 1 to 3 and map to gamepads 1 to 3
+        _i2c_role = (i2c_address == 0x00) ? Role::MASTER : Role::SLAVE;
 
         i2c_init(I2C_PORT, I2C_BAUDRATE);
 
@@ -334,11 +735,16 @@ namespace I2C {
 
         if (_i2c_role == Role::SLAVE) {
             i2c_slave_init(I2C_PORT, i2c_address, &Slave::slave_handler);
+        } else {
+            Master::initialize();
         }
     }
 } // namespace I2C
 
 void core1_task() {
+    //Lets core0 pause this core while profiles are written to flash in the background
+    flash_safe_execute_core_init();
+
     HostManager& host_manager = HostManager::get_instance();
     host_manager.initialize(_gamepads);
 
@@ -372,7 +778,7 @@ void set_gp_check_timer(uint32_t task_id) {
         //Check gamepad inputs for button combo to change usb device driver
         if (user_settings.check_for_driver_change(_gamepads[0]))
         {
-            //This will store the new mode and reboot the pico
+            //Stores the new mode and switches to it, reboots only if it can't switch in place
             user_settings.store_driver_type(user_settings.get_current_driver());
         }
     });
@@ -385,23 +791,9 @@ void four_ch_i2c::wireless_connected(bool connected, uint8_t idx) {
 }
 
 void four_ch_i2c::host_mounted(bool mounted) {
-    static std::atomic<bool> tud_is_inited = false;
-
     board_api::set_led(mounted);
-
-    if (!mounted && tud_is_inited.load()) {
-        TaskQueue::Core0::queue_task([]() {
-            OGXM_LOG("Disconnecting USB and rebooting.\n");
-            board_api::usb::disconnect_all();
-            board_api::reboot();
-        });
-    } else if (!tud_is_inited.load() && mounted) {
-        TaskQueue::Core0::queue_task([]() { 
-            OGXM_LOG("Initializing USB device stack.\n");
-            tud_init(BOARD_TUD_RHPORT); 
-            tud_is_inited.store(true);
-        });
-    }
+    //Only the device stack follows the controller, the host stack and I2C link stay up
+    DeviceManager::get_instance().set_connected(mounted);
 }
 
 void four_ch_i2c::host_mounted_w_type(bool mounted, HostDriverType host_type) {
@@ -420,6 +812,7 @@ void four_ch_i2c::initialize() {
     for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
         _gamepads[i].set_profile(user_settings.get_profile_by_index(i));
     }
+    user_settings.attach_gamepads(_gamepads);
 
     DeviceManager::get_instance().initialize_driver(user_settings.get_current_driver(), _gamepads);
 }
@@ -427,34 +820,37 @@ void four_ch_i2c::initialize() {
 void four_ch_i2c::run() {
     I2C::initialize();
     
-    multicore_reset_core1();
-    multicore_launch_core1(core1_task);
+    board_api::launch_core1(core1_task);
 
     //Wait for something to call tud_init
     while (!tud_inited()) {
         TaskQueue::Core0::process_tasks();
+        OGXM_LOG_FLUSH();
         sleep_ms(100);
     }
 
     uint32_t tid_gp_check = TaskQueue::Core0::get_new_task_id();
     set_gp_check_timer(tid_gp_check);
 
-    DeviceDriver* device_driver = DeviceManager::get_instance().get_driver();
+    //Mode switches replace the driver from a core0 task, get it again after process_tasks
+    DeviceManager& device_manager = DeviceManager::get_instance();
 
     if (I2C::role() == I2C::Role::MASTER) {
         while (true) {
             TaskQueue::Core0::process_tasks();
+            DeviceDriver* device_driver = device_manager.get_driver();
             I2C::Master::process();
             device_driver->process(0, _gamepads[0]);
             tud_task();
-            sleep_ms(1);
+            board_api::wait_for_event(sof_sync::wait_us());
         }
     } else {
         while (true) {
             TaskQueue::Core0::process_tasks();
+            DeviceDriver* device_driver = device_manager.get_driver();
             device_driver->process(0, _gamepads[0]);
             tud_task();
-            sleep_ms(1);
+            board_api::wait_for_event(sof_sync::wait_us());
         }
     }
 }
@@ -4,11 +4,13 @@
 
 #include <hardware/clocks.h>
 #include <pico/multicore.h>
+#include <pico/flash.h>
 
 #include "tusb.h"
 #include "bsp/board_api.h"
 
 #include "USBDevice/DeviceManager.h"
+#include "USBDevice/SOFSync.h"
 #include "UserSettings/UserSettings.h"
 #include "Board/board_api.h"
 #include "Bluepad32/Bluepad32.h"
@@ -19,6 +21,9 @@
 Gamepad _gamepads[MAX_GAMEPADS];
 
 void core1_task() {
+    //Lets core0 pause this core while profiles are written to flash in the background
+    flash_safe_execute_core_init();
+
     board_api::init_bluetooth();
     board_api::set_led(true);
     BLEServer::init_server(_gamepads);
@@ -31,7 +36,7 @@ void set_gp_check_timer(uint32_t task_id) {
     [&user_settings] {
         //Check gamepad inputs for button combo to change usb device driver
         if (user_settings.check_for_driver_change(_gamepads[0])) {
-            //This will store the new mode and reboot the pico
+            //Stores the new mode and switches to it, reboots only if it can't switch in place
             user_settings.store_driver_type(user_settings.get_current_driver());
         }
     });
@@ -46,30 +51,31 @@ void pico_w::initialize() {
     for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
         _gamepads[i].set_profile(user_settings.get_profile_by_index(i));
     }
+    user_settings.attach_gamepads(_gamepads);
 
     DeviceManager& device_manager = DeviceManager::get_instance();
     device_manager.initialize_driver(user_settings.get_current_driver(), _gamepads);
 }
 
 void pico_w::run() {
-    multicore_reset_core1();
-    multicore_launch_core1(core1_task);
+    board_api::launch_core1(core1_task);
 
     uint32_t tid_gp_check = TaskQueue::Core0::get_new_task_id();
     set_gp_check_timer(tid_gp_check);
 
-    DeviceDriver* device_driver = DeviceManager::get_instance().get_driver();
-
-    tud_init(BOARD_TUD_RHPORT);
+    //Mode switches replace the driver from a core0 task, get it again after process_tasks
+    DeviceManager& device_manager = DeviceManager::get_instance();
+    device_manager.start_usb();
 
     while (true) {
         TaskQueue::Core0::process_tasks();
+        DeviceDriver* device_driver = device_manager.get_driver();
 
         for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
             device_driver->process(i, _gamepads[i]);
             tud_task();
         }
-        sleep_ms(1);
+        board_api::wait_for_event(sof_sync::wait_us());
     }
 }
 
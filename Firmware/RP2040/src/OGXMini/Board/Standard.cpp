@@ -3,6 +3,7 @@
 #if ((OGXM_BOARD == PI_PICO) || (OGXM_BOARD == RP2040_ZERO) || (OGXM_BOARD == ADAFRUIT_FEATHER))
 
 #include <pico/multicore.h>
+#include <pico/flash.h>
 
 #include "tusb.h"
 #include "bsp/board_api.h"
@@ -10,6 +11,7 @@
 
 #include "USBHost/HostManager.h"
 #include "USBDevice/DeviceManager.h"
+#include "USBDevice/SOFSync.h"
 #include "TaskQueue/TaskQueue.h"
 #include "Gamepad/Gamepad.h"
 #include "Board/board_api.h"
@@ -20,6 +22,9 @@ constexpr uint32_t FEEDBACK_DELAY_MS = 200;
 Gamepad _gamepads[MAX_GAMEPADS];
 
 void core1_task() {
+    //Lets core0 pause this core while profiles are written to flash in the background
+    flash_safe_execute_core_init();
+
     HostManager& host_manager = HostManager::get_instance();
     host_manager.initialize(_gamepads);
 
@@ -54,7 +59,7 @@ void set_gp_check_timer(uint32_t task_id) {
         //Check gamepad inputs for button combo to change usb device driver
         if (user_settings.check_for_driver_change(_gamepads[0])) {
             OGXM_LOG("Driver change detected, storing new driver.\n");
-            //This will store the new mode and reboot the pico
+            //Stores the new mode and switches to it, reboots only if it can't switch in place
             user_settings.store_driver_type(user_settings.get_current_driver());
         }
     });
@@ -62,21 +67,9 @@ void set_gp_check_timer(uint32_t task_id) {
 
 //Called by tusb host so we know to connect or disconnect usb
 void standard::host_mounted(bool host_mounted) {
-    static std::atomic<bool> tud_is_inited = false;
     board_api::set_led(host_mounted);
-
-    if (!host_mounted && tud_is_inited.load()) {
-        TaskQueue::Core0::queue_task([]() {
-            OGXM_LOG("USB disconnected, rebooting.\n");
-            board_api::usb::disconnect_all();
-            board_api::reboot();
-        });
-    } else if (!tud_is_inited.load()) {
-        TaskQueue::Core0::queue_task([]() { 
-            tud_init(BOARD_TUD_RHPORT); 
-            tud_is_inited.store(true);
-        });
-    }
+    //Only the device stack follows the controller, the host stack stays up for the next one
+    DeviceManager::get_instance().set_connected(host_mounted);
 }
 
 void standard::initialize() {
@@ -88,13 +81,13 @@ void standard::initialize() {
     for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
         _gamepads[i].set_profile(user_settings.get_profile_by_index(i));
     }
+    user_settings.attach_gamepads(_gamepads);
 
     DeviceManager::get_instance().initialize_driver(user_settings.get_current_driver(), _gamepads);
 }
 
 void standard::run() {
-    multicore_reset_core1();
-    multicore_launch_core1(core1_task);
+    board_api::launch_core1(core1_task);
 
     DeviceDriverType current_driver = UserSettings::get_instance().get_current_driver();
 
@@ -102,6 +95,7 @@ void standard::run() {
         // Wait for something to call host_mounted()
         while (!tud_inited()) {
             TaskQueue::Core0::process_tasks();
+            OGXM_LOG_FLUSH();
             sleep_ms(100);
         }
     } else {
@@ -112,16 +106,18 @@ void standard::run() {
     uint32_t tid_gp_check = TaskQueue::Core0::get_new_task_id();
     set_gp_check_timer(tid_gp_check);
 
-    DeviceDriver* device_driver = DeviceManager::get_instance().get_driver();
+    //Mode switches replace the driver from a core0 task, get it again after process_tasks
+    DeviceManager& device_manager = DeviceManager::get_instance();
 
     while (true) {
         TaskQueue::Core0::process_tasks();
+        DeviceDriver* device_driver = device_manager.get_driver();
 
         for (uint8_t i = 0; i < MAX_GAMEPADS; ++i) {
             device_driver->process(i, _gamepads[i]);
         }
         tud_task();
-        sleep_ms(1);
+        board_api::wait_for_event(sof_sync::wait_us());
     }
 }
 
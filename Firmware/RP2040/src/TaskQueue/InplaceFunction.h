@@ -0,0 +1,62 @@
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*  Fixed size replacement for std::function that never touches the heap, safe to copy from IRQ context.
+    Only trivially copyable callables (lambdas capturing references, pointers or small values) are accepted,
+    so copies are a memcpy and nothing needs destroying. Anything larger than Capacity fails to compile. */
+template <typename Signature, size_t Capacity = 4 * sizeof(void*)>
+class InplaceFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+public:
+    InplaceFunction() = default;
+    InplaceFunction(std::nullptr_t) {}
+
+    template <typename F>
+    requires (!std::is_same_v<std::decay_t<F>, InplaceFunction>) && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+    InplaceFunction(F&& function)
+    {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= Capacity, "InplaceFunction: callable is too large, capture less or capture by reference");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "InplaceFunction: callable is over-aligned");
+        static_assert(std::is_trivially_copyable_v<Fn> && std::is_trivially_destructible_v<Fn>,
+                      "InplaceFunction: callable must be trivially copyable, don't capture std::function, std::string etc.");
+
+        ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(function));
+        invoke_ = [](void* storage, Args... args) -> R
+        {
+            return (*std::launder(reinterpret_cast<Fn*>(storage)))(std::forward<Args>(args)...);
+        };
+    }
+
+    InplaceFunction(const InplaceFunction&) = default;
+    InplaceFunction& operator=(const InplaceFunction&) = default;
+
+    InplaceFunction& operator=(std::nullptr_t)
+    {
+        invoke_ = nullptr;
+        return *this;
+    }
+
+    inline R operator()(Args... args)
+    {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    inline explicit operator bool() const { return invoke_ != nullptr; }
+
+private:
+    alignas(std::max_align_t) uint8_t storage_[Capacity]{0};
+    R (*invoke_)(void*, Args...){nullptr};
+};
+
+#endif // INPLACE_FUNCTION_H
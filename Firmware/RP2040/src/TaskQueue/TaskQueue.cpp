@@ -1,14 +1,23 @@
+#include <algorithm>
+
 #include "TaskQueue/TaskQueue.h"
 
-TaskQueue::TaskQueue(CoreNum core_num) 
-{   
+TaskQueue::TaskQueue(CoreNum core_num)
+{
     alarm_num_ = (core_num == CoreNum::Core0) ? 0 : 1;
     alarm_num_ += (OGXM_BOARD == PI_PICOW) ? 1 : 0; //BTStack uses alarm 0
 
+    id_map_.fill(INVALID_IDX);
+    for (uint8_t i = 0; i < MAX_DELAYED_TASKS; ++i)
+    {
+        free_slots_[i] = i;
+    }
+    free_count_ = MAX_DELAYED_TASKS;
+
     hw_set_bits(&timer_hw->inte, 1u << alarm_num_);
 
     irq_set_exclusive_handler(
-        TIMER_IRQ(alarm_num_), 
+        TIMER_IRQ(alarm_num_),
         (core_num == CoreNum::Core0) ? timer_irq_wrapper_c0 : timer_irq_wrapper_c1);
 
     irq_set_enabled(TIMER_IRQ(alarm_num_), true);
@@ -19,119 +28,91 @@ uint32_t TaskQueue::get_new_task_id()
     return new_task_id_++;
 }
 
-bool TaskQueue::queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const std::function<void()>& function)
+bool TaskQueue::queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const Function& function)
 {
     uint32_t irq_state = spin_lock_blocking(spinlock_delayed_);
-    for (const auto& task : task_queue_delayed_) 
+
+    if (!function || free_count_ == 0 || find_slot_unsafe(task_id) != INVALID_IDX)
     {
-        if (task.task_id == task_id)
-        {
-            spin_unlock(spinlock_delayed_, irq_state);
-            return false;
-        }
+        spin_unlock(spinlock_delayed_, irq_state);
+        return false;
     }
 
     hw_set_bits(&timer_hw->inte, 1u << alarm_num_);
 
-    //Might come back to this, there is overflow potential
-    uint64_t target_time = timer_hw->timerawl + static_cast<uint64_t>(delay_ms) * 1000;
+    uint8_t slot = free_slots_[--free_count_];
+    DelayedTask& task = task_queue_delayed_[slot];
 
-    for (auto& task : task_queue_delayed_) 
-    {
-        if (!task.function) 
-        {
-            task.target_time = target_time;
-            task.interval_ms = repeating ? delay_ms : 0;
-            task.function = function;
-            task.task_id = task_id;
+    task.task_id = task_id;
+    task.interval_ms = repeating ? delay_ms : 0;
+    task.target_time = get_time_64_us() + static_cast<uint64_t>(delay_ms) * 1000;
+    task.function = function;
 
-            auto it = std::min_element(task_queue_delayed_.begin(), task_queue_delayed_.end(), [](const DelayedTask& a, const DelayedTask& b) 
-            {
-                return a.function && (!b.function || a.target_time < b.target_time);
-            });
+    insert_id_unsafe(task_id, slot);
 
-            if (it != task_queue_delayed_.end() && it->function) 
-            {
-                timer_hw->alarm[alarm_num_] = static_cast<uint32_t>(it->target_time);
-            }
+    task.heap_pos = heap_size_;
+    heap_[heap_size_++] = slot;
+    heap_sift_up_unsafe(task.heap_pos);
 
-            spin_unlock(spinlock_delayed_, irq_state);
-            return true;
-        }
-    }
+    arm_alarm_unsafe();
 
     spin_unlock(spinlock_delayed_, irq_state);
-    return false;
+    return true;
 }
 
 void TaskQueue::cancel_delayed_task(uint32_t task_id)
 {
     uint32_t irq_state = spin_lock_blocking(spinlock_delayed_);
-    bool found = false;
 
-    for (auto& task : task_queue_delayed_) 
-    {
-        if (task.task_id == task_id) 
-        {
-            task.function = nullptr;
-            task.task_id = 0;
-            task.interval_ms = 0;
-            found = true;
-        }
-    }
-
-    if (!found)
+    uint8_t slot = find_slot_unsafe(task_id);
+    if (slot == INVALID_IDX)
     {
         spin_unlock(spinlock_delayed_, irq_state);
         return;
     }
 
-    hw_set_bits(&timer_hw->inte, 1u << alarm_num_);
+    heap_remove_unsafe(task_queue_delayed_[slot].heap_pos);
+    release_slot_unsafe(slot);
+
+    arm_alarm_unsafe();
 
-    int64_t next_target_time = get_next_target_time_unsafe(task_queue_delayed_);
-    if (next_target_time >= 0) 
-    {
-        timer_hw->alarm[alarm_num_] = static_cast<uint32_t>(next_target_time);
-    }
-    
     spin_unlock(spinlock_delayed_, irq_state);
 }
 
-bool TaskQueue::queue_task(const std::function<void()>& function)
+bool TaskQueue::queue_task(const Function& function)
 {
     uint32_t irq_state = spin_lock_blocking(spinlock_queue_);
-    for (auto& task : task_queue_)
+    if (!function || queue_count_ >= MAX_TASKS)
     {
-        if (!task.function)
-        {
-            task.function = function;
-            spin_unlock(spinlock_queue_, irq_state);
-            return true;
-        }
+        spin_unlock(spinlock_queue_, irq_state);
+        return false;
     }
+
+    task_queue_[(queue_head_ + queue_count_) % MAX_TASKS] = function;
+    ++queue_count_;
+
     spin_unlock(spinlock_queue_, irq_state);
-    return false;
+    return true;
 }
 
 void TaskQueue::process_tasks()
 {
     uint32_t irq_state = spin_lock_blocking(spinlock_queue_);
-    for (auto& task : task_queue_)
+
+    //Only run what was queued before this call, tasks queued meanwhile run next time
+    uint8_t count = queue_count_;
+
+    while (count-- && queue_count_)
     {
-        if (task.function)
-        {
-            auto function = task.function;
-            task.function = nullptr;
-            spin_unlock(spinlock_queue_, irq_state);
+        Function function = task_queue_[queue_head_];
+        task_queue_[queue_head_] = nullptr;
+        queue_head_ = (queue_head_ + 1) % MAX_TASKS;
+        --queue_count_;
+        spin_unlock(spinlock_queue_, irq_state);
 
-            function();
+        function();
 
-            irq_state = spin_lock_blocking(spinlock_queue_);
-        }
-        else
-        {
-            break; //No more tasks
-        }
+        irq_state = spin_lock_blocking(spinlock_queue_);
     }
     spin_unlock(spinlock_queue_, irq_state);
 }
@@ -154,6 +135,7 @@ uint64_t TaskQueue::get_time_64_us()
 void TaskQueue::timer_irq_handler()
 {
     hw_clear_bits(&timer_hw->intr, 1u << alarm_num_);
+    hw_clear_bits(&timer_hw->intf, 1u << alarm_num_);
 
     uint64_t now = get_time_64_us();
     uint32_t irq_state = spin_lock_blocking(spinlock_delayed_);
@@ -163,32 +145,38 @@ void TaskQueue::timer_irq_handler()
         return;
     }
 
-    for (auto& task : task_queue_delayed_) 
+    //Only due tasks are touched, each costs a log(n) heap fix-up
+    while (heap_size_ > 0 && task_queue_delayed_[heap_[0]].target_time <= now)
     {
-        if (task.function && task.target_time <= now) 
+        uint8_t slot = heap_[0];
+        DelayedTask& task = task_queue_delayed_[slot];
+
+        //More tasks can come due at once than the ready queue holds, retry those later instead of dropping them
+        if (!queue_task(task.function))
         {
-            auto function = task.function;
-            if (task.interval_ms) 
-            {
-                task.target_time += (task.interval_ms * 1000);
-            } 
-            else 
+            task.target_time = now + QUEUE_FULL_RETRY_US;
+            heap_sift_down_unsafe(0);
+            continue;
+        }
+
+        if (task.interval_ms)
+        {
+            task.target_time += static_cast<uint64_t>(task.interval_ms) * 1000;
+            if (task.target_time <= now)
             {
-                task.function = nullptr;
-                task.task_id = 0;
+                //Fell behind (e.g. long IRQ latency), don't queue the same task repeatedly to catch up
+                task.target_time = now + static_cast<uint64_t>(task.interval_ms) * 1000;
             }
-
-            spin_unlock(spinlock_delayed_, irq_state);
-            queue_task(function);
-            irq_state = spin_lock_blocking(spinlock_delayed_);
+            heap_sift_down_unsafe(0);
+        }
+        else
+        {
+            heap_remove_unsafe(0);
+            release_slot_unsafe(slot);
         }
     }
 
-    int64_t next_target_time = get_next_target_time_unsafe(task_queue_delayed_);
-    if (next_target_time >= 0) 
-    {
-        timer_hw->alarm[alarm_num_] = static_cast<uint32_t>(next_target_time);
-    }
+    arm_alarm_unsafe();
 
     spin_unlock(spinlock_delayed_, irq_state);
 }
@@ -235,18 +223,168 @@ void TaskQueue::resume_delayed()
     uint64_t now = get_time_64_us();
     uint64_t elapsed_time = now - suspended_time_;
 
-    for (auto& task : task_queue_delayed_) 
+    //Shifting every target by the same amount (then clamping) keeps the heap ordered
+    for (uint8_t i = 0; i < heap_size_; ++i)
+    {
+        DelayedTask& task = task_queue_delayed_[heap_[i]];
+        task.target_time = std::max(task.target_time + elapsed_time, now + 10);
+    }
+    suspended_ = false;
+    arm_alarm_unsafe();
+    spin_unlock(spinlock_delayed_, irq_state);
+}
+
+uint8_t TaskQueue::find_slot_unsafe(uint32_t task_id)
+{
+    for (uint8_t i = id_hash(task_id), probes = 0; probes < ID_MAP_SIZE; i = (i + 1) & (ID_MAP_SIZE - 1), ++probes)
     {
-        if (task.function) 
+        uint8_t slot = id_map_[i];
+        if (slot == INVALID_IDX)
         {
-            task.target_time = std::max(task.target_time + elapsed_time, now + 10);
+            break;
+        }
+        if (task_queue_delayed_[slot].task_id == task_id)
+        {
+            return slot;
         }
     }
-    int64_t next_target_time = get_next_target_time_unsafe(task_queue_delayed_);
-    if (next_target_time >= 0) 
+    return INVALID_IDX;
+}
+
+void TaskQueue::insert_id_unsafe(uint32_t task_id, uint8_t slot)
+{
+    //Map is twice the size of the slot array so there's always a free entry
+    uint8_t i = id_hash(task_id);
+    while (id_map_[i] != INVALID_IDX)
     {
-        timer_hw->alarm[alarm_num_] = static_cast<uint32_t>(next_target_time);
+        i = (i + 1) & (ID_MAP_SIZE - 1);
     }
-    suspended_ = false;
-    spin_unlock(spinlock_delayed_, irq_state);
-}
\ No newline at end of file
+    id_map_[i] = slot;
+}
+
+void TaskQueue::erase_id_unsafe(uint32_t task_id)
+{
+    uint8_t i = id_hash(task_id);
+    while (id_map_[i] != INVALID_IDX && task_queue_delayed_[id_map_[i]].task_id != task_id)
+    {
+        i = (i + 1) & (ID_MAP_SIZE - 1);
+    }
+    if (id_map_[i] == INVALID_IDX)
+    {
+        return;
+    }
+
+    //Backward shift deletion, keeps probe chains intact without tombstones
+    uint8_t j = i;
+    while (true)
+    {
+        id_map_[i] = INVALID_IDX;
+        while (true)
+        {
+            j = (j + 1) & (ID_MAP_SIZE - 1);
+            if (id_map_[j] == INVALID_IDX)
+            {
+                return;
+            }
+            uint8_t home = id_hash(task_queue_delayed_[id_map_[j]].task_id);
+            bool in_place = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (!in_place)
+            {
+                break;
+            }
+        }
+        id_map_[i] = id_map_[j];
+        i = j;
+    }
+}
+
+void TaskQueue::heap_swap_unsafe(uint8_t a, uint8_t b)
+{
+    std::swap(heap_[a], heap_[b]);
+    task_queue_delayed_[heap_[a]].heap_pos = a;
+    task_queue_delayed_[heap_[b]].heap_pos = b;
+}
+
+void TaskQueue::heap_sift_up_unsafe(uint8_t pos)
+{
+    while (pos > 0)
+    {
+        uint8_t parent = (pos - 1) / 2;
+        if (task_queue_delayed_[heap_[parent]].target_time <= task_queue_delayed_[heap_[pos]].target_time)
+        {
+            break;
+        }
+        heap_swap_unsafe(pos, parent);
+        pos = parent;
+    }
+}
+
+void TaskQueue::heap_sift_down_unsafe(uint8_t pos)
+{
+    while (true)
+    {
+        uint8_t smallest = pos;
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+
+        if (left < heap_size_ &&
+            task_queue_delayed_[heap_[left]].target_time < task_queue_delayed_[heap_[smallest]].target_time)
+        {
+            smallest = left;
+        }
+        if (right < heap_size_ &&
+            task_queue_delayed_[heap_[right]].target_time < task_queue_delayed_[heap_[smallest]].target_time)
+        {
+            smallest = right;
+        }
+        if (smallest == pos)
+        {
+            break;
+        }
+        heap_swap_unsafe(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void TaskQueue::heap_remove_unsafe(uint8_t pos)
+{
+    uint8_t last = --heap_size_;
+    task_queue_delayed_[heap_[pos]].heap_pos = INVALID_IDX;
+
+    if (pos == last)
+    {
+        return;
+    }
+
+    heap_[pos] = heap_[last];
+    task_queue_delayed_[heap_[pos]].heap_pos = pos;
+    heap_sift_down_unsafe(pos);
+    heap_sift_up_unsafe(pos);
+}
+
+void TaskQueue::release_slot_unsafe(uint8_t slot)
+{
+    DelayedTask& task = task_queue_delayed_[slot];
+    erase_id_unsafe(task.task_id);
+    task.function = nullptr;
+    task.task_id = 0;
+    task.interval_ms = 0;
+    free_slots_[free_count_++] = slot;
+}
+
+void TaskQueue::arm_alarm_unsafe()
+{
+    if (heap_size_ == 0 || suspended_)
+    {
+        return;
+    }
+
+    uint64_t target_time = task_queue_delayed_[heap_[0]].target_time;
+    timer_hw->alarm[alarm_num_] = static_cast<uint32_t>(target_time);
+
+    //The alarm only matches the low 32 bits, if the target already passed force the IRQ instead of waiting for a wrap
+    if (get_time_64_us() >= target_time)
+    {
+        hw_set_bits(&timer_hw->intf, 1u << alarm_num_);
+    }
+}
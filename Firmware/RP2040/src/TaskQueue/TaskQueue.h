@@ -2,18 +2,21 @@
 #define TASK_QUEUE_H
 
 #include <cstdint>
-#include <functional>
-#include <memory>
+#include <array>
 #include <pico/stdlib.h>
 #include <hardware/timer.h>
 #include <hardware/irq.h>
 #include <hardware/sync.h>
 
 #include "Board/Config.h"
+#include "TaskQueue/InplaceFunction.h"
 
 class TaskQueue
 {
 public:
+    //Callables are stored inline, lambdas must fit in 4 pointers worth of captures
+    using Function = InplaceFunction<void()>;
+
     struct Core0
     {
         static inline uint32_t get_new_task_id()
@@ -24,11 +27,11 @@ public:
         {
             get_core0().cancel_delayed_task(task_id);
         }
-        static inline bool queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const std::function<void()>& function)
+        static inline bool queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const Function& function)
         {
             return get_core0().queue_delayed_task(task_id, delay_ms, repeating, function);
         }
-        static inline bool queue_task(const std::function<void()>& function)
+        static inline bool queue_task(const Function& function)
         {
             return get_core0().queue_task(function);
         }
@@ -57,11 +60,11 @@ public:
         {
             get_core1().cancel_delayed_task(task_id);
         }
-        static inline bool queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const std::function<void()>& function)
+        static inline bool queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const Function& function)
         {
             return get_core1().queue_delayed_task(task_id, delay_ms, repeating, function);
         }
-        static inline bool queue_task(const std::function<void()>& function)
+        static inline bool queue_task(const Function& function)
         {
             return get_core1().queue_task(function);
         }
@@ -97,23 +100,22 @@ private:
     TaskQueue(CoreNum core_num);
     ~TaskQueue() = default;
 
-    struct Task
-    {
-        // uint32_t task_id = 0;
-        std::function<void()> function = nullptr;
-    };
+    static constexpr uint8_t MAX_TASKS = 8;
+    static constexpr uint8_t MAX_DELAYED_TASKS = MAX_TASKS * 2;
+    static constexpr uint8_t ID_MAP_SIZE = MAX_DELAYED_TASKS * 2;
+    static constexpr uint8_t INVALID_IDX = 0xFF;
+    static constexpr uint64_t QUEUE_FULL_RETRY_US = 1000;
+    static_assert((ID_MAP_SIZE & (ID_MAP_SIZE - 1)) == 0, "TaskQueue::ID_MAP_SIZE must be a power of 2");
 
     struct DelayedTask
     {
         uint32_t task_id = 0;
         uint32_t interval_ms = 0;
         uint64_t target_time = 0;
-        std::function<void()> function = nullptr;
+        uint8_t heap_pos = INVALID_IDX;
+        Function function = nullptr;
     };
 
-    static constexpr uint8_t MAX_TASKS = 8;
-    static constexpr uint8_t MAX_DELAYED_TASKS = MAX_TASKS * 2;
-
     // CoreNum core_num_;
     uint32_t alarm_num_;
     uint32_t new_task_id_ = 1;
@@ -126,8 +128,19 @@ private:
     spin_lock_t* spinlock_queue_ = spin_lock_instance(static_cast<uint>(spinlock_queue_num_));
     spin_lock_t* spinlock_delayed_ = spin_lock_instance(static_cast<uint>(spinlock_delayed_num_));
 
-    std::array<Task, MAX_TASKS> task_queue_;
+    //FIFO of tasks ready to run
+    std::array<Function, MAX_TASKS> task_queue_;
+    uint8_t queue_head_ = 0;
+    uint8_t queue_count_ = 0;
+
+    //Delayed task storage, a min-heap of slot indices ordered by target time,
+    //a free list of slots and an open addressed task_id -> slot map for cancellation
     std::array<DelayedTask, MAX_DELAYED_TASKS> task_queue_delayed_;
+    std::array<uint8_t, MAX_DELAYED_TASKS> heap_;
+    uint8_t heap_size_ = 0;
+    std::array<uint8_t, MAX_DELAYED_TASKS> free_slots_;
+    uint8_t free_count_ = 0;
+    std::array<uint8_t, ID_MAP_SIZE> id_map_;
 
     static TaskQueue& get_core0()
     {
@@ -141,9 +154,9 @@ private:
     }
 
     uint32_t get_new_task_id();
-    bool queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const std::function<void()>& function);
+    bool queue_delayed_task(uint32_t task_id, uint32_t delay_ms, bool repeating, const Function& function);
     void cancel_delayed_task(uint32_t task_id);
-    bool queue_task(const std::function<void()>& function);
+    bool queue_task(const Function& function);
     void process_tasks();
 
     void suspend_delayed();
@@ -163,21 +176,22 @@ private:
     {
         return timer_hardware_alarm_get_irq_num(timer_hw, alarm_num);
     }
-    static inline int64_t get_next_target_time_unsafe(std::array<DelayedTask, MAX_DELAYED_TASKS>& task_queue_delayed)
+    static inline uint8_t id_hash(uint32_t task_id)
     {
-        auto it = std::min_element(task_queue_delayed.begin(), task_queue_delayed.end(), [](const DelayedTask& a, const DelayedTask& b) 
-        {
-            //Get task with the earliest target time
-            return a.function && (!b.function || a.target_time < b.target_time);
-        });
-
-        if (it != task_queue_delayed.end() && it->function) 
-        {
-            return static_cast<int64_t>(it->target_time);
-        }
-        return -1;
+        return static_cast<uint8_t>((task_id * 2654435761u) >> 24) & (ID_MAP_SIZE - 1);
     }
 
+    //All _unsafe methods expect spinlock_delayed_ to be held
+    uint8_t find_slot_unsafe(uint32_t task_id);
+    void insert_id_unsafe(uint32_t task_id, uint8_t slot);
+    void erase_id_unsafe(uint32_t task_id);
+    void heap_swap_unsafe(uint8_t a, uint8_t b);
+    void heap_sift_up_unsafe(uint8_t pos);
+    void heap_sift_down_unsafe(uint8_t pos);
+    void heap_remove_unsafe(uint8_t pos);
+    void release_slot_unsafe(uint8_t slot);
+    void arm_alarm_unsafe();
+
 }; // class TaskQueue
 
 #endif // TASK_QUEUE_H
\ No newline at end of file
@@ -36,7 +36,7 @@ void DInputDevice::initialize()
 		.open = hidd_open,
 		.control_xfer_cb = DInputDevice::control_xfer_cb,
 		.xfer_cb = hidd_xfer_cb,
-		.sof = NULL
+		.sof = sof_sync::SOF_CB
 	};
 }
 
@@ -47,53 +47,14 @@ void DInputDevice::process(const uint8_t idx, Gamepad& gamepad)
     if (gamepad.new_pad_in())
     {
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        sof_sync::input_read(gamepad.get_pad_in_time());
 
-        switch (gp_in.dpad)
-        {
-            case Gamepad::DPAD_UP:
-                in_report.dpad = DInput::DPad::UP;
-                break;
-            case Gamepad::DPAD_DOWN:
-                in_report.dpad = DInput::DPad::DOWN;
-                break;
-            case Gamepad::DPAD_LEFT:
-                in_report.dpad = DInput::DPad::LEFT;
-                break;
-            case Gamepad::DPAD_RIGHT:
-                in_report.dpad = DInput::DPad::RIGHT;
-                break;
-            case Gamepad::DPAD_UP_LEFT:
-                in_report.dpad = DInput::DPad::UP_LEFT;
-                break;
-            case Gamepad::DPAD_UP_RIGHT:
-                in_report.dpad = DInput::DPad::UP_RIGHT;
-                break;
-            case Gamepad::DPAD_DOWN_LEFT:
-                in_report.dpad = DInput::DPad::DOWN_LEFT;
-                break;
-            case Gamepad::DPAD_DOWN_RIGHT:
-                in_report.dpad = DInput::DPad::DOWN_RIGHT;
-                break;
-            default:
-                in_report.dpad = DInput::DPad::CENTER;
-                break;
-        }
-
-        std::memset(in_report.buttons, 0, sizeof(in_report.buttons));
-
-        if (gp_in.buttons & Gamepad::BUTTON_A)   in_report.buttons[0] |= DInput::Buttons0::CROSS;
-        if (gp_in.buttons & Gamepad::BUTTON_B)   in_report.buttons[0] |= DInput::Buttons0::CIRCLE;
-        if (gp_in.buttons & Gamepad::BUTTON_X)   in_report.buttons[0] |= DInput::Buttons0::SQUARE;
-        if (gp_in.buttons & Gamepad::BUTTON_Y)   in_report.buttons[0] |= DInput::Buttons0::TRIANGLE;
-        if (gp_in.buttons & Gamepad::BUTTON_LB)  in_report.buttons[0] |= DInput::Buttons0::L1;
-        if (gp_in.buttons & Gamepad::BUTTON_RB)  in_report.buttons[0] |= DInput::Buttons0::R1;
+        in_report.dpad = DPAD_LUT(gp_in.dpad);
 
-        if (gp_in.buttons & Gamepad::BUTTON_L3)    in_report.buttons[1] |= DInput::Buttons1::L3;
-        if (gp_in.buttons & Gamepad::BUTTON_R3)    in_report.buttons[1] |= DInput::Buttons1::R3;
-        if (gp_in.buttons & Gamepad::BUTTON_BACK)  in_report.buttons[1] |= DInput::Buttons1::SELECT;
-        if (gp_in.buttons & Gamepad::BUTTON_START) in_report.buttons[1] |= DInput::Buttons1::START;
-        if (gp_in.buttons & Gamepad::BUTTON_SYS)   in_report.buttons[1] |= DInput::Buttons1::SYS;
-        if (gp_in.buttons & Gamepad::BUTTON_MISC)  in_report.buttons[1] |= DInput::Buttons1::TP;
+        const uint16_t buttons = BUTTON_LUT(gp_in.buttons);
+        in_report.buttons[0] = static_cast<uint8_t>(buttons);
+        in_report.buttons[1] = static_cast<uint8_t>(buttons >> 8);
 
         if (gamepad.analog_enabled())
         {
@@ -125,9 +86,14 @@ void DInputDevice::process(const uint8_t idx, Gamepad& gamepad)
         tud_remote_wakeup();
     }
 
-    if (tud_hid_n_ready(idx))
+    if (submit_due() &&
+        tud_hid_n_ready(idx) &&
+        std::memcmp(&prev_in_reports_[idx], &in_report, sizeof(DInput::InReport)) &&
+        tud_hid_n_report(idx, 0, reinterpret_cast<void*>(&in_report), sizeof(DInput::InReport)))
     {
-        tud_hid_n_report(idx, 0, reinterpret_cast<void*>(&in_report), sizeof(DInput::InReport));
+        std::memcpy(&prev_in_reports_[idx], &in_report, sizeof(DInput::InReport));
+        sof_sync::submitted();
+        OGXM_TRACE(DEVICE_SUBMIT);
     }
 }
 
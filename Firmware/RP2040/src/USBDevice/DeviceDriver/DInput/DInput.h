@@ -23,7 +23,27 @@ public:
     const uint8_t* get_descriptor_device_qualifier_cb() override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map_to(Gamepad::BUTTON_A,     0, DInput::Buttons0::CROSS)
+        .map_to(Gamepad::BUTTON_B,     0, DInput::Buttons0::CIRCLE)
+        .map_to(Gamepad::BUTTON_X,     0, DInput::Buttons0::SQUARE)
+        .map_to(Gamepad::BUTTON_Y,     0, DInput::Buttons0::TRIANGLE)
+        .map_to(Gamepad::BUTTON_LB,    0, DInput::Buttons0::L1)
+        .map_to(Gamepad::BUTTON_RB,    0, DInput::Buttons0::R1)
+        .map_to(Gamepad::BUTTON_L3,    1, DInput::Buttons1::L3)
+        .map_to(Gamepad::BUTTON_R3,    1, DInput::Buttons1::R3)
+        .map_to(Gamepad::BUTTON_BACK,  1, DInput::Buttons1::SELECT)
+        .map_to(Gamepad::BUTTON_START, 1, DInput::Buttons1::START)
+        .map_to(Gamepad::BUTTON_SYS,   1, DInput::Buttons1::SYS)
+        .map_to(Gamepad::BUTTON_MISC,  1, DInput::Buttons1::TP);
+    static constexpr auto DPAD_LUT = DPadLut<uint8_t>::hat(
+        DInput::DPad::UP, DInput::DPad::UP_RIGHT, DInput::DPad::RIGHT, DInput::DPad::DOWN_RIGHT,
+        DInput::DPad::DOWN, DInput::DPad::DOWN_LEFT, DInput::DPad::LEFT, DInput::DPad::UP_LEFT,
+        DInput::DPad::CENTER);
+
     std::array<DInput::InReport, MAX_GAMEPADS> in_reports_;
+    //Last report the host accepted, identical reports aren't resent
+    std::array<DInput::InReport, MAX_GAMEPADS> prev_in_reports_{};
 
     static bool control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request);
 };
@@ -8,6 +8,8 @@
 #include "device/usbd_pvt.h"
 
 #include "Gamepad/Gamepad.h"
+#include "Gamepad/ButtonLut.h"
+#include "USBDevice/SOFSync.h"
 
 #if CFG_TUSB_DEBUG >= CFG_TUD_LOG_LEVEL
     #define TUD_DRV_NAME(name) name
@@ -34,6 +36,9 @@ public:
 protected:
     usbd_class_driver_t class_driver_;
 
+    //Drivers that set class_driver_.sof to sof_sync::SOF_CB hold IN reports until just before the host polls
+    bool submit_due() const { return !class_driver_.sof || sof_sync::submit_due(); }
+
     uint16_t* get_string_descriptor(const char* value, uint8_t index);
 };
 
@@ -14,7 +14,7 @@ void PS3Device::initialize()
 		.open = hidd_open,
 		.control_xfer_cb = hidd_control_xfer_cb,
 		.xfer_cb = hidd_xfer_cb,
-		.sof = NULL
+		.sof = sof_sync::SOF_CB
 	};
 }
 
@@ -23,50 +23,14 @@ void PS3Device::process(const uint8_t idx, Gamepad& gamepad)
     if (gamepad.new_pad_in())
     {
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        sof_sync::input_read(gamepad.get_pad_in_time());
         report_in_ = PS3::InReport();
 
-        switch (gp_in.dpad)
-        {
-            case Gamepad::DPAD_UP:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_UP;
-                break;
-            case Gamepad::DPAD_DOWN:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_DOWN;
-                break;
-            case Gamepad::DPAD_LEFT:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_RIGHT:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_RIGHT;
-                break;
-            case Gamepad::DPAD_UP_LEFT:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_UP | PS3::Buttons0::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_UP_RIGHT:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_UP | PS3::Buttons0::DPAD_RIGHT;
-                break;
-            case Gamepad::DPAD_DOWN_LEFT:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_DOWN | PS3::Buttons0::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_DOWN_RIGHT:
-                report_in_.buttons[0] = PS3::Buttons0::DPAD_DOWN | PS3::Buttons0::DPAD_RIGHT;
-                break;
-            default:
-                break;
-        }
-
-        if (gp_in.buttons & Gamepad::BUTTON_X)        report_in_.buttons[1] |= PS3::Buttons1::SQUARE;
-        if (gp_in.buttons & Gamepad::BUTTON_A)        report_in_.buttons[1] |= PS3::Buttons1::CROSS;
-        if (gp_in.buttons & Gamepad::BUTTON_Y)        report_in_.buttons[1] |= PS3::Buttons1::TRIANGLE;
-        if (gp_in.buttons & Gamepad::BUTTON_B)        report_in_.buttons[1] |= PS3::Buttons1::CIRCLE;
-        if (gp_in.buttons & Gamepad::BUTTON_LB)       report_in_.buttons[1] |= PS3::Buttons1::L1;
-        if (gp_in.buttons & Gamepad::BUTTON_RB)       report_in_.buttons[1] |= PS3::Buttons1::R1;
-        if (gp_in.buttons & Gamepad::BUTTON_BACK)     report_in_.buttons[0] |= PS3::Buttons0::SELECT;
-        if (gp_in.buttons & Gamepad::BUTTON_START)    report_in_.buttons[0] |= PS3::Buttons0::START;
-        if (gp_in.buttons & Gamepad::BUTTON_L3)       report_in_.buttons[0] |= PS3::Buttons0::L3;
-        if (gp_in.buttons & Gamepad::BUTTON_R3)       report_in_.buttons[0] |= PS3::Buttons0::R3;
-        if (gp_in.buttons & Gamepad::BUTTON_SYS)      report_in_.buttons[2] |= PS3::Buttons2::SYS;
-        if (gp_in.buttons & Gamepad::BUTTON_MISC)     report_in_.buttons[2] |= PS3::Buttons2::TP;
+        const uint32_t buttons = BUTTON_LUT(gp_in.buttons);
+        report_in_.buttons[0] = static_cast<uint8_t>(buttons) | DPAD_LUT(gp_in.dpad);
+        report_in_.buttons[1] = static_cast<uint8_t>(buttons >> 8);
+        report_in_.buttons[2] = static_cast<uint8_t>(buttons >> 16);
 
         if (gp_in.trigger_l) report_in_.buttons[1] |= PS3::Buttons1::L2;
         if (gp_in.trigger_r) report_in_.buttons[1] |= PS3::Buttons1::R2;
@@ -113,10 +77,12 @@ void PS3Device::process(const uint8_t idx, Gamepad& gamepad)
         tud_remote_wakeup();
     }
 
-    if (tud_hid_ready())
+    if (submit_due() && tud_hid_ready())
     {
         //PS3 seems to start using stale data if a report isn't sent every frame
         tud_hid_report(0, reinterpret_cast<uint8_t*>(&report_in_), sizeof(PS3::InReport));
+        sof_sync::submitted();
+        OGXM_TRACE(DEVICE_SUBMIT);
     }
 
     if (new_report_out_)
@@ -22,6 +22,22 @@ public:
     const uint8_t* get_descriptor_device_qualifier_cb() override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16, uint32_t>()
+        .map_to(Gamepad::BUTTON_BACK,  0, PS3::Buttons0::SELECT)
+        .map_to(Gamepad::BUTTON_START, 0, PS3::Buttons0::START)
+        .map_to(Gamepad::BUTTON_L3,    0, PS3::Buttons0::L3)
+        .map_to(Gamepad::BUTTON_R3,    0, PS3::Buttons0::R3)
+        .map_to(Gamepad::BUTTON_X,     1, PS3::Buttons1::SQUARE)
+        .map_to(Gamepad::BUTTON_A,     1, PS3::Buttons1::CROSS)
+        .map_to(Gamepad::BUTTON_Y,     1, PS3::Buttons1::TRIANGLE)
+        .map_to(Gamepad::BUTTON_B,     1, PS3::Buttons1::CIRCLE)
+        .map_to(Gamepad::BUTTON_LB,    1, PS3::Buttons1::L1)
+        .map_to(Gamepad::BUTTON_RB,    1, PS3::Buttons1::R1)
+        .map_to(Gamepad::BUTTON_SYS,   2, PS3::Buttons2::SYS)
+        .map_to(Gamepad::BUTTON_MISC,  2, PS3::Buttons2::TP);
+    static constexpr auto DPAD_LUT = DPadLut<uint8_t>::bits(
+        PS3::Buttons0::DPAD_UP, PS3::Buttons0::DPAD_DOWN, PS3::Buttons0::DPAD_LEFT, PS3::Buttons0::DPAD_RIGHT);
+
     PS3::InReport report_in_;
     PS3::OutReport report_out_;
     PS3::BTInfo bt_info_;
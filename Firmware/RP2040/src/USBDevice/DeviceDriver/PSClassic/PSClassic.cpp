@@ -13,7 +13,7 @@ void PSClassicDevice::initialize()
 		.open = hidd_open,
 		.control_xfer_cb = hidd_control_xfer_cb,
 		.xfer_cb = hidd_xfer_cb,
-		.sof = NULL
+		.sof = sof_sync::SOF_CB
 	};
 }
 
@@ -22,36 +22,10 @@ void PSClassicDevice::process(const uint8_t idx, Gamepad& gamepad)
     if (gamepad.new_pad_in())
     {
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
-        switch (gp_in.dpad)
-        {
-            case Gamepad::DPAD_UP:
-                in_report_.buttons = PSClassic::Buttons::UP;
-                break;
-            case Gamepad::DPAD_DOWN:
-                in_report_.buttons = PSClassic::Buttons::DOWN;
-                break;
-            case Gamepad::DPAD_LEFT:
-                in_report_.buttons = PSClassic::Buttons::LEFT;
-                break;
-            case Gamepad::DPAD_RIGHT:
-                in_report_.buttons = PSClassic::Buttons::RIGHT;
-                break;
-            case Gamepad::DPAD_UP_LEFT:
-                in_report_.buttons = PSClassic::Buttons::UP_LEFT;
-                break;
-            case Gamepad::DPAD_UP_RIGHT:
-                in_report_.buttons = PSClassic::Buttons::UP_RIGHT;
-                break;
-            case Gamepad::DPAD_DOWN_LEFT:
-                in_report_.buttons = PSClassic::Buttons::DOWN_LEFT;
-                break;
-            case Gamepad::DPAD_DOWN_RIGHT:
-                in_report_.buttons = PSClassic::Buttons::DOWN_RIGHT;
-                break;
-            default:
-                in_report_.buttons = PSClassic::Buttons::CENTER;
-                break;
-        }
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        sof_sync::input_read(gamepad.get_pad_in_time());
+
+        in_report_.buttons = DPAD_LUT(gp_in.dpad);
 
         int16_t joy_lx = gp_in.joystick_lx;
         int16_t joy_ly = Range::invert(gp_in.joystick_ly);
@@ -97,14 +71,7 @@ void PSClassicDevice::process(const uint8_t idx, Gamepad& gamepad)
             in_report_.buttons = PSClassic::Buttons::UP;
         }
 
-        if (gp_in.buttons & Gamepad::BUTTON_A) in_report_.buttons |= PSClassic::Buttons::CROSS;
-        if (gp_in.buttons & Gamepad::BUTTON_B) in_report_.buttons |= PSClassic::Buttons::CIRCLE;
-        if (gp_in.buttons & Gamepad::BUTTON_X) in_report_.buttons |= PSClassic::Buttons::SQUARE;
-        if (gp_in.buttons & Gamepad::BUTTON_Y) in_report_.buttons |= PSClassic::Buttons::TRIANGLE;
-        if (gp_in.buttons & Gamepad::BUTTON_LB)    in_report_.buttons |= PSClassic::Buttons::L1;
-        if (gp_in.buttons & Gamepad::BUTTON_RB)    in_report_.buttons |= PSClassic::Buttons::R1;
-        if (gp_in.buttons & Gamepad::BUTTON_BACK)  in_report_.buttons |= PSClassic::Buttons::SELECT;
-        if (gp_in.buttons & Gamepad::BUTTON_START) in_report_.buttons |= PSClassic::Buttons::START;
+        in_report_.buttons |= BUTTON_LUT(gp_in.buttons);
         
         if (gp_in.trigger_l) in_report_.buttons |= PSClassic::Buttons::L2;
         if (gp_in.trigger_r) in_report_.buttons |= PSClassic::Buttons::R2;
@@ -114,9 +81,14 @@ void PSClassicDevice::process(const uint8_t idx, Gamepad& gamepad)
     {
         tud_remote_wakeup();
     }
-    if (tud_hid_n_ready(idx))
+    if (submit_due() &&
+        tud_hid_n_ready(idx) &&
+        std::memcmp(&prev_in_report_, &in_report_, sizeof(PSClassic::InReport)) &&
+        tud_hid_n_report(idx, 0, reinterpret_cast<uint8_t*>(&in_report_), sizeof(PSClassic::InReport)))
     {
-        tud_hid_n_report(idx, 0, reinterpret_cast<uint8_t*>(&in_report_), sizeof(PSClassic::InReport));
+        std::memcpy(&prev_in_report_, &in_report_, sizeof(PSClassic::InReport));
+        sof_sync::submitted();
+        OGXM_TRACE(DEVICE_SUBMIT);
     }
 }
 
@@ -23,12 +23,27 @@ public:
     const uint8_t* get_descriptor_device_qualifier_cb() override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(Gamepad::BUTTON_A,     PSClassic::Buttons::CROSS)
+        .map(Gamepad::BUTTON_B,     PSClassic::Buttons::CIRCLE)
+        .map(Gamepad::BUTTON_X,     PSClassic::Buttons::SQUARE)
+        .map(Gamepad::BUTTON_Y,     PSClassic::Buttons::TRIANGLE)
+        .map(Gamepad::BUTTON_LB,    PSClassic::Buttons::L1)
+        .map(Gamepad::BUTTON_RB,    PSClassic::Buttons::R1)
+        .map(Gamepad::BUTTON_BACK,  PSClassic::Buttons::SELECT)
+        .map(Gamepad::BUTTON_START, PSClassic::Buttons::START);
+    static constexpr auto DPAD_LUT = DPadLut<uint16_t>::hat(
+        PSClassic::Buttons::UP, PSClassic::Buttons::UP_RIGHT, PSClassic::Buttons::RIGHT, PSClassic::Buttons::DOWN_RIGHT,
+        PSClassic::Buttons::DOWN, PSClassic::Buttons::DOWN_LEFT, PSClassic::Buttons::LEFT, PSClassic::Buttons::UP_LEFT,
+        PSClassic::Buttons::CENTER);
+
     static constexpr int16_t JOY_POS_THRESHOLD = 10000;
     static constexpr int16_t JOY_NEG_THRESHOLD = -10000;
     static constexpr int16_t JOY_POS_45_THRESHOLD = JOY_POS_THRESHOLD * 2;
     static constexpr int16_t JOY_NEG_45_THRESHOLD = JOY_NEG_THRESHOLD * 2;
 
     PSClassic::InReport in_report_{0};
+    PSClassic::InReport prev_in_report_{0};
 
     inline bool meets_pos_threshold(int16_t joy_l, int16_t joy_r) { return (joy_l >= JOY_POS_THRESHOLD) || (joy_r >= JOY_POS_THRESHOLD); }
     inline bool meets_neg_threshold(int16_t joy_l, int16_t joy_r) { return (joy_l <= JOY_NEG_THRESHOLD) || (joy_r <= JOY_NEG_THRESHOLD); }
@@ -13,7 +13,7 @@ void SwitchDevice::initialize()
 		.open = hidd_open,
 		.control_xfer_cb = hidd_control_xfer_cb,
 		.xfer_cb = hidd_xfer_cb,
-		.sof = NULL
+		.sof = sof_sync::SOF_CB
 	};
 
     in_report_.fill(SwitchWired::InReport());
@@ -26,52 +26,11 @@ void SwitchDevice::process(const uint8_t idx, Gamepad& gamepad)
     if (gamepad.new_pad_in())
     {
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        sof_sync::input_read(gamepad.get_pad_in_time());
     
-        switch (gp_in.dpad)
-        {
-            case Gamepad::DPAD_UP:
-                in_report.dpad = SwitchWired::DPad::UP;
-                break;
-            case Gamepad::DPAD_DOWN:
-                in_report.dpad = SwitchWired::DPad::DOWN;
-                break;
-            case Gamepad::DPAD_LEFT:
-                in_report.dpad = SwitchWired::DPad::LEFT;
-                break;
-            case Gamepad::DPAD_RIGHT:
-                in_report.dpad = SwitchWired::DPad::RIGHT;
-                break;
-            case Gamepad::DPAD_UP_LEFT:
-                in_report.dpad = SwitchWired::DPad::UP_LEFT;
-                break;
-            case Gamepad::DPAD_UP_RIGHT:
-                in_report.dpad = SwitchWired::DPad::UP_RIGHT;
-                break;
-            case Gamepad::DPAD_DOWN_LEFT:
-                in_report.dpad = SwitchWired::DPad::DOWN_LEFT;
-                break;
-            case Gamepad::DPAD_DOWN_RIGHT:
-                in_report.dpad = SwitchWired::DPad::DOWN_RIGHT;
-                break;
-            default:
-                in_report.dpad = SwitchWired::DPad::CENTER;
-                break;
-        }
-
-        in_report.buttons = 0;
-
-        if (gp_in.buttons & Gamepad::BUTTON_X)        in_report.buttons |= SwitchWired::Buttons::Y;
-        if (gp_in.buttons & Gamepad::BUTTON_A)        in_report.buttons |= SwitchWired::Buttons::B;
-        if (gp_in.buttons & Gamepad::BUTTON_Y)        in_report.buttons |= SwitchWired::Buttons::X;
-        if (gp_in.buttons & Gamepad::BUTTON_B)        in_report.buttons |= SwitchWired::Buttons::A;
-        if (gp_in.buttons & Gamepad::BUTTON_LB)       in_report.buttons |= SwitchWired::Buttons::L;
-        if (gp_in.buttons & Gamepad::BUTTON_RB)       in_report.buttons |= SwitchWired::Buttons::R;
-        if (gp_in.buttons & Gamepad::BUTTON_BACK)     in_report.buttons |= SwitchWired::Buttons::MINUS;
-        if (gp_in.buttons & Gamepad::BUTTON_START)    in_report.buttons |= SwitchWired::Buttons::PLUS;
-        if (gp_in.buttons & Gamepad::BUTTON_L3)       in_report.buttons |= SwitchWired::Buttons::L3;
-        if (gp_in.buttons & Gamepad::BUTTON_R3)       in_report.buttons |= SwitchWired::Buttons::R3;
-        if (gp_in.buttons & Gamepad::BUTTON_SYS)      in_report.buttons |= SwitchWired::Buttons::HOME;
-        if (gp_in.buttons & Gamepad::BUTTON_MISC)     in_report.buttons |= SwitchWired::Buttons::CAPTURE;
+        in_report.dpad = DPAD_LUT(gp_in.dpad);
+        in_report.buttons = BUTTON_LUT(gp_in.buttons);
 
         if (gp_in.trigger_l) in_report.buttons |= SwitchWired::Buttons::ZL;
         if (gp_in.trigger_r) in_report.buttons |= SwitchWired::Buttons::ZR;
@@ -86,9 +45,14 @@ void SwitchDevice::process(const uint8_t idx, Gamepad& gamepad)
     {
 		tud_remote_wakeup();
     }
-	if (tud_hid_n_ready(idx))
+	if (submit_due() &&
+        tud_hid_n_ready(idx) &&
+        std::memcmp(&prev_in_report_[idx], &in_report, sizeof(SwitchWired::InReport)) &&
+        tud_hid_n_report(idx, 0, reinterpret_cast<uint8_t*>(&in_report), sizeof(SwitchWired::InReport)))
     {
-        tud_hid_n_report(idx, 0, reinterpret_cast<uint8_t*>(&in_report), sizeof(SwitchWired::InReport));
+        std::memcpy(&prev_in_report_[idx], &in_report, sizeof(SwitchWired::InReport));
+        sof_sync::submitted();
+        OGXM_TRACE(DEVICE_SUBMIT);
     }
 }
 
@@ -22,7 +22,27 @@ public:
     const uint8_t* get_descriptor_device_qualifier_cb() override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(Gamepad::BUTTON_X,     SwitchWired::Buttons::Y)
+        .map(Gamepad::BUTTON_A,     SwitchWired::Buttons::B)
+        .map(Gamepad::BUTTON_Y,     SwitchWired::Buttons::X)
+        .map(Gamepad::BUTTON_B,     SwitchWired::Buttons::A)
+        .map(Gamepad::BUTTON_LB,    SwitchWired::Buttons::L)
+        .map(Gamepad::BUTTON_RB,    SwitchWired::Buttons::R)
+        .map(Gamepad::BUTTON_BACK,  SwitchWired::Buttons::MINUS)
+        .map(Gamepad::BUTTON_START, SwitchWired::Buttons::PLUS)
+        .map(Gamepad::BUTTON_L3,    SwitchWired::Buttons::L3)
+        .map(Gamepad::BUTTON_R3,    SwitchWired::Buttons::R3)
+        .map(Gamepad::BUTTON_SYS,   SwitchWired::Buttons::HOME)
+        .map(Gamepad::BUTTON_MISC,  SwitchWired::Buttons::CAPTURE);
+    static constexpr auto DPAD_LUT = DPadLut<uint8_t>::hat(
+        SwitchWired::DPad::UP, SwitchWired::DPad::UP_RIGHT, SwitchWired::DPad::RIGHT, SwitchWired::DPad::DOWN_RIGHT,
+        SwitchWired::DPad::DOWN, SwitchWired::DPad::DOWN_LEFT, SwitchWired::DPad::LEFT, SwitchWired::DPad::UP_LEFT,
+        SwitchWired::DPad::CENTER);
+
     std::array<SwitchWired::InReport, MAX_GAMEPADS> in_report_;
+    //Last report the host accepted, identical reports aren't resent
+    std::array<SwitchWired::InReport, MAX_GAMEPADS> prev_in_report_{};
 };
 
 #endif // _SWITCH_DEVICE_H_
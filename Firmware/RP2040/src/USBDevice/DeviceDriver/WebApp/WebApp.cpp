@@ -1,3 +1,7 @@
+#include <cstddef>
+#include <algorithm>
+#include <pico/stdlib.h>
+
 #include "class/cdc/cdc_device.h"
 #include "bsp/board_api.h"
 
@@ -20,126 +24,391 @@ void WebAppDevice::initialize()
     };
 }
 
-bool WebAppDevice::read_serial(void* buffer, size_t len, bool block)
+//CRC-16/CCITT-FALSE, nibble table
+static constexpr std::array<uint16_t, 16> CRC16_TABLE = []
 {
-    if (!block && !tud_cdc_available()) 
+    std::array<uint16_t, 16> table{};
+    for (uint16_t i = 0; i < 16; ++i)
     {
-        return false;
+        uint16_t crc = static_cast<uint16_t>(i << 12);
+        for (int bit = 0; bit < 4; ++bit)
+        {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+        table[i] = crc;
     }
+    return table;
+}();
 
-    uint8_t* buf_ptr = reinterpret_cast<uint8_t*>(buffer);
-    size_t total_read = 0;
-
-    while (total_read < len)
+static inline uint16_t crc16(const uint8_t* data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i)
     {
-        if (!tud_cdc_connected())
-        {
-            return false;
-        }
-        tud_task();
+        crc = static_cast<uint16_t>((crc << 4) ^ CRC16_TABLE[((crc >> 12) ^ (data[i] >> 4)) & 0x0F]);
+        crc = static_cast<uint16_t>((crc << 4) ^ CRC16_TABLE[((crc >> 12) ^ data[i]) & 0x0F]);
+    }
+    return crc;
+}
 
-        if (tud_cdc_available())
-        {
-            size_t read = tud_cdc_read(buf_ptr + total_read, len - total_read);
-            total_read += read;
-        }
+//All or nothing, never waits on the host. Flushed once at the end of process()
+bool WebAppDevice::write_serial(const void* buffer, size_t len)
+{
+    if (tud_cdc_write_available() < len)
+    {
+        return false;
     }
-    OGXM_LOG("Read %d bytes\n", total_read);
-    OGXM_LOG_HEX(buf_ptr, total_read);
+    tud_cdc_write(buffer, len);
+    tx_written_ = true;
+    return true;
+}
 
-    return total_read == len;
+bool WebAppDevice::write_packet(const Packet& packet)
+{
+    return write_serial(&packet, sizeof(Packet));
 }
 
-bool WebAppDevice::write_serial(const void* buffer, size_t len)
+//Moves whatever CDC has into rx_buffer_, never waits for more
+void WebAppDevice::read_rx()
 {
-    const uint8_t* buf_ptr = reinterpret_cast<const uint8_t*>(buffer);
-    size_t total_written = 0;
+    if (rx_len_ < rx_buffer_.size() && tud_cdc_available())
+    {
+        rx_len_ += tud_cdc_read(rx_buffer_.data() + rx_len_, rx_buffer_.size() - rx_len_);
+    }
+}
+
+//Handles every whole frame or packet in rx_buffer_, a byte that starts neither is dropped to resync
+void WebAppDevice::parse_rx()
+{
+    size_t pos = 0;
 
-    while (total_written < len)
+    while ((pos < rx_len_) && (tx_pending_len_ == 0))
     {
-        if (!tud_cdc_connected())
+        const uint8_t* data = rx_buffer_.data() + pos;
+        const size_t available = rx_len_ - pos;
+
+        if (data[0] == FRAME_SYNC)
         {
-            return false;
+            if (available < sizeof(FrameHeader))
+            {
+                break;
+            }
+            FrameHeader header;
+            std::memcpy(&header, data, sizeof(FrameHeader));
+
+            if (header.len > FRAME_PAYLOAD_MAX)
+            {
+                ++pos;
+                continue;
+            }
+            const size_t frame_len = sizeof(FrameHeader) + header.len + sizeof(uint16_t);
+            if (available < frame_len)
+            {
+                break;
+            }
+
+            uint16_t crc = 0;
+            std::memcpy(&crc, data + frame_len - sizeof(uint16_t), sizeof(uint16_t));
+            if (crc != crc16(data, frame_len - sizeof(uint16_t)))
+            {
+                OGXM_LOG("WebApp: Frame CRC mismatch\n");
+                ++pos;
+                continue;
+            }
+
+            handle_frame(header, data + sizeof(FrameHeader));
+            pos += frame_len;
         }
-        tud_task();
+        else if (data[0] == sizeof(Packet))
+        {
+            if (available < sizeof(Packet))
+            {
+                break;
+            }
+            Packet packet;
+            std::memcpy(&packet, data, sizeof(Packet));
 
-        if (tud_cdc_write_available())
+            handle_packet(packet);
+            pos += sizeof(Packet);
+        }
+        else
         {
-            size_t written = tud_cdc_write(buf_ptr + total_written, len - total_written);
-            total_written += written;
-            tud_cdc_write_flush();
+            ++pos;
         }
     }
-    OGXM_LOG("Wrote %d bytes\n", total_written);
-    OGXM_LOG_HEX(buf_ptr, total_written);
 
-    return total_written == len;
+    if (pos > 0)
+    {
+        rx_len_ -= pos;
+        std::memmove(rx_buffer_.data(), rx_buffer_.data() + pos, rx_len_);
+    }
 }
 
-bool WebAppDevice::write_packet(const Packet& packet)
+//Header goes in tx_frame_, returns where the payload goes
+uint8_t* WebAppDevice::begin_frame(FrameType type, uint8_t seq)
 {
-    if (!write_serial(&packet, sizeof(Packet)))
+    FrameHeader header;
+    header.type = type;
+    header.seq = seq;
+    std::memcpy(tx_frame_.data(), &header, sizeof(FrameHeader));
+    return tx_frame_.data() + sizeof(FrameHeader);
+}
+
+//Sets the length and CRC, if it doesn't fit it's either dropped or held until there's room
+bool WebAppDevice::end_frame(uint16_t len, bool keep_if_full)
+{
+    std::memcpy(tx_frame_.data() + offsetof(FrameHeader, len), &len, sizeof(len));
+
+    const size_t frame_len = sizeof(FrameHeader) + len;
+    const uint16_t crc = crc16(tx_frame_.data(), frame_len);
+    std::memcpy(tx_frame_.data() + frame_len, &crc, sizeof(crc));
+
+    if (write_serial(tx_frame_.data(), frame_len + sizeof(crc)))
     {
-        return false;
+        return true;
     }
-    return true;
+    if (keep_if_full)
+    {
+        tx_pending_len_ = frame_len + sizeof(crc);
+    }
+    return false;
 }
 
-bool WebAppDevice::read_packet(Packet& packet, bool block)
+bool WebAppDevice::write_response(FrameType type, uint8_t seq, const void* payload, uint16_t len)
 {
-    if (!read_serial(&packet, sizeof(Packet), block))
+    uint8_t* frame_payload = begin_frame(static_cast<FrameType>(static_cast<uint8_t>(type) | FRAME_RESPONSE), seq);
+    if (len)
     {
-        return false;
+        std::memcpy(frame_payload, payload, len);
     }
+    end_frame(len, true);
     return true;
 }
 
-//Blocking read
-bool WebAppDevice::read_profile(UserProfile& profile)
+void WebAppDevice::write_frame_error(uint8_t seq)
 {
-    Packet packet_out;
-    uint8_t* profile_data = reinterpret_cast<uint8_t*>(&profile);
-    uint8_t current_chunk = 0;
-    uint8_t expected_chunks = 0;
-    size_t profile_offset = 0;
+    begin_frame(FrameType::ERROR, seq);
+    end_frame(0, true);
+}
 
-    while (current_chunk < expected_chunks || expected_chunks == 0)
+void WebAppDevice::handle_frame(const FrameHeader& header, const uint8_t* payload)
+{
+    switch (header.type)
     {
-        if (!read_packet(packet_out, true))
-        {
-            OGXM_LOG("Failed to read profile packet\n");
-            return false;
-        }
-        if (packet_out.header.packet_id != PacketID::SET_PROFILE)
+        case FrameType::GET_INFO:
         {
-            OGXM_LOG("Invalid packet ID: %i\n", packet_out.header.packet_id);
-            return false;
+            Info info;
+            info.device_driver = user_settings_.get_current_driver();
+            write_response(header.type, header.seq, &info, sizeof(info));
+            return;
         }
-        if (expected_chunks == 0 && packet_out.header.chunks_total > 0)
+        case FrameType::GET_PROFILE_BY_ID:
+        case FrameType::GET_PROFILE_BY_IDX:
         {
-            expected_chunks = packet_out.header.chunks_total;
-            OGXM_LOG("Expected chunks: %d\n", expected_chunks);
+            if (header.len < 1)
+            {
+                break;
+            }
+            ProfileHeader profile_header;
+            if (header.type == FrameType::GET_PROFILE_BY_ID)
+            {
+                profile_ = user_settings_.get_profile_by_id(payload[0]);
+            }
+            else
+            {
+                profile_header.player_idx = payload[0];
+                profile_ = user_settings_.get_profile_by_index(payload[0]);
+            }
+            uint8_t* frame_payload = begin_frame(static_cast<FrameType>(static_cast<uint8_t>(header.type) | FRAME_RESPONSE), header.seq);
+            std::memcpy(frame_payload, &profile_header, sizeof(ProfileHeader));
+            std::memcpy(frame_payload + sizeof(ProfileHeader), &profile_, sizeof(UserProfile));
+            end_frame(sizeof(ProfileHeader) + sizeof(UserProfile), true);
+            return;
         }
-        else if (expected_chunks == 0)
+        case FrameType::SET_PROFILE:
         {
-            OGXM_LOG("Invalid chunk count\n");
-            return false;
+            if (header.len != sizeof(ProfileHeader) + sizeof(UserProfile))
+            {
+                break;
+            }
+            ProfileHeader profile_header;
+            std::memcpy(&profile_header, payload, sizeof(ProfileHeader));
+            std::memcpy(&profile_, payload + sizeof(ProfileHeader), sizeof(UserProfile));
+
+            //Answer first, a driver switch takes this device off the bus
+            write_response(header.type, header.seq, nullptr, 0);
+            tud_cdc_write_flush();
+
+            const bool switch_driver = (profile_header.device_driver != DeviceDriverType::WEBAPP) && 
+                                        user_settings_.is_valid_driver(profile_header.device_driver);
+            if (switch_driver)
+            {
+                user_settings_.store_profile_and_driver_type(profile_header.device_driver, profile_header.player_idx, profile_);
+            }
+            else
+            {
+                user_settings_.store_profile(profile_header.player_idx, profile_);
+            }
+            return;
         }
-        if (packet_out.header.chunk_len > sizeof(UserProfile) - profile_offset)
+        case FrameType::SUBSCRIBE:
         {
-            OGXM_LOG("Invalid chunk length\n");
-            return false;
+            if (header.len != sizeof(Subscribe))
+            {
+                break;
+            }
+            Subscribe subscribe;
+            std::memcpy(&subscribe, payload, sizeof(Subscribe));
+
+            stream_mask_ = subscribe.gamepad_mask;
+            stream_interval_us_ = std::max(static_cast<uint32_t>(subscribe.interval_us), STREAM_INTERVAL_MIN_US);
+            stream_last_us_.fill(0);
+            stream_dropped_.fill(0);
+
+            write_response(header.type, header.seq, nullptr, 0);
+            return;
         }
+        case FrameType::GET_LATENCY_STATS:
+            if (write_latency_stats(header.seq, true))
+            {
+                return;
+            }
+            break;
+
+        case FrameType::GET_LATENCY_EVENTS:
+            if (write_latency_events(header.seq, true))
+            {
+                return;
+            }
+            break;
 
-        OGXM_LOG("Reading chunk %d\n", current_chunk);
-        OGXM_LOG("Chunks IDX: %d\n", packet_out.header.chunk_idx);
+        case FrameType::RESET_LATENCY:
+#if defined(CONFIG_OGXM_TRACE)
+            ogxm_trace::reset();
+            write_response(header.type, header.seq, nullptr, 0);
+            return;
+#else
+            break;
+#endif
+        case FrameType::GET_DEVICE_STATS:
+            if (write_device_stats(header.seq))
+            {
+                return;
+            }
+            break;
 
-        std::memcpy(profile_data + profile_offset, packet_out.data.data(), packet_out.header.chunk_len);
-        current_chunk++;
-        profile_offset += packet_out.header.chunk_len;
+        default:
+            break;
+    }
+    write_frame_error(header.seq);
+}
+
+//64 byte Packet protocol used by the current web app
+void WebAppDevice::handle_packet(const Packet& packet)
+{
+    if (legacy_receiving_)
+    {
+        handle_legacy_profile_chunk(packet);
+        return;
+    }
+
+    switch (packet.header.packet_id)
+    {
+        case PacketID::GET_PROFILE_BY_ID:
+            profile_ = user_settings_.get_profile_by_id(packet.header.profile_id);
+            if (!write_profile(0, profile_, PacketID::GET_PROFILE_BY_ID))
+            {
+                write_error();
+            }
+            break;
+
+        case PacketID::GET_PROFILE_BY_IDX:
+            profile_ = user_settings_.get_profile_by_index(packet.header.player_idx);
+            if (!write_profile(packet.header.player_idx, profile_, PacketID::GET_PROFILE_BY_IDX))
+            {
+                write_error();
+            }
+            break;
+
+        case PacketID::SET_PROFILE_START:
+            legacy_receiving_ = true;
+            legacy_start_ = packet.header;
+            legacy_chunks_ = 0;
+            legacy_chunks_total_ = 0;
+            legacy_offset_ = 0;
+            break;
+
+        case PacketID::GET_LATENCY_STATS:
+            if (!write_latency_stats(0, false))
+            {
+                write_error();
+            }
+            break;
+
+        case PacketID::GET_LATENCY_EVENTS:
+            if (!write_latency_events(0, false))
+            {
+                write_error();
+            }
+            break;
+
+        case PacketID::RESET_LATENCY:
+#if defined(CONFIG_OGXM_TRACE)
+            ogxm_trace::reset();
+#else
+            write_error();
+#endif
+            break;
+
+        default:
+            OGXM_LOG("WebApp: Invalid packet ID: %i\n", packet.header.packet_id);
+            break;
+    }
+}
+
+void WebAppDevice::handle_legacy_profile_chunk(const Packet& packet)
+{
+    uint8_t* profile_data = reinterpret_cast<uint8_t*>(&profile_);
+
+    if ((packet.header.packet_id != PacketID::SET_PROFILE) ||
+        (legacy_chunks_total_ == 0 && packet.header.chunks_total == 0) ||
+        (packet.header.chunk_len > packet.data.size()) ||
+        (packet.header.chunk_len > sizeof(UserProfile) - legacy_offset_))
+    {
+        OGXM_LOG("WebApp: Invalid profile chunk\n");
+        legacy_receiving_ = false;
+        write_error();
+        return;
+    }
+    if (legacy_chunks_total_ == 0)
+    {
+        legacy_chunks_total_ = packet.header.chunks_total;
+    }
+
+    std::memcpy(profile_data + legacy_offset_, packet.data.data(), packet.header.chunk_len);
+    legacy_offset_ += packet.header.chunk_len;
+
+    if (++legacy_chunks_ < legacy_chunks_total_)
+    {
+        return;
+    }
+
+    legacy_receiving_ = false;
+    bool success = false;
+
+    if (legacy_start_.device_driver != DeviceDriverType::WEBAPP &&
+        user_settings_.is_valid_driver(legacy_start_.device_driver))
+    {
+        success = user_settings_.store_profile_and_driver_type(legacy_start_.device_driver, legacy_start_.player_idx, profile_);
+    }
+    else
+    {
+        success = user_settings_.store_profile(legacy_start_.player_idx, profile_);
+    }
+    if (!success)
+    {
+        write_error();
     }
-    OGXM_LOG("Profile read successfully\n");
-    return true;
 }
 
 bool WebAppDevice::write_profile(uint8_t index, const UserProfile& profile, PacketID packet_id)
@@ -149,7 +418,10 @@ bool WebAppDevice::write_profile(uint8_t index, const UserProfile& profile, Pack
     uint8_t total_chunks = static_cast<uint8_t>((sizeof(UserProfile) + packet_in.data.size() - 1) / packet_in.data.size());
     uint8_t current_chunk = 0;
 
-    OGXM_LOG("Writing profile\n");
+    if (tud_cdc_write_available() < total_chunks * sizeof(Packet))
+    {
+        return false;
+    }
 
     packet_in.header.packet_id = packet_id;
     packet_in.header.max_gamepads = MAX_GAMEPADS;
@@ -175,33 +447,51 @@ bool WebAppDevice::write_profile(uint8_t index, const UserProfile& profile, Pack
         }
         current_chunk++;
     }
-
-    OGXM_LOG("Profile ID %i written successfully\n", profile.id);
     return true;
 }
 
 bool WebAppDevice::write_gamepad(uint8_t index, const Gamepad::PadIn& pad_in)
 {
     Packet packet_in;
-    const uint8_t* pad_in_data = reinterpret_cast<const uint8_t*>(&pad_in);
-    const uint8_t total_chunks = static_cast<uint8_t>((sizeof(Gamepad::PadIn) + packet_in.data.size() - 1) / packet_in.data.size());
-    uint8_t current_chunk = 0;
+    static_assert(sizeof(Gamepad::PadIn) <= sizeof(packet_in.data), "WebApp PadIn doesn't fit in one packet");
 
     packet_in.header.packet_id = PacketID::SET_GP_IN;
     packet_in.header.max_gamepads = MAX_GAMEPADS;
     packet_in.header.player_idx = index;
+    packet_in.header.chunks_total = 1;
+    packet_in.header.chunk_idx = 0;
+    packet_in.header.chunk_len = sizeof(Gamepad::PadIn);
+
+    std::memcpy(packet_in.data.data(), &pad_in, sizeof(Gamepad::PadIn));
+    return write_packet(packet_in);
+}
+
+bool WebAppDevice::write_chunks(const void* data, size_t len, PacketID packet_id)
+{
+    Packet packet_in;
+    const uint8_t* data_ptr = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t total_chunks = static_cast<uint8_t>(std::max((len + packet_in.data.size() - 1) / packet_in.data.size(), size_t(1)));
+    uint8_t current_chunk = 0;
+
+    if (tud_cdc_write_available() < total_chunks * sizeof(Packet))
+    {
+        return false;
+    }
+
+    packet_in.header.packet_id = packet_id;
+    packet_in.header.max_gamepads = MAX_GAMEPADS;
     packet_in.header.chunks_total = total_chunks;
 
     while (current_chunk < total_chunks)
     {
         size_t offset = current_chunk * packet_in.data.size();
-        size_t remaining_bytes = sizeof(Gamepad::PadIn) - offset;
+        size_t remaining_bytes = len - std::min(offset, len);
         uint8_t current_chunk_len = static_cast<uint8_t>(std::min(packet_in.data.size(), remaining_bytes));
 
         packet_in.header.chunk_idx = current_chunk;
         packet_in.header.chunk_len = current_chunk_len;
 
-        std::memcpy(packet_in.data.data(), pad_in_data + offset, packet_in.header.chunk_len);
+        std::memcpy(packet_in.data.data(), data_ptr + offset, packet_in.header.chunk_len);
 
         if (!write_packet(packet_in))
         {
@@ -212,6 +502,60 @@ bool WebAppDevice::write_gamepad(uint8_t index, const Gamepad::PadIn& pad_in)
     return true;
 }
 
+bool WebAppDevice::write_latency_stats(uint8_t seq, bool framed)
+{
+#if defined(CONFIG_OGXM_TRACE)
+    #pragma pack(push, 1)
+    struct LatencyStats
+    {
+        uint32_t dropped_events;
+        ogxm_trace::Stats stages[static_cast<size_t>(ogxm_trace::Stage::COUNT)];
+    };
+    #pragma pack(pop)
+    static_assert(sizeof(LatencyStats) <= FRAME_PAYLOAD_MAX, "WebApp LatencyStats doesn't fit in a frame");
+
+    LatencyStats latency_stats;
+    latency_stats.dropped_events = ogxm_trace::dropped_events();
+    for (size_t i = 0; i < static_cast<size_t>(ogxm_trace::Stage::COUNT); ++i)
+    {
+        latency_stats.stages[i] = ogxm_trace::get_stats(static_cast<ogxm_trace::Stage>(i));
+    }
+    if (framed)
+    {
+        return write_response(FrameType::GET_LATENCY_STATS, seq, &latency_stats, sizeof(latency_stats));
+    }
+    return write_chunks(&latency_stats, sizeof(latency_stats), PacketID::GET_LATENCY_STATS);
+#else
+    return false;
+#endif
+}
+
+bool WebAppDevice::write_latency_events(uint8_t seq, bool framed)
+{
+#if defined(CONFIG_OGXM_TRACE)
+    static std::array<ogxm_trace::Event, 64> events;
+    //A frame holds fewer than a full read, what's left is returned by the next request
+    const size_t max_events = framed ? (FRAME_PAYLOAD_MAX / sizeof(ogxm_trace::Event)) : events.size();
+    size_t count = ogxm_trace::read_events(events.data(), std::min(max_events, events.size()));
+    if (framed)
+    {
+        return write_response(FrameType::GET_LATENCY_EVENTS, seq, events.data(), static_cast<uint16_t>(count * sizeof(ogxm_trace::Event)));
+    }
+    return write_chunks(events.data(), count * sizeof(ogxm_trace::Event), PacketID::GET_LATENCY_EVENTS);
+#else
+    return false;
+#endif
+}
+
+bool WebAppDevice::write_device_stats(uint8_t seq)
+{
+    DeviceStats device_stats;
+    device_stats.storage = user_settings_.get_storage_stats();
+    device_stats.settings_cache = user_settings_.get_cache_stats();
+    device_stats.usb = DeviceManager::get_instance().get_usb_stats();
+    return write_response(FrameType::GET_DEVICE_STATS, seq, &device_stats, sizeof(device_stats));
+}
+
 void WebAppDevice::write_error()
 {
     Packet packet_in;
@@ -220,85 +564,92 @@ void WebAppDevice::write_error()
     write_packet(packet_in);
 }
 
-void WebAppDevice::process(const uint8_t idx, Gamepad& gamepad) 
+//Sends a PadState if PadIn changed since the last one, or every STREAM_IDLE_US if it didn't.
+//Never more often than the subscribed interval, a frame that doesn't fit is dropped and counted
+void WebAppDevice::stream_pad(uint8_t index, Gamepad& gamepad)
 {
-    if (!tud_cdc_connected())
+    const uint32_t now_us = time_us_32();
+    const uint32_t elapsed_us = now_us - stream_last_us_[index];
+    const bool changed = gamepad.new_pad_in();
+
+    if ((elapsed_us < stream_interval_us_) || (!changed && elapsed_us < STREAM_IDLE_US))
     {
         return;
     }
 
-    tud_cdc_write_flush();
-    bool success = false;   
-    static Packet packet_out;
-
-    if (tud_cdc_available())
+    if (tud_cdc_write_available() < sizeof(FrameHeader) + sizeof(PadState) + sizeof(uint16_t))
     {
-        OGXM_LOG("Reading packet\n");
-
-        Packet packet_out;
-        if (!read_packet(packet_out, true))
+        if (stream_dropped_[index] < UINT8_MAX)
         {
-            return;
+            ++stream_dropped_[index];
         }
+        return;
+    }
 
-        OGXM_LOG("Received packet with ID: %d\n", packet_out.header.packet_id);
-        
-        switch (packet_out.header.packet_id)
-        {
-            case PacketID::GET_PROFILE_BY_ID:
-                OGXM_LOG("Getting profile by ID: %i\n", packet_out.header.profile_id);
-
-                profile_ = user_settings_.get_profile_by_id(packet_out.header.profile_id);
-                if (!write_profile(0, profile_, PacketID::GET_PROFILE_BY_ID))
-                {
-                    write_error();
-                    return;
-                }
-                break;
+    PadState pad_state;
+    pad_state.player_idx = index;
+    pad_state.dropped = stream_dropped_[index];
+    pad_state.timestamp_us = now_us;
+    pad_state.pad_in = gamepad.get_pad_in();
+    pad_state.pad_out = gamepad.peek_pad_out();
+#if defined(CONFIG_OGXM_TRACE)
+    pad_state.age_us = now_us - gamepad.get_trace_origin();
+    OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+#endif
+
+    uint8_t* frame_payload = begin_frame(FrameType::PAD_STATE, stream_seq_++);
+    std::memcpy(frame_payload, &pad_state, sizeof(PadState));
+    end_frame(sizeof(PadState), false);
+
+    stream_last_us_[index] = now_us;
+    stream_dropped_[index] = 0;
+}
 
-            case PacketID::GET_PROFILE_BY_IDX:
-                OGXM_LOG("Getting profile by index: %i\n", packet_out.header.player_idx);
+void WebAppDevice::process(const uint8_t idx, Gamepad& gamepad) 
+{
+    if (!tud_cdc_connected())
+    {
+        rx_len_ = 0;
+        tx_pending_len_ = 0;
+        legacy_receiving_ = false;
+        stream_mask_ = 0;
+        return;
+    }
 
-                profile_ = user_settings_.get_profile_by_index(packet_out.header.player_idx);
-                if (!write_profile(packet_out.header.player_idx, profile_, PacketID::GET_PROFILE_BY_IDX))
-                {
-                    write_error();
-                    return;
-                }
-                break;
+    tx_written_ = false;
 
-            case PacketID::SET_PROFILE_START:
-                if (!read_profile(profile_))
-                {
-                    write_error();
-                    return;
-                }
-                if (packet_out.header.device_driver != DeviceDriverType::WEBAPP &&
-                    user_settings_.is_valid_driver(packet_out.header.device_driver))
-                {
-                    success = user_settings_.store_profile_and_driver_type(packet_out.header.device_driver, packet_out.header.player_idx, profile_);
-                }
-                else
-                {
-                    success = user_settings_.store_profile(packet_out.header.player_idx, profile_);
-                }
-                if (!success)
-                {
-                    write_error();
-                    return;
-                }
-                break;
+    //A held response goes out before anything else is read
+    if (tx_pending_len_ && write_serial(tx_frame_.data(), tx_pending_len_))
+    {
+        tx_pending_len_ = 0;
+    }
+    if (tx_pending_len_ == 0)
+    {
+        read_rx();
+        parse_rx();
+    }
 
-            default:
-                // write_response(PacketID::RESP_ERROR);
-                return;
-        }
-    } 
-    else if (gamepad.new_pad_in())
+    if (stream_mask_ & (1 << idx))
     {
-        OGXM_LOG("Writing gamepad input\n");
+        stream_pad(idx, gamepad);
+    }
+    else if ((stream_mask_ == 0) && !legacy_receiving_ && gamepad.new_pad_in())
+    {
+        //The packet web app expects every new PadIn
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
-        write_gamepad(idx, gp_in);
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        if (write_gamepad(idx, gp_in))
+        {
+            //CDC has no IN completion callback here, the write counts as both
+            OGXM_TRACE(DEVICE_SUBMIT);
+            OGXM_TRACE(DEVICE_COMPLETE);
+        }
+    }
+
+    //Everything from this call goes out in as few bulk transfers as possible
+    if (tx_written_)
+    {
+        tud_cdc_write_flush();
     }
 }
 
@@ -6,6 +6,8 @@
 #include "USBDevice/DeviceDriver/DeviceDriver.h"
 #include "UserSettings/UserSettings.h"
 #include "UserSettings/UserProfile.h"
+#include "USBDevice/DeviceManager.h"
+#include "Board/ogxm_trace.h"
 
 class WebAppDevice : public DeviceDriver 
 {
@@ -31,6 +33,9 @@ private:
         SET_PROFILE = 0x61,
         SET_GP_IN = 0x80,
         SET_GP_OUT = 0x81,
+        GET_LATENCY_STATS = 0x90,
+        GET_LATENCY_EVENTS = 0x91,
+        RESET_LATENCY = 0x92,
         RESP_ERROR = 0xFF
     };
     
@@ -57,16 +62,134 @@ private:
     static_assert(sizeof(Packet) == 64, "WebApp report size mismatch");
     #pragma pack(pop)
 
+    /*  Framed protocol, runs alongside the 64 byte Packet protocol above and is told apart by the first byte.
+        A frame is a FrameHeader, 'len' payload bytes, then a CRC16 (CCITT) of both, little endian.
+        Requests are answered with the same type | FRAME_RESPONSE and the same seq, or FRAME_ERROR.
+        PAD_STATE frames are sent unrequested to a subscriber, seq counts them so drops show up. */
+    static constexpr uint8_t  FRAME_SYNC = 0xA5;
+    static constexpr uint8_t  FRAME_VERSION = 1;
+    static constexpr uint8_t  FRAME_RESPONSE = 0x80;
+    static constexpr uint16_t FRAME_PAYLOAD_MAX = 256;
+
+    enum class FrameType : uint8_t
+    {
+        GET_INFO           = 0x01, // -> Info
+        GET_PROFILE_BY_ID  = 0x10, // u8 profile id -> ProfileHeader, UserProfile
+        GET_PROFILE_BY_IDX = 0x11, // u8 player index -> ProfileHeader, UserProfile
+        SET_PROFILE        = 0x12, // ProfileHeader, UserProfile -> empty
+        SUBSCRIBE          = 0x20, // Subscribe -> empty
+        PAD_STATE          = 0x21, // PadState, device to host only
+        GET_LATENCY_STATS  = 0x30,
+        GET_LATENCY_EVENTS = 0x31,
+        RESET_LATENCY      = 0x32,
+        GET_DEVICE_STATS   = 0x40, // -> DeviceStats
+        ERROR              = 0xFF
+    };
+
+    #pragma pack(push, 1)
+    struct FrameHeader
+    {
+        uint8_t   sync{FRAME_SYNC};
+        FrameType type{FrameType::ERROR};
+        uint8_t   seq{0};
+        uint8_t   reserved{0};
+        uint16_t  len{0};
+    };
+    static_assert(sizeof(FrameHeader) == 6, "WebApp FrameHeader size mismatch");
+
+    struct Info
+    {
+        uint8_t version{FRAME_VERSION};
+        uint8_t max_gamepads{MAX_GAMEPADS};
+        uint8_t max_profiles{UserSettings::MAX_PROFILES};
+        DeviceDriverType device_driver{DeviceDriverType::WEBAPP};
+        uint16_t profile_size{sizeof(UserProfile)};
+        uint16_t payload_max{FRAME_PAYLOAD_MAX};
+    };
+
+    struct ProfileHeader
+    {
+        uint8_t player_idx{0};
+        DeviceDriverType device_driver{DeviceDriverType::WEBAPP}; // Anything else switches drivers on SET_PROFILE
+    };
+
+    struct Subscribe
+    {
+        uint8_t  gamepad_mask{0};  // Bit per player index, 0 stops the stream
+        uint16_t interval_us{0};   // Per gamepad, clamped to STREAM_INTERVAL_MIN_US
+    };
+
+    struct PadState
+    {
+        uint8_t  player_idx{0};
+        uint8_t  dropped{0};       // PAD_STATE frames that didn't fit since the last one sent, saturates
+        uint32_t timestamp_us{0};  // Device time the snapshot was taken
+        uint32_t age_us{0};        // Since the host core published PadIn, 0 without CONFIG_OGXM_TRACE
+        Gamepad::PadIn  pad_in;
+        Gamepad::PadOut pad_out;
+    };
+
+    //Counters since boot
+    struct DeviceStats
+    {
+        NVSTool::Stats storage;
+        UserSettings::CacheStats settings_cache;
+        DeviceManager::UsbStats usb;
+    };
+    #pragma pack(pop)
+
+    static constexpr size_t   FRAME_LEN_MAX = sizeof(FrameHeader) + FRAME_PAYLOAD_MAX + sizeof(uint16_t);
+    static constexpr uint32_t STREAM_INTERVAL_MIN_US = 1000;
+    static constexpr uint32_t STREAM_IDLE_US = 100000; // Unchanged pads are still sent this often
+
+    static_assert(sizeof(ProfileHeader) + sizeof(UserProfile) <= FRAME_PAYLOAD_MAX, "WebApp profile doesn't fit in a frame");
+    static_assert(sizeof(DeviceStats) <= FRAME_PAYLOAD_MAX, "WebApp DeviceStats doesn't fit in a frame");
+
     UserSettings& user_settings_{UserSettings::get_instance()};
     UserProfile profile_;
 
-    bool read_profile(UserProfile& profile);
-    bool read_serial(void* buffer, size_t len, bool block);
-    bool read_packet(Packet& packet, bool block);
+    //Bytes from CDC waiting to make up a whole frame or packet
+    std::array<uint8_t, FRAME_LEN_MAX> rx_buffer_;
+    size_t rx_len_{0};
+
+    //A response that didn't fit in the CDC TX FIFO, no new requests are read until it's sent
+    std::array<uint8_t, FRAME_LEN_MAX> tx_frame_;
+    size_t tx_pending_len_{0};
+    bool tx_written_{false};
+
+    //Legacy SET_PROFILE_START is followed by SET_PROFILE chunks
+    bool legacy_receiving_{false};
+    PacketHeader legacy_start_;
+    uint8_t legacy_chunks_{0};
+    uint8_t legacy_chunks_total_{0};
+    size_t legacy_offset_{0};
+
+    uint8_t stream_mask_{0};
+    uint32_t stream_interval_us_{STREAM_INTERVAL_MIN_US};
+    uint8_t stream_seq_{0};
+    std::array<uint32_t, MAX_GAMEPADS> stream_last_us_{0};
+    std::array<uint8_t, MAX_GAMEPADS> stream_dropped_{0};
+
+    void read_rx();
+    void parse_rx();
+    void handle_frame(const FrameHeader& header, const uint8_t* payload);
+    void handle_packet(const Packet& packet);
+    void handle_legacy_profile_chunk(const Packet& packet);
+    void stream_pad(uint8_t index, Gamepad& gamepad);
+
+    uint8_t* begin_frame(FrameType type, uint8_t seq);
+    bool end_frame(uint16_t len, bool keep_if_full);
+    bool write_response(FrameType type, uint8_t seq, const void* payload, uint16_t len);
+    void write_frame_error(uint8_t seq);
+
     bool write_serial(const void* buffer, size_t len);
     bool write_packet(const Packet& packet);
     bool write_profile(uint8_t index, const UserProfile& profile, PacketID packet_id);
     bool write_gamepad(uint8_t index, const Gamepad::PadIn& pad_in);
+    bool write_chunks(const void* data, size_t len, PacketID packet_id);
+    bool write_latency_stats(uint8_t seq, bool framed);
+    bool write_latency_events(uint8_t seq, bool framed);
+    bool write_device_stats(uint8_t seq);
     void write_error();  
 };
 
@@ -6,59 +6,20 @@
 void XInputDevice::initialize() 
 {
     class_driver_ = *tud_xinput::class_driver();
+    class_driver_.sof = sof_sync::SOF_CB;
 }
 
 void XInputDevice::process(const uint8_t idx, Gamepad& gamepad)
 {
     if (gamepad.new_pad_in())
     {
-        in_report_.buttons[0] = 0;
-        in_report_.buttons[1] = 0;
-
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        sof_sync::input_read(gamepad.get_pad_in_time());
 
-        switch (gp_in.dpad)
-        {
-            case Gamepad::DPAD_UP:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_UP;
-                break;
-            case Gamepad::DPAD_DOWN:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_DOWN;
-                break;
-            case Gamepad::DPAD_LEFT:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_RIGHT:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_RIGHT;
-                break;
-            case Gamepad::DPAD_UP_LEFT:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_UP | XInput::Buttons0::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_UP_RIGHT:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_UP | XInput::Buttons0::DPAD_RIGHT;
-                break;
-            case Gamepad::DPAD_DOWN_LEFT:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_DOWN | XInput::Buttons0::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_DOWN_RIGHT:
-                in_report_.buttons[0] = XInput::Buttons0::DPAD_DOWN | XInput::Buttons0::DPAD_RIGHT;
-                break;
-            default:
-                break;
-        }
-
-        if (gp_in.buttons & Gamepad::BUTTON_BACK)  in_report_.buttons[0] |= XInput::Buttons0::BACK;
-        if (gp_in.buttons & Gamepad::BUTTON_START) in_report_.buttons[0] |= XInput::Buttons0::START;
-        if (gp_in.buttons & Gamepad::BUTTON_L3)    in_report_.buttons[0] |= XInput::Buttons0::L3;
-        if (gp_in.buttons & Gamepad::BUTTON_R3)    in_report_.buttons[0] |= XInput::Buttons0::R3;
-
-        if (gp_in.buttons & Gamepad::BUTTON_X)     in_report_.buttons[1] |= XInput::Buttons1::X;
-        if (gp_in.buttons & Gamepad::BUTTON_A)     in_report_.buttons[1] |= XInput::Buttons1::A;
-        if (gp_in.buttons & Gamepad::BUTTON_Y)     in_report_.buttons[1] |= XInput::Buttons1::Y;
-        if (gp_in.buttons & Gamepad::BUTTON_B)     in_report_.buttons[1] |= XInput::Buttons1::B;
-        if (gp_in.buttons & Gamepad::BUTTON_LB)    in_report_.buttons[1] |= XInput::Buttons1::LB;
-        if (gp_in.buttons & Gamepad::BUTTON_RB)    in_report_.buttons[1] |= XInput::Buttons1::RB;
-        if (gp_in.buttons & Gamepad::BUTTON_SYS)   in_report_.buttons[1] |= XInput::Buttons1::HOME;
+        const uint16_t buttons = DPAD_LUT(gp_in.dpad) | BUTTON_LUT(gp_in.buttons);
+        in_report_.buttons[0] = static_cast<uint8_t>(buttons);
+        in_report_.buttons[1] = static_cast<uint8_t>(buttons >> 8);
 
         in_report_.trigger_l = gp_in.trigger_l;
         in_report_.trigger_r = gp_in.trigger_r;
@@ -72,8 +33,14 @@ void XInputDevice::process(const uint8_t idx, Gamepad& gamepad)
         {
             tud_remote_wakeup();
         }
+    }
 
-        tud_xinput::send_report((uint8_t*)&in_report_, sizeof(XInput::InReport));
+    //Retried until the endpoint takes it, a change that arrives while busy isn't lost
+    if (submit_due() &&
+        std::memcmp(&prev_in_report_, &in_report_, sizeof(XInput::InReport)) &&
+        tud_xinput::send_report(reinterpret_cast<uint8_t*>(&in_report_), sizeof(XInput::InReport)))
+    {
+        std::memcpy(&prev_in_report_, &in_report_, sizeof(XInput::InReport));
     }
 
     if (tud_xinput::receive_report(reinterpret_cast<uint8_t*>(&out_report_), sizeof(XInput::OutReport)) &&
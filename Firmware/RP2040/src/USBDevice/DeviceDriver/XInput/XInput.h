@@ -19,7 +19,23 @@ public:
     const uint8_t* get_descriptor_device_qualifier_cb() override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map_to(Gamepad::BUTTON_BACK,  0, XInput::Buttons0::BACK)
+        .map_to(Gamepad::BUTTON_START, 0, XInput::Buttons0::START)
+        .map_to(Gamepad::BUTTON_L3,    0, XInput::Buttons0::L3)
+        .map_to(Gamepad::BUTTON_R3,    0, XInput::Buttons0::R3)
+        .map_to(Gamepad::BUTTON_X,     1, XInput::Buttons1::X)
+        .map_to(Gamepad::BUTTON_A,     1, XInput::Buttons1::A)
+        .map_to(Gamepad::BUTTON_Y,     1, XInput::Buttons1::Y)
+        .map_to(Gamepad::BUTTON_B,     1, XInput::Buttons1::B)
+        .map_to(Gamepad::BUTTON_LB,    1, XInput::Buttons1::LB)
+        .map_to(Gamepad::BUTTON_RB,    1, XInput::Buttons1::RB)
+        .map_to(Gamepad::BUTTON_SYS,   1, XInput::Buttons1::HOME);
+    static constexpr auto DPAD_LUT = DPadLut<uint16_t>::bits(
+        XInput::Buttons0::DPAD_UP, XInput::Buttons0::DPAD_DOWN, XInput::Buttons0::DPAD_LEFT, XInput::Buttons0::DPAD_RIGHT);
+
     XInput::InReport in_report_;
+    XInput::InReport prev_in_report_;
     XInput::OutReport out_report_;
 };
 
@@ -7,6 +7,8 @@
 #include "tusb.h"
 #include "device/usbd_pvt.h"
 
+#include "Board/ogxm_trace.h"
+#include "USBDevice/SOFSync.h"
 #include "Descriptors/XInput.h"
 #include "USBDevice/DeviceDriver/XInput/tud_xinput/tud_xinput.h"
 
@@ -82,6 +84,11 @@ static bool xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint3
 	if (ep_addr == endpoint_out_) 
     {
         usbd_edpt_xfer(BOARD_TUD_RHPORT, endpoint_out_, ep_out_buffer_, ENDPOINT_SIZE);
+    }
+    else if (ep_addr == endpoint_in_)
+    {
+        sof_sync::completed();
+        OGXM_TRACE(DEVICE_COMPLETE);
     }
 	return true;
 }
@@ -138,6 +145,8 @@ bool send_report(const uint8_t *report, uint16_t len)
         usbd_edpt_claim(BOARD_TUD_RHPORT, endpoint_in_);
         usbd_edpt_xfer(BOARD_TUD_RHPORT, endpoint_in_, ep_in_buffer_, sizeof(XInput::InReport));
         usbd_edpt_release(BOARD_TUD_RHPORT, endpoint_in_);
+        sof_sync::submitted();
+        OGXM_TRACE(DEVICE_SUBMIT);
         return true;
     }
     return false;
@@ -8,9 +8,11 @@ void XboxOGDevice::initialize()
 {
     tud_xid::initialize(tud_xid::Type::GAMEPAD);
     class_driver_ = *tud_xid::class_driver();
+    class_driver_.sof = sof_sync::SOF_CB;
 
     std::memset(&in_report_, 0, sizeof(XboxOG::GP::InReport));
     in_report_.report_len = sizeof(XboxOG::GP::InReport);
+    std::memset(&prev_in_report_, 0, sizeof(XboxOG::GP::InReport));
 }
 
 void XboxOGDevice::process(const uint8_t idx, Gamepad& gamepad)
@@ -19,41 +21,10 @@ void XboxOGDevice::process(const uint8_t idx, Gamepad& gamepad)
     {
         std::memset(&in_report_.buttons, 0, 8);
         Gamepad::PadIn gp_in = gamepad.get_pad_in();
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+        sof_sync::input_read(gamepad.get_pad_in_time());
 
-        switch (gp_in.dpad)
-        {
-            case Gamepad::DPAD_UP:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_UP;
-                break;
-            case Gamepad::DPAD_DOWN:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_DOWN;
-                break;
-            case Gamepad::DPAD_LEFT:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_RIGHT:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_RIGHT;
-                break;
-            case Gamepad::DPAD_UP_LEFT:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_UP | XboxOG::GP::Buttons::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_UP_RIGHT:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_UP | XboxOG::GP::Buttons::DPAD_RIGHT;
-                break;
-            case Gamepad::DPAD_DOWN_LEFT:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_DOWN | XboxOG::GP::Buttons::DPAD_LEFT;
-                break;
-            case Gamepad::DPAD_DOWN_RIGHT:
-                in_report_.buttons = XboxOG::GP::Buttons::DPAD_DOWN | XboxOG::GP::Buttons::DPAD_RIGHT;
-                break;
-            default:
-                break;
-        }
-        
-        if (gp_in.buttons & Gamepad::BUTTON_BACK)     in_report_.buttons |= XboxOG::GP::Buttons::BACK;
-        if (gp_in.buttons & Gamepad::BUTTON_START)    in_report_.buttons |= XboxOG::GP::Buttons::START;
-        if (gp_in.buttons & Gamepad::BUTTON_L3)       in_report_.buttons |= XboxOG::GP::Buttons::L3;
-        if (gp_in.buttons & Gamepad::BUTTON_R3)       in_report_.buttons |= XboxOG::GP::Buttons::R3;
+        in_report_.buttons = DPAD_LUT(gp_in.dpad) | BUTTON_LUT(gp_in.buttons);
 
         if (gamepad.analog_enabled())
         {
@@ -86,10 +57,15 @@ void XboxOGDevice::process(const uint8_t idx, Gamepad& gamepad)
         {
             tud_remote_wakeup();
         }
-        if (tud_xid::send_report_ready(0))
-        {
-            tud_xid::send_report(0, reinterpret_cast<uint8_t*>(&in_report_), sizeof(XboxOG::GP::InReport));
-        }
+    }
+
+    //Retried until the endpoint takes it, a change that arrives while busy isn't lost
+    if (submit_due() &&
+        tud_xid::send_report_ready(0) &&
+        std::memcmp(&prev_in_report_, &in_report_, sizeof(XboxOG::GP::InReport)) &&
+        tud_xid::send_report(0, reinterpret_cast<uint8_t*>(&in_report_), sizeof(XboxOG::GP::InReport)))
+    {
+        std::memcpy(&prev_in_report_, &in_report_, sizeof(XboxOG::GP::InReport));
     }
 
     if (tud_xid::receive_report(0, reinterpret_cast<uint8_t*>(&out_report_), sizeof(XboxOG::GP::OutReport)))
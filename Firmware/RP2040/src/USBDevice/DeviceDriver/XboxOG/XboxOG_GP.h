@@ -21,7 +21,16 @@ public:
     const uint8_t* get_descriptor_device_qualifier_cb() override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16, uint8_t>()
+        .map(Gamepad::BUTTON_BACK,  XboxOG::GP::Buttons::BACK)
+        .map(Gamepad::BUTTON_START, XboxOG::GP::Buttons::START)
+        .map(Gamepad::BUTTON_L3,    XboxOG::GP::Buttons::L3)
+        .map(Gamepad::BUTTON_R3,    XboxOG::GP::Buttons::R3);
+    static constexpr auto DPAD_LUT = DPadLut<uint8_t>::bits(
+        XboxOG::GP::Buttons::DPAD_UP, XboxOG::GP::Buttons::DPAD_DOWN, XboxOG::GP::Buttons::DPAD_LEFT, XboxOG::GP::Buttons::DPAD_RIGHT);
+
     XboxOG::GP::InReport in_report_;
+    XboxOG::GP::InReport prev_in_report_;
     XboxOG::GP::OutReport out_report_;
 };
 
@@ -87,7 +87,14 @@ void XboxOGSBDevice::initialize()
 
 void XboxOGSBDevice::process(const uint8_t idx, Gamepad& gamepad) 
 {
+#if defined(CONFIG_OGXM_TRACE)
+    if (gamepad.new_pad_in())
+    {
+        OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+    }
+#endif
     Gamepad::PadIn gp_in = gamepad.get_pad_in();
+    sof_sync::input_read(gamepad.get_pad_in_time());
     Gamepad::ChatpadIn gp_in_chatpad = gamepad.get_chatpad_in();
 
     in_report_.dButtons[0] = 0;
@@ -29,6 +29,8 @@ void XboxOGXRDevice::process(const uint8_t idx, Gamepad& gamepad)
     }
 
     Gamepad::PadIn gp_in = gamepad.get_pad_in();
+    OGXM_TRACE_PROCESS(gamepad.get_trace_origin());
+    sof_sync::input_read(gamepad.get_pad_in_time());
 
     in_report_.buttonCode = 0;
 
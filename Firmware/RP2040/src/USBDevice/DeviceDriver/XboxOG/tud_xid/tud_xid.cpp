@@ -5,6 +5,8 @@
 
 #include "USBDevice/DeviceDriver/XboxOG/tud_xid/tud_xid.h"
 #include "Descriptors/XboxOG.h"
+#include "Board/ogxm_trace.h"
+#include "USBDevice/SOFSync.h"
 
 #if defined(XREMOTE_ROM_AVAILABLE)
     #define XREMOTE_ENABLED 1
@@ -237,6 +239,11 @@ static bool xid_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, u
     // TU_VERIFY(index != 0xFF, true);
     // TU_VERIFY(xferred_bytes < ENDPOINT_SIZE, true);
 
+    if (tu_edpt_dir(ep_addr) == TUSB_DIR_IN)
+    {
+        sof_sync::completed();
+        OGXM_TRACE(DEVICE_COMPLETE);
+    }
     return true;
 }
 
@@ -393,7 +400,10 @@ bool send_report(uint8_t index, const uint8_t* report, uint16_t len)
 
     std::memcpy(interfaces_[index].ep_in_buffer.data(), report, size);
 
-    return usbd_edpt_xfer(BOARD_TUD_RHPORT, interfaces_[index].ep_in, interfaces_[index].ep_in_buffer.data(), size);
+    TU_VERIFY(usbd_edpt_xfer(BOARD_TUD_RHPORT, interfaces_[index].ep_in, interfaces_[index].ep_in_buffer.data(), size), false);
+    sof_sync::submitted();
+    OGXM_TRACE(DEVICE_SUBMIT);
+    return true;
 }
 
 bool receive_report(uint8_t index, uint8_t *report, uint16_t len)
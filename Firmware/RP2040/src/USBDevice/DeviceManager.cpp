@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <pico/stdlib.h>
+
 #include "tusb.h"
 
 #include "Board/Config.h"
@@ -11,13 +14,15 @@
 #include "USBDevice/DeviceDriver/XboxOG/XboxOG_XR.h"
 #include "USBDevice/DeviceDriver/WebApp/WebApp.h"
 #include "USBDevice/DeviceManager.h"
+#include "USBDevice/SOFSync.h"
+#include "TaskQueue/TaskQueue.h"
+#include "Board/ogxm_log.h"
 
 #if defined(CONFIG_EN_UART_BRIDGE)
 #include "USBDevice/DeviceDriver/UARTBridge/UARTBridge.h"
 #endif // defined(CONFIG_EN_UART_BRIDGE)
 
-void DeviceManager::initialize_driver(  DeviceDriverType driver_type, 
-                                        Gamepad(&gamepads)[MAX_GAMEPADS]) {
+bool DeviceManager::create_driver(DeviceDriverType driver_type) {
     //TODO: Put gamepad setup in the drivers themselves
     bool has_analog = false; 
     
@@ -58,14 +63,133 @@ void DeviceManager::initialize_driver(  DeviceDriverType driver_type,
             break;
 #endif //defined(CONFIG_EN_UART_BRIDGE)
         default:
-            return;
+            return false;
     }
 
-    if (has_analog) {
-        for (size_t i = 0; i < MAX_GAMEPADS; ++i) {
-            gamepads[i].set_analog_device(true);
-        }
+    driver_type_ = driver_type;
+
+    for (size_t i = 0; i < MAX_GAMEPADS; ++i) {
+        gamepads_[i].set_analog_device(has_analog);
     }
 
     device_driver_->initialize();
-}
\ No newline at end of file
+    return true;
+}
+
+void DeviceManager::initialize_driver(  DeviceDriverType driver_type, 
+                                        Gamepad(&gamepads)[MAX_GAMEPADS]) {
+    gamepads_ = gamepads;
+    reconnect_task_id_ = TaskQueue::Core0::get_new_task_id();
+    create_driver(driver_type);
+}
+
+bool DeviceManager::switch_driver(DeviceDriverType driver_type) {
+    if (!device_driver_) {
+        return false;
+    }
+    return TaskQueue::Core0::queue_task([this, driver_type] {
+        replace_driver(driver_type);
+    });
+}
+
+void DeviceManager::replace_driver(DeviceDriverType driver_type) {
+    if (driver_type == driver_type_) {
+        return;
+    }
+
+    OGXM_LOG("Switching device driver: %i -> %i\n", static_cast<int>(driver_type_), static_cast<int>(driver_type));
+
+    const bool usb_started = (usb_state_ != UsbState::STOPPED);
+
+    //The class drivers' deinit callbacks run here, the old driver can go after this
+    stop_usb();
+
+    const DeviceDriverType old_driver_type = driver_type_;
+    device_driver_.reset();
+
+    if (!create_driver(driver_type)) {
+        OGXM_LOG("Invalid driver type, restoring the last one\n");
+        create_driver(old_driver_type);
+    }
+
+    if (!usb_started) {
+        //The board starts the stack itself once a controller is connected
+        return;
+    }
+
+    usb_state_ = UsbState::RECONNECTING;
+    switch_us_ = time_us_32();
+    TaskQueue::Core0::queue_delayed_task(reconnect_task_id_, RECONNECT_DELAY_MS, false, [this] {
+        start_usb();
+    });
+}
+
+bool DeviceManager::set_connected(bool connected) {
+    return TaskQueue::Core0::queue_task([this, connected] {
+        if (connected) {
+            start_usb();
+        } else if (driver_type_ != DeviceDriverType::WEBAPP) {
+            //The WebApp doesn't need a controller, stay on the bus
+            stop_usb();
+        }
+    });
+}
+
+void DeviceManager::start_usb() {
+    TaskQueue::Core0::cancel_delayed_task(reconnect_task_id_);
+
+    if (tud_inited()) {
+        usb_state_ = UsbState::STARTED;
+        return;
+    }
+
+    start_us_ = time_us_32();
+    tud_init(BOARD_TUD_RHPORT);
+    usb_state_ = UsbState::STARTED;
+
+    OGXM_LOG("USB device started\n");
+}
+
+void DeviceManager::stop_usb() {
+    TaskQueue::Core0::cancel_delayed_task(reconnect_task_id_);
+    usb_state_ = UsbState::STOPPED;
+    start_us_ = 0;
+    switch_us_ = 0;
+
+    if (!tud_inited()) {
+        return;
+    }
+
+    tud_disconnect();
+    tud_deinit(BOARD_TUD_RHPORT);
+    sof_sync::set_enabled(false);
+
+    OGXM_LOG("USB device stopped\n");
+}
+
+void DeviceManager::usb_mounted() {
+    if (start_us_ == 0) {
+        //Bus reset by the console, not a start of ours
+        return;
+    }
+
+    const uint32_t elapsed_us = time_us_32() - start_us_;
+    start_us_ = 0;
+
+    ++usb_stats_.connects;
+    usb_stats_.last_us = elapsed_us;
+    usb_stats_.max_us = std::max(usb_stats_.max_us, elapsed_us);
+
+    OGXM_LOG("USB device configured %u us after start\n", elapsed_us);
+
+    if (switch_us_ != 0) {
+        const uint32_t reconnect_us = time_us_32() - switch_us_;
+        switch_us_ = 0;
+
+        ++usb_stats_.reconnects;
+        usb_stats_.reconnect_last_us = reconnect_us;
+        usb_stats_.reconnect_max_us = std::max(usb_stats_.reconnect_max_us, reconnect_us);
+
+        OGXM_LOG("USB device reconnected %u us after the driver switch\n", reconnect_us);
+    }
+}
@@ -9,6 +9,23 @@
 
 class DeviceManager {
 public:
+	enum class UsbState : uint8_t {
+		STOPPED,		//Device stack isn't running, nothing on the bus
+		RECONNECTING,	//Stopped for a driver switch, starts again after RECONNECT_DELAY_MS
+		STARTED			//tud_init has run, the console enumerates it from here
+	};
+
+	//Time from tud_init to the console configuring the device, and for a driver switch 
+	//from tearing the old driver down to the console configuring the new one
+	struct UsbStats {
+		uint32_t connects{0};
+		uint32_t last_us{0};
+		uint32_t max_us{0};
+		uint32_t reconnects{0};
+		uint32_t reconnect_last_us{0};
+		uint32_t reconnect_max_us{0};
+	};
+
 	DeviceManager(DeviceManager const&) = delete;
 	void operator=(DeviceManager const&)  = delete;
 
@@ -19,14 +36,46 @@ public:
 
 	//Must be called before any other method
 	void initialize_driver(DeviceDriverType driver_type, Gamepad(&gamepads)[MAX_GAMEPADS]);
+
+	//Replaces the running driver without a reboot, the swap is queued on core0 so it's safe to call
+	//from inside DeviceDriver::process. The host side on core1 keeps running. 
+	//If the device stack is up it's torn down and re-enumerates with the new driver after RECONNECT_DELAY_MS.
+	bool switch_driver(DeviceDriverType driver_type);
+
+	//Brings the device stack up or down to follow the controller, queued on core0 so any core can call it.
+	//Only tud is touched, the host stack, its slots and the Gamepads stay as they are.
+	bool set_connected(bool connected);
+	//Core0 only
+	void start_usb();
+	void stop_usb();
+	//Called from tud_mount_cb, closes the reconnect timer
+	void usb_mounted();
 	
+	//Can change between iterations of the core0 loop, don't hold onto it
 	DeviceDriver* get_driver() { return device_driver_.get(); }
+	DeviceDriverType get_driver_type() const { return driver_type_; }
+	UsbState get_usb_state() const { return usb_state_; }
+	UsbStats get_usb_stats() const { return usb_stats_; }
 	
 private:
+	//Long enough for a console to see the device leave the bus
+	static constexpr uint32_t RECONNECT_DELAY_MS = 100;
+
     DeviceManager() = default;
 	~DeviceManager() = default;
 
 	std::unique_ptr<DeviceDriver> device_driver_{nullptr};
+	DeviceDriverType driver_type_{DeviceDriverType::NONE};
+	Gamepad* gamepads_{nullptr};
+
+	UsbState usb_state_{UsbState::STOPPED};
+	UsbStats usb_stats_;
+	uint32_t reconnect_task_id_{0};
+	uint32_t start_us_{0};
+	uint32_t switch_us_{0};
+
+	bool create_driver(DeviceDriverType driver_type);
+	void replace_driver(DeviceDriverType driver_type);
 };
 
 #endif // _DEVICE_MANAGER_H_
\ No newline at end of file
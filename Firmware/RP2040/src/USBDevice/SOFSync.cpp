@@ -0,0 +1,266 @@
+#include "Board/Config.h"
+#if defined(CONFIG_OGXM_SOF_SYNC)
+
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+#include <hardware/timer.h>
+
+#include "tusb.h"
+
+#include "TaskQueue/TaskQueue.h"
+#include "Board/ogxm_log.h"
+#include "USBDevice/SOFSync.h"
+
+namespace sof_sync
+{
+
+static constexpr uint32_t FRAME_US = 1000;
+static constexpr uint32_t FRAME_MASK = 0x7FF; //Full speed frame numbers are 11 bits
+static constexpr uint32_t MAX_INTERVAL_FRAMES = 32;
+static constexpr uint32_t WINDOW_POLLS = 64;
+static constexpr uint32_t DUMP_INTERVAL_MS = 5000;
+
+//Written by the SOF IRQ, read on core0 outside of it
+static std::atomic<uint32_t> sof_us_{0};
+static std::atomic<uint32_t> sof_frame_{0};
+
+static bool enabled_{false};
+
+//Poll schedule, phase is the earliest poll seen after SOF over the last window since
+//completions are timestamped in tud_task and can only land later than the actual poll
+static bool locked_{false};
+static uint32_t phase_us_{0};
+static uint32_t interval_frames_{1};
+static uint32_t poll_frame_{0};
+static bool have_poll_{false};
+
+static uint32_t window_count_{0};
+static uint32_t window_phase_us_{FRAME_US};
+static uint32_t window_interval_{MAX_INTERVAL_FRAMES};
+
+static uint32_t submitted_us_{0};
+static uint32_t stat_count_{0};
+static uint32_t stat_min_us_{UINT32_MAX};
+static uint32_t stat_max_us_{0};
+static uint64_t stat_sum_us_{0};
+
+//PadIn time of the last input read, and of the one the in flight report was built from. 0 is none
+static uint32_t input_us_{0};
+static uint32_t submitted_input_us_{0};
+static uint32_t age_count_{0};
+static uint32_t age_min_us_{UINT32_MAX};
+static uint32_t age_max_us_{0};
+static uint64_t age_sum_us_{0};
+
+static inline void read_sof(uint32_t& frame, uint32_t& sof_us)
+{
+    //The IRQ can only land between the loads, not inside its own writes
+    do
+    {
+        frame = sof_frame_.load(std::memory_order_acquire);
+        sof_us = sof_us_.load(std::memory_order_relaxed);
+    }
+    while (frame != sof_frame_.load(std::memory_order_acquire));
+}
+
+static void reset_schedule()
+{
+    locked_ = false;
+    phase_us_ = 0;
+    interval_frames_ = 1;
+    have_poll_ = false;
+    window_count_ = 0;
+    window_phase_us_ = FRAME_US;
+    window_interval_ = MAX_INTERVAL_FRAMES;
+    submitted_us_ = 0;
+    submitted_input_us_ = 0;
+}
+
+//Time the next held report should be queued, may be in the past if the coming poll is close
+static uint32_t next_submit_us(uint32_t now)
+{
+    uint32_t frame, sof_us;
+    read_sof(frame, sof_us);
+
+    //A completion seen in this frame means its poll is done even if it came before phase_us_
+    const uint32_t frames = (frame - poll_frame_) & FRAME_MASK;
+    const uint32_t since_poll = frames % interval_frames_;
+    const uint32_t to_poll = (since_poll || !frames) ? (interval_frames_ - since_poll) : 0;
+    uint32_t poll_us = sof_us + (to_poll * FRAME_US) + phase_us_;
+
+    if (static_cast<int32_t>(now - poll_us) > 0)
+    {
+        poll_us += interval_frames_ * FRAME_US;
+    }
+    return poll_us - SOF_SYNC_MARGIN_US;
+}
+
+void sof_cb(uint8_t rhport, uint32_t frame_count)
+{
+    sof_us_.store(time_us_32(), std::memory_order_relaxed);
+    sof_frame_.store(frame_count & FRAME_MASK, std::memory_order_release);
+}
+
+void set_enabled(bool enabled)
+{
+    reset_schedule();
+    enabled_ = enabled;
+    tud_sof_cb_enable(enabled);
+
+#if defined(CONFIG_OGXM_DEBUG)
+    static bool dump_queued = false;
+    if (enabled && !dump_queued)
+    {
+        dump_queued = true;
+        TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), DUMP_INTERVAL_MS, true, []
+        {
+            dump();
+        });
+    }
+#endif
+}
+
+void input_read(uint32_t produced_us)
+{
+    input_us_ = std::max(produced_us, static_cast<uint32_t>(1));
+}
+
+void submitted()
+{
+    if (enabled_)
+    {
+        submitted_us_ = std::max(time_us_32(), static_cast<uint32_t>(1));
+        submitted_input_us_ = input_us_;
+    }
+}
+
+void completed()
+{
+    if (!enabled_)
+    {
+        return;
+    }
+
+    const uint32_t now = time_us_32();
+    uint32_t frame, sof_us;
+    read_sof(frame, sof_us);
+
+    if (submitted_us_)
+    {
+        const uint32_t wait_us = now - submitted_us_;
+        submitted_us_ = 0;
+        ++stat_count_;
+        stat_min_us_ = std::min(stat_min_us_, wait_us);
+        stat_max_us_ = std::max(stat_max_us_, wait_us);
+        stat_sum_us_ += wait_us;
+    }
+    if (submitted_input_us_)
+    {
+        const uint32_t age_us = now - submitted_input_us_;
+        submitted_input_us_ = 0;
+        ++age_count_;
+        age_min_us_ = std::min(age_min_us_, age_us);
+        age_max_us_ = std::max(age_max_us_, age_us);
+        age_sum_us_ += age_us;
+    }
+
+    if (have_poll_)
+    {
+        //Multiple interfaces can complete in the same frame
+        const uint32_t frames = std::max((frame - poll_frame_) & FRAME_MASK, static_cast<uint32_t>(1));
+        window_interval_ = std::min(window_interval_, frames);
+    }
+    poll_frame_ = frame;
+    have_poll_ = true;
+    window_phase_us_ = std::min(window_phase_us_, std::min(now - sof_us, FRAME_US - 1));
+
+    if (++window_count_ >= WINDOW_POLLS)
+    {
+        phase_us_ = window_phase_us_;
+        interval_frames_ = window_interval_;
+        locked_ = true;
+
+        window_count_ = 0;
+        window_phase_us_ = FRAME_US;
+        window_interval_ = MAX_INTERVAL_FRAMES;
+    }
+}
+
+bool submit_due()
+{
+    if (!enabled_ || !locked_)
+    {
+        return true;
+    }
+    const uint32_t now = time_us_32();
+    return static_cast<int32_t>(now - next_submit_us(now)) >= 0;
+}
+
+uint32_t wait_us(uint32_t max_us)
+{
+    if (!enabled_ || !locked_)
+    {
+        return max_us;
+    }
+
+    const uint32_t now = time_us_32();
+    int32_t delta = static_cast<int32_t>(next_submit_us(now) - now);
+
+    //Already inside this poll's window, sleep until the one after it
+    while (delta <= 0)
+    {
+        delta += static_cast<int32_t>(interval_frames_ * FRAME_US);
+    }
+    return std::min(static_cast<uint32_t>(delta), max_us);
+}
+
+Stats get_stats()
+{
+    Stats stats;
+    stats.phase_us = phase_us_;
+    stats.interval_frames = interval_frames_;
+    stats.locked = locked_;
+
+    if (stat_count_)
+    {
+        stats.count = stat_count_;
+        stats.min_us = stat_min_us_;
+        stats.max_us = stat_max_us_;
+        stats.avg_us = static_cast<uint32_t>(stat_sum_us_ / stat_count_);
+    }
+    if (age_count_)
+    {
+        stats.age_count = age_count_;
+        stats.age_min_us = age_min_us_;
+        stats.age_max_us = age_max_us_;
+        stats.age_avg_us = static_cast<uint32_t>(age_sum_us_ / age_count_);
+    }
+    return stats;
+}
+
+void reset_stats()
+{
+    stat_count_ = 0;
+    stat_min_us_ = UINT32_MAX;
+    stat_max_us_ = 0;
+    stat_sum_us_ = 0;
+    age_count_ = 0;
+    age_min_us_ = UINT32_MAX;
+    age_max_us_ = 0;
+    age_sum_us_ = 0;
+}
+
+void dump()
+{
+    const Stats stats = get_stats();
+    OGXM_LOG("SOF sync %s, phase %u us, interval %u frames, submit to poll (us) count/min/avg/max: %u %u %u %u\n",
+        stats.locked ? "locked" : "learning", stats.phase_us, stats.interval_frames,
+        stats.count, stats.min_us, stats.avg_us, stats.max_us);
+    OGXM_LOG("SOF sync input age at poll (us) count/min/avg/max: %u %u %u %u\n",
+        stats.age_count, stats.age_min_us, stats.age_avg_us, stats.age_max_us);
+}
+
+} // namespace sof_sync
+
+#endif // defined(CONFIG_OGXM_SOF_SYNC)
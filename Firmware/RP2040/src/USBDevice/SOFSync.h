@@ -0,0 +1,84 @@
+#ifndef _SOF_SYNC_H_
+#define _SOF_SYNC_H_
+
+#include <cstdint>
+
+#include "Board/Config.h"
+
+/*  Just in time IN report submission, enable with -DOGXM_SOF_SYNC=TRUE.
+    The poll phase is learned from SOF interrupts and IN completions, drivers that opt in
+    hold their report until SOF_SYNC_MARGIN_US before the next predicted poll so it's built
+    from the freshest PadIn instead of sitting in the endpoint buffer. Core0 only. */
+namespace sof_sync
+{
+    struct Stats
+    {
+        //Time from IN submit to the host polling it
+        uint32_t count{0};
+        uint32_t min_us{0};
+        uint32_t avg_us{0};
+        uint32_t max_us{0};
+        //Input age at poll, time from the host core setting the PadIn a report was built from to the host polling it
+        uint32_t age_count{0};
+        uint32_t age_min_us{0};
+        uint32_t age_avg_us{0};
+        uint32_t age_max_us{0};
+        //Learned poll schedule
+        uint32_t phase_us{0};
+        uint32_t interval_frames{0};
+        bool locked{false};
+    };
+}
+
+#if defined(CONFIG_OGXM_SOF_SYNC)
+
+#ifndef SOF_SYNC_MARGIN_US
+    #define SOF_SYNC_MARGIN_US 200
+#endif
+
+namespace sof_sync
+{
+    //Class driver .sof callback, runs in the USB IRQ
+    void sof_cb(uint8_t rhport, uint32_t frame_count);
+    //Drivers opt in by setting class_driver_.sof to this
+    inline constexpr void (*SOF_CB)(uint8_t, uint32_t) = sof_cb;
+
+    //Called on mount/unmount, SOF interrupts are only enabled for drivers that opted in
+    void set_enabled(bool enabled);
+    //Called with Gamepad::get_pad_in_time() when a driver reads its PadIn
+    void input_read(uint32_t produced_us);
+    //Called when an IN report is queued and when its transfer completes
+    void submitted();
+    void completed();
+
+    //True if a held report should be queued now, always true until the poll phase is known
+    bool submit_due();
+    //Timeout for the core0 loop so it wakes up at the next submit point
+    uint32_t wait_us(uint32_t max_us = 1000);
+
+    Stats get_stats();
+    void reset_stats();
+    //Prints stats over the debug UART
+    void dump();
+}
+
+#else // CONFIG_OGXM_SOF_SYNC
+
+namespace sof_sync
+{
+    inline constexpr void (*SOF_CB)(uint8_t, uint32_t) = nullptr;
+
+    inline void set_enabled(bool enabled) {}
+    inline void input_read(uint32_t produced_us) {}
+    inline void submitted() {}
+    inline void completed() {}
+    inline bool submit_due() { return true; }
+    inline uint32_t wait_us(uint32_t max_us = 1000) { return max_us; }
+    inline Stats get_stats() { return Stats(); }
+    inline void reset_stats() {}
+    inline void dump() {}
+}
+
+#endif // CONFIG_OGXM_SOF_SYNC
+
+#endif // _SOF_SYNC_H_
@@ -5,6 +5,8 @@
 #include "device/usbd_pvt.h"
 
 #include "USBDevice/DeviceManager.h"
+#include "Board/ogxm_trace.h"
+#include "USBDevice/SOFSync.h"
 
 const usbd_class_driver_t *usbd_app_driver_get_cb(uint8_t *driver_count) 
 {
@@ -23,6 +25,24 @@ void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t rep
 	tud_hid_report(report_id, buffer, bufsize);
 }
 
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_t len)
+{
+	sof_sync::completed();
+	OGXM_TRACE(DEVICE_COMPLETE);
+}
+
+void tud_mount_cb()
+{
+	DeviceManager& device_manager = DeviceManager::get_instance();
+	sof_sync::set_enabled(device_manager.get_driver()->get_class_driver()->sof != NULL);
+	device_manager.usb_mounted();
+}
+
+void tud_umount_cb()
+{
+	sof_sync::set_enabled(false);
+}
+
 bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request) 
 {
 	return DeviceManager::get_instance().get_driver()->vendor_control_xfer_cb(rhport, stage, request);
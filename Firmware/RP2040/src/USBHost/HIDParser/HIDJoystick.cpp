@@ -23,14 +23,86 @@
 */
 
 #include "USBHost/HIDParser/HIDJoystick.h"
-#include "USBHost/HIDParser/HIDUtils.h"
+#include "Board/ogxm_log.h"
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 /* ----------------------------------------------- */
 
-static int32_t mapValue(int32_t value, int32_t in_min, int32_t in_max, int32_t out_min, int32_t out_max)
+#define FIELD_FLAG_SIGNED 0x01 // Negative logical minimum, value is two's complement
+#define FIELD_FLAG_WIDE   0x02 // Scaling overflows 32 bits
+
+static bool isJoystickField(HIDIOType type)
+{
+    switch (type)
+    {
+    case HIDIOType::Button:
+    case HIDIOType::X:
+    case HIDIOType::Y:
+    case HIDIOType::Z:
+    case HIDIOType::Rx:
+    case HIDIOType::Ry:
+    case HIDIOType::Rz:
+    case HIDIOType::Slider:
+    case HIDIOType::Dial:
+    case HIDIOType::HatSwitch:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* ----------------------------------------------- */
+
+// Reads whole bytes instead of single bits, a field spans at most 5 bytes
+static inline uint32_t readField(const uint8_t *data, uint32_t bit_offset, uint8_t bit_size)
+{
+    const uint8_t *bytes = data + (bit_offset >> 3);
+    const uint32_t shift = bit_offset & 7;
+    const uint32_t byte_count = (shift + bit_size + 7) >> 3;
+    uint32_t value;
+
+    if (byte_count <= 4)
+    {
+        value = 0;
+        for (uint32_t i = 0; i < byte_count; i++)
+            value |= (uint32_t)bytes[i] << (i * 8);
+        value >>= shift;
+    }
+    else
+    {
+        uint64_t wide = 0;
+        for (uint32_t i = 0; i < byte_count; i++)
+            wide |= (uint64_t)bytes[i] << (i * 8);
+        value = (uint32_t)(wide >> shift);
+    }
+
+    return (bit_size >= 32) ? value : (value & ((1u << bit_size) - 1));
+}
+
+/* ----------------------------------------------- */
+
+static inline int16_t mapField(uint32_t raw, uint8_t bit_size, uint8_t flags, int32_t logical_min, int32_t logical_range)
 {
-    return (value - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+    int32_t value = (int32_t)raw;
+
+    if ((flags & FIELD_FLAG_SIGNED) && bit_size > 0 && bit_size < 32)
+        value = (int32_t)(raw << (32 - bit_size)) >> (32 - bit_size);
+
+    const int32_t offset = value - logical_min;
+    const int32_t scaled = (flags & FIELD_FLAG_WIDE) ? (int32_t)((int64_t)offset * 65535 / logical_range)
+                                                     : offset * 65535 / logical_range;
+
+    return (int16_t)std::clamp(scaled - 32768, (int32_t)-32768, (int32_t)32767);
+}
+
+/* ----------------------------------------------- */
+
+// Once per descriptor, inputs past the plan's fixed size are never read
+static void logTruncated()
+{
+    OGXM_LOG("HIDJoystick: descriptor exceeds %d fields or %d blocks, the rest is ignored\n", MAX_JOYSTICK_FIELDS, MAX_JOYSTICK_BLOCKS);
 }
 
 /* ----------------------------------------------- */
@@ -46,7 +118,8 @@ HIDJoystickData::HIDJoystickData() : index(0xFF),
                                      Slider(0),
                                      Dial(0),
                                      hat_switch(HIDJoystickHatSwitch::NEUTRAL),
-                                     button_count(0)
+                                     button_count(0),
+                                     button_bits(0)
 {
     memset(buttons, 0, sizeof(buttons));
 }
@@ -59,9 +132,98 @@ HIDJoystickData::~HIDJoystickData()
 
 /* ----------------------------------------------- */
 
-HIDJoystick::HIDJoystick(const std::shared_ptr<HIDReportDescriptor> &descriptor)
+HIDJoystick::HIDJoystick(const HIDReportDescriptor &descriptor) : m_field_count(0),
+                                                                    m_block_count(0),
+                                                                    m_joystick_count(0)
 {
-    this->m_reports = descriptor->GetReports();
+    bool truncated = false;
+
+    for (const auto &report : descriptor.GetReports())
+    {
+        if (report.report_type != HIDIOReportType::Joystick && report.report_type != HIDIOReportType::GamePad)
+            continue;
+
+        const uint8_t index = this->m_joystick_count++;
+
+        for (const auto &ioblock : report.inputs)
+        {
+            if (this->m_block_count >= MAX_JOYSTICK_BLOCKS)
+            {
+                logTruncated();
+                return;
+            }
+
+            Block &block = this->m_blocks[this->m_block_count];
+            block.report_id = 0;
+            block.report_id_size = 0;
+            block.first_field = this->m_field_count;
+            block.index = index;
+
+            uint32_t bit_offset = 0;
+
+            for (const auto &input : ioblock.data)
+            {
+                const uint32_t field_offset = bit_offset;
+                bit_offset += input.size;
+
+                // The descriptor parser starts a new block at every report ID, so it's always the first field
+                if (input.type == HIDIOType::ReportId)
+                {
+                    block.report_id = input.id;
+                    block.report_id_size = (uint8_t)input.size;
+                    continue;
+                }
+
+                // Padding, vendor and unhandled usages only move the offset
+                if (!isJoystickField(input.type) || input.size == 0 || input.size > 32)
+                    continue;
+
+                // Buttons past MAX_BUTTONS are dropped rather than rejecting the whole report
+                if (input.type == HIDIOType::Button && input.id >= MAX_BUTTONS)
+                    continue;
+
+                if (this->m_field_count >= MAX_JOYSTICK_FIELDS)
+                {
+                    truncated = true;
+                    continue;
+                }
+
+                Field &field = this->m_fields[this->m_field_count++];
+                field.bit_offset = field_offset;
+                field.bit_size = (uint8_t)input.size;
+                field.type = (uint8_t)input.type;
+                field.id = (uint8_t)input.id;
+                field.flags = 0;
+                field.logical_min = input.logical_min;
+                field.logical_range = input.logical_max - input.logical_min;
+
+                if (field.logical_range == 0)
+                    field.logical_range = 1;
+
+                if (input.logical_min < 0)
+                    field.flags |= FIELD_FLAG_SIGNED;
+
+                // Widest offset the field can produce, decides if scaling needs 64 bits
+                const int64_t raw_min = (field.flags & FIELD_FLAG_SIGNED) ? -((int64_t)1 << (field.bit_size - 1)) : 0;
+                const int64_t raw_max = (field.flags & FIELD_FLAG_SIGNED) ? ((int64_t)1 << (field.bit_size - 1)) - 1
+                                                                          : ((int64_t)1 << field.bit_size) - 1;
+                const int64_t max_offset = std::max(std::abs(raw_max - input.logical_min), std::abs(raw_min - input.logical_min));
+
+                if (max_offset * 65535 > INT32_MAX)
+                    field.flags |= FIELD_FLAG_WIDE;
+            }
+
+            if (ioblock.data.empty())
+                continue;
+
+            block.bit_end = bit_offset;
+            block.field_count = this->m_field_count - block.first_field;
+            this->m_block_count++;
+        }
+    }
+
+    if (truncated)
+        logTruncated();
 }
 
 /* ----------------------------------------------- */
@@ -81,113 +243,97 @@ bool HIDJoystick::isValid()
 
 uint8_t HIDJoystick::getCount()
 {
-    uint8_t count = 0;
-
-    for (auto report : this->m_reports)
-    {
-        if (report.report_type == HIDIOReportType::Joystick || report.report_type == HIDIOReportType::GamePad)
-            count++;
-    }
-
-    return count;
+    return this->m_joystick_count;
 }
 
 /* ----------------------------------------------- */
 
 bool HIDJoystick::parseData(uint8_t *data, uint16_t datalen, HIDJoystickData *joystick_data)
 {
-    bool found = false;
-    uint8_t joystick_count = 0;
+    const uint32_t data_bits = datalen * (uint32_t)8;
 
-    for (uint32_t i = 0; i < this->m_reports.size(); i++)
+    for (uint8_t i = 0; i < this->m_block_count; i++)
     {
-        auto report = this->m_reports[i];
-
-        if (report.report_type != HIDIOReportType::Joystick && report.report_type != HIDIOReportType::GamePad)
-            continue;
-
-        joystick_count += 1;
+        const Block &block = this->m_blocks[i];
 
-        for (auto ioblock : report.inputs)
+        if (block.report_id_size)
         {
-            uint32_t bitOffset = 0;
+            if (block.report_id_size > data_bits)
+                return false; // Out of range
 
-            for (auto input : ioblock.data)
-            {
-                uint32_t value = HIDUtils::readBitsLE(data, bitOffset, input.size);
-                bitOffset += input.size;
+            if (readField(data, 0, block.report_id_size) != block.report_id)
+                continue; // Not the correct report id
+        }
 
-                if (bitOffset > (datalen * (uint32_t)8))
-                    return false; // Out of range
+        // Short reports fill the fields that fit and fail, checking the whole block once covers the usual case
+        const bool complete = (block.bit_end <= data_bits);
 
-                if (input.type == HIDIOType::ReportId)
-                {
-                    if (value != input.id)
-                        break; // Not the correct report id
-                }
+        const Field *field = &this->m_fields[block.first_field];
+        const Field *field_end = field + block.field_count;
 
-                found = true;
-                joystick_data->index = joystick_count - 1;
+        for (; field != field_end; ++field)
+        {
+            if (!complete && (field->bit_offset + field->bit_size > data_bits))
+                return false; // Out of range
 
-                if (input.type == HIDIOType::Button)
-                {
-                    if (input.id >= MAX_BUTTONS)
-                        return false;
+            joystick_data->index = block.index;
+            const uint32_t value = readField(data, field->bit_offset, field->bit_size);
 
-                    joystick_data->buttons[input.id] = value;
-                    if (joystick_data->button_count < input.id)
-                        joystick_data->button_count = input.id;
-                }
-                else if (input.type == HIDIOType::X)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_X;
-                    joystick_data->X = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Y)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Y;
-                    joystick_data->Y = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Z)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Z;
-                    joystick_data->Z = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Rx)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Rx;
-                    joystick_data->Rx = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Ry)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Ry;
-                    joystick_data->Ry = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Rz)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Rz;
-                    joystick_data->Rz = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Slider)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Slider;
-                    joystick_data->Slider = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::Dial)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_Dial;
-                    joystick_data->Dial = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
-                }
-                else if (input.type == HIDIOType::HatSwitch)
-                {
-                    joystick_data->support |= JOYSTICK_SUPPORT_HatSwitch;
-                    joystick_data->hat_switch = (HIDJoystickHatSwitch)value;
-                }
+            switch ((HIDIOType)field->type)
+            {
+            case HIDIOType::Button:
+                joystick_data->buttons[field->id] = value;
+                joystick_data->button_bits = (joystick_data->button_bits & ~(1UL << field->id)) | ((uint32_t)(value != 0) << field->id);
+                if (joystick_data->button_count < field->id)
+                    joystick_data->button_count = field->id;
+                break;
+            case HIDIOType::X:
+                joystick_data->support |= JOYSTICK_SUPPORT_X;
+                joystick_data->X = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Y:
+                joystick_data->support |= JOYSTICK_SUPPORT_Y;
+                joystick_data->Y = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Z:
+                joystick_data->support |= JOYSTICK_SUPPORT_Z;
+                joystick_data->Z = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Rx:
+                joystick_data->support |= JOYSTICK_SUPPORT_Rx;
+                joystick_data->Rx = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Ry:
+                joystick_data->support |= JOYSTICK_SUPPORT_Ry;
+                joystick_data->Ry = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Rz:
+                joystick_data->support |= JOYSTICK_SUPPORT_Rz;
+                joystick_data->Rz = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Slider:
+                joystick_data->support |= JOYSTICK_SUPPORT_Slider;
+                joystick_data->Slider = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::Dial:
+                joystick_data->support |= JOYSTICK_SUPPORT_Dial;
+                joystick_data->Dial = mapField(value, field->bit_size, field->flags, field->logical_min, field->logical_range);
+                break;
+            case HIDIOType::HatSwitch:
+                joystick_data->support |= JOYSTICK_SUPPORT_HatSwitch;
+                joystick_data->hat_switch = (HIDJoystickHatSwitch)value;
+                break;
+            default:
+                break;
             }
-
-            if (found)
-                return true;
         }
+
+        // Trailing padding or vendor data that didn't fit
+        if (!complete)
+            return false;
+
+        joystick_data->index = block.index;
+        return true;
     }
 
     return false;
@@ -23,10 +23,11 @@
 */
 
 #include "USBHost/HIDParser/HIDReportDescriptor.h"
-#include <memory>
-#include <vector>
+#include <stdint.h>
 
 #define MAX_BUTTONS 32
+#define MAX_JOYSTICK_FIELDS 48
+#define MAX_JOYSTICK_BLOCKS 8
 
 enum class HIDJoystickHatSwitch
 {
@@ -74,12 +75,13 @@ public:
 
     uint8_t button_count;
     uint8_t buttons[MAX_BUTTONS];
+    uint32_t button_bits; // Bit n set while buttons[n] is pressed
 };
 
 class HIDJoystick
 {
 public:
-    HIDJoystick(const std::shared_ptr<HIDReportDescriptor> &descriptor);
+    HIDJoystick(const HIDReportDescriptor &descriptor);
     ~HIDJoystick();
 
     bool isValid();
@@ -88,5 +90,32 @@ public:
     bool parseData(uint8_t *data, uint16_t datalen, HIDJoystickData *joystick_data);
 
 private:
-    std::vector<HIDIOReport> m_reports;
+    // Extraction plan compiled from the descriptor once, only fields HIDJoystickData uses are kept
+    struct Field
+    {
+        int32_t logical_min;
+        int32_t logical_range;
+        uint32_t bit_offset;
+        uint8_t bit_size;
+        uint8_t type;       // HIDIOType
+        uint8_t id;         // Button index
+        uint8_t flags;
+    };
+
+    // One per input block, a block starts at every report ID
+    struct Block
+    {
+        uint32_t report_id;
+        uint32_t bit_end;
+        uint8_t report_id_size; // 0 if the block has no report ID
+        uint8_t first_field;
+        uint8_t field_count;
+        uint8_t index;
+    };
+
+    Field m_fields[MAX_JOYSTICK_FIELDS];
+    Block m_blocks[MAX_JOYSTICK_BLOCKS];
+    uint8_t m_field_count;
+    uint8_t m_block_count;
+    uint8_t m_joystick_count;
 };
\ No newline at end of file
@@ -17,6 +17,20 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(0, DInput::Buttons0::SQUARE,   Gamepad::BUTTON_X)
+        .map(0, DInput::Buttons0::CROSS,    Gamepad::BUTTON_A)
+        .map(0, DInput::Buttons0::CIRCLE,   Gamepad::BUTTON_B)
+        .map(0, DInput::Buttons0::TRIANGLE, Gamepad::BUTTON_Y)
+        .map(0, DInput::Buttons0::L1,       Gamepad::BUTTON_LB)
+        .map(0, DInput::Buttons0::R1,       Gamepad::BUTTON_RB)
+        .map(1, DInput::Buttons1::L3,       Gamepad::BUTTON_L3)
+        .map(1, DInput::Buttons1::R3,       Gamepad::BUTTON_R3)
+        .map(1, DInput::Buttons1::SELECT,   Gamepad::BUTTON_BACK)
+        .map(1, DInput::Buttons1::START,    Gamepad::BUTTON_START)
+        .map(1, DInput::Buttons1::SYS,      Gamepad::BUTTON_SYS)
+        .map(1, DInput::Buttons1::TP,       Gamepad::BUTTON_MISC);
+
     DInput::InReport prev_in_report_{};
 };
 
@@ -3,7 +3,7 @@
 
 #include <cstdint>
 #include <array>
-#include <memory>
+#include <optional>
 
 #include "tusb_option.h"
 
@@ -21,10 +21,25 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    //Indexed by HIDJoystickData::button_bits, buttons 7 and 8 are the triggers
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(1U << 1,  Gamepad::BUTTON_X)
+        .map(1U << 2,  Gamepad::BUTTON_A)
+        .map(1U << 3,  Gamepad::BUTTON_B)
+        .map(1U << 4,  Gamepad::BUTTON_Y)
+        .map(1U << 5,  Gamepad::BUTTON_LB)
+        .map(1U << 6,  Gamepad::BUTTON_RB)
+        .map(1U << 9,  Gamepad::BUTTON_BACK)
+        .map(1U << 10, Gamepad::BUTTON_START)
+        .map(1U << 11, Gamepad::BUTTON_L3)
+        .map(1U << 12, Gamepad::BUTTON_R3)
+        .map(1U << 13, Gamepad::BUTTON_SYS)
+        .map(1U << 14, Gamepad::BUTTON_MISC);
+
     std::array<uint8_t, 0x100> report_desc_buffer_;
     uint16_t report_desc_len_{0};
     std::array<uint8_t, CFG_TUH_HID_EPIN_BUFSIZE> prev_report_in_{0};
-    std::unique_ptr<HIDJoystick> hid_joystick_;
+    std::optional<HIDJoystick> hid_joystick_;
     HIDJoystickData hid_joystick_data_;
 };
 
@@ -2,10 +2,14 @@
 #define _HOST_DRIVER_H_
 
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
 
 #include "UserSettings/UserProfile.h"
 #include "UserSettings/UserSettings.h"
 #include "Gamepad/Gamepad.h"
+#include "Gamepad/ButtonLut.h"
 #include "USBHost/HostDriver/HostDriverTypes.h"
 
 //Use HostManager, don't use this directly
@@ -27,6 +31,52 @@ public:
 protected:
     const uint8_t idx_;
 
+    //Bits set in the mask are the ones that count as input, counters, motion and timestamps are left out
+    template <size_t SIZE>
+    struct ReportMask
+    {
+        std::array<uint8_t, SIZE> bytes{};
+
+        constexpr ReportMask& set(size_t offset, size_t len, uint8_t bits = 0xFF)
+        {
+            for (size_t i = offset; i < offset + len && i < SIZE; ++i)
+            {
+                bytes[i] = bits;
+            }
+            return *this;
+        }
+    };
+
+    //Compares against the previous report and saves the new one if it changed, a null mask compares every byte.
+    //len is clamped to the size of prev by the caller
+    static inline bool report_changed(void* prev, const void* report, size_t len, const uint8_t* mask = nullptr)
+    {
+        uint8_t* prev_bytes = static_cast<uint8_t*>(prev);
+        const uint8_t* report_bytes = static_cast<const uint8_t*>(report);
+        bool changed = false;
+
+        if (!mask)
+        {
+            changed = (std::memcmp(prev_bytes, report_bytes, len) != 0);
+        }
+        else
+        {
+            for (size_t i = 0; i < len; ++i)
+            {
+                if ((prev_bytes[i] ^ report_bytes[i]) & mask[i])
+                {
+                    changed = true;
+                    break;
+                }
+            }
+        }
+        if (changed)
+        {
+            std::memcpy(prev_bytes, report_bytes, len);
+        }
+        return changed;
+    }
+
     void manage_rumble(Gamepad& gamepad)
     {
         Gamepad::PadOut gp_out = gamepad.get_pad_out();
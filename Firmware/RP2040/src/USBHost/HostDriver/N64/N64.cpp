@@ -1,4 +1,5 @@
 #include <cstring>
+#include <algorithm>
 
 #include "host/usbh.h"
 #include "class/hid/hid_host.h"
@@ -13,7 +14,7 @@ void N64Host::initialize(Gamepad& gamepad, uint8_t address, uint8_t instance, co
 void N64Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance, const uint8_t* report, uint16_t len)
 {
     const N64::InReport* in_report = reinterpret_cast<const N64::InReport*>(report);
-    if (std::memcmp(in_report, &prev_in_report_, sizeof(N64::InReport)) == 0)
+    if (!report_changed(&prev_in_report_, in_report, std::min(static_cast<size_t>(len), sizeof(N64::InReport))))
     {
         tuh_hid_receive_report(address, instance);
         return;
@@ -21,41 +22,9 @@ void N64Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
 
     Gamepad::PadIn gp_in;   
 
-    switch (in_report->buttons & N64::DPAD_MASK)
-    {
-        case N64::Buttons::DPAD_UP:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP;
-            break;
-        case N64::Buttons::DPAD_UP_RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP_RIGHT;
-            break;
-        case N64::Buttons::DPAD_RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;  
-            break;
-        case N64::Buttons::DPAD_RIGHT_DOWN:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN_RIGHT;
-            break;
-        case N64::Buttons::DPAD_DOWN:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
-            break;
-        case N64::Buttons::DPAD_DOWN_LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN_LEFT;
-            break;
-        case N64::Buttons::DPAD_LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
-            break;
-        case N64::Buttons::DPAD_LEFT_UP:    
-            gp_in.dpad |= gamepad.MAP_DPAD_UP_LEFT;
-            break;  
-        default:
-            break;
-    }
+    gp_in.dpad = gamepad.map_dpad(Gamepad::hat_to_dpad(in_report->buttons & N64::DPAD_MASK));
 
-    if (in_report->buttons & N64::Buttons::A) gp_in.buttons |= gamepad.MAP_BUTTON_A;
-    if (in_report->buttons & N64::Buttons::B) gp_in.buttons |= gamepad.MAP_BUTTON_B;
-    if (in_report->buttons & N64::Buttons::L) gp_in.buttons |= gamepad.MAP_BUTTON_LB;
-    if (in_report->buttons & N64::Buttons::R) gp_in.buttons |= gamepad.MAP_BUTTON_RB;
-    if (in_report->buttons & N64::Buttons::START) gp_in.buttons |= gamepad.MAP_BUTTON_START;
+    gp_in.buttons = gamepad.map_buttons(BUTTON_LUT(in_report->buttons));
 
     uint8_t joy_ry = N64::JOY_MID;
     uint8_t joy_rx = N64::JOY_MID;
@@ -102,7 +71,6 @@ void N64Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
     gamepad.set_pad_in(gp_in);
 
     tuh_hid_receive_report(address, instance);
-    std::memcpy(&prev_in_report_, in_report, sizeof(N64::InReport));
 }
 
 bool N64Host::send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance)
@@ -17,6 +17,13 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(N64::Buttons::A,     Gamepad::BUTTON_A)
+        .map(N64::Buttons::B,     Gamepad::BUTTON_B)
+        .map(N64::Buttons::L,     Gamepad::BUTTON_LB)
+        .map(N64::Buttons::R,     Gamepad::BUTTON_RB)
+        .map(N64::Buttons::START, Gamepad::BUTTON_START);
+
     N64::InReport prev_in_report_{};
 };
 
@@ -1,4 +1,5 @@
 #include <cstring>
+#include <algorithm>
 
 #include "host/usbh.h"
 #include "class/hid/hid_host.h"
@@ -98,7 +99,7 @@ void PS3Host::get_report_complete_cb(tuh_xfer_s *xfer)
 void PS3Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance, const uint8_t* report, uint16_t len)
 {
     const PS3::InReport* in_report = reinterpret_cast<const PS3::InReport*>(report);
-    if (std::memcmp(&prev_in_report_, in_report, std::min(static_cast<size_t>(len), static_cast<size_t>(26))) == 0)
+    if (!report_changed(&prev_in_report_, in_report, std::min(static_cast<size_t>(len), offsetof(PS3::InReport, unk4))))
     {
         tuh_hid_receive_report(address, instance);
         return;
@@ -106,35 +107,22 @@ void PS3Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
 
     Gamepad::PadIn gp_in;   
 
-    if (in_report->buttons[0] & PS3::Buttons0::DPAD_UP)    gp_in.dpad |= gamepad.MAP_DPAD_UP;
-    if (in_report->buttons[0] & PS3::Buttons0::DPAD_DOWN)  gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
-    if (in_report->buttons[0] & PS3::Buttons0::DPAD_LEFT)  gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
-    if (in_report->buttons[0] & PS3::Buttons0::DPAD_RIGHT) gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;
-
-    if (in_report->buttons[0] & PS3::Buttons0::SELECT)   gp_in.buttons |= gamepad.MAP_BUTTON_BACK;
-    if (in_report->buttons[0] & PS3::Buttons0::START)    gp_in.buttons |= gamepad.MAP_BUTTON_START;
-    if (in_report->buttons[0] & PS3::Buttons0::L3)       gp_in.buttons |= gamepad.MAP_BUTTON_L3;
-    if (in_report->buttons[0] & PS3::Buttons0::R3)       gp_in.buttons |= gamepad.MAP_BUTTON_R3;
-    if (in_report->buttons[1] & PS3::Buttons1::L1)       gp_in.buttons |= gamepad.MAP_BUTTON_LB;
-    if (in_report->buttons[1] & PS3::Buttons1::R1)       gp_in.buttons |= gamepad.MAP_BUTTON_RB;
-    if (in_report->buttons[1] & PS3::Buttons1::TRIANGLE) gp_in.buttons |= gamepad.MAP_BUTTON_Y;
-    if (in_report->buttons[1] & PS3::Buttons1::CIRCLE)   gp_in.buttons |= gamepad.MAP_BUTTON_B;
-    if (in_report->buttons[1] & PS3::Buttons1::CROSS)    gp_in.buttons |= gamepad.MAP_BUTTON_A;
-    if (in_report->buttons[1] & PS3::Buttons1::SQUARE)   gp_in.buttons |= gamepad.MAP_BUTTON_X;
-    if (in_report->buttons[2] & PS3::Buttons2::SYS)      gp_in.buttons |= gamepad.MAP_BUTTON_SYS;
+    gp_in.dpad = gamepad.map_dpad(DPAD_LUT(in_report->buttons[0]));
+
+    gp_in.buttons = gamepad.map_buttons(BUTTON_LUT(in_report->buttons));
 
     if (gamepad.analog_enabled())
     {
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_UP]    = in_report->up_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_DOWN]  = in_report->down_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_LEFT]  = in_report->left_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_RIGHT] = in_report->right_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_A]  = in_report->cross_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_B]  = in_report->circle_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_X]  = in_report->square_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_Y]  = in_report->triangle_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_LB] = in_report->l1_axis;
-        gp_in.analog[gamepad.MAP_ANALOG_OFF_RB] = in_report->r1_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_UP)]    = in_report->up_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_DOWN)]  = in_report->down_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_LEFT)]  = in_report->left_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_RIGHT)] = in_report->right_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_A)]  = in_report->cross_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_B)]  = in_report->circle_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_X)]  = in_report->square_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_Y)]  = in_report->triangle_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_LB)] = in_report->l1_axis;
+        gp_in.analog[gamepad.map_analog_off(Gamepad::ANALOG_OFF_RB)] = in_report->r1_axis;
     }
 
     gp_in.trigger_l = gamepad.scale_trigger_l(in_report->l2_axis);
@@ -146,7 +134,6 @@ void PS3Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
     gamepad.set_pad_in(gp_in);
 
     tuh_hid_receive_report(address, instance);
-    std::memcpy(&prev_in_report_, in_report, sizeof(PS3::InReport));
 }
 
 bool PS3Host::send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance)
@@ -20,6 +20,24 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<24>()
+        .map(0, PS3::Buttons0::SELECT,   Gamepad::BUTTON_BACK)
+        .map(0, PS3::Buttons0::START,    Gamepad::BUTTON_START)
+        .map(0, PS3::Buttons0::L3,       Gamepad::BUTTON_L3)
+        .map(0, PS3::Buttons0::R3,       Gamepad::BUTTON_R3)
+        .map(1, PS3::Buttons1::L1,       Gamepad::BUTTON_LB)
+        .map(1, PS3::Buttons1::R1,       Gamepad::BUTTON_RB)
+        .map(1, PS3::Buttons1::TRIANGLE, Gamepad::BUTTON_Y)
+        .map(1, PS3::Buttons1::CIRCLE,   Gamepad::BUTTON_B)
+        .map(1, PS3::Buttons1::CROSS,    Gamepad::BUTTON_A)
+        .map(1, PS3::Buttons1::SQUARE,   Gamepad::BUTTON_X)
+        .map(2, PS3::Buttons2::SYS,      Gamepad::BUTTON_SYS);
+    static constexpr auto DPAD_LUT = ButtonLut<8>()
+        .map(PS3::Buttons0::DPAD_UP,    Gamepad::DPAD_UP)
+        .map(PS3::Buttons0::DPAD_DOWN,  Gamepad::DPAD_DOWN)
+        .map(PS3::Buttons0::DPAD_LEFT,  Gamepad::DPAD_LEFT)
+        .map(PS3::Buttons0::DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
     enum class InitStage { RESP1, RESP2, RESP3, DONE };
 
     struct InitState
@@ -17,6 +17,27 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<24>()
+        .map(0, PS4::Buttons0::SQUARE,   Gamepad::BUTTON_X)
+        .map(0, PS4::Buttons0::CROSS,    Gamepad::BUTTON_A)
+        .map(0, PS4::Buttons0::CIRCLE,   Gamepad::BUTTON_B)
+        .map(0, PS4::Buttons0::TRIANGLE, Gamepad::BUTTON_Y)
+        .map(1, PS4::Buttons1::L1,       Gamepad::BUTTON_LB)
+        .map(1, PS4::Buttons1::R1,       Gamepad::BUTTON_RB)
+        .map(1, PS4::Buttons1::L3,       Gamepad::BUTTON_L3)
+        .map(1, PS4::Buttons1::R3,       Gamepad::BUTTON_R3)
+        .map(1, PS4::Buttons1::SHARE,    Gamepad::BUTTON_BACK)
+        .map(1, PS4::Buttons1::OPTIONS,  Gamepad::BUTTON_START)
+        .map(2, PS4::Buttons2::PS,       Gamepad::BUTTON_SYS)
+        .map(2, PS4::Buttons2::TP,       Gamepad::BUTTON_MISC);
+
+    //The low bits of buttons[2] are a report counter
+    static constexpr auto IN_REPORT_MASK = ReportMask<sizeof(PS4::InReport)>()
+        .set(offsetof(PS4::InReport, joystick_lx), 4)
+        .set(offsetof(PS4::InReport, buttons), 2)
+        .set(offsetof(PS4::InReport, buttons) + 2, 1, PS4::COUNTER_MASK)
+        .set(offsetof(PS4::InReport, trigger_l), 2);
+
     PS4::InReport in_report_{};
     PS4::InReport prev_in_report_{};
     PS4::OutReport out_report_{};
@@ -1,4 +1,5 @@
 #include <cstring>
+#include <algorithm>
 
 #include "host/usbh.h"
 #include "class/hid/hid_host.h"
@@ -34,8 +35,7 @@ void PS5Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
 {
     const PS5::InReport* in_report = reinterpret_cast<const PS5::InReport*>(report);
 
-    if (std::memcmp(&prev_in_report_.joystick_lx, &in_report->joystick_lx, sizeof(uint8_t) * 6) == 0 &&
-        std::memcmp(prev_in_report_.buttons, in_report->buttons, sizeof(in_report->buttons)) == 0)
+    if (!report_changed(&prev_in_report_, in_report, std::min(static_cast<size_t>(len), sizeof(PS5::InReport)), IN_REPORT_MASK.bytes.data()))
     {
         tuh_hid_receive_report(address, instance);
         return;
@@ -43,48 +43,9 @@ void PS5Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
 
     Gamepad::PadIn gp_in;   
 
-    switch (in_report->buttons[0] & PS5::DPAD_MASK)
-    {
-        case PS5::Buttons0::DPAD_UP:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP;
-            break;
-        case PS5::Buttons0::DPAD_UP_RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP_RIGHT;
-            break;
-        case PS5::Buttons0::DPAD_RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;
-            break;
-        case PS5::Buttons0::DPAD_RIGHT_DOWN:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN_RIGHT;
-            break;
-        case PS5::Buttons0::DPAD_DOWN:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
-            break;
-        case PS5::Buttons0::DPAD_DOWN_LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN_LEFT;
-            break;
-        case PS5::Buttons0::DPAD_LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
-            break;
-        case PS5::Buttons0::DPAD_LEFT_UP:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP_LEFT;
-            break;
-        default:
-            break;
-    }
+    gp_in.dpad = gamepad.map_dpad(Gamepad::hat_to_dpad(in_report->buttons[0] & PS5::DPAD_MASK));
 
-    if (in_report->buttons[0] & PS5::Buttons0::SQUARE)   gp_in.buttons |= gamepad.MAP_BUTTON_X;
-    if (in_report->buttons[0] & PS5::Buttons0::CROSS)    gp_in.buttons |= gamepad.MAP_BUTTON_A;
-    if (in_report->buttons[0] & PS5::Buttons0::CIRCLE)   gp_in.buttons |= gamepad.MAP_BUTTON_B;
-    if (in_report->buttons[0] & PS5::Buttons0::TRIANGLE) gp_in.buttons |= gamepad.MAP_BUTTON_Y;
-    if (in_report->buttons[1] & PS5::Buttons1::L1)       gp_in.buttons |= gamepad.MAP_BUTTON_LB;
-    if (in_report->buttons[1] & PS5::Buttons1::R1)       gp_in.buttons |= gamepad.MAP_BUTTON_RB;
-    if (in_report->buttons[1] & PS5::Buttons1::L3)       gp_in.buttons |= gamepad.MAP_BUTTON_L3;
-    if (in_report->buttons[1] & PS5::Buttons1::R3)       gp_in.buttons |= gamepad.MAP_BUTTON_R3;
-    if (in_report->buttons[1] & PS5::Buttons1::SHARE)    gp_in.buttons |= gamepad.MAP_BUTTON_BACK;
-    if (in_report->buttons[1] & PS5::Buttons1::OPTIONS)  gp_in.buttons |= gamepad.MAP_BUTTON_START;
-    if (in_report->buttons[2] & PS5::Buttons2::PS)       gp_in.buttons |= gamepad.MAP_BUTTON_SYS;
-    if (in_report->buttons[2] & PS5::Buttons2::MUTE)     gp_in.buttons |= gamepad.MAP_BUTTON_MISC;
+    gp_in.buttons = gamepad.map_buttons(BUTTON_LUT(in_report->buttons));
 
     gp_in.trigger_l = gamepad.scale_trigger_l(in_report->trigger_l);
     gp_in.trigger_r = gamepad.scale_trigger_r(in_report->trigger_r);
@@ -95,7 +56,6 @@ void PS5Host::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance
     gamepad.set_pad_in(gp_in);
 
     tuh_hid_receive_report(address, instance);
-    std::memcpy(&prev_in_report_, in_report, sizeof(PS5::InReport));
 }
 
 bool PS5Host::send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance)
@@ -17,6 +17,25 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<24>()
+        .map(0, PS5::Buttons0::SQUARE,   Gamepad::BUTTON_X)
+        .map(0, PS5::Buttons0::CROSS,    Gamepad::BUTTON_A)
+        .map(0, PS5::Buttons0::CIRCLE,   Gamepad::BUTTON_B)
+        .map(0, PS5::Buttons0::TRIANGLE, Gamepad::BUTTON_Y)
+        .map(1, PS5::Buttons1::L1,       Gamepad::BUTTON_LB)
+        .map(1, PS5::Buttons1::R1,       Gamepad::BUTTON_RB)
+        .map(1, PS5::Buttons1::L3,       Gamepad::BUTTON_L3)
+        .map(1, PS5::Buttons1::R3,       Gamepad::BUTTON_R3)
+        .map(1, PS5::Buttons1::SHARE,    Gamepad::BUTTON_BACK)
+        .map(1, PS5::Buttons1::OPTIONS,  Gamepad::BUTTON_START)
+        .map(2, PS5::Buttons2::PS,       Gamepad::BUTTON_SYS)
+        .map(2, PS5::Buttons2::MUTE,     Gamepad::BUTTON_MISC);
+
+    //Sticks, triggers and buttons, the sequence number and motion data change every report
+    static constexpr auto IN_REPORT_MASK = ReportMask<sizeof(PS5::InReport)>()
+        .set(offsetof(PS5::InReport, joystick_lx), 6)
+        .set(offsetof(PS5::InReport, buttons), sizeof(PS5::InReport::buttons));
+
     PS5::InReport prev_in_report_{};
     PS5::OutReport out_report_{};
 };
@@ -17,6 +17,27 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(PSClassic::Buttons::SQUARE,   Gamepad::BUTTON_X)
+        .map(PSClassic::Buttons::CROSS,    Gamepad::BUTTON_A)
+        .map(PSClassic::Buttons::CIRCLE,   Gamepad::BUTTON_B)
+        .map(PSClassic::Buttons::TRIANGLE, Gamepad::BUTTON_Y)
+        .map(PSClassic::Buttons::L1,       Gamepad::BUTTON_LB)
+        .map(PSClassic::Buttons::R1,       Gamepad::BUTTON_RB)
+        .map(PSClassic::Buttons::SELECT,   Gamepad::BUTTON_BACK)
+        .map(PSClassic::Buttons::START,    Gamepad::BUTTON_START);
+
+    //The dpad isn't a hat switch, indexed by the DPAD_MASK bits, unused values are centered
+    static constexpr uint8_t DPAD_SHIFT = 10;
+    static constexpr std::array<uint8_t, 16> DPAD_LUT = 
+    {
+        Gamepad::DPAD_UP_LEFT,   Gamepad::DPAD_UP,   Gamepad::DPAD_UP_RIGHT,   Gamepad::DPAD_NONE,
+        Gamepad::DPAD_LEFT,      Gamepad::DPAD_NONE, Gamepad::DPAD_RIGHT,      Gamepad::DPAD_NONE,
+        Gamepad::DPAD_DOWN_LEFT, Gamepad::DPAD_DOWN, Gamepad::DPAD_DOWN_RIGHT, Gamepad::DPAD_NONE,
+        Gamepad::DPAD_NONE,      Gamepad::DPAD_NONE, Gamepad::DPAD_NONE,       Gamepad::DPAD_NONE
+    };
+    static_assert((PSClassic::Buttons::DOWN_RIGHT >> DPAD_SHIFT) == 10, "PSClassic dpad LUT mismatch");
+
     PSClassic::InReport prev_in_report_{};
 };
 
@@ -1,4 +1,5 @@
 #include <cstring>
+#include <algorithm>
 #include <array>
 
 #include "host/usbh.h"
@@ -134,7 +135,7 @@ void SwitchProHost::process_report(Gamepad& gamepad, uint8_t address, uint8_t in
     }
 
     const SwitchPro::InReport* in_report = reinterpret_cast<const SwitchPro::InReport*>(report);
-    if (std::memcmp(&prev_in_report_.buttons, in_report->buttons, 9) == 0)
+    if (!report_changed(&prev_in_report_, in_report, std::min(static_cast<size_t>(len), sizeof(SwitchPro::InReport)), IN_REPORT_MASK.bytes.data()))
     {
         tuh_hid_receive_report(address, instance);
         return;
@@ -142,23 +143,9 @@ void SwitchProHost::process_report(Gamepad& gamepad, uint8_t address, uint8_t in
 
     Gamepad::PadIn gp_in;   
 
-    if (in_report->buttons[0] & SwitchPro::Buttons0::Y)  gp_in.buttons |= gamepad.MAP_BUTTON_X;   
-    if (in_report->buttons[0] & SwitchPro::Buttons0::B)  gp_in.buttons |= gamepad.MAP_BUTTON_A;
-    if (in_report->buttons[0] & SwitchPro::Buttons0::A)  gp_in.buttons |= gamepad.MAP_BUTTON_B;
-    if (in_report->buttons[0] & SwitchPro::Buttons0::X)  gp_in.buttons |= gamepad.MAP_BUTTON_Y;
-    if (in_report->buttons[2] & SwitchPro::Buttons2::L)  gp_in.buttons |= gamepad.MAP_BUTTON_LB;
-    if (in_report->buttons[0] & SwitchPro::Buttons0::R)  gp_in.buttons |= gamepad.MAP_BUTTON_RB;
-    if (in_report->buttons[1] & SwitchPro::Buttons1::L3) gp_in.buttons |= gamepad.MAP_BUTTON_L3;
-    if (in_report->buttons[1] & SwitchPro::Buttons1::R3) gp_in.buttons |= gamepad.MAP_BUTTON_R3;
-    if (in_report->buttons[1] & SwitchPro::Buttons1::MINUS)     gp_in.buttons |= gamepad.MAP_BUTTON_BACK;
-    if (in_report->buttons[1] & SwitchPro::Buttons1::PLUS)      gp_in.buttons |= gamepad.MAP_BUTTON_START;
-    if (in_report->buttons[1] & SwitchPro::Buttons1::HOME)      gp_in.buttons |= gamepad.MAP_BUTTON_SYS;
-    if (in_report->buttons[1] & SwitchPro::Buttons1::CAPTURE)   gp_in.buttons |= gamepad.MAP_BUTTON_MISC;
-
-    if (in_report->buttons[2] & SwitchPro::Buttons2::DPAD_UP)    gp_in.dpad |= gamepad.MAP_DPAD_UP;
-    if (in_report->buttons[2] & SwitchPro::Buttons2::DPAD_DOWN)  gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
-    if (in_report->buttons[2] & SwitchPro::Buttons2::DPAD_LEFT)  gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
-    if (in_report->buttons[2] & SwitchPro::Buttons2::DPAD_RIGHT) gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;
+    gp_in.buttons = gamepad.map_buttons(BUTTON_LUT(in_report->buttons));
+
+    gp_in.dpad = gamepad.map_dpad(DPAD_LUT(in_report->buttons[2]));
 
     gp_in.trigger_l = in_report->buttons[2] & SwitchPro::Buttons2::ZL ? Range::MAX<uint8_t> : Range::MIN<uint8_t>;
     gp_in.trigger_r = in_report->buttons[0] & SwitchPro::Buttons0::ZR ? Range::MAX<uint8_t> : Range::MIN<uint8_t>;
@@ -177,7 +164,6 @@ void SwitchProHost::process_report(Gamepad& gamepad, uint8_t address, uint8_t in
     gamepad.set_pad_in(gp_in);
 
     tuh_hid_receive_report(address, instance);
-    std::memcpy(&prev_in_report_, in_report, sizeof(SwitchPro::InReport));
 }
 
 bool SwitchProHost::send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance)
@@ -18,6 +18,25 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<24>()
+        .map(0, SwitchPro::Buttons0::Y,       Gamepad::BUTTON_X)
+        .map(0, SwitchPro::Buttons0::B,       Gamepad::BUTTON_A)
+        .map(0, SwitchPro::Buttons0::A,       Gamepad::BUTTON_B)
+        .map(0, SwitchPro::Buttons0::X,       Gamepad::BUTTON_Y)
+        .map(2, SwitchPro::Buttons2::L,       Gamepad::BUTTON_LB)
+        .map(0, SwitchPro::Buttons0::R,       Gamepad::BUTTON_RB)
+        .map(1, SwitchPro::Buttons1::L3,      Gamepad::BUTTON_L3)
+        .map(1, SwitchPro::Buttons1::R3,      Gamepad::BUTTON_R3)
+        .map(1, SwitchPro::Buttons1::MINUS,   Gamepad::BUTTON_BACK)
+        .map(1, SwitchPro::Buttons1::PLUS,    Gamepad::BUTTON_START)
+        .map(1, SwitchPro::Buttons1::HOME,    Gamepad::BUTTON_SYS)
+        .map(1, SwitchPro::Buttons1::CAPTURE, Gamepad::BUTTON_MISC);
+    static constexpr auto DPAD_LUT = ButtonLut<8>()
+        .map(SwitchPro::Buttons2::DPAD_UP,    Gamepad::DPAD_UP)
+        .map(SwitchPro::Buttons2::DPAD_DOWN,  Gamepad::DPAD_DOWN)
+        .map(SwitchPro::Buttons2::DPAD_LEFT,  Gamepad::DPAD_LEFT)
+        .map(SwitchPro::Buttons2::DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
     enum class InitState
     {
         HANDSHAKE,
@@ -32,6 +51,10 @@ private:
     InitState init_state_{InitState::HANDSHAKE};
     uint8_t sequence_counter_{0};
 
+    //Buttons and sticks, the timer and IMU data change every report
+    static constexpr auto IN_REPORT_MASK = ReportMask<sizeof(SwitchPro::InReport)>()
+        .set(offsetof(SwitchPro::InReport, buttons), sizeof(SwitchPro::InReport::buttons) + sizeof(SwitchPro::InReport::joysticks));
+
     SwitchPro::InReport prev_in_report_{};
     SwitchPro::OutReport out_report_{};
 
@@ -1,4 +1,5 @@
 #include <cstring>
+#include <algorithm>
 
 #include "host/usbh.h"
 #include "class/hid/hid_host.h"
@@ -13,7 +14,7 @@ void SwitchWiredHost::initialize(Gamepad& gamepad, uint8_t address, uint8_t inst
 void SwitchWiredHost::process_report(Gamepad& gamepad, uint8_t address, uint8_t instance, const uint8_t* report, uint16_t len)
 {
     const SwitchWired::InReport* in_report = reinterpret_cast<const SwitchWired::InReport*>(report);
-    if (std::memcmp(&prev_in_report_, in_report, sizeof(SwitchWired::InReport)) == 0)
+    if (!report_changed(&prev_in_report_, in_report, std::min(static_cast<size_t>(len), sizeof(SwitchWired::InReport))))
     {
         tuh_hid_receive_report(address, instance);
         return;
@@ -21,48 +22,9 @@ void SwitchWiredHost::process_report(Gamepad& gamepad, uint8_t address, uint8_t
 
     Gamepad::PadIn gp_in;   
 
-    switch (in_report->dpad)
-    {
-        case SwitchWired::DPad::UP:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP;
-            break;
-        case SwitchWired::DPad::DOWN:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
-            break;
-        case SwitchWired::DPad::LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
-            break;
-        case SwitchWired::DPad::RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;
-            break;
-        case SwitchWired::DPad::UP_RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP_RIGHT;
-            break;
-        case SwitchWired::DPad::DOWN_RIGHT:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN_RIGHT;
-            break;
-        case SwitchWired::DPad::DOWN_LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_DOWN_LEFT;
-            break;
-        case SwitchWired::DPad::UP_LEFT:
-            gp_in.dpad |= gamepad.MAP_DPAD_UP_LEFT;
-            break;
-        default:
-            break;
-    }
+    gp_in.dpad = gamepad.map_dpad(Gamepad::hat_to_dpad(in_report->dpad));
 
-    if (in_report->buttons & SwitchWired::Buttons::Y)       gp_in.buttons |= gamepad.MAP_BUTTON_X;
-    if (in_report->buttons & SwitchWired::Buttons::B)       gp_in.buttons |= gamepad.MAP_BUTTON_A;
-    if (in_report->buttons & SwitchWired::Buttons::A)       gp_in.buttons |= gamepad.MAP_BUTTON_B;
-    if (in_report->buttons & SwitchWired::Buttons::X)       gp_in.buttons |= gamepad.MAP_BUTTON_Y;
-    if (in_report->buttons & SwitchWired::Buttons::L)       gp_in.buttons |= gamepad.MAP_BUTTON_LB;
-    if (in_report->buttons & SwitchWired::Buttons::R)       gp_in.buttons |= gamepad.MAP_BUTTON_RB;
-    if (in_report->buttons & SwitchWired::Buttons::MINUS)   gp_in.buttons |= gamepad.MAP_BUTTON_BACK;
-    if (in_report->buttons & SwitchWired::Buttons::PLUS)    gp_in.buttons |= gamepad.MAP_BUTTON_START;
-    if (in_report->buttons & SwitchWired::Buttons::HOME)    gp_in.buttons |= gamepad.MAP_BUTTON_SYS;
-    if (in_report->buttons & SwitchWired::Buttons::CAPTURE) gp_in.buttons |= gamepad.MAP_BUTTON_MISC;   
-    if (in_report->buttons & SwitchWired::Buttons::L3)      gp_in.buttons |= gamepad.MAP_BUTTON_L3;
-    if (in_report->buttons & SwitchWired::Buttons::R3)      gp_in.buttons |= gamepad.MAP_BUTTON_R3;
+    gp_in.buttons = gamepad.map_buttons(BUTTON_LUT(in_report->buttons));
 
     gp_in.trigger_l = (in_report->buttons & SwitchWired::Buttons::ZL) ? Range::MAX<uint8_t> : Range::MIN<uint8_t>;
     gp_in.trigger_r = (in_report->buttons & SwitchWired::Buttons::ZR) ? Range::MAX<uint8_t> : Range::MIN<uint8_t>;
@@ -73,7 +35,6 @@ void SwitchWiredHost::process_report(Gamepad& gamepad, uint8_t address, uint8_t
     gamepad.set_pad_in(gp_in);
 
     tuh_hid_receive_report(address, instance);
-    std::memcpy(&prev_in_report_, in_report, sizeof(SwitchWired::InReport));
 }
 
 bool SwitchWiredHost::send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance)
@@ -17,6 +17,20 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(SwitchWired::Buttons::Y,       Gamepad::BUTTON_X)
+        .map(SwitchWired::Buttons::B,       Gamepad::BUTTON_A)
+        .map(SwitchWired::Buttons::A,       Gamepad::BUTTON_B)
+        .map(SwitchWired::Buttons::X,       Gamepad::BUTTON_Y)
+        .map(SwitchWired::Buttons::L,       Gamepad::BUTTON_LB)
+        .map(SwitchWired::Buttons::R,       Gamepad::BUTTON_RB)
+        .map(SwitchWired::Buttons::MINUS,   Gamepad::BUTTON_BACK)
+        .map(SwitchWired::Buttons::PLUS,    Gamepad::BUTTON_START)
+        .map(SwitchWired::Buttons::HOME,    Gamepad::BUTTON_SYS)
+        .map(SwitchWired::Buttons::CAPTURE, Gamepad::BUTTON_MISC)
+        .map(SwitchWired::Buttons::L3,      Gamepad::BUTTON_L3)
+        .map(SwitchWired::Buttons::R3,      Gamepad::BUTTON_R3);
+
     SwitchWired::InReport prev_in_report_{};
 };
 
@@ -17,6 +17,24 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(0, XInput::Buttons0::START, Gamepad::BUTTON_START)
+        .map(0, XInput::Buttons0::BACK,  Gamepad::BUTTON_BACK)
+        .map(0, XInput::Buttons0::L3,    Gamepad::BUTTON_L3)
+        .map(0, XInput::Buttons0::R3,    Gamepad::BUTTON_R3)
+        .map(1, XInput::Buttons1::LB,    Gamepad::BUTTON_LB)
+        .map(1, XInput::Buttons1::RB,    Gamepad::BUTTON_RB)
+        .map(1, XInput::Buttons1::HOME,  Gamepad::BUTTON_SYS)
+        .map(1, XInput::Buttons1::A,     Gamepad::BUTTON_A)
+        .map(1, XInput::Buttons1::B,     Gamepad::BUTTON_B)
+        .map(1, XInput::Buttons1::X,     Gamepad::BUTTON_X)
+        .map(1, XInput::Buttons1::Y,     Gamepad::BUTTON_Y);
+    static constexpr auto DPAD_LUT = ButtonLut<8>()
+        .map(XInput::Buttons0::DPAD_UP,    Gamepad::DPAD_UP)
+        .map(XInput::Buttons0::DPAD_DOWN,  Gamepad::DPAD_DOWN)
+        .map(XInput::Buttons0::DPAD_LEFT,  Gamepad::DPAD_LEFT)
+        .map(XInput::Buttons0::DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
     XInput::InReport prev_in_report_;
 };
 
@@ -17,6 +17,17 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<8>()
+        .map(XboxOG::GP::Buttons::START, Gamepad::BUTTON_START)
+        .map(XboxOG::GP::Buttons::BACK,  Gamepad::BUTTON_BACK)
+        .map(XboxOG::GP::Buttons::L3,    Gamepad::BUTTON_L3)
+        .map(XboxOG::GP::Buttons::R3,    Gamepad::BUTTON_R3);
+    static constexpr auto DPAD_LUT = ButtonLut<8>()
+        .map(XboxOG::GP::Buttons::DPAD_UP,    Gamepad::DPAD_UP)
+        .map(XboxOG::GP::Buttons::DPAD_DOWN,  Gamepad::DPAD_DOWN)
+        .map(XboxOG::GP::Buttons::DPAD_LEFT,  Gamepad::DPAD_LEFT)
+        .map(XboxOG::GP::Buttons::DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
     XboxOG::GP::InReport prev_in_report_;
 };
 
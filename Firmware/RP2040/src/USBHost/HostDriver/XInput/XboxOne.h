@@ -17,6 +17,29 @@ public:
     bool send_feedback(Gamepad& gamepad, uint8_t address, uint8_t instance) override;
 
 private:
+    static constexpr auto BUTTON_LUT = ButtonLut<16>()
+        .map(1, XboxOne::Buttons1::L3,    Gamepad::BUTTON_L3)
+        .map(1, XboxOne::Buttons1::R3,    Gamepad::BUTTON_R3)
+        .map(1, XboxOne::Buttons1::LB,    Gamepad::BUTTON_LB)
+        .map(1, XboxOne::Buttons1::RB,    Gamepad::BUTTON_RB)
+        .map(0, XboxOne::Buttons0::BACK,  Gamepad::BUTTON_BACK)
+        .map(0, XboxOne::Buttons0::START, Gamepad::BUTTON_START)
+        .map(0, XboxOne::Buttons0::SYNC,  Gamepad::BUTTON_MISC)
+        .map(0, XboxOne::Buttons0::GUIDE, Gamepad::BUTTON_SYS)
+        .map(0, XboxOne::Buttons0::A,     Gamepad::BUTTON_A)
+        .map(0, XboxOne::Buttons0::B,     Gamepad::BUTTON_B)
+        .map(0, XboxOne::Buttons0::X,     Gamepad::BUTTON_X)
+        .map(0, XboxOne::Buttons0::Y,     Gamepad::BUTTON_Y);
+    static constexpr auto DPAD_LUT = ButtonLut<8>()
+        .map(XboxOne::Buttons1::DPAD_UP,    Gamepad::DPAD_UP)
+        .map(XboxOne::Buttons1::DPAD_DOWN,  Gamepad::DPAD_DOWN)
+        .map(XboxOne::Buttons1::DPAD_LEFT,  Gamepad::DPAD_LEFT)
+        .map(XboxOne::Buttons1::DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
+    //Buttons, triggers and sticks, the GIP header carries a sequence number
+    static constexpr auto IN_REPORT_MASK = ReportMask<sizeof(XboxOne::InReport)>()
+        .set(offsetof(XboxOne::InReport, buttons), offsetof(XboxOne::InReport, reserved) - offsetof(XboxOne::InReport, buttons));
+
     XboxOne::InReport prev_in_report_;
 };
 
@@ -2,13 +2,14 @@
 #define _HOST_MANAGER_H_
 
 #include <cstdint>
-#include <memory>	
+#include <variant>
 #include <hardware/regs/usb.h>
 #include <hardware/irq.h>
 #include <hardware/structs/usb.h>
 #include <hardware/resets.h>
 
 #include "Board/Config.h"
+#include "Board/ogxm_trace.h"
 #include "USBHost/HardwareIDs.h"
 #include "USBHost/HostDriver/XInput/tuh_xinput/tuh_xinput.h"
 #include "USBHost/HostDriver/HostDriver.h"
@@ -51,150 +52,131 @@ public:
 	}
 
 	//XInput doesn't need report_desc or desc_len
-	inline bool setup_driver(const HostDriverType driver_type, const uint8_t address, const uint8_t instance, uint8_t const* report_desc = nullptr, uint16_t desc_len = 0)
+	inline bool setup_driver(const DriverClass driver_class, const HostDriverType driver_type, const uint8_t address, const uint8_t instance, uint8_t const* report_desc = nullptr, uint16_t desc_len = 0)
 	{
-		uint8_t gp_idx = find_free_gamepad();
-		if (gp_idx == INVALID_IDX || instance >= MAX_INTERFACES)
+		Route* route = get_route(driver_class, address, instance);
+		if (!route)
+		{
+			return false;
+		}
+		//Check before touching the route, a failed mount leaves whatever is mounted there alone
+		if (is_generic_type(driver_type) && !is_hid_gamepad(report_desc, desc_len))
 		{
 			return false;
 		}
 
-		//Check if this device is already mounted
-		uint8_t dev_idx = get_device_slot(address);
-		//If not, find a free device slot
-		if (dev_idx == INVALID_IDX && ((dev_idx = find_free_device_slot()) == INVALID_IDX)) 
+		//Remounted without an unmount, the stale driver's gamepad is reused for the new one
+		uint8_t gp_idx = route->gamepad_idx;
+		if (gp_idx == INVALID_IDX && (gp_idx = alloc_gamepad()) == INVALID_IDX)
 		{
 			return false;
 		}
 
-		Device& device_slot = device_slots_[dev_idx];
-		Interface& interface = device_slot.interfaces[instance];
+		GamepadSlot& gamepad_slot = gamepad_slots_[gp_idx];
 
 		switch (driver_type)
 		{
 			case HostDriverType::PS5:
-				interface.driver = std::make_unique<PS5Host>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<PS5Host>(gp_idx);
 				break;
 			case HostDriverType::PS4:
-				interface.driver = std::make_unique<PS4Host>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<PS4Host>(gp_idx);
 				break;
 			case HostDriverType::PS3:
-				interface.driver = std::make_unique<PS3Host>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<PS3Host>(gp_idx);
 				break;
 			case HostDriverType::DINPUT:
-				interface.driver = std::make_unique<DInputHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<DInputHost>(gp_idx);
 				break;
 			case HostDriverType::SWITCH:
-				interface.driver = std::make_unique<SwitchWiredHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<SwitchWiredHost>(gp_idx);
 				break;
 			case HostDriverType::SWITCH_PRO:
-				interface.driver = std::make_unique<SwitchProHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<SwitchProHost>(gp_idx);
 				break;
 			case HostDriverType::N64:
-				interface.driver = std::make_unique<N64Host>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<N64Host>(gp_idx);
 				break;
 			case HostDriverType::PSCLASSIC:
-				interface.driver = std::make_unique<PSClassicHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<PSClassicHost>(gp_idx);
 				break;
 			case HostDriverType::XBOXOG:
-				interface.driver = std::make_unique<XboxOGHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<XboxOGHost>(gp_idx);
 				break;
 			case HostDriverType::XBOXONE:
-				interface.driver = std::make_unique<XboxOneHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<XboxOneHost>(gp_idx);
 				break;
 			case HostDriverType::XBOX360:
-				interface.driver = std::make_unique<Xbox360Host>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<Xbox360Host>(gp_idx);
 				break;
 			case HostDriverType::XBOX360W: //Composite device, takes up all 4 gamepads when mounted
-				interface.driver = std::make_unique<Xbox360WHost>(gp_idx);
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<Xbox360WHost>(gp_idx);
 				break;
-			default:
-				if (is_hid_gamepad(report_desc, desc_len))
-				{
-					interface.driver = std::make_unique<HIDHost>(gp_idx);
-				}
-				else
-				{
-					return false;
-				}
+			default: //Generic types were checked by is_hid_gamepad above
+				gamepad_slot.driver = &gamepad_slot.storage.emplace<HIDHost>(gp_idx);
 				break;
 		}
 
-		device_slot.address = address;
-		interface.gamepad_idx = gp_idx;
-		interface.gamepad = gamepads_[gp_idx];
-		interface.driver->initialize(*interface.gamepad, device_slot.address, instance, report_desc, desc_len);
+		gamepad_slot.address = address;
+		gamepad_slot.instance = instance;
+		gamepad_slot.driver->initialize(*gamepads_[gp_idx], address, instance, report_desc, desc_len);
+
+		route->gamepad_idx = gp_idx;
+		route->gamepad = gamepads_[gp_idx];
+		route->driver = gamepad_slot.driver;
 
 		return true;
 	}
 
-	inline void process_report(uint8_t address, uint8_t instance, const uint8_t* report, uint16_t len)
+	inline void process_report(DriverClass driver_class, uint8_t address, uint8_t instance, const uint8_t* report, uint16_t len)
 	{
-		for (auto& device_slot : device_slots_)
+		const Route* route = get_route(driver_class, address, instance);
+		if (route && route->driver)
 		{
-			if (device_slot.address == address && 
-				device_slot.interfaces[instance].driver &&
-				device_slot.interfaces[instance].gamepad)
-			{
-				device_slot.interfaces[instance].driver->process_report(*device_slot.interfaces[instance].gamepad, address, instance, report, len);
-			}
+			OGXM_TRACE(HOST_PROCESS);
+			route->driver->process_report(*route->gamepad, address, instance, report, len);
 		}
 	}
 
-	inline void connect_cb(uint8_t address, uint8_t instance)
+	inline void connect_cb(DriverClass driver_class, uint8_t address, uint8_t instance)
 	{
-		for (auto& device_slot : device_slots_)
+		const Route* route = get_route(driver_class, address, instance);
+		if (route && route->driver)
 		{
-			if (device_slot.address == address && 
-				device_slot.interfaces[instance].driver &&
-				device_slot.interfaces[instance].gamepad)
-			{
-				device_slot.interfaces[instance].driver->connect_cb(*device_slot.interfaces[instance].gamepad, address, instance);
-			}
+			route->driver->connect_cb(*route->gamepad, address, instance);
 		}
 	}
 
-	inline void disconnect_cb(uint8_t address, uint8_t instance)
+	inline void disconnect_cb(DriverClass driver_class, uint8_t address, uint8_t instance)
 	{
-		for (auto& device_slot : device_slots_)
+		const Route* route = get_route(driver_class, address, instance);
+		if (route && route->driver)
 		{
-			if (device_slot.address == address && 
-				device_slot.interfaces[instance].driver &&
-				device_slot.interfaces[instance].gamepad)
-			{
-				device_slot.interfaces[instance].driver->disconnect_cb(*device_slot.interfaces[instance].gamepad, address, instance);
-			}
+			route->driver->disconnect_cb(*route->gamepad, address, instance);
 		}
 	}
 
 	//Call on a timer
 	inline void send_feedback()
 	{
-		for (auto& device_slot : device_slots_)
+		for (uint8_t i = 0; i < MAX_GAMEPADS; ++i)
 		{
-			if (device_slot.address == INVALID_IDX)
-			{
-				continue;
-			}
-			for (uint8_t i = 0; i < MAX_INTERFACES; ++i)
+			GamepadSlot& gamepad_slot = gamepad_slots_[i];
+			if (gamepad_slot.driver && gamepads_[i]->new_pad_out())
 			{
-				if (device_slot.interfaces[i].driver && device_slot.interfaces[i].gamepad->new_pad_out())
-				{
-					device_slot.interfaces[i].driver->send_feedback(*device_slot.interfaces[i].gamepad, device_slot.address, i);
-					tuh_task();
-				}
+				gamepad_slot.driver->send_feedback(*gamepads_[i], gamepad_slot.address, gamepad_slot.instance);
+				tuh_task();
 			}
 		}
 	}
 
+	//Unmount callbacks come once per interface, only that interface's gamepad is released
     void deinit_driver(DriverClass driver_class, uint8_t address, uint8_t instance)
 	{
-		for (auto& device_slot : device_slots_)
+		Route* route = get_route(driver_class, address, instance);
+		if (route)
 		{
-			if (device_slot.address == address)
-			{
-				device_slot.reset();
-			}
+			release_route(*route);
 		}
 	}
 
@@ -234,110 +216,122 @@ public:
 
 	inline uint8_t get_gamepad_idx(DriverClass driver_class, uint8_t address, uint8_t instance)
 	{
-		for (auto& device_slot : device_slots_)
-		{
-			if (device_slot.address == address && instance < MAX_INTERFACES)
-			{
-				return device_slot.interfaces[instance].gamepad_idx;
-			}
-		}
-		return INVALID_IDX;
+		const Route* route = get_route(driver_class, address, instance);
+		return route ? route->gamepad_idx : INVALID_IDX;
 	}
 
 	inline bool any_mounted() 
 	{ 
-		for (auto& device_slot : device_slots_)
-		{
-			if (device_slot.address != INVALID_IDX)
-			{
-				return true;
-			}
-		}
-		return false;
+		return free_gamepads_ != ALL_GAMEPADS_FREE;
 	}
 
 private:
 	static constexpr uint8_t INVALID_IDX = 0xFF;
+	//TinyUSB hands out addresses 1 to CFG_TUH_DEVICE_MAX + CFG_TUH_HUB, hubs take one too
+	static constexpr uint8_t MAX_DEVICE_ADDR = CFG_TUH_DEVICE_MAX + CFG_TUH_HUB;
+	static constexpr uint32_t ALL_GAMEPADS_FREE = (1u << MAX_GAMEPADS) - 1;
+
+	static_assert(MAX_GAMEPADS <= 32, "Gamepad free mask is 32 bits");
 
-	struct Interface
+	//HID and XInput number their instances independently, each class gets its own table
+	static constexpr uint8_t NUM_ROUTE_CLASSES = 2;
+
+	//Looked up on every report, driver and gamepad are cached so dispatch is a single index
+	struct Route
 	{
-		std::unique_ptr<HostDriver> driver{nullptr};
+		HostDriver* driver{nullptr};
 		Gamepad* gamepad{nullptr};
 		uint8_t gamepad_idx{INVALID_IDX};
 	};
-	struct Device
+	//Every driver type fits in each slot, mount and unmount never touch the heap
+	using DriverStorage = std::variant<
+		std::monostate,
+		PS5Host, PS4Host, PS3Host, DInputHost, SwitchWiredHost, SwitchProHost, N64Host,
+		PSClassicHost, XboxOGHost, XboxOneHost, Xbox360Host, Xbox360WHost, HIDHost>;
+
+	//Owns the driver, indexed by gamepad
+	struct GamepadSlot
 	{
+		DriverStorage storage;
+		HostDriver* driver{nullptr};
 		uint8_t address{INVALID_IDX};
-		Interface interfaces[MAX_INTERFACES];
-
-		void reset()
-		{
-			address = INVALID_IDX;
-			for (auto& interface : interfaces)
-			{
-				interface.driver.reset();
-				interface.gamepad_idx = INVALID_IDX;
-				interface.gamepad = nullptr;
-			}
-		}
+		uint8_t instance{INVALID_IDX};
 	};
 
-	Device device_slots_[MAX_GAMEPADS];
+	Route routes_[NUM_ROUTE_CLASSES][MAX_DEVICE_ADDR][MAX_INTERFACES];
+	GamepadSlot gamepad_slots_[MAX_GAMEPADS];
 	Gamepad* gamepads_[MAX_GAMEPADS];
+	uint32_t free_gamepads_{ALL_GAMEPADS_FREE};
 
     HostManager() {}
 
-	inline uint8_t find_free_device_slot()
+	inline Route* get_route(DriverClass driver_class, uint8_t address, uint8_t instance)
 	{
-		for (uint8_t i = 0; i < MAX_GAMEPADS; ++i)
+		//NONE and address 0 wrap and fail the bounds check
+		const uint8_t class_idx = static_cast<uint8_t>(driver_class) - 1;
+		const uint8_t addr_idx = address - 1;
+		if (class_idx >= NUM_ROUTE_CLASSES || addr_idx >= MAX_DEVICE_ADDR || instance >= MAX_INTERFACES)
 		{
-			if (device_slots_[i].address == INVALID_IDX)
-			{
-				return i;
-			}
+			return nullptr;
 		}
-		return INVALID_IDX;
+		return &routes_[class_idx][addr_idx][instance];
 	}
 
-	inline uint8_t find_free_gamepad()
+	//Lowest free index first so player numbers stay put when a pad is replugged
+	inline uint8_t alloc_gamepad()
 	{
-		uint8_t count = 0;
-
-		for (auto& device_slot : device_slots_)
+		if (free_gamepads_ == 0)
 		{
-			for (auto& interface : device_slot.interfaces)
-			{
-				if (interface.gamepad_idx != INVALID_IDX)
-				{
-					++count;
-				}
-			}
+			return INVALID_IDX;
 		}
-		return (count < MAX_GAMEPADS) ? count : INVALID_IDX;
+		uint8_t idx = static_cast<uint8_t>(__builtin_ctz(free_gamepads_));
+		free_gamepads_ &= ~(1u << idx);
+		return idx;
 	}
 
-	inline uint8_t get_device_slot(uint8_t address)
+	inline void free_gamepad(uint8_t idx)
 	{
-		if (address > MAX_GAMEPADS)
+		free_gamepads_ |= (1u << idx);
+	}
+
+	inline void release_route(Route& route)
+	{
+		if (route.gamepad_idx == INVALID_IDX)
 		{
-			return INVALID_IDX;
+			return;
 		}
-		return address - 1;
+		GamepadSlot& gamepad_slot = gamepad_slots_[route.gamepad_idx];
+		free_gamepad(route.gamepad_idx);
+		route = Route();
+
+		gamepad_slot.driver = nullptr;
+		gamepad_slot.storage.emplace<std::monostate>();
+		gamepad_slot.address = INVALID_IDX;
+		gamepad_slot.instance = INVALID_IDX;
 	}
 
-	// inline DriverClass determine_driver_class(HostDriver::Type host_type)
-	// {
-	// 	switch (host_type)
-	// 	{
-	// 		case HostDriver::Type::XBOXOG:
-	// 		case HostDriver::Type::XBOXONE:
-	// 		case HostDriver::Type::XBOX360:
-	// 		case HostDriver::Type::XBOX360W:
-	// 			return DriverClass::XINPUT;
-	// 		default:
-	// 			return DriverClass::HID;
-	// 	}
-	// }
+	//Types without a dedicated driver fall back to HIDHost
+	static inline bool is_generic_type(HostDriverType driver_type)
+	{
+		switch (driver_type)
+		{
+			case HostDriverType::PS5:
+			case HostDriverType::PS4:
+			case HostDriverType::PS3:
+			case HostDriverType::DINPUT:
+			case HostDriverType::SWITCH:
+			case HostDriverType::SWITCH_PRO:
+			case HostDriverType::N64:
+			case HostDriverType::PSCLASSIC:
+			case HostDriverType::XBOXOG:
+			case HostDriverType::XBOXONE:
+			case HostDriverType::XBOX360:
+			case HostDriverType::XBOX360W:
+				return false;
+			default:
+				return true;
+		}
+	}
 
 	bool is_hid_gamepad(const uint8_t* report_desc, uint16_t desc_len)
 	{
@@ -358,17 +352,7 @@ private:
 
 	inline HostDriver* get_driver_by_gamepad(uint8_t gamepad_idx)
 	{
-		for (const auto& device_slot : device_slots_)
-		{
-			for (const auto& interface : device_slot.interfaces)
-			{
-				if (interface.gamepad_idx == gamepad_idx)
-				{
-					return interface.driver.get();
-				}
-			}
-		}
-		return nullptr;
+		return (gamepad_idx < MAX_GAMEPADS) ? gamepad_slots_[gamepad_idx].driver : nullptr;
 	}
 };
 
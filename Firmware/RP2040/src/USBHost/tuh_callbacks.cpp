@@ -7,6 +7,7 @@
 #include "USBHost/HostDriver/XInput/tuh_xinput/tuh_xinput.h"
 #include "USBHost/HostManager.h"
 #include "OGXMini/OGXMini.h"
+#include "Board/ogxm_trace.h"
 
 usbh_class_driver_t const* usbh_app_driver_get_cb(uint8_t* driver_count) {
     *driver_count = 1;
@@ -21,7 +22,7 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_re
 
     HostManager& host_manager = HostManager::get_instance();
 
-    if (host_manager.setup_driver(HostManager::get_type({ vid, pid }), dev_addr, instance, desc_report, desc_len)) {
+    if (host_manager.setup_driver(HostManager::DriverClass::HID, HostManager::get_type({ vid, pid }), dev_addr, instance, desc_report, desc_len)) {
         OGXMini::host_mounted(true);
     }
 }
@@ -36,7 +37,8 @@ void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
 }
 
 void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
-    HostManager::get_instance().process_report(dev_addr, instance, report, len);
+    OGXM_TRACE_BEGIN();
+    HostManager::get_instance().process_report(HostManager::DriverClass::HID, dev_addr, instance, report, len);
 }
 
 //XINPUT
@@ -45,7 +47,7 @@ void tuh_xinput::mount_cb(uint8_t dev_addr, uint8_t instance, const tuh_xinput::
     HostManager& host_manager = HostManager::get_instance();
     HostDriverType host_type = HostManager::get_type(interface->dev_type);
 
-    if (host_manager.setup_driver(host_type, dev_addr, instance)) {
+    if (host_manager.setup_driver(HostManager::DriverClass::XINPUT, host_type, dev_addr, instance)) {
         OGXMini::host_mounted(true, host_type);
     }
 }
@@ -60,19 +62,20 @@ void tuh_xinput::unmount_cb(uint8_t dev_addr, uint8_t instance, const tuh_xinput
 }
 
 void tuh_xinput::report_received_cb(uint8_t dev_addr, uint8_t instance, const uint8_t* report, uint16_t len) {
-    HostManager::get_instance().process_report(dev_addr, instance, report, len);
+    OGXM_TRACE_BEGIN();
+    HostManager::get_instance().process_report(HostManager::DriverClass::XINPUT, dev_addr, instance, report, len);
 }
 
 void tuh_xinput::xbox360w_connect_cb(uint8_t dev_addr, uint8_t instance) {
     uint8_t idx = HostManager::get_instance().get_gamepad_idx(  HostManager::DriverClass::XINPUT, 
                                                                 dev_addr, instance);
     OGXMini::wireless_connected(true, idx);
-    HostManager::get_instance().connect_cb(dev_addr, instance);
+    HostManager::get_instance().connect_cb(HostManager::DriverClass::XINPUT, dev_addr, instance);
 }
 
 void tuh_xinput::xbox360w_disconnect_cb(uint8_t dev_addr, uint8_t instance) {
     uint8_t idx = HostManager::get_instance().get_gamepad_idx(  HostManager::DriverClass::XINPUT, 
                                                                 dev_addr, instance);
     OGXMini::wireless_connected(false, idx);
-    HostManager::get_instance().disconnect_cb(dev_addr, instance);
+    HostManager::get_instance().disconnect_cb(HostManager::DriverClass::XINPUT, dev_addr, instance);
 }
\ No newline at end of file
@@ -0,0 +1,614 @@
+#include <cstring>
+#include <algorithm>
+#include <hardware/sync.h>
+#include <pico/flash.h>
+
+#include "Board/board_api.h"
+#include "Board/ogxm_log.h"
+#include "UserSettings/NVSTool.h"
+
+//CRC-32 (IEEE), nibble table so it doesn't cost a 1K table in RAM
+static constexpr std::array<uint32_t, 16> CRC32_TABLE = []
+{
+    std::array<uint32_t, 16> table{};
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 4; ++bit)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+static inline uint32_t crc32_update(uint32_t crc, const void* data, size_t len)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc = CRC32_TABLE[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = CRC32_TABLE[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return crc;
+}
+
+static inline uint32_t round_up_page(uint32_t len)
+{
+    return (len + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+}
+
+static inline size_t key_length(const char* key)
+{
+    return strnlen(key, NVSTool::KEY_LEN_MAX);
+}
+
+//Feeds the records of a block to a sink, once for the CRC and once to program them
+template <typename Sink>
+static void emit_records(Sink& sink, const NVSTool::Write* writes, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t key_len = static_cast<uint8_t>(key_length(writes[i].key));
+        const uint16_t value_len = static_cast<uint16_t>(writes[i].len);
+        const uint8_t record[] = { key_len, 0xFF, static_cast<uint8_t>(value_len), static_cast<uint8_t>(value_len >> 8) };
+
+        sink(record, sizeof(record));
+        sink(writes[i].key, key_len);
+        sink(writes[i].value, value_len);
+    }
+}
+
+NVSTool::NVSTool()
+{
+    mutex_init(&nvs_mutex_);
+    mount();
+}
+
+uint32_t NVSTool::hash_key(const char* key, size_t key_len)
+{
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < key_len; ++i)
+    {
+        hash = (hash ^ static_cast<uint8_t>(key[i])) * 16777619u;
+    }
+    return hash;
+}
+
+size_t NVSTool::block_length(const Write* writes, size_t count)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        length += sizeof(RecordHeader) + key_length(writes[i].key) + writes[i].len;
+    }
+    return length;
+}
+
+NVSTool::IndexEntry* NVSTool::find(const char* key, size_t key_len, uint32_t hash)
+{
+    for (size_t probe = 0; probe < INDEX_SIZE; ++probe)
+    {
+        IndexEntry& entry = index_[(hash + probe) & (INDEX_SIZE - 1)];
+        if (entry.offset == NO_OFFSET)
+        {
+            return &entry;
+        }
+        if (entry.hash != hash)
+        {
+            continue;
+        }
+        const RecordHeader* record = reinterpret_cast<const RecordHeader*>(flash_ptr(entry.offset));
+        if (record->key_len == key_len && std::memcmp(flash_ptr(entry.offset + sizeof(RecordHeader)), key, key_len) == 0)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool NVSTool::index_record(uint16_t offset, uint32_t seq)
+{
+    const RecordHeader* record = reinterpret_cast<const RecordHeader*>(flash_ptr(offset));
+    const char* key = reinterpret_cast<const char*>(flash_ptr(offset + sizeof(RecordHeader)));
+    const uint32_t hash = hash_key(key, record->key_len);
+
+    IndexEntry* entry = find(key, record->key_len, hash);
+    if (!entry)
+    {
+        return false;
+    }
+    if (entry->offset == NO_OFFSET)
+    {
+        ++stats_.entries;
+    }
+    else if (entry->seq > seq)
+    {
+        return true;
+    }
+    entry->hash = hash;
+    entry->seq = seq;
+    entry->offset = offset;
+    entry->value_len = record->value_len;
+    return true;
+}
+
+//Indexes every intact block in the sector and records how much of it is used, false if there were none
+bool NVSTool::scan_sector(uint8_t sector)
+{
+    const uint32_t sector_offset = sector * FLASH_SECTOR_SIZE;
+    uint32_t pos = 0;
+    bool intact = false;
+
+    while (pos < FLASH_SECTOR_SIZE)
+    {
+        const uint8_t* page = flash_ptr(sector_offset + pos);
+        if (std::all_of(page, page + FLASH_PAGE_SIZE, [](uint8_t byte) { return byte == 0xFF; }))
+        {
+            break;
+        }
+
+        const BlockHeader* header = reinterpret_cast<const BlockHeader*>(page);
+        const uint32_t block_len = sizeof(BlockHeader) + header->length;
+
+        if (header->magic != BLOCK_MAGIC || pos + block_len > FLASH_SECTOR_SIZE ||
+            crc32_update(crc32_update(0, header, offsetof(BlockHeader, crc)), page + sizeof(BlockHeader), header->length) != header->crc)
+        {
+            //Torn or foreign, skip it a page at a time
+            pos += FLASH_PAGE_SIZE;
+            continue;
+        }
+
+        uint32_t record_pos = pos + sizeof(BlockHeader);
+        for (uint8_t i = 0; i < header->count; ++i)
+        {
+            const RecordHeader* record = reinterpret_cast<const RecordHeader*>(flash_ptr(sector_offset + record_pos));
+            const uint32_t record_len = sizeof(RecordHeader) + record->key_len + record->value_len;
+
+            if (record->key_len >= KEY_LEN_MAX || record->value_len > VALUE_LEN_MAX ||
+                record_pos + record_len > pos + block_len)
+            {
+                break;
+            }
+            index_record(static_cast<uint16_t>(sector_offset + record_pos), header->seq);
+            record_pos += record_len;
+        }
+
+        if (header->seq >= next_seq_)
+        {
+            next_seq_ = header->seq + 1;
+            write_sector_ = sector;
+        }
+        intact = true;
+        pos += round_up_page(block_len);
+    }
+    sector_used_[sector] = static_cast<uint16_t>(pos);
+    return intact;
+}
+
+//Copies the old layout's entries into one block in the last sector, then erases the others.
+//Power lost before the block is complete leaves the old layout in place to migrate again,
+//lost after it, mount() erases what's left of the old layout since it has no intact blocks
+bool NVSTool::migrate_legacy()
+{
+    const LegacyEntry* legacy = reinterpret_cast<const LegacyEntry*>(flash_ptr(0));
+    if (std::strncmp(legacy[0].key, LEGACY_INVALID_KEY, KEY_LEN_MAX) != 0)
+    {
+        return false;
+    }
+
+    const uint8_t target = NVS_SECTORS - 1;
+    std::array<Write, MAX_ENTRIES> writes;
+    size_t count = 0;
+    size_t length = 0;
+    uint32_t dropped = 0;
+
+    for (uint32_t i = 1; i < LEGACY_MAX_ENTRIES; ++i)
+    {
+        const LegacyEntry& entry = legacy[i];
+        if (std::strncmp(entry.key, LEGACY_INVALID_KEY, KEY_LEN_MAX) == 0)
+        {
+            break;
+        }
+
+        const Write write{ entry.key, entry.value, VALUE_LEN_MAX };
+        const size_t key_len = key_length(entry.key);
+        const size_t record_len = block_length(&write, 1);
+
+        //The target sector is erased first, so nothing can be copied out of it
+        if (key_len == 0 || key_len >= KEY_LEN_MAX || count == MAX_ENTRIES ||
+            sizeof(BlockHeader) + length + record_len > FLASH_SECTOR_SIZE ||
+            (i + 1) * FLASH_PAGE_SIZE > target * FLASH_SECTOR_SIZE)
+        {
+            ++dropped;
+            continue;
+        }
+        writes[count++] = write;
+        length += record_len;
+    }
+
+    erase_sector(target);
+    write_sector_ = target;
+    if (count && !program_block(writes.data(), count, length))
+    {
+        return false;
+    }
+    for (uint8_t sector = 0; sector < target; ++sector)
+    {
+        erase_sector(sector);
+    }
+
+    OGXM_LOG("NVSTool: migrated %u entries from the old layout, %u dropped\n", static_cast<unsigned>(count), static_cast<unsigned>(dropped));
+    return true;
+}
+
+void NVSTool::mount()
+{
+    index_.fill(IndexEntry());
+    stats_.entries = 0;
+    next_seq_ = 0;
+    write_sector_ = 0;
+
+    std::array<bool, NVS_SECTORS> intact{};
+    for (uint8_t sector = 0; sector < NVS_SECTORS; ++sector)
+    {
+        intact[sector] = scan_sector(sector);
+    }
+
+    if (next_seq_ == 0)
+    {
+        next_seq_ = 1;
+        if (migrate_legacy())
+        {
+            return;
+        }
+
+        //Blank or unreadable
+        for (uint8_t sector = 0; sector < NVS_SECTORS; ++sector)
+        {
+            if (sector_used_[sector])
+            {
+                erase_sector(sector);
+            }
+        }
+        return;
+    }
+
+    //Nothing live in a sector without an intact block, only a torn first block or what's left of the old layout
+    for (uint8_t sector = 0; sector < NVS_SECTORS; ++sector)
+    {
+        if (sector_used_[sector] && !intact[sector])
+        {
+            erase_sector(sector);
+        }
+    }
+
+    //Power was lost between copying the oldest sector forward and erasing it
+    const uint8_t reserve = (write_sector_ + 1) % NVS_SECTORS;
+    if (sector_used_[reserve])
+    {
+        collect(reserve);
+    }
+}
+
+static constexpr uint32_t FLASH_SAFE_TIMEOUT_MS = 100;
+
+//Erases a sector if data is null, otherwise programs a page
+struct FlashOp
+{
+    uint32_t offset;
+    const uint8_t* data;
+};
+
+static void flash_op(void* param)
+{
+    const FlashOp* op = static_cast<const FlashOp*>(param);
+    if (op->data)
+    {
+        flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+    }
+    else
+    {
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+    }
+}
+
+//Pauses core1 while flash is busy, it has to have called flash_safe_execute_core_init.
+//Before core1 is launched, or after disconnect_all has reset it, disabling interrupts is enough.
+//False if core1 is running and can't be paused, flash is untouched and the caller retries later
+static bool run_flash_op(FlashOp& op)
+{
+    if (flash_safe_execute(flash_op, &op, FLASH_SAFE_TIMEOUT_MS) == PICO_OK)
+    {
+        return true;
+    }
+    if (board_api::core1_launched())
+    {
+        return false;
+    }
+    const uint32_t irq_state = save_and_disable_interrupts();
+    flash_op(&op);
+    restore_interrupts(irq_state);
+    return true;
+}
+
+bool NVSTool::erase_sector(uint8_t sector)
+{
+    FlashOp op = { NVS_START_OFFSET + sector * FLASH_SECTOR_SIZE, nullptr };
+    if (!run_flash_op(op))
+    {
+        return false;
+    }
+
+    sector_used_[sector] = 0;
+    ++stats_.sector_erases;
+    return true;
+}
+
+bool NVSTool::program_page(uint32_t offset)
+{
+    FlashOp op = { NVS_START_OFFSET + offset, page_buffer_.data() };
+    if (!run_flash_op(op))
+    {
+        return false;
+    }
+
+    ++stats_.pages_programmed;
+    return true;
+}
+
+//Writes a block at the current write position, caller makes sure it fits
+bool NVSTool::program_block(const Write* writes, size_t count, size_t length)
+{
+    const uint32_t block_offset = write_sector_ * FLASH_SECTOR_SIZE + sector_used_[write_sector_];
+
+    BlockHeader header;
+    header.magic = BLOCK_MAGIC;
+    header.seq = next_seq_++;
+    header.length = static_cast<uint16_t>(length);
+    header.count = static_cast<uint8_t>(count);
+    header.reserved = 0xFF;
+
+    uint32_t crc = crc32_update(0, &header, offsetof(BlockHeader, crc));
+    auto crc_sink = [&crc](const void* data, size_t len) { crc = crc32_update(crc, data, len); };
+    emit_records(crc_sink, writes, count);
+    header.crc = crc;
+
+    size_t fill = 0;
+    uint32_t page_offset = block_offset;
+    bool programmed = true;
+    auto page_sink = [this, &fill, &page_offset, &programmed](const void* data, size_t len)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (len && programmed)
+        {
+            const size_t chunk = std::min(len, FLASH_PAGE_SIZE - fill);
+            std::memcpy(page_buffer_.data() + fill, bytes, chunk);
+            fill += chunk;
+            bytes += chunk;
+            len -= chunk;
+
+            if (fill == FLASH_PAGE_SIZE)
+            {
+                programmed = program_page(page_offset);
+                page_offset += programmed ? FLASH_PAGE_SIZE : 0;
+                fill = 0;
+            }
+        }
+    };
+
+    page_sink(&header, sizeof(header));
+    emit_records(page_sink, writes, count);
+    if (fill && programmed)
+    {
+        std::fill(page_buffer_.begin() + fill, page_buffer_.end(), 0xFF);
+        programmed = program_page(page_offset);
+    }
+    if (!programmed)
+    {
+        //The pages already written are a torn block to skip, the next block starts after them
+        sector_used_[write_sector_] += static_cast<uint16_t>(page_offset - block_offset);
+        return false;
+    }
+
+    sector_used_[write_sector_] += round_up_page(sizeof(BlockHeader) + length);
+    ++stats_.blocks_written;
+
+    //Point the index at the new copies
+    uint32_t record_offset = block_offset + sizeof(BlockHeader);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!index_record(static_cast<uint16_t>(record_offset), header.seq))
+        {
+            return false;
+        }
+        record_offset += sizeof(RecordHeader) + key_length(writes[i].key) + writes[i].len;
+    }
+    return true;
+}
+
+//Copies the sector's live records to the write position and erases it
+bool NVSTool::collect(uint8_t sector)
+{
+    const uint32_t start = sector * FLASH_SECTOR_SIZE;
+    const uint32_t end = start + FLASH_SECTOR_SIZE;
+
+    std::array<Write, MAX_ENTRIES> live;
+    std::array<std::array<char, KEY_LEN_MAX>, MAX_ENTRIES> keys;
+    size_t count = 0;
+
+    for (const IndexEntry& entry : index_)
+    {
+        if (entry.offset == NO_OFFSET || entry.offset < start || entry.offset >= end)
+        {
+            continue;
+        }
+        const RecordHeader* record = reinterpret_cast<const RecordHeader*>(flash_ptr(entry.offset));
+        std::memcpy(keys[count].data(), flash_ptr(entry.offset + sizeof(RecordHeader)), record->key_len);
+        keys[count][record->key_len] = '\0';
+
+        live[count].key = keys[count].data();
+        live[count].value = flash_ptr(entry.offset + sizeof(RecordHeader) + record->key_len);
+        live[count].len = record->value_len;
+        ++count;
+    }
+
+    if (count)
+    {
+        const size_t length = block_length(live.data(), count);
+        if (sector_used_[write_sector_] + round_up_page(sizeof(BlockHeader) + length) > FLASH_SECTOR_SIZE ||
+            !program_block(live.data(), count, length))
+        {
+            return false;
+        }
+    }
+
+    //Refused, nothing in it is live anymore so it's erased the next time around
+    if (!erase_sector(sector))
+    {
+        return false;
+    }
+    ++stats_.sectors_collected;
+    return true;
+}
+
+//Moves into the erased sector and frees the oldest one so there's always one erased
+bool NVSTool::advance()
+{
+    //Still used if its erase was refused last time, its records were already copied forward
+    const uint8_t next_sector = (write_sector_ + 1) % NVS_SECTORS;
+    if (sector_used_[next_sector] && !collect(next_sector))
+    {
+        return false;
+    }
+
+    const uint8_t prev_sector = write_sector_;
+    write_sector_ = next_sector;
+
+    if (!collect((write_sector_ + 1) % NVS_SECTORS))
+    {
+        //Keep appending where we were unless the copy got into the new sector
+        if (!sector_used_[write_sector_])
+        {
+            write_sector_ = prev_sector;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool NVSTool::append(const Write* writes, size_t count)
+{
+    const size_t length = block_length(writes, count);
+    const uint32_t block_len = round_up_page(sizeof(BlockHeader) + length);
+
+    if (block_len > FLASH_SECTOR_SIZE)
+    {
+        return false;
+    }
+
+    //Copying the oldest sector forward can fill most of a new one
+    for (uint8_t attempts = 0; sector_used_[write_sector_] + block_len > FLASH_SECTOR_SIZE; ++attempts)
+    {
+        if (attempts == NVS_SECTORS || !advance())
+        {
+            return false;
+        }
+    }
+    return program_block(writes, count, length);
+}
+
+bool NVSTool::write(const char* key, const void* value, size_t len)
+{
+    Write write{ key, value, len };
+    return write_batch(&write, 1);
+}
+
+bool NVSTool::write_batch(const Write* writes, size_t count)
+{
+    if (count == 0 || count > MAX_ENTRIES)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t key_len = key_length(writes[i].key);
+        if (key_len == 0 || key_len >= KEY_LEN_MAX || writes[i].len > VALUE_LEN_MAX)
+        {
+            return false;
+        }
+    }
+
+    mutex_enter_blocking(&nvs_mutex_);
+    const bool stored = append(writes, count);
+    mutex_exit(&nvs_mutex_);
+    return stored;
+}
+
+bool NVSTool::read(const char* key, void* value, size_t len)
+{
+    const size_t key_len = key_length(key);
+    if (key_len == 0 || key_len >= KEY_LEN_MAX)
+    {
+        return false;
+    }
+
+    mutex_enter_blocking(&nvs_mutex_);
+
+    const IndexEntry* entry = find(key, key_len, hash_key(key, key_len));
+    const bool found = (entry && entry->offset != NO_OFFSET);
+    if (found)
+    {
+        std::memcpy(value, flash_ptr(entry->offset + sizeof(RecordHeader) + key_len), std::min(len, static_cast<size_t>(entry->value_len)));
+    }
+
+    mutex_exit(&nvs_mutex_);
+    return found;
+}
+
+bool NVSTool::erase_all()
+{
+    mutex_enter_blocking(&nvs_mutex_);
+
+    bool erased = true;
+    for (uint8_t sector = 0; sector < NVS_SECTORS; ++sector)
+    {
+        erased = erase_sector(sector) && erased;
+    }
+    if (erased)
+    {
+        index_.fill(IndexEntry());
+        stats_.entries = 0;
+        write_sector_ = 0;
+        next_seq_ = 1;
+    }
+    else
+    {
+        //Some sectors are left, index whatever they still hold
+        mount();
+    }
+
+    mutex_exit(&nvs_mutex_);
+    return erased;
+}
+
+NVSTool::Stats NVSTool::get_stats()
+{
+    mutex_enter_blocking(&nvs_mutex_);
+
+    Stats stats = stats_;
+    stats.free_bytes = 0;
+    for (uint8_t sector = 0; sector < NVS_SECTORS; ++sector)
+    {
+        //The reserve sector is only there for collecting
+        if (sector != (write_sector_ + 1) % NVS_SECTORS)
+        {
+            stats.free_bytes += FLASH_SECTOR_SIZE - sector_used_[sector];
+        }
+    }
+
+    mutex_exit(&nvs_mutex_);
+    return stats;
+}
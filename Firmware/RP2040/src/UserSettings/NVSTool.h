@@ -2,20 +2,44 @@
 #define _NVS_TOOL_H_
 
 #include <cstdint>
+#include <cstddef>
 #include <string>
 #include <array>
-#include <cstring>
 #include <hardware/flash.h>
 #include <pico/mutex.h>
 
 /* Define NVS_SECTORS (number of sectors to allocate to storage) either here or with CMake */
 
+/*  Log structured key/value store. A write appends a block of records with a CRC to the end of the log,
+    the newest copy of a key wins, nothing is erased to update a value. A block is either read back whole
+    or ignored, so all records in a batch are stored together or not at all.
+    The log wraps around NVS_SECTORS, one sector is always kept erased. Moving into it copies the live
+    records out of the oldest sector so that one can be erased. Reads go through a RAM index built at boot.
+    Flash still in the old page per entry layout is migrated into the log on the first boot. */
 class NVSTool
 {
 public:
     static constexpr size_t   KEY_LEN_MAX = 16; //Including null terminator
     static constexpr size_t   VALUE_LEN_MAX = FLASH_PAGE_SIZE - KEY_LEN_MAX;
-    static constexpr uint32_t MAX_ENTRIES = ((NVS_SECTORS * FLASH_SECTOR_SIZE) / FLASH_PAGE_SIZE) - 1;
+    static constexpr uint32_t MAX_ENTRIES = 32;
+
+    struct Write
+    {
+        const char* key;
+        const void* value;
+        size_t len;
+    };
+
+    //Wear since boot
+    struct Stats
+    {
+        uint32_t sector_erases{0};
+        uint32_t pages_programmed{0};
+        uint32_t blocks_written{0};
+        uint32_t sectors_collected{0};
+        uint32_t entries{0};
+        uint32_t free_bytes{0};
+    };
 
     static NVSTool& get_instance()
     {
@@ -23,158 +47,115 @@ public:
         return instance;
     }
 
-    bool write(const std::string& key, const void* value, size_t len)
-    {
-        if (!valid_args(key, len))
-        {
-            return false;
-        }
-
-        mutex_enter_blocking(&nvs_mutex_);
-
-        for (uint32_t i = 1; i < MAX_ENTRIES; ++i) 
-        {
-            Entry* read_entry = get_entry(i);
+    bool write(const char* key, const void* value, size_t len);
+    bool write(const std::string& key, const void* value, size_t len) { return write(key.c_str(), value, len); }
+    //Stores all of them in one block, a power cut leaves either all the old values or all the new ones.
+    //False if core1 is running but can't be paused for flash, nothing new is stored and it can be retried
+    bool write_batch(const Write* writes, size_t count);
 
-            if (!is_valid_entry(read_entry) || std::strcmp(read_entry->key, key.c_str()) == 0)
-            {
-                update_entry(i, key, value, len);
+    //Copies up to len bytes of the stored value, false if the key isn't stored
+    bool read(const char* key, void* value, size_t len);
+    bool read(const std::string& key, void* value, size_t len) { return read(key.c_str(), value, len); }
 
-                mutex_exit(&nvs_mutex_);
-                return true;
-            }
-        }
-
-        mutex_exit(&nvs_mutex_);
-        return false; // No space for new entry
-    }
+    bool erase_all();
+    Stats get_stats();
 
-    bool read(const std::string& key, void* value, size_t len)
-    {
-        if (!valid_args(key, len))
-        {
-            return false;
-        }
-
-        mutex_enter_blocking(&nvs_mutex_);
-
-        for (uint32_t i = 1; i < MAX_ENTRIES; ++i) 
-        {
-            Entry* read_entry = get_entry(i);
-
-            if (std::strcmp(read_entry->key, key.c_str()) == 0)
-            {
-                std::memcpy(value, read_entry->value, len);
-
-                mutex_exit(&nvs_mutex_);
-                return true;
-            }
-            else if (!is_valid_entry(read_entry))
-            {
-                // Key not found
-                break;
-            }
-        }
-
-        mutex_exit(&nvs_mutex_);
-        return false;
-    }
-
-    void erase_all()
-    {
-        mutex_enter_blocking(&nvs_mutex_);
+private:
+    //Host tests reboot and power cycle it against the stubbed flash
+    friend class NVSToolSim;
 
-        for (uint32_t i = 0; i < NVS_SECTORS; ++i) 
-        {
-            flash_range_erase(NVS_START_OFFSET + i * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
-        }
+    NVSTool();
+    ~NVSTool() = default;
+    NVSTool(const NVSTool&) = delete;
+    NVSTool& operator=(const NVSTool&) = delete;
 
-        Entry entry;
+    static_assert(NVS_SECTORS >= 2, "NVSTool needs at least 2 sectors");
 
-        for (uint32_t i = 0; i < MAX_ENTRIES + 1; ++i) 
-        {
-            flash_range_program(NVS_START_OFFSET + i * sizeof(Entry), 
-                                reinterpret_cast<const uint8_t*>(&entry), 
-                                sizeof(Entry));
-        }
+    static constexpr uint32_t NVS_SIZE = FLASH_SECTOR_SIZE * NVS_SECTORS;
+    static constexpr uint32_t NVS_START_OFFSET = PICO_FLASH_SIZE_BYTES - NVS_SIZE;
+    static constexpr uint32_t BLOCK_MAGIC = 0x4B4D5847; //"GXMK"
+    static constexpr uint16_t NO_OFFSET = 0xFFFF;
+    static constexpr size_t   INDEX_SIZE = MAX_ENTRIES * 2;
 
-        mutex_exit(&nvs_mutex_);
-    }
+    static_assert(NVS_SIZE < NO_OFFSET, "NVSTool record offsets are 16 bit");
+    static_assert((INDEX_SIZE & (INDEX_SIZE - 1)) == 0, "NVSTool INDEX_SIZE must be a power of two");
 
-private:
-    NVSTool()
+    #pragma pack(push, 1)
+    //Starts on a page boundary, followed by 'count' records, crc covers everything but itself
+    struct BlockHeader
     {
-        mutex_init(&nvs_mutex_);
-
-        Entry* initial_entry = get_entry(0);
-
-        if (std::strcmp(initial_entry->key, INVALID_KEY) != 0) 
-        {
-            erase_all();
-        }
-    }
+        uint32_t magic;
+        uint32_t seq;
+        uint16_t length; //Records only
+        uint8_t  count;
+        uint8_t  reserved;
+        uint32_t crc;
+    };
+    static_assert(sizeof(BlockHeader) == 16, "NVSTool::BlockHeader size mismatch");
 
-    ~NVSTool() = default;
-    NVSTool(const NVSTool&) = delete;
-    NVSTool& operator=(const NVSTool&) = delete;
+    //Followed by the key without its terminator, then the value
+    struct RecordHeader
+    {
+        uint8_t  key_len;
+        uint8_t  reserved;
+        uint16_t value_len;
+    };
+    static_assert(sizeof(RecordHeader) == 4, "NVSTool::RecordHeader size mismatch");
 
-    struct Entry 
+    //Old layout, a page per entry. Page 0 holds LEGACY_INVALID_KEY, entries follow until the first one that does too.
+    //Values weren't sized, the whole VALUE_LEN_MAX is migrated
+    struct LegacyEntry
     {
         char key[KEY_LEN_MAX];
         uint8_t value[VALUE_LEN_MAX];
-
-        Entry()
-        {
-            std::fill(std::begin(key), std::end(key), '\0');
-            std::strncpy(key, INVALID_KEY, sizeof(key) - 1);
-            std::fill(std::begin(value), std::end(value), 0xFF);
-        }
     };
-    static_assert(sizeof(Entry) == FLASH_PAGE_SIZE, "NVSTool::Entry size mismatch");
+    static_assert(sizeof(LegacyEntry) == FLASH_PAGE_SIZE, "NVSTool::LegacyEntry size mismatch");
+    #pragma pack(pop)
 
-    static constexpr const char INVALID_KEY[KEY_LEN_MAX] = "INVALID";
-    static constexpr uint32_t NVS_START_OFFSET = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE * NVS_SECTORS;
+    static constexpr char LEGACY_INVALID_KEY[] = "INVALID";
+    static constexpr uint32_t LEGACY_MAX_ENTRIES = (NVS_SIZE / FLASH_PAGE_SIZE) - 1;
+
+    struct IndexEntry
+    {
+        uint32_t hash{0};
+        uint32_t seq{0};
+        uint16_t offset{NO_OFFSET}; //Of the RecordHeader from the start of NVS
+        uint16_t value_len{0};
+    };
 
     mutex_t nvs_mutex_;
 
-    inline Entry* get_entry(const uint32_t index) 
-    {
-        return reinterpret_cast<Entry*>(XIP_BASE + NVS_START_OFFSET + index * sizeof(Entry));
-    }
+    std::array<IndexEntry, INDEX_SIZE> index_;
+    std::array<uint16_t, NVS_SECTORS> sector_used_{0}; //Bytes, rounded up to pages
+    uint8_t  write_sector_{0};
+    uint32_t next_seq_{1};
+    Stats    stats_;
 
-    inline bool is_valid_entry(const Entry* entry) 
-    {
-        return std::strcmp(entry->key, INVALID_KEY) != 0;
-    }
+    //Blocks are streamed out a page at a time
+    std::array<uint8_t, FLASH_PAGE_SIZE> page_buffer_;
 
-    inline bool valid_args(const std::string& key, size_t len)
+    static inline const uint8_t* flash_ptr(uint32_t offset)
     {
-        return (key.size() < KEY_LEN_MAX - 1 && len <= sizeof(Entry::value) && std::strcmp(key.c_str(), INVALID_KEY) != 0);
+        return reinterpret_cast<const uint8_t*>(XIP_BASE + NVS_START_OFFSET + offset);
     }
 
-    void update_entry(uint32_t index, const std::string& key, const void* buffer, size_t len)
-    {
-        uint32_t entry_offset = index * sizeof(Entry);
-        uint32_t sector_offset = ((NVS_START_OFFSET + entry_offset) / FLASH_SECTOR_SIZE) * FLASH_SECTOR_SIZE;
-
-        std::array<uint8_t, FLASH_SECTOR_SIZE> sector_buffer;
-        std::memcpy(sector_buffer.data(), reinterpret_cast<const uint8_t*>(XIP_BASE + sector_offset), FLASH_SECTOR_SIZE);
+    static uint32_t hash_key(const char* key, size_t key_len);
+    static size_t block_length(const Write* writes, size_t count);
 
-        flash_range_erase(sector_offset, FLASH_SECTOR_SIZE);
+    void mount();
+    bool migrate_legacy();
+    bool scan_sector(uint8_t sector);
+    bool index_record(uint16_t offset, uint32_t seq);
+    IndexEntry* find(const char* key, size_t key_len, uint32_t hash);
 
-        Entry* entry_to_write = reinterpret_cast<Entry*>(sector_buffer.data() + entry_offset);
+    bool append(const Write* writes, size_t count);
+    bool program_block(const Write* writes, size_t count, size_t length);
+    bool advance();
+    bool collect(uint8_t sector);
 
-        *entry_to_write = Entry();
-        std::strncpy(entry_to_write->key, key.c_str(), key.size());
-        entry_to_write->key[key.size()] = '\0';
-        std::memcpy(entry_to_write->value, buffer, len);
-
-        for (uint32_t i = 0; i < FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE; ++i) 
-        {
-            flash_range_program(sector_offset + i * FLASH_PAGE_SIZE, sector_buffer.data() + i * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE);
-        }
-    }
+    bool erase_sector(uint8_t sector);
+    bool program_page(uint32_t offset);
 
 }; // class NVSTool
 
-#endif // _NVS_TOOL_H_
\ No newline at end of file
+#endif // _NVS_TOOL_H_
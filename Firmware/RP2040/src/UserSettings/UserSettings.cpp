@@ -7,7 +7,9 @@
 
 #include "Board/ogxm_log.h"
 #include "Board/board_api.h"
+#include "TaskQueue/TaskQueue.h"
 #include "UserSettings/UserSettings.h"
+#include "USBDevice/DeviceManager.h"
 
 static constexpr uint32_t BUTTON_COMBO(const uint16_t& buttons, const uint8_t& dpad = 0) {
     return (static_cast<uint32_t>(buttons) << 16) | static_cast<uint32_t>(dpad);
@@ -75,31 +77,6 @@ static constexpr std::array<ComboMap, 9> BUTTON_COMBO_MAP = {{
     { ButtonCombo::PSCLASSIC, DeviceDriverType::PSCLASSIC }
 }};
 
-const std::string UserSettings::INIT_FLAG_KEY()
-{
-    return std::string("init_flag");
-}
-
-const std::string UserSettings::PROFILE_KEY(const uint8_t profile_id)
-{
-    return std::string("profile_") + std::to_string(profile_id);
-}
-
-const std::string UserSettings::ACTIVE_PROFILE_KEY(const uint8_t index)
-{
-    return std::string("active_id_") + std::to_string(index);
-}
-
-const std::string UserSettings::DRIVER_TYPE_KEY()
-{
-    return std::string("driver_type");
-}
-
-const std::string UserSettings::DATETIME_KEY()
-{
-    return std::string("datetime");
-}
-
 DeviceDriverType UserSettings::DEFAULT_DRIVER()
 {
     return VALID_DRIVER_TYPES[0];
@@ -152,7 +129,93 @@ bool UserSettings::check_for_driver_change(Gamepad& gamepad)
     return true;
 }
 
-//Disconnects usb and resets pico, call from core0
+void UserSettings::cache_profile(uint8_t index, const UserProfile& profile)
+{
+    active_ids_[index] = profile.id;
+    active_id_dirty_[index] = true;
+    profiles_[profile.id - 1] = profile;
+    profile_dirty_[profile.id - 1] = true;
+}
+
+//Writes everything that's changed since the last flush as one block
+bool UserSettings::flush()
+{
+    std::array<NVSTool::Write, 1 + MAX_GAMEPADS + MAX_PROFILES> writes;
+    size_t count = 0;
+
+    if (driver_dirty_)
+    {
+        writes[count++] = { DRIVER_TYPE_KEY, &stored_driver_, sizeof(uint8_t) };
+    }
+    for (uint8_t i = 0; i < MAX_GAMEPADS; ++i)
+    {
+        if (active_id_dirty_[i])
+        {
+            writes[count++] = { ACTIVE_PROFILE_KEYS[i].data(), &active_ids_[i], sizeof(uint8_t) };
+        }
+    }
+    for (uint8_t i = 0; i < MAX_PROFILES; ++i)
+    {
+        if (profile_dirty_[i])
+        {
+            writes[count++] = { PROFILE_KEYS[i].data(), &profiles_[i], sizeof(UserProfile) };
+        }
+    }
+
+    if (count == 0)
+    {
+        return true;
+    }
+    if (!nvs_tool_.write_batch(writes.data(), count))
+    {
+        OGXM_LOG("UserSettings: flush failed\n");
+        return false;
+    }
+
+    driver_dirty_ = false;
+    active_id_dirty_.fill(false);
+    profile_dirty_.fill(false);
+    return true;
+}
+
+void UserSettings::attach_gamepads(Gamepad (&gamepads)[MAX_GAMEPADS])
+{
+    gamepads_ = gamepads;
+}
+
+//Stages the profile on every gamepad using it and writes it to flash once changes stop coming in
+void UserSettings::apply_profile(const UserProfile& profile)
+{
+    for (uint8_t i = 0; i < MAX_GAMEPADS; ++i)
+    {
+        if (active_ids_[i] == profile.id)
+        {
+            gamepads_[i].stage_profile(profile);
+        }
+    }
+
+    queue_flush();
+}
+
+//Flushes once changes stop coming in, and again later while flash can't be written
+void UserSettings::queue_flush()
+{
+    if (flush_task_id_ == 0)
+    {
+        flush_task_id_ = TaskQueue::Core0::get_new_task_id();
+    }
+    TaskQueue::Core0::cancel_delayed_task(flush_task_id_);
+    TaskQueue::Core0::queue_delayed_task(flush_task_id_, FLUSH_DELAY_MS, false, 
+    [this]
+    {
+        if (!flush())
+        {
+            queue_flush();
+        }
+    });
+}
+
+//Applied live if gamepads are attached, otherwise disconnects usb and resets pico, call from core0
 bool UserSettings::store_profile(uint8_t index, const UserProfile& profile)
 {
     if (profile.id < 1 || profile.id > MAX_PROFILES)
@@ -164,17 +227,22 @@ bool UserSettings::store_profile(uint8_t index, const UserProfile& profile)
         index = 0;
     }
 
-    board_api::usb::disconnect_all();
+    cache_profile(index, profile);
 
-    nvs_tool_.write(ACTIVE_PROFILE_KEY(index), &profile.id, sizeof(uint8_t));
-    nvs_tool_.write(PROFILE_KEY(profile.id), &profile, sizeof(UserProfile));
+    if (gamepads_ != nullptr && can_write_live())
+    {
+        apply_profile(profile);
+        return true;
+    }
 
+    board_api::usb::disconnect_all();
+    flush();
     board_api::reboot();
 
     return true;
 }
 
-//Disconnects usb and resets pico, call from core0
+//Applied live along with a driver switch where the board supports it, otherwise disconnects usb and resets pico, call from core0
 bool UserSettings::store_profile_and_driver_type(DeviceDriverType new_driver_type, uint8_t index, const UserProfile& profile)
 {
     if (profile.id < 1 || profile.id > MAX_PROFILES)
@@ -185,50 +253,82 @@ bool UserSettings::store_profile_and_driver_type(DeviceDriverType new_driver_typ
     {
         index = 0;
     }
-
-    bool valid_driver = false;
-    for (const auto& driver : VALID_DRIVER_TYPES)
+    if (!is_valid_driver(new_driver_type))
     {
-        if (new_driver_type == driver)
-        {
-            valid_driver = true;
-            break;
-        }
+        new_driver_type = DEFAULT_DRIVER();
     }
-    if (!valid_driver)
+    if (new_driver_type == get_current_driver())
     {
-        new_driver_type = DEFAULT_DRIVER();
+        return store_profile(index, profile);
     }
 
-    board_api::usb::disconnect_all();
+    stored_driver_ = new_driver_type;
+    driver_dirty_ = true;
+    cache_profile(index, profile);
 
-    nvs_tool_.write(DRIVER_TYPE_KEY(), reinterpret_cast<const uint8_t*>(&new_driver_type), sizeof(new_driver_type));
-    nvs_tool_.write(ACTIVE_PROFILE_KEY(index), &profile.id, sizeof(uint8_t));
-    nvs_tool_.write(PROFILE_KEY(profile.id), &profile, sizeof(UserProfile));
-    
+    if (gamepads_ != nullptr && can_write_live() && switch_driver(new_driver_type))
+    {
+        apply_profile(profile);
+        return true;
+    }
+
+    board_api::usb::disconnect_all();
+    flush();
     board_api::reboot();
     
     return true;
 }
 
-//Disconnects usb and resets pico if it's a new & valid mode, call from core0
+//Swaps the device driver in place where it can, otherwise disconnects usb and resets pico, call from core0
 void UserSettings::store_driver_type(DeviceDriverType new_driver) 
 {
     if (!is_valid_driver(new_driver))
     {
-        OGXM_LOG("Invalid driver type detected during store: " + OGXM_TO_STRING(new_driver) + "\n");
+        OGXM_LOG("Invalid driver type detected during store: %i\n", static_cast<int>(new_driver));
         return;
     }
 
-    OGXM_LOG("Storing new driver type: " + OGXM_TO_STRING(new_driver) + "\n");
+    OGXM_LOG("Storing new driver type: %i\n", static_cast<int>(new_driver));
 
-    board_api::usb::disconnect_all();
+    stored_driver_ = new_driver;
+    driver_dirty_ = true;
 
-    nvs_tool_.write(DRIVER_TYPE_KEY(), &new_driver, sizeof(uint8_t));
+    if (can_write_live() && switch_driver(new_driver))
+    {
+        if (!flush())
+        {
+            queue_flush();
+        }
+        return;
+    }
 
+    board_api::usb::disconnect_all();
+    flush();
     board_api::reboot();
 }
 
+//Flash can only be written with core1 running once it lets core0 pause it, until then stores reboot
+bool UserSettings::can_write_live()
+{
+    return !board_api::core1_launched() || multicore_lockout_victim_is_initialized(1);
+}
+
+//False if the running driver can't be swapped out without a reboot
+bool UserSettings::switch_driver(DeviceDriverType new_driver)
+{
+    DeviceManager& device_manager = DeviceManager::get_instance();
+
+    //UART bridge mode is picked at boot by the board, not from flash
+    if (device_manager.get_driver_type() == DeviceDriverType::UART_BRIDGE ||
+        !device_manager.switch_driver(new_driver))
+    {
+        return false;
+    }
+
+    current_driver_ = new_driver;
+    return true;
+}
+
 uint8_t UserSettings::get_active_profile_id(const uint8_t index)
 {
     if (index > MAX_GAMEPADS - 1)
@@ -238,7 +338,16 @@ uint8_t UserSettings::get_active_profile_id(const uint8_t index)
     }
 
     uint8_t read_profile_id = 0;
-    nvs_tool_.read(ACTIVE_PROFILE_KEY(index), &read_profile_id, sizeof(uint8_t));
+    if (cache_loaded_)
+    {
+        ++cache_stats_.hits;
+        read_profile_id = active_ids_[index];
+    }
+    else
+    {
+        ++cache_stats_.misses;
+        nvs_tool_.read(ACTIVE_PROFILE_KEYS[index].data(), &read_profile_id, sizeof(uint8_t));
+    }
 
     if (read_profile_id < 1 || read_profile_id > MAX_PROFILES)
     {
@@ -255,8 +364,22 @@ UserProfile UserSettings::get_profile_by_index(const uint8_t index)
 
 UserProfile UserSettings::get_profile_by_id(const uint8_t profile_id)
 {
+    if (profile_id < 1 || profile_id > MAX_PROFILES)
+    {
+        OGXM_LOG("Invalid profile id, returning default profile\n");
+        return UserProfile();
+    }
+
+    if (cache_loaded_)
+    {
+        ++cache_stats_.hits;
+        return profiles_[profile_id - 1];
+    }
+
+    ++cache_stats_.misses;
+
     UserProfile profile;
-    nvs_tool_.read(PROFILE_KEY(profile_id), &profile, sizeof(UserProfile));
+    nvs_tool_.read(PROFILE_KEYS[profile_id - 1].data(), &profile, sizeof(UserProfile));
 
     if (profile.id != profile_id)
     {
@@ -286,11 +409,20 @@ DeviceDriverType UserSettings::get_current_driver()
     }
 
     uint8_t stored_value = 0;
-    nvs_tool_.read(DRIVER_TYPE_KEY(), &stored_value, sizeof(uint8_t));
+    if (cache_loaded_)
+    {
+        ++cache_stats_.hits;
+        stored_value = static_cast<uint8_t>(stored_driver_);
+    }
+    else
+    {
+        ++cache_stats_.misses;
+        nvs_tool_.read(DRIVER_TYPE_KEY, &stored_value, sizeof(uint8_t));
+    }
 
     if (is_valid_driver(static_cast<DeviceDriverType>(stored_value)))
     {
-        OGXM_LOG("Driver type read from flash: " + OGXM_TO_STRING(static_cast<DeviceDriverType>(stored_value)) + "\n");
+        OGXM_LOG("Driver type read from flash: %i\n", static_cast<int>(stored_value));
 
         current_driver_ = static_cast<DeviceDriverType>(stored_value);
         return current_driver_;
@@ -304,69 +436,97 @@ DeviceDriverType UserSettings::get_current_driver()
 
 void UserSettings::write_datetime()
 {
-    nvs_tool_.write(DATETIME_KEY(), DATETIME_TAG.c_str(), DATETIME_TAG.size() + 1);
+    nvs_tool_.write(DATETIME_KEY, DATETIME_TAG, sizeof(DATETIME_TAG));
 }
 
 bool UserSettings::verify_datetime()
 {
-    char read_dt_tag[DATETIME_TAG.size() + 1] = {0};
+    char read_dt_tag[sizeof(DATETIME_TAG)] = {0};
 
-    if (!nvs_tool_.read(DATETIME_KEY(), read_dt_tag, sizeof(read_dt_tag)) ||
-        (std::strcmp(read_dt_tag, DATETIME_TAG.c_str()) != 0))
+    if (!nvs_tool_.read(DATETIME_KEY, read_dt_tag, sizeof(read_dt_tag)) ||
+        (std::strcmp(read_dt_tag, DATETIME_TAG) != 0))
     {
         return false;
     }
     return true;
 }
 
+//Reads every setting into RAM, profiles that fail to read fall back to defaults
+void UserSettings::load_cache()
+{
+    uint8_t stored_driver = 0;
+    nvs_tool_.read(DRIVER_TYPE_KEY, &stored_driver, sizeof(uint8_t));
+    stored_driver_ = static_cast<DeviceDriverType>(stored_driver);
+
+    for (uint8_t i = 0; i < MAX_GAMEPADS; ++i)
+    {
+        active_ids_[i] = 0;
+        nvs_tool_.read(ACTIVE_PROFILE_KEYS[i].data(), &active_ids_[i], sizeof(uint8_t));
+    }
+
+    for (uint8_t i = 0; i < MAX_PROFILES; ++i)
+    {
+        if (!nvs_tool_.read(PROFILE_KEYS[i].data(), &profiles_[i], sizeof(UserProfile)) ||
+            profiles_[i].id != i + 1)
+        {
+            OGXM_LOG("Profile %i read failed, using default profile\n", i + 1);
+            profiles_[i] = UserProfile();
+            profiles_[i].id = i + 1;
+        }
+    }
+
+    cache_loaded_ = true;
+}
+
 //Checks for first boot and initializes user profiles, call before tusb is inited.
 void UserSettings::initialize_flash()
 {
+    if (cache_loaded_)
+    {
+        return;
+    }
+
     OGXM_LOG("Initializing flash\n");
 
     uint8_t read_init_flag = 0;
-    nvs_tool_.read(INIT_FLAG_KEY(), &read_init_flag, sizeof(uint8_t));
+    nvs_tool_.read(INIT_FLAG_KEY, &read_init_flag, sizeof(uint8_t));
 
     if (read_init_flag == FLASH_INIT_FLAG)
     {
         OGXM_LOG("Flash already initialized: %i\n", read_init_flag);
+        load_cache();
         return;
     }
 
     OGXM_LOG("Flash not initialized, erasing\n");
     nvs_tool_.erase_all();
 
-    OGXM_LOG("Writing default driver\n");
+    OGXM_LOG("Writing defaults, profile size: %i\n", sizeof(UserProfile));
 
-    uint8_t device_mode_buffer = static_cast<uint8_t>(DEFAULT_DRIVER());
-    nvs_tool_.write(DRIVER_TYPE_KEY(), &device_mode_buffer, sizeof(uint8_t));
-
-    OGXM_LOG("Writing default profile ids\n");
+    stored_driver_ = DEFAULT_DRIVER();
+    driver_dirty_ = true;
 
     for (uint8_t i = 0; i < MAX_GAMEPADS; i++)
     {
-        uint8_t profile_id = i + 1;
-        nvs_tool_.write(ACTIVE_PROFILE_KEY(i), &profile_id, sizeof(uint8_t));
+        active_ids_[i] = i + 1;
+        active_id_dirty_[i] = true;
     }
-
-    OGXM_LOG("Writing default profiles\n");
-
+    for (uint8_t i = 0; i < MAX_PROFILES; i++)
     {
-        UserProfile profile;
-        OGXM_LOG("Profile size: %i\n", sizeof(UserProfile));
-
-        for (uint8_t i = 0; i < MAX_PROFILES; i++)
-        {
-            profile.id = i + 1;
-            nvs_tool_.write(PROFILE_KEY(profile.id), &profile, sizeof(UserProfile));
-            OGXM_LOG("Profile " + std::to_string(profile.id) + " written\n");
-        }
+        profiles_[i] = UserProfile();
+        profiles_[i].id = i + 1;
+        profile_dirty_[i] = true;
     }
+    cache_loaded_ = true;
 
-    OGXM_LOG("Writing init flag\n");    
+    //Init flag goes last so an interrupted init is redone on the next boot
+    if (!flush())
+    {
+        return;
+    }
 
-    uint8_t init_flag_buffer = FLASH_INIT_FLAG;
-    nvs_tool_.write(INIT_FLAG_KEY(), &init_flag_buffer, sizeof(uint8_t));
+    const uint8_t init_flag_buffer = FLASH_INIT_FLAG;
+    nvs_tool_.write(INIT_FLAG_KEY, &init_flag_buffer, sizeof(uint8_t));
 
     OGXM_LOG("Flash initialized\n");
-}
\ No newline at end of file
+}
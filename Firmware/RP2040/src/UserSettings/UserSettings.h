@@ -2,7 +2,7 @@
 #define _USER_SETTINGS_H_
 
 #include <cstdint>
-#include <string>
+#include <array>
 
 #include "Board/Config.h"
 #include "USBDevice/DeviceDriver/DeviceDriverTypes.h"
@@ -10,6 +10,31 @@
 #include "UserSettings/NVSTool.h"
 #include "Gamepad/Gamepad.h"
 
+using UserSettingsKey = std::array<char, NVSTool::KEY_LEN_MAX>;
+
+//"<prefix><first>", "<prefix><first + 1>"... built at compile time, ids are 1 or 2 digits
+template <size_t COUNT>
+constexpr std::array<UserSettingsKey, COUNT> make_settings_keys(const char* prefix, uint8_t first)
+{
+    std::array<UserSettingsKey, COUNT> keys{};
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        size_t len = 0;
+        while (prefix[len] != '\0')
+        {
+            keys[i][len] = prefix[len];
+            ++len;
+        }
+        const uint8_t number = static_cast<uint8_t>(first + i);
+        if (number >= 10)
+        {
+            keys[i][len++] = static_cast<char>('0' + number / 10);
+        }
+        keys[i][len] = static_cast<char>('0' + number % 10);
+    }
+    return keys;
+}
+
 /* Only write/store flash from Core0 */
 class UserSettings
 {
@@ -17,6 +42,13 @@ public:
     static constexpr uint8_t MAX_PROFILES = 8;
     static constexpr int32_t GP_CHECK_DELAY_MS = 600;
 
+    //Profile, active id and driver lookups served from RAM vs read from flash
+    struct CacheStats
+    {
+        uint32_t hits{0};
+        uint32_t misses{0};
+    };
+
     static UserSettings& get_instance()
     {
         static UserSettings instance;
@@ -24,6 +56,8 @@ public:
     }
 
     void initialize_flash();
+    //Profiles stored after this are applied to these gamepads live instead of rebooting
+    void attach_gamepads(Gamepad (&gamepads)[MAX_GAMEPADS]);
 
     bool is_valid_driver(DeviceDriverType driver);
     bool verify_datetime();
@@ -40,6 +74,9 @@ public:
     bool store_profile(uint8_t index, const UserProfile& profile);
     bool store_profile_and_driver_type(DeviceDriverType new_driver_type, uint8_t index, const UserProfile& profile);
 
+    CacheStats get_cache_stats() const { return cache_stats_; }
+    NVSTool::Stats get_storage_stats() { return nvs_tool_.get_stats(); }
+
 private:
     UserSettings() = default;
     ~UserSettings() = default;
@@ -48,17 +85,43 @@ private:
 
     static constexpr uint8_t GP_CHECK_COUNT = 3000 / GP_CHECK_DELAY_MS;
     static constexpr uint8_t FLASH_INIT_FLAG = 0xF8;
-    const std::string DATETIME_TAG = BUILD_DATETIME; 
+    static constexpr uint32_t FLUSH_DELAY_MS = 1000; //Coalesces a burst of live profile changes into one write
+    static constexpr char DATETIME_TAG[] = BUILD_DATETIME;
+
+    static constexpr char INIT_FLAG_KEY[] = "init_flag";
+    static constexpr char DRIVER_TYPE_KEY[] = "driver_type";
+    static constexpr char DATETIME_KEY[] = "datetime";
+    static constexpr std::array<UserSettingsKey, MAX_PROFILES> PROFILE_KEYS = make_settings_keys<MAX_PROFILES>("profile_", 1);
+    static constexpr std::array<UserSettingsKey, MAX_GAMEPADS> ACTIVE_PROFILE_KEYS = make_settings_keys<MAX_GAMEPADS>("active_id_", 0);
     
     NVSTool& nvs_tool_{NVSTool::get_instance()};
     DeviceDriverType current_driver_{DeviceDriverType::NONE};
+
+    //Everything UserSettings keeps in flash, loaded once by initialize_flash. 
+    //Stores update it first and mark it dirty, flush() writes the dirty entries in one batch.
+    bool cache_loaded_{false};
+    DeviceDriverType stored_driver_{DeviceDriverType::NONE};
+    std::array<uint8_t, MAX_GAMEPADS> active_ids_{0};
+    std::array<UserProfile, MAX_PROFILES> profiles_;
+
+    bool driver_dirty_{false};
+    std::array<bool, MAX_GAMEPADS> active_id_dirty_{false};
+    std::array<bool, MAX_PROFILES> profile_dirty_{false};
+
+    CacheStats cache_stats_;
+
+    Gamepad* gamepads_{nullptr};
+    uint32_t flush_task_id_{0};
     
     DeviceDriverType DEFAULT_DRIVER();
-    const std::string INIT_FLAG_KEY();
-    const std::string PROFILE_KEY(const uint8_t profile_id);
-    const std::string ACTIVE_PROFILE_KEY(const uint8_t index);
-    const std::string DRIVER_TYPE_KEY();
-    const std::string DATETIME_KEY();
+
+    void load_cache();
+    bool flush();
+    void queue_flush();
+    void cache_profile(uint8_t index, const UserProfile& profile);
+    void apply_profile(const UserProfile& profile);
+    bool switch_driver(DeviceDriverType new_driver);
+    bool can_write_live();
 };
 
 #endif // _USER_SETTINGS_H_
\ No newline at end of file
@@ -114,10 +114,10 @@
 #define CFG_TUD_HID_EP_BUFSIZE 64
 #define CFG_TUD_CDC_EP_BUFSIZE 64
 
-#define CFG_TUD_CDC_TX_BUFSIZE  256
-#define CFG_TUD_CDC_RX_BUFSIZE  256
-// #define CFG_TUD_CDC_TX_BUFSIZE  1024
-// #define CFG_TUD_CDC_RX_BUFSIZE  1024
+// #define CFG_TUD_CDC_TX_BUFSIZE  256
+// #define CFG_TUD_CDC_RX_BUFSIZE  256
+#define CFG_TUD_CDC_TX_BUFSIZE  1024
+#define CFG_TUD_CDC_RX_BUFSIZE  1024
 
 //--------------------------------------------------------------------
 // HOST CONFIGURATION
@@ -0,0 +1,278 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "Gamepad/Gamepad.h"
+#include "Gamepad/ButtonLut.h"
+#include "Descriptors/PS4.h"
+#include "Descriptors/XInput.h"
+#include "UserSettings/UserProfile.h"
+
+/*  Host driver button and dpad translation, ButtonLut and the profile tables in Gamepad against the
+    per bit if-chains and MAP_* members they replaced. Every combination of the PS4 (hat dpad, 3 button
+    bytes) and XInput (bit dpad, 2 button bytes) button bytes is compared with the default profile and a
+    shuffled one, then both are timed on random reports. Fails on any difference.
+    Usage: buttonlut_bench [passes] */
+
+namespace baseline
+{
+    //The Gamepad members set_profile_mappings used to fill
+    struct Mappings
+    {
+        uint8_t MAP_DPAD_UP, MAP_DPAD_DOWN, MAP_DPAD_LEFT, MAP_DPAD_RIGHT;
+        uint8_t MAP_DPAD_UP_LEFT, MAP_DPAD_UP_RIGHT, MAP_DPAD_DOWN_LEFT, MAP_DPAD_DOWN_RIGHT;
+        uint16_t MAP_BUTTON_A, MAP_BUTTON_B, MAP_BUTTON_X, MAP_BUTTON_Y, MAP_BUTTON_L3, MAP_BUTTON_R3;
+        uint16_t MAP_BUTTON_BACK, MAP_BUTTON_START, MAP_BUTTON_LB, MAP_BUTTON_RB, MAP_BUTTON_SYS, MAP_BUTTON_MISC;
+
+        void set_profile_mappings(const UserProfile& profile)
+        {
+            MAP_DPAD_UP         = profile.dpad_up;
+            MAP_DPAD_DOWN       = profile.dpad_down;
+            MAP_DPAD_LEFT       = profile.dpad_left;
+            MAP_DPAD_RIGHT      = profile.dpad_right;
+            MAP_DPAD_UP_LEFT    = profile.dpad_up | profile.dpad_left;
+            MAP_DPAD_UP_RIGHT   = profile.dpad_up | profile.dpad_right;
+            MAP_DPAD_DOWN_LEFT  = profile.dpad_down | profile.dpad_left;
+            MAP_DPAD_DOWN_RIGHT = profile.dpad_down | profile.dpad_right;
+
+            MAP_BUTTON_A     = profile.button_a;
+            MAP_BUTTON_B     = profile.button_b;
+            MAP_BUTTON_X     = profile.button_x;
+            MAP_BUTTON_Y     = profile.button_y;
+            MAP_BUTTON_L3    = profile.button_l3;
+            MAP_BUTTON_R3    = profile.button_r3;
+            MAP_BUTTON_BACK  = profile.button_back;
+            MAP_BUTTON_START = profile.button_start;
+            MAP_BUTTON_LB    = profile.button_lb;
+            MAP_BUTTON_RB    = profile.button_rb;
+            MAP_BUTTON_SYS   = profile.button_sys;
+            MAP_BUTTON_MISC  = profile.button_misc;
+        }
+    };
+
+    static Gamepad::PadIn ps4(const Mappings& gamepad, const uint8_t* buttons)
+    {
+        Gamepad::PadIn gp_in;
+
+        switch (buttons[0] & PS4::DPAD_MASK)
+        {
+            case PS4::Buttons0::DPAD_UP:
+                gp_in.dpad |= gamepad.MAP_DPAD_UP;
+                break;
+            case PS4::Buttons0::DPAD_DOWN:
+                gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
+                break;
+            case PS4::Buttons0::DPAD_LEFT:
+                gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
+                break;
+            case PS4::Buttons0::DPAD_RIGHT:
+                gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;
+                break;
+            case PS4::Buttons0::DPAD_UP_RIGHT:
+                gp_in.dpad |= gamepad.MAP_DPAD_UP_RIGHT;
+                break;
+            case PS4::Buttons0::DPAD_RIGHT_DOWN:
+                gp_in.dpad |= gamepad.MAP_DPAD_DOWN_RIGHT;
+                break;
+            case PS4::Buttons0::DPAD_DOWN_LEFT:
+                gp_in.dpad |= gamepad.MAP_DPAD_DOWN_LEFT;
+                break;
+            case PS4::Buttons0::DPAD_LEFT_UP:
+                gp_in.dpad |= gamepad.MAP_DPAD_UP_LEFT;
+                break;
+            default:
+                break;
+        }
+
+        if (buttons[0] & PS4::Buttons0::SQUARE)   gp_in.buttons |= gamepad.MAP_BUTTON_X;
+        if (buttons[0] & PS4::Buttons0::CROSS)    gp_in.buttons |= gamepad.MAP_BUTTON_A;
+        if (buttons[0] & PS4::Buttons0::CIRCLE)   gp_in.buttons |= gamepad.MAP_BUTTON_B;
+        if (buttons[0] & PS4::Buttons0::TRIANGLE) gp_in.buttons |= gamepad.MAP_BUTTON_Y;
+        if (buttons[1] & PS4::Buttons1::L1)       gp_in.buttons |= gamepad.MAP_BUTTON_LB;
+        if (buttons[1] & PS4::Buttons1::R1)       gp_in.buttons |= gamepad.MAP_BUTTON_RB;
+        if (buttons[1] & PS4::Buttons1::L3)       gp_in.buttons |= gamepad.MAP_BUTTON_L3;
+        if (buttons[1] & PS4::Buttons1::R3)       gp_in.buttons |= gamepad.MAP_BUTTON_R3;
+        if (buttons[1] & PS4::Buttons1::SHARE)    gp_in.buttons |= gamepad.MAP_BUTTON_BACK;
+        if (buttons[1] & PS4::Buttons1::OPTIONS)  gp_in.buttons |= gamepad.MAP_BUTTON_START;
+        if (buttons[2] & PS4::Buttons2::PS)       gp_in.buttons |= gamepad.MAP_BUTTON_SYS;
+        if (buttons[2] & PS4::Buttons2::TP)       gp_in.buttons |= gamepad.MAP_BUTTON_MISC;
+
+        return gp_in;
+    }
+
+    static Gamepad::PadIn xinput(const Mappings& gamepad, const uint8_t* buttons)
+    {
+        Gamepad::PadIn gp_in;
+
+        if (buttons[0] & XInput::Buttons0::DPAD_UP)    gp_in.dpad |= gamepad.MAP_DPAD_UP;
+        if (buttons[0] & XInput::Buttons0::DPAD_DOWN)  gp_in.dpad |= gamepad.MAP_DPAD_DOWN;
+        if (buttons[0] & XInput::Buttons0::DPAD_LEFT)  gp_in.dpad |= gamepad.MAP_DPAD_LEFT;
+        if (buttons[0] & XInput::Buttons0::DPAD_RIGHT) gp_in.dpad |= gamepad.MAP_DPAD_RIGHT;
+
+        if (buttons[0] & XInput::Buttons0::START)  gp_in.buttons |= gamepad.MAP_BUTTON_START;
+        if (buttons[0] & XInput::Buttons0::BACK)   gp_in.buttons |= gamepad.MAP_BUTTON_BACK;
+        if (buttons[0] & XInput::Buttons0::L3)     gp_in.buttons |= gamepad.MAP_BUTTON_L3;
+        if (buttons[0] & XInput::Buttons0::R3)     gp_in.buttons |= gamepad.MAP_BUTTON_R3;
+        if (buttons[1] & XInput::Buttons1::LB)     gp_in.buttons |= gamepad.MAP_BUTTON_LB;
+        if (buttons[1] & XInput::Buttons1::RB)     gp_in.buttons |= gamepad.MAP_BUTTON_RB;
+        if (buttons[1] & XInput::Buttons1::HOME)   gp_in.buttons |= gamepad.MAP_BUTTON_SYS;
+        if (buttons[1] & XInput::Buttons1::A)      gp_in.buttons |= gamepad.MAP_BUTTON_A;
+        if (buttons[1] & XInput::Buttons1::B)      gp_in.buttons |= gamepad.MAP_BUTTON_B;
+        if (buttons[1] & XInput::Buttons1::X)      gp_in.buttons |= gamepad.MAP_BUTTON_X;
+        if (buttons[1] & XInput::Buttons1::Y)      gp_in.buttons |= gamepad.MAP_BUTTON_Y;
+
+        return gp_in;
+    }
+} // namespace baseline
+
+//Same tables as PS4Host and Xbox360Host
+static constexpr auto PS4_BUTTON_LUT = ButtonLut<24>()
+    .map(0, PS4::Buttons0::SQUARE,   Gamepad::BUTTON_X)
+    .map(0, PS4::Buttons0::CROSS,    Gamepad::BUTTON_A)
+    .map(0, PS4::Buttons0::CIRCLE,   Gamepad::BUTTON_B)
+    .map(0, PS4::Buttons0::TRIANGLE, Gamepad::BUTTON_Y)
+    .map(1, PS4::Buttons1::L1,       Gamepad::BUTTON_LB)
+    .map(1, PS4::Buttons1::R1,       Gamepad::BUTTON_RB)
+    .map(1, PS4::Buttons1::L3,       Gamepad::BUTTON_L3)
+    .map(1, PS4::Buttons1::R3,       Gamepad::BUTTON_R3)
+    .map(1, PS4::Buttons1::SHARE,    Gamepad::BUTTON_BACK)
+    .map(1, PS4::Buttons1::OPTIONS,  Gamepad::BUTTON_START)
+    .map(2, PS4::Buttons2::PS,       Gamepad::BUTTON_SYS)
+    .map(2, PS4::Buttons2::TP,       Gamepad::BUTTON_MISC);
+
+static constexpr auto XINPUT_BUTTON_LUT = ButtonLut<16>()
+    .map(0, XInput::Buttons0::START, Gamepad::BUTTON_START)
+    .map(0, XInput::Buttons0::BACK,  Gamepad::BUTTON_BACK)
+    .map(0, XInput::Buttons0::L3,    Gamepad::BUTTON_L3)
+    .map(0, XInput::Buttons0::R3,    Gamepad::BUTTON_R3)
+    .map(1, XInput::Buttons1::LB,    Gamepad::BUTTON_LB)
+    .map(1, XInput::Buttons1::RB,    Gamepad::BUTTON_RB)
+    .map(1, XInput::Buttons1::HOME,  Gamepad::BUTTON_SYS)
+    .map(1, XInput::Buttons1::A,     Gamepad::BUTTON_A)
+    .map(1, XInput::Buttons1::B,     Gamepad::BUTTON_B)
+    .map(1, XInput::Buttons1::X,     Gamepad::BUTTON_X)
+    .map(1, XInput::Buttons1::Y,     Gamepad::BUTTON_Y);
+
+static constexpr auto XINPUT_DPAD_LUT = ButtonLut<8>()
+    .map(XInput::Buttons0::DPAD_UP,    Gamepad::DPAD_UP)
+    .map(XInput::Buttons0::DPAD_DOWN,  Gamepad::DPAD_DOWN)
+    .map(XInput::Buttons0::DPAD_LEFT,  Gamepad::DPAD_LEFT)
+    .map(XInput::Buttons0::DPAD_RIGHT, Gamepad::DPAD_RIGHT);
+
+static Gamepad::PadIn ps4(const Gamepad& gamepad, const uint8_t* buttons)
+{
+    Gamepad::PadIn gp_in;
+    gp_in.dpad = gamepad.map_dpad(Gamepad::hat_to_dpad(buttons[0] & PS4::DPAD_MASK));
+    gp_in.buttons = gamepad.map_buttons(PS4_BUTTON_LUT(buttons));
+    return gp_in;
+}
+
+static Gamepad::PadIn xinput(const Gamepad& gamepad, const uint8_t* buttons)
+{
+    Gamepad::PadIn gp_in;
+    gp_in.dpad = gamepad.map_dpad(XINPUT_DPAD_LUT(buttons[0]));
+    gp_in.buttons = gamepad.map_buttons(XINPUT_BUTTON_LUT(buttons));
+    return gp_in;
+}
+
+//Every button moved to another one, dpad mirrored
+static UserProfile shuffled_profile()
+{
+    UserProfile profile;
+    profile.dpad_up = Gamepad::DPAD_DOWN;
+    profile.dpad_down = Gamepad::DPAD_UP;
+    profile.dpad_left = Gamepad::DPAD_RIGHT;
+    profile.dpad_right = Gamepad::DPAD_LEFT;
+
+    uint16_t* targets[] =
+    {
+        &profile.button_a, &profile.button_b, &profile.button_x, &profile.button_y,
+        &profile.button_l3, &profile.button_r3, &profile.button_back, &profile.button_start,
+        &profile.button_lb, &profile.button_rb, &profile.button_sys, &profile.button_misc
+    };
+    const uint16_t first = *targets[0];
+    for (size_t i = 0; i + 1 < std::size(targets); ++i)
+    {
+        *targets[i] = *targets[i + 1];
+    }
+    *targets[std::size(targets) - 1] = first;
+    return profile;
+}
+
+using OldTranslate = Gamepad::PadIn (*)(const baseline::Mappings&, const uint8_t*);
+using NewTranslate = Gamepad::PadIn (*)(const Gamepad&, const uint8_t*);
+
+//Every value of the button bytes, returns the number that differ
+static uint32_t compare(const baseline::Mappings& mappings, const Gamepad& gamepad, OldTranslate old_translate,
+                        NewTranslate new_translate, size_t bytes)
+{
+    uint32_t differences = 0;
+    for (uint32_t value = 0; value < (1u << (bytes * 8)); ++value)
+    {
+        const uint8_t buttons[3] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value >> 16) };
+        const Gamepad::PadIn old_in = old_translate(mappings, buttons);
+        const Gamepad::PadIn new_in = new_translate(gamepad, buttons);
+        differences += (old_in.dpad != new_in.dpad || old_in.buttons != new_in.buttons) ? 1 : 0;
+    }
+    return differences;
+}
+
+template <typename Translate, typename Source>
+static double ns_per_report(Translate translate, const Source& source, const std::vector<uint8_t>& reports, size_t passes)
+{
+    //Keeps the translation from being optimized away
+    static volatile uint16_t sink = 0;
+    uint16_t acc = sink;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < passes; ++pass)
+    {
+        for (size_t i = 0; i + 3 <= reports.size(); i += 3)
+        {
+            const Gamepad::PadIn gp_in = translate(source, &reports[i]);
+            acc = static_cast<uint16_t>(acc + (gp_in.buttons ^ gp_in.dpad));
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    sink = acc;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(passes * (reports.size() / 3));
+}
+
+int main(int argc, char** argv)
+{
+    const size_t passes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    int failures = 0;
+
+    std::mt19937 rng(1);
+    std::vector<uint8_t> reports(3 * 4096);
+    for (uint8_t& byte : reports)
+    {
+        byte = static_cast<uint8_t>(rng());
+    }
+
+    static Gamepad gamepad;
+    std::printf("%-8s %-9s %12s %10s %10s\n", "format", "profile", "differences", "old ns", "new ns");
+
+    for (int shuffled = 0; shuffled < 2; ++shuffled)
+    {
+        const UserProfile profile = shuffled ? shuffled_profile() : UserProfile();
+        baseline::Mappings mappings;
+        mappings.set_profile_mappings(profile);
+        gamepad.set_profile(profile);
+        const char* profile_name = shuffled ? "shuffled" : "default";
+
+        const uint32_t ps4_diff = compare(mappings, gamepad, baseline::ps4, ps4, 3);
+        std::printf("%-8s %-9s %12u %10.2f %10.2f\n", "PS4", profile_name, ps4_diff,
+                    ns_per_report(baseline::ps4, mappings, reports, passes), ns_per_report(ps4, gamepad, reports, passes));
+
+        const uint32_t xinput_diff = compare(mappings, gamepad, baseline::xinput, xinput, 2);
+        std::printf("%-8s %-9s %12u %10.2f %10.2f\n", "XInput", profile_name, xinput_diff,
+                    ns_per_report(baseline::xinput, mappings, reports, passes), ns_per_report(xinput, gamepad, reports, passes));
+
+        failures += (ps4_diff || xinput_diff) ? 1 : 0;
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,383 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "USBDevice/DeviceDriver/XInput/XInput.h"
+#include "USBDevice/DeviceDriver/PS3/PS3.h"
+#include "USBDevice/DeviceDriver/DInput/DInput.h"
+#include "USBDevice/DeviceDriver/Switch/Switch.h"
+#include "USBDevice/DeviceDriver/PSClassic/PSClassic.h"
+#include "USBDevice/DeviceDriver/XboxOG/XboxOG_GP.h"
+
+#include "stubs.h"
+
+/*  Device driver button and dpad encoding, DPadLut and ButtonLut in each driver against the per driver
+    dpad switches and button if-chains they replaced. Every dpad value and every button mask goes through
+    the driver's process(), the report it hands to TinyUSB is compared byte for byte with the same report
+    with its button and dpad fields rebuilt by the old chain. Sticks and triggers are left centered so the
+    PSClassic stick-to-dpad override stays out of the way. Fails on any difference.
+    Usage: device_lut_test */
+
+namespace baseline
+{
+    static void xinput(XInput::InReport& in_report, const Gamepad::PadIn& gp_in)
+    {
+        in_report.buttons[0] = 0;
+        in_report.buttons[1] = 0;
+
+        switch (gp_in.dpad)
+        {
+            case Gamepad::DPAD_UP:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_UP;
+                break;
+            case Gamepad::DPAD_DOWN:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_DOWN;
+                break;
+            case Gamepad::DPAD_LEFT:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_RIGHT:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_RIGHT;
+                break;
+            case Gamepad::DPAD_UP_LEFT:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_UP | XInput::Buttons0::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_UP_RIGHT:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_UP | XInput::Buttons0::DPAD_RIGHT;
+                break;
+            case Gamepad::DPAD_DOWN_LEFT:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_DOWN | XInput::Buttons0::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_DOWN_RIGHT:
+                in_report.buttons[0] = XInput::Buttons0::DPAD_DOWN | XInput::Buttons0::DPAD_RIGHT;
+                break;
+            default:
+                break;
+        }
+
+        if (gp_in.buttons & Gamepad::BUTTON_BACK)  in_report.buttons[0] |= XInput::Buttons0::BACK;
+        if (gp_in.buttons & Gamepad::BUTTON_START) in_report.buttons[0] |= XInput::Buttons0::START;
+        if (gp_in.buttons & Gamepad::BUTTON_L3)    in_report.buttons[0] |= XInput::Buttons0::L3;
+        if (gp_in.buttons & Gamepad::BUTTON_R3)    in_report.buttons[0] |= XInput::Buttons0::R3;
+
+        if (gp_in.buttons & Gamepad::BUTTON_X)     in_report.buttons[1] |= XInput::Buttons1::X;
+        if (gp_in.buttons & Gamepad::BUTTON_A)     in_report.buttons[1] |= XInput::Buttons1::A;
+        if (gp_in.buttons & Gamepad::BUTTON_Y)     in_report.buttons[1] |= XInput::Buttons1::Y;
+        if (gp_in.buttons & Gamepad::BUTTON_B)     in_report.buttons[1] |= XInput::Buttons1::B;
+        if (gp_in.buttons & Gamepad::BUTTON_LB)    in_report.buttons[1] |= XInput::Buttons1::LB;
+        if (gp_in.buttons & Gamepad::BUTTON_RB)    in_report.buttons[1] |= XInput::Buttons1::RB;
+        if (gp_in.buttons & Gamepad::BUTTON_SYS)   in_report.buttons[1] |= XInput::Buttons1::HOME;
+    }
+
+    static void ps3(PS3::InReport& report_in, const Gamepad::PadIn& gp_in)
+    {
+        //Was reset with the whole report
+        std::memset(report_in.buttons, 0, sizeof(report_in.buttons));
+
+        switch (gp_in.dpad)
+        {
+            case Gamepad::DPAD_UP:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_UP;
+                break;
+            case Gamepad::DPAD_DOWN:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_DOWN;
+                break;
+            case Gamepad::DPAD_LEFT:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_RIGHT:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_RIGHT;
+                break;
+            case Gamepad::DPAD_UP_LEFT:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_UP | PS3::Buttons0::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_UP_RIGHT:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_UP | PS3::Buttons0::DPAD_RIGHT;
+                break;
+            case Gamepad::DPAD_DOWN_LEFT:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_DOWN | PS3::Buttons0::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_DOWN_RIGHT:
+                report_in.buttons[0] = PS3::Buttons0::DPAD_DOWN | PS3::Buttons0::DPAD_RIGHT;
+                break;
+            default:
+                break;
+        }
+
+        if (gp_in.buttons & Gamepad::BUTTON_X)        report_in.buttons[1] |= PS3::Buttons1::SQUARE;
+        if (gp_in.buttons & Gamepad::BUTTON_A)        report_in.buttons[1] |= PS3::Buttons1::CROSS;
+        if (gp_in.buttons & Gamepad::BUTTON_Y)        report_in.buttons[1] |= PS3::Buttons1::TRIANGLE;
+        if (gp_in.buttons & Gamepad::BUTTON_B)        report_in.buttons[1] |= PS3::Buttons1::CIRCLE;
+        if (gp_in.buttons & Gamepad::BUTTON_LB)       report_in.buttons[1] |= PS3::Buttons1::L1;
+        if (gp_in.buttons & Gamepad::BUTTON_RB)       report_in.buttons[1] |= PS3::Buttons1::R1;
+        if (gp_in.buttons & Gamepad::BUTTON_BACK)     report_in.buttons[0] |= PS3::Buttons0::SELECT;
+        if (gp_in.buttons & Gamepad::BUTTON_START)    report_in.buttons[0] |= PS3::Buttons0::START;
+        if (gp_in.buttons & Gamepad::BUTTON_L3)       report_in.buttons[0] |= PS3::Buttons0::L3;
+        if (gp_in.buttons & Gamepad::BUTTON_R3)       report_in.buttons[0] |= PS3::Buttons0::R3;
+        if (gp_in.buttons & Gamepad::BUTTON_SYS)      report_in.buttons[2] |= PS3::Buttons2::SYS;
+        if (gp_in.buttons & Gamepad::BUTTON_MISC)     report_in.buttons[2] |= PS3::Buttons2::TP;
+
+        if (gp_in.trigger_l) report_in.buttons[1] |= PS3::Buttons1::L2;
+        if (gp_in.trigger_r) report_in.buttons[1] |= PS3::Buttons1::R2;
+    }
+
+    static void dinput(DInput::InReport& in_report, const Gamepad::PadIn& gp_in)
+    {
+        switch (gp_in.dpad)
+        {
+            case Gamepad::DPAD_UP:
+                in_report.dpad = DInput::DPad::UP;
+                break;
+            case Gamepad::DPAD_DOWN:
+                in_report.dpad = DInput::DPad::DOWN;
+                break;
+            case Gamepad::DPAD_LEFT:
+                in_report.dpad = DInput::DPad::LEFT;
+                break;
+            case Gamepad::DPAD_RIGHT:
+                in_report.dpad = DInput::DPad::RIGHT;
+                break;
+            case Gamepad::DPAD_UP_LEFT:
+                in_report.dpad = DInput::DPad::UP_LEFT;
+                break;
+            case Gamepad::DPAD_UP_RIGHT:
+                in_report.dpad = DInput::DPad::UP_RIGHT;
+                break;
+            case Gamepad::DPAD_DOWN_LEFT:
+                in_report.dpad = DInput::DPad::DOWN_LEFT;
+                break;
+            case Gamepad::DPAD_DOWN_RIGHT:
+                in_report.dpad = DInput::DPad::DOWN_RIGHT;
+                break;
+            default:
+                in_report.dpad = DInput::DPad::CENTER;
+                break;
+        }
+
+        std::memset(in_report.buttons, 0, sizeof(in_report.buttons));
+
+        if (gp_in.buttons & Gamepad::BUTTON_A)   in_report.buttons[0] |= DInput::Buttons0::CROSS;
+        if (gp_in.buttons & Gamepad::BUTTON_B)   in_report.buttons[0] |= DInput::Buttons0::CIRCLE;
+        if (gp_in.buttons & Gamepad::BUTTON_X)   in_report.buttons[0] |= DInput::Buttons0::SQUARE;
+        if (gp_in.buttons & Gamepad::BUTTON_Y)   in_report.buttons[0] |= DInput::Buttons0::TRIANGLE;
+        if (gp_in.buttons & Gamepad::BUTTON_LB)  in_report.buttons[0] |= DInput::Buttons0::L1;
+        if (gp_in.buttons & Gamepad::BUTTON_RB)  in_report.buttons[0] |= DInput::Buttons0::R1;
+
+        if (gp_in.buttons & Gamepad::BUTTON_L3)    in_report.buttons[1] |= DInput::Buttons1::L3;
+        if (gp_in.buttons & Gamepad::BUTTON_R3)    in_report.buttons[1] |= DInput::Buttons1::R3;
+        if (gp_in.buttons & Gamepad::BUTTON_BACK)  in_report.buttons[1] |= DInput::Buttons1::SELECT;
+        if (gp_in.buttons & Gamepad::BUTTON_START) in_report.buttons[1] |= DInput::Buttons1::START;
+        if (gp_in.buttons & Gamepad::BUTTON_SYS)   in_report.buttons[1] |= DInput::Buttons1::SYS;
+        if (gp_in.buttons & Gamepad::BUTTON_MISC)  in_report.buttons[1] |= DInput::Buttons1::TP;
+    }
+
+    static void switch_wired(SwitchWired::InReport& in_report, const Gamepad::PadIn& gp_in)
+    {
+        switch (gp_in.dpad)
+        {
+            case Gamepad::DPAD_UP:
+                in_report.dpad = SwitchWired::DPad::UP;
+                break;
+            case Gamepad::DPAD_DOWN:
+                in_report.dpad = SwitchWired::DPad::DOWN;
+                break;
+            case Gamepad::DPAD_LEFT:
+                in_report.dpad = SwitchWired::DPad::LEFT;
+                break;
+            case Gamepad::DPAD_RIGHT:
+                in_report.dpad = SwitchWired::DPad::RIGHT;
+                break;
+            case Gamepad::DPAD_UP_LEFT:
+                in_report.dpad = SwitchWired::DPad::UP_LEFT;
+                break;
+            case Gamepad::DPAD_UP_RIGHT:
+                in_report.dpad = SwitchWired::DPad::UP_RIGHT;
+                break;
+            case Gamepad::DPAD_DOWN_LEFT:
+                in_report.dpad = SwitchWired::DPad::DOWN_LEFT;
+                break;
+            case Gamepad::DPAD_DOWN_RIGHT:
+                in_report.dpad = SwitchWired::DPad::DOWN_RIGHT;
+                break;
+            default:
+                in_report.dpad = SwitchWired::DPad::CENTER;
+                break;
+        }
+
+        in_report.buttons = 0;
+
+        if (gp_in.buttons & Gamepad::BUTTON_X)        in_report.buttons |= SwitchWired::Buttons::Y;
+        if (gp_in.buttons & Gamepad::BUTTON_A)        in_report.buttons |= SwitchWired::Buttons::B;
+        if (gp_in.buttons & Gamepad::BUTTON_Y)        in_report.buttons |= SwitchWired::Buttons::X;
+        if (gp_in.buttons & Gamepad::BUTTON_B)        in_report.buttons |= SwitchWired::Buttons::A;
+        if (gp_in.buttons & Gamepad::BUTTON_LB)       in_report.buttons |= SwitchWired::Buttons::L;
+        if (gp_in.buttons & Gamepad::BUTTON_RB)       in_report.buttons |= SwitchWired::Buttons::R;
+        if (gp_in.buttons & Gamepad::BUTTON_BACK)     in_report.buttons |= SwitchWired::Buttons::MINUS;
+        if (gp_in.buttons & Gamepad::BUTTON_START)    in_report.buttons |= SwitchWired::Buttons::PLUS;
+        if (gp_in.buttons & Gamepad::BUTTON_L3)       in_report.buttons |= SwitchWired::Buttons::L3;
+        if (gp_in.buttons & Gamepad::BUTTON_R3)       in_report.buttons |= SwitchWired::Buttons::R3;
+        if (gp_in.buttons & Gamepad::BUTTON_SYS)      in_report.buttons |= SwitchWired::Buttons::HOME;
+        if (gp_in.buttons & Gamepad::BUTTON_MISC)     in_report.buttons |= SwitchWired::Buttons::CAPTURE;
+
+        if (gp_in.trigger_l) in_report.buttons |= SwitchWired::Buttons::ZL;
+        if (gp_in.trigger_r) in_report.buttons |= SwitchWired::Buttons::ZR;
+    }
+
+    static void psclassic(PSClassic::InReport& in_report, const Gamepad::PadIn& gp_in)
+    {
+        switch (gp_in.dpad)
+        {
+            case Gamepad::DPAD_UP:
+                in_report.buttons = PSClassic::Buttons::UP;
+                break;
+            case Gamepad::DPAD_DOWN:
+                in_report.buttons = PSClassic::Buttons::DOWN;
+                break;
+            case Gamepad::DPAD_LEFT:
+                in_report.buttons = PSClassic::Buttons::LEFT;
+                break;
+            case Gamepad::DPAD_RIGHT:
+                in_report.buttons = PSClassic::Buttons::RIGHT;
+                break;
+            case Gamepad::DPAD_UP_LEFT:
+                in_report.buttons = PSClassic::Buttons::UP_LEFT;
+                break;
+            case Gamepad::DPAD_UP_RIGHT:
+                in_report.buttons = PSClassic::Buttons::UP_RIGHT;
+                break;
+            case Gamepad::DPAD_DOWN_LEFT:
+                in_report.buttons = PSClassic::Buttons::DOWN_LEFT;
+                break;
+            case Gamepad::DPAD_DOWN_RIGHT:
+                in_report.buttons = PSClassic::Buttons::DOWN_RIGHT;
+                break;
+            default:
+                in_report.buttons = PSClassic::Buttons::CENTER;
+                break;
+        }
+
+        if (gp_in.buttons & Gamepad::BUTTON_A) in_report.buttons |= PSClassic::Buttons::CROSS;
+        if (gp_in.buttons & Gamepad::BUTTON_B) in_report.buttons |= PSClassic::Buttons::CIRCLE;
+        if (gp_in.buttons & Gamepad::BUTTON_X) in_report.buttons |= PSClassic::Buttons::SQUARE;
+        if (gp_in.buttons & Gamepad::BUTTON_Y) in_report.buttons |= PSClassic::Buttons::TRIANGLE;
+        if (gp_in.buttons & Gamepad::BUTTON_LB)    in_report.buttons |= PSClassic::Buttons::L1;
+        if (gp_in.buttons & Gamepad::BUTTON_RB)    in_report.buttons |= PSClassic::Buttons::R1;
+        if (gp_in.buttons & Gamepad::BUTTON_BACK)  in_report.buttons |= PSClassic::Buttons::SELECT;
+        if (gp_in.buttons & Gamepad::BUTTON_START) in_report.buttons |= PSClassic::Buttons::START;
+
+        if (gp_in.trigger_l) in_report.buttons |= PSClassic::Buttons::L2;
+        if (gp_in.trigger_r) in_report.buttons |= PSClassic::Buttons::R2;
+    }
+
+    static void xboxog(XboxOG::GP::InReport& in_report, const Gamepad::PadIn& gp_in)
+    {
+        in_report.buttons = 0;
+
+        switch (gp_in.dpad)
+        {
+            case Gamepad::DPAD_UP:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_UP;
+                break;
+            case Gamepad::DPAD_DOWN:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_DOWN;
+                break;
+            case Gamepad::DPAD_LEFT:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_RIGHT:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_RIGHT;
+                break;
+            case Gamepad::DPAD_UP_LEFT:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_UP | XboxOG::GP::Buttons::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_UP_RIGHT:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_UP | XboxOG::GP::Buttons::DPAD_RIGHT;
+                break;
+            case Gamepad::DPAD_DOWN_LEFT:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_DOWN | XboxOG::GP::Buttons::DPAD_LEFT;
+                break;
+            case Gamepad::DPAD_DOWN_RIGHT:
+                in_report.buttons = XboxOG::GP::Buttons::DPAD_DOWN | XboxOG::GP::Buttons::DPAD_RIGHT;
+                break;
+            default:
+                break;
+        }
+
+        if (gp_in.buttons & Gamepad::BUTTON_BACK)     in_report.buttons |= XboxOG::GP::Buttons::BACK;
+        if (gp_in.buttons & Gamepad::BUTTON_START)    in_report.buttons |= XboxOG::GP::Buttons::START;
+        if (gp_in.buttons & Gamepad::BUTTON_L3)       in_report.buttons |= XboxOG::GP::Buttons::L3;
+        if (gp_in.buttons & Gamepad::BUTTON_R3)       in_report.buttons |= XboxOG::GP::Buttons::R3;
+    }
+} // namespace baseline
+
+static constexpr uint8_t IDX = 0;
+
+//Every dpad value (opposing directions included) and every button mask, returns the number of reports that differ.
+//A driver only hands over a report that changed, so one it holds back must match the last one it sent.
+template <typename Device, typename Report>
+static uint32_t compare(void (*old_encode)(Report&, const Gamepad::PadIn&), uint32_t& reports)
+{
+    static Gamepad gamepad;
+    gamepad.set_profile(UserProfile());
+    gamepad.reset_pad_in();
+
+    Device device;
+    device.initialize();
+    stubs::reset_transfers();
+
+    //Every button held first, so the all released report that starts the sweep differs from what was last sent
+    Gamepad::PadIn prime;
+    prime.buttons = 0xFFFF;
+    gamepad.set_pad_in(prime);
+    device.process(IDX, gamepad);
+
+    uint32_t differences = 0;
+    for (uint32_t dpad = 0; dpad < 16; ++dpad)
+    {
+        for (uint32_t buttons = 0; buttons <= 0xFFFF; ++buttons)
+        {
+            Gamepad::PadIn gp_in;
+            gp_in.dpad = static_cast<uint8_t>(dpad);
+            gp_in.buttons = static_cast<uint16_t>(buttons);
+            gamepad.set_pad_in(gp_in);
+            device.process(IDX, gamepad);
+
+            const stubs::Transfer& transfer = stubs::device_in(IDX);
+            Report expected;
+            std::memcpy(&expected, transfer.data.data(), sizeof(Report));
+            old_encode(expected, gp_in);
+
+            differences += std::memcmp(&expected, transfer.data.data(), sizeof(Report)) ? 1 : 0;
+        }
+    }
+    reports = stubs::device_in(IDX).count;
+    return differences;
+}
+
+static int failures_ = 0;
+
+template <typename Device, typename Report>
+static void check(const char* name, void (*old_encode)(Report&, const Gamepad::PadIn&))
+{
+    uint32_t reports = 0;
+    const uint32_t differences = compare<Device>(old_encode, reports);
+    const bool failed = (differences > 0) || (reports == 0);
+    std::printf("%-10s %10u %12u %s\n", name, reports, differences, failed ? "FAIL" : "");
+    failures_ += failed ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    stubs::set_device_ready(true);
+    std::printf("%-10s %10s %12s\n", "driver", "reports", "differences");
+
+    check<XInputDevice>("XInput", baseline::xinput);
+    check<PS3Device>("PS3", baseline::ps3);
+    check<DInputDevice>("DInput", baseline::dinput);
+    check<SwitchDevice>("Switch", baseline::switch_wired);
+    check<PSClassicDevice>("PSClassic", baseline::psclassic);
+    check<XboxOGDevice>("XboxOG", baseline::xboxog);
+
+    return failures_ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <array>
+#include <tuple>
+
+#include <pico/platform.h>
+
+#include "Gamepad/Gamepad.h"
+#include "UserSettings/UserProfile.h"
+
+/*  Live profile swap stress test. One thread plays core0 staging two profiles in turn, the other plays
+    the host core mapping reports the way host drivers do, set_pad_in swapping at the report boundary.
+    Every report's buttons, dpad, stick and trigger must all come from one of the two profiles, a report
+    that matches neither saw mixed or half compiled settings.
+    Usage: gamepad_profile_test [stages] */
+
+static constexpr size_t NUM_INPUTS = 8;
+
+struct Input
+{
+    uint16_t buttons;
+    uint8_t dpad;
+    int16_t joy_x;
+    int16_t joy_y;
+    uint8_t trigger;
+};
+
+struct Output
+{
+    uint16_t buttons;
+    uint8_t dpad;
+    int16_t joy_x;
+    int16_t joy_y;
+    uint8_t trigger;
+
+    bool operator==(const Output& other) const
+    {
+        return buttons == other.buttons && dpad == other.dpad && joy_x == other.joy_x &&
+               joy_y == other.joy_y && trigger == other.trigger;
+    }
+};
+
+static const std::array<Input, NUM_INPUTS> INPUTS =
+{{
+    { Gamepad::BUTTON_A,                     Gamepad::DPAD_UP,    4000,   -4000,  20 },
+    { Gamepad::BUTTON_B | Gamepad::BUTTON_X, Gamepad::DPAD_LEFT,  12000,  3000,   60 },
+    { Gamepad::BUTTON_Y,                     Gamepad::DPAD_DOWN,  -20000, 20000,  100 },
+    { Gamepad::BUTTON_LB | Gamepad::BUTTON_RB, Gamepad::DPAD_RIGHT, 30000, -30000, 140 },
+    { Gamepad::BUTTON_START,                 Gamepad::DPAD_UP | Gamepad::DPAD_LEFT, 8000, 8000, 180 },
+    { Gamepad::BUTTON_BACK | Gamepad::BUTTON_SYS, 0,               -6000,  -6000,  220 },
+    { Gamepad::BUTTON_L3 | Gamepad::BUTTON_R3, Gamepad::DPAD_DOWN | Gamepad::DPAD_RIGHT, 0, 16000, 250 },
+    { Gamepad::BUTTON_MISC,                  0,                   2000,   -25000, 5 },
+}};
+
+//Mapping and shaping as a host driver does it
+static Output map(const Gamepad& gamepad, const Input& input)
+{
+    Output output;
+    output.buttons = gamepad.map_buttons(input.buttons);
+    output.dpad = gamepad.map_dpad(input.dpad);
+    std::tie(output.joy_x, output.joy_y) = gamepad.scale_joystick_l(input.joy_x, input.joy_y);
+    output.trigger = gamepad.scale_trigger_l(input.trigger);
+    return output;
+}
+
+static UserProfile profile_a()
+{
+    UserProfile profile;
+    profile.joystick_settings_l.dz_inner = fix16_from_float(0.1f);
+    profile.trigger_settings_l.dz_inner = fix16_from_float(0.1f);
+    return profile;
+}
+
+//Every button, dpad direction and setting differs from profile_a
+static UserProfile profile_b()
+{
+    UserProfile profile;
+    profile.dpad_up = Gamepad::DPAD_DOWN;
+    profile.dpad_down = Gamepad::DPAD_UP;
+    profile.dpad_left = Gamepad::DPAD_RIGHT;
+    profile.dpad_right = Gamepad::DPAD_LEFT;
+
+    uint16_t* targets[] =
+    {
+        &profile.button_a, &profile.button_b, &profile.button_x, &profile.button_y,
+        &profile.button_l3, &profile.button_r3, &profile.button_back, &profile.button_start,
+        &profile.button_lb, &profile.button_rb, &profile.button_sys, &profile.button_misc
+    };
+    const uint16_t first = *targets[0];
+    for (size_t i = 0; i + 1 < std::size(targets); ++i)
+    {
+        *targets[i] = *targets[i + 1];
+    }
+    *targets[std::size(targets) - 1] = first;
+
+    profile.joystick_settings_l.dz_inner = fix16_from_float(0.05f);
+    profile.joystick_settings_l.curve = fix16_from_int(2);
+    profile.trigger_settings_l.dz_inner = fix16_from_float(0.3f);
+    return profile;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t stages = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 20000;
+
+    const UserProfile profiles[2] = { profile_a(), profile_b() };
+    std::array<Output, NUM_INPUTS> expected[2];
+    {
+        static Gamepad reference;
+        for (size_t p = 0; p < 2; ++p)
+        {
+            reference.set_profile(profiles[p]);
+            for (size_t i = 0; i < NUM_INPUTS; ++i)
+            {
+                expected[p][i] = map(reference, INPUTS[i]);
+            }
+        }
+    }
+    uint32_t same = 0;
+    for (size_t i = 0; i < NUM_INPUTS; ++i)
+    {
+        same += (expected[0][i] == expected[1][i]) ? 1 : 0;
+    }
+
+    static Gamepad gamepad;
+    gamepad.set_profile(profiles[0]);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> reports{0};
+    uint64_t mixed = 0;
+    uint64_t swaps = 0;
+
+    std::thread host([&]
+    {
+        stub_core_num = 1;
+        int last = 0;
+        auto report = [&]
+        {
+            const uint64_t n = reports.load(std::memory_order_relaxed);
+            const size_t i = n % NUM_INPUTS;
+            Gamepad::PadIn pad_in;
+            pad_in.buttons = static_cast<uint16_t>(n);
+            gamepad.set_pad_in(pad_in);
+
+            const Output output = map(gamepad, INPUTS[i]);
+            const int matched = (output == expected[0][i]) ? 0 : (output == expected[1][i]) ? 1 : -1;
+            mixed += (matched < 0) ? 1 : 0;
+            swaps += (matched >= 0 && matched != last) ? 1 : 0;
+            last = (matched < 0) ? last : matched;
+            reports.store(n + 1, std::memory_order_relaxed);
+            return matched;
+        };
+
+        while (!done.load())
+        {
+            report();
+            //Stages and reports have to interleave on a single CPU too
+            std::this_thread::yield();
+        }
+        //The last staged profile is the one every report after it uses
+        for (size_t i = 0; i < NUM_INPUTS; ++i)
+        {
+            mixed += (report() != static_cast<int>(stages & 1)) ? 1 : 0;
+        }
+    });
+
+    for (uint32_t n = 1; n <= stages; ++n)
+    {
+        gamepad.stage_profile(profiles[n & 1]);
+
+        //Let a report or two through, most stages land on a host mid report instead of replacing the last one
+        const uint64_t seen = reports.load(std::memory_order_relaxed);
+        while (reports.load(std::memory_order_relaxed) < seen + 1 + (n % 2))
+        {
+            std::this_thread::yield();
+        }
+    }
+    done.store(true);
+    host.join();
+
+    std::printf("Profile swap: %u stages, %llu reports, %llu swaps seen, %llu mixed\n", stages,
+                static_cast<unsigned long long>(reports.load()), static_cast<unsigned long long>(swaps),
+                static_cast<unsigned long long>(mixed));
+
+    bool ok = true;
+    if (same)
+    {
+        std::printf("FAIL: %u inputs map the same under both profiles\n", same);
+        ok = false;
+    }
+    if (!swaps)
+    {
+        std::printf("FAIL: no staged profile was swapped in\n");
+        ok = false;
+    }
+    if (mixed)
+    {
+        std::printf("FAIL: reports mapped with mixed settings\n");
+        ok = false;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
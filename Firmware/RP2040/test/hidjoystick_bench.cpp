@@ -0,0 +1,327 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <new>
+
+#include "USBHost/HIDParser/HIDJoystick.h"
+#include "USBHost/HIDParser/HIDUtils.h"
+#include "Descriptors/DInput.h"
+#include "Descriptors/PS3.h"
+#include "Descriptors/PSClassic.h"
+#include "Descriptors/SwitchWired.h"
+
+/*  HIDJoystick::parseData against the descriptor walking parser it replaced, on real and synthetic
+    generic HID descriptors with random reports, short ones included. Where the descriptor has none of
+    the cases the plan handles differently on purpose (signed fields, axes that overflowed int32 scaling,
+    buttons past MAX_BUTTONS) every field must match. Reports ns per report for both and fails if
+    parseData allocates.
+    Usage: hidjoystick_bench [passes] */
+
+static std::atomic<uint64_t> allocations_{0};
+
+void* operator new(size_t size)
+{
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace baseline
+{
+    //Clamped like the plan does, the old parser let values outside the logical range wrap around
+    static int32_t mapValue(int32_t value, int32_t in_min, int32_t in_max, int32_t out_min, int32_t out_max)
+    {
+        return std::clamp((value - in_min) * (out_max - out_min) / (in_max - in_min) + out_min, out_min, out_max);
+    }
+
+    class HIDJoystick
+    {
+    public:
+        HIDJoystick(const HIDReportDescriptor &descriptor)
+        {
+            this->m_reports = descriptor.GetReports();
+        }
+
+        bool parseData(uint8_t *data, uint16_t datalen, HIDJoystickData *joystick_data)
+        {
+            bool found = false;
+            uint8_t joystick_count = 0;
+
+            for (uint32_t i = 0; i < this->m_reports.size(); i++)
+            {
+                auto report = this->m_reports[i];
+
+                if (report.report_type != HIDIOReportType::Joystick && report.report_type != HIDIOReportType::GamePad)
+                    continue;
+
+                joystick_count += 1;
+
+                for (auto ioblock : report.inputs)
+                {
+                    uint32_t bitOffset = 0;
+
+                    for (auto input : ioblock.data)
+                    {
+                        uint32_t value = HIDUtils::readBitsLE(data, bitOffset, input.size);
+                        bitOffset += input.size;
+
+                        if (bitOffset > (datalen * (uint32_t)8))
+                            return false; // Out of range
+
+                        if (input.type == HIDIOType::ReportId)
+                        {
+                            if (value != input.id)
+                                break; // Not the correct report id
+                        }
+
+                        found = true;
+                        joystick_data->index = joystick_count - 1;
+
+                        if (input.type == HIDIOType::Button)
+                        {
+                            if (input.id >= MAX_BUTTONS)
+                                return false;
+
+                            joystick_data->buttons[input.id] = value;
+                            if (joystick_data->button_count < input.id)
+                                joystick_data->button_count = input.id;
+                        }
+                        else if (input.type == HIDIOType::X)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_X;
+                            joystick_data->X = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Y)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Y;
+                            joystick_data->Y = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Z)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Z;
+                            joystick_data->Z = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Rx)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Rx;
+                            joystick_data->Rx = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Ry)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Ry;
+                            joystick_data->Ry = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Rz)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Rz;
+                            joystick_data->Rz = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Slider)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Slider;
+                            joystick_data->Slider = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::Dial)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_Dial;
+                            joystick_data->Dial = mapValue(value, input.logical_min, input.logical_max, -32768, 32767);
+                        }
+                        else if (input.type == HIDIOType::HatSwitch)
+                        {
+                            joystick_data->support |= JOYSTICK_SUPPORT_HatSwitch;
+                            joystick_data->hat_switch = (HIDJoystickHatSwitch)value;
+                        }
+                    }
+
+                    if (found)
+                        return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        std::vector<HIDIOReport> m_reports;
+    };
+} // namespace baseline
+
+//Generic pad, no report ID: 4 8-bit axes, hat, 12 buttons and vendor bytes
+static const uint8_t GENERIC_VENDOR[] =
+{
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00,
+    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x75, 0x08, 0x95, 0x04, 0x81, 0x02, 0x25, 0x07,
+    0x46, 0x3B, 0x01, 0x75, 0x04, 0x95, 0x01, 0x65, 0x14, 0x09, 0x39, 0x81, 0x42, 0x65, 0x00, 0x05,
+    0x09, 0x19, 0x01, 0x29, 0x0C, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x0C, 0x81, 0x02, 0x06,
+    0x00, 0xFF, 0x09, 0x20, 0x75, 0x08, 0x95, 0x02, 0x81, 0x02, 0xC0
+};
+
+//13 buttons, hat 1 to 8, 10-bit axes that don't start on a byte
+static const uint8_t GENERIC_10BIT[] =
+{
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x05, 0x09, 0x19, 0x01, 0x29, 0x0D, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x0D, 0x81, 0x02, 0x05, 0x01, 0x15, 0x01, 0x25, 0x08, 0x75, 0x03, 0x95, 0x01,
+    0x09, 0x39, 0x81, 0x42, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x75, 0x0A, 0x95, 0x04, 0x09, 0x30, 0x09,
+    0x31, 0x09, 0x32, 0x09, 0x35, 0x81, 0x02, 0xC0
+};
+
+//Report IDs 1 and 2, 16-bit axes 0 to 1023 and signed 8-bit axes
+static const uint8_t GENERIC_REPORT_IDS[] =
+{
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x85, 0x01, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x09, 0x30, 0x09,
+    0x31, 0x75, 0x10, 0x95, 0x02, 0x81, 0x02, 0x05, 0x09, 0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25,
+    0x01, 0x75, 0x01, 0x95, 0x10, 0x81, 0x02, 0x85, 0x02, 0x05, 0x01, 0x15, 0x81, 0x25, 0x7F, 0x09,
+    0x33, 0x09, 0x34, 0x75, 0x08, 0x95, 0x02, 0x81, 0x02, 0xC0
+};
+
+//32 buttons and full range 16-bit axes
+static const uint8_t GENERIC_WIDE[] =
+{
+    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x05, 0x09, 0x19, 0x01, 0x29, 0x20, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x20, 0x81, 0x02, 0x05, 0x01, 0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x09,
+    0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x75, 0x10, 0x95, 0x04, 0x81, 0x02, 0xC0
+};
+
+//32 buttons and 24 axes, more fields than the plan holds
+static const uint8_t GENERIC_TRUNCATED[] =
+{
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x05, 0x09, 0x19, 0x01, 0x29, 0x20, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x20, 0x81, 0x02, 0x05, 0x01, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x09, 0x30, 0x09,
+    0x31, 0x09, 0x32, 0x09, 0x33, 0x09, 0x34, 0x09, 0x35, 0x09, 0x36, 0x09, 0x37, 0x75, 0x08, 0x95,
+    0x18, 0x81, 0x02, 0xC0
+};
+
+struct Descriptor
+{
+    const char* name;
+    const uint8_t* data;
+    uint16_t len;
+    bool compare;
+};
+
+static constexpr size_t REPORTS = 20000;
+static constexpr size_t REPORT_SIZE = 64;
+
+struct Report
+{
+    uint8_t data[REPORT_SIZE];
+    uint16_t len;
+};
+
+//The old parser could set index on a report it then rejected, nothing reads it after a failed parse
+static bool same(bool ok_a, const HIDJoystickData& a, bool ok_b, const HIDJoystickData& b)
+{
+    return ok_a == ok_b && (!ok_a || a.index == b.index) && a.support == b.support &&
+           a.X == b.X && a.Y == b.Y && a.Z == b.Z && a.Rx == b.Rx && a.Ry == b.Ry && a.Rz == b.Rz &&
+           a.Slider == b.Slider && a.Dial == b.Dial && a.hat_switch == b.hat_switch &&
+           a.button_count == b.button_count && std::memcmp(a.buttons, b.buttons, sizeof(a.buttons)) == 0;
+}
+
+template <typename Parser>
+static double ns_per_report(Parser& parser, std::vector<Report>& reports, size_t passes, uint32_t& parsed)
+{
+    HIDJoystickData data;
+    parsed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < passes; ++pass)
+    {
+        for (Report& report : reports)
+        {
+            parsed += parser.parseData(report.data, report.len, &data) ? 1 : 0;
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(passes * reports.size());
+}
+
+int main(int argc, char** argv)
+{
+    const size_t passes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 50;
+    int failures = 0;
+
+    const Descriptor descriptors[] =
+    {
+        { "DInput",         DInput::REPORT_DESCRIPTORS,      sizeof(DInput::REPORT_DESCRIPTORS),      true  },
+        { "PS3",            PS3::REPORT_DESCRIPTORS,         sizeof(PS3::REPORT_DESCRIPTORS),         true  },
+        { "PSClassic",      PSClassic::REPORT_DESCRIPTORS,   sizeof(PSClassic::REPORT_DESCRIPTORS),   true  },
+        { "SwitchWired",    SwitchWired::REPORT_DESCRIPTORS, sizeof(SwitchWired::REPORT_DESCRIPTORS), true  },
+        { "generic_vendor", GENERIC_VENDOR,                  sizeof(GENERIC_VENDOR),                  true  },
+        { "generic_10bit",  GENERIC_10BIT,                   sizeof(GENERIC_10BIT),                   true  },
+        { "generic_ids",    GENERIC_REPORT_IDS,              sizeof(GENERIC_REPORT_IDS),              false },
+        { "generic_wide",   GENERIC_WIDE,                    sizeof(GENERIC_WIDE),                    false },
+        { "generic_trunc",  GENERIC_TRUNCATED,               sizeof(GENERIC_TRUNCATED),               false },
+    };
+
+    std::printf("%-16s %10s %10s %10s %10s %12s\n", "descriptor", "parsed", "mismatch", "old ns", "new ns", "allocs/rep");
+
+    for (const Descriptor& desc : descriptors)
+    {
+        HIDReportDescriptor report_desc(desc.data, desc.len);
+        baseline::HIDJoystick old_parser(report_desc);
+        HIDJoystick new_parser(report_desc);
+
+        //Random contents, one in eight short, the first byte usually a valid report ID
+        std::mt19937 rng(1);
+        std::vector<Report> reports(REPORTS);
+        for (Report& report : reports)
+        {
+            for (uint8_t& byte : report.data)
+            {
+                byte = static_cast<uint8_t>(rng());
+            }
+            if ((rng() % 4) != 0)
+            {
+                report.data[0] = static_cast<uint8_t>(1 + rng() % 2);
+            }
+            report.len = static_cast<uint16_t>(((rng() % 8) == 0) ? (rng() % 16) : (16 + rng() % (REPORT_SIZE - 16)));
+        }
+
+        uint32_t mismatches = 0;
+        if (desc.compare)
+        {
+            for (Report& report : reports)
+            {
+                HIDJoystickData old_data;
+                HIDJoystickData new_data;
+                const bool old_ok = old_parser.parseData(report.data, report.len, &old_data);
+                const bool new_ok = new_parser.parseData(report.data, report.len, &new_data);
+                mismatches += same(old_ok, old_data, new_ok, new_data) ? 0 : 1;
+            }
+        }
+
+        uint32_t old_parsed = 0;
+        uint32_t new_parsed = 0;
+        const double old_ns = ns_per_report(old_parser, reports, passes, old_parsed);
+        const uint64_t allocations = allocations_.load();
+        const double new_ns = ns_per_report(new_parser, reports, passes, new_parsed);
+        const double allocs = static_cast<double>(allocations_.load() - allocations) / static_cast<double>(passes * REPORTS);
+
+        const bool failed = (mismatches > 0) || (allocs > 0) || (new_parsed == 0);
+        std::printf("%-16s %10u %10s %10.1f %10.1f %12.3f %s\n",
+                    desc.name, new_parsed / static_cast<uint32_t>(passes),
+                    desc.compare ? std::to_string(mismatches).c_str() : "-", old_ns, new_ns, allocs, failed ? "FAIL" : "");
+        failures += failed ? 1 : 0;
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
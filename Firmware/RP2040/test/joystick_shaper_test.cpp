@@ -0,0 +1,446 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Gamepad/Range.h"
+#include "Gamepad/fix16ext.h"
+#include "Gamepad/JoystickShaper.h"
+#include "UserSettings/JoystickSettings.h"
+
+/*  Compares JoystickShaper against the per report Fix16 math it replaced, Gamepad::apply_joystick_settings
+    as it was before the shaper, calling the shipping fix16::pow, over every int16 stick position for a set of
+    profiles. Both depend on each axis only through its magnitude and sign, so one quadrant plus the -32768
+    edge covers the full grid. invert_y only flips y before anything else, that pass runs on every 61st row.
+    Every point is compared against that fix16::pow output and must land within 1 LSB, except where the
+    shaper's curve and fix16::pow disagree for the point's base. That's a deliberate change: fix16::pow goes
+    through fix16_exp and fix16_log, which are off by up to thousands of Q16.16 LSB for small bases, while the
+    shaper's curve is within 1 Q16.16 LSB of a correctly rounded pow, checked over every base up to 2.0.
+    At those points the old math runs again on the shaper's curve and must match within 1 LSB, so only the
+    curve moves the output. How many points that is and how far they land from fix16::pow is reported.
+    Usage: joystick_shaper_test [stride] [profile], stride 1 (the default) is exhaustive */
+
+namespace baseline
+{
+    static std::pair<int16_t, int16_t> apply_joystick_settings(
+        int16_t gp_joy_x, 
+        int16_t gp_joy_y, 
+            const JoystickSettings& set,
+        bool invert_y,
+        Fix16 (*pow)(Fix16, Fix16))
+    {
+        static const Fix16 
+            FIX_0(0.0f),
+            FIX_1(1.0f),
+            FIX_2(2.0f),
+            FIX_45(45.0f),
+            FIX_90(90.0f),
+            FIX_100(100.0f),
+            FIX_180(180.0f),
+            FIX_EPSILON(0.0001f),
+            FIX_EPSILON2(0.001f),
+            FIX_ELLIPSE_DEF(1.570796f),
+            FIX_DIAG_DIVISOR(0.29289f);
+
+        Fix16 x = (set.invert_x ? Fix16(Range::invert(gp_joy_x)) : Fix16(gp_joy_x)) / Range::MAX<int16_t>;
+        Fix16 y = ((set.invert_y ^ invert_y) ? Fix16(Range::invert(gp_joy_y)) : Fix16(gp_joy_y)) / Range::MAX<int16_t>;
+
+        const Fix16 abs_x = fix16::abs(x);
+        const Fix16 abs_y = fix16::abs(y);
+        const Fix16 inv_axis_restrict = FIX_1 / (FIX_1 - set.axis_restrict);
+
+        Fix16 rAngle = (abs_x < FIX_EPSILON) 
+            ? FIX_90 
+            : fix16::rad2deg(fix16::abs(fix16::atan(y / x)));
+
+        Fix16 axial_x = (abs_x <= set.axis_restrict && rAngle > FIX_45) 
+            ? FIX_0 
+            : ((abs_x - set.axis_restrict) * inv_axis_restrict);
+                
+        Fix16 axial_y = (abs_y <= set.axis_restrict && rAngle <= FIX_45) 
+            ? FIX_0 
+            : ((abs_y - set.axis_restrict) * inv_axis_restrict);
+
+        Fix16 in_magnitude = fix16::sqrt(fix16::sq(axial_x) + fix16::sq(axial_y));
+
+        if (in_magnitude < set.dz_inner)
+        {
+            return { 0, 0 };
+        }
+
+        Fix16 angle = 
+            fix16::abs(axial_x) < FIX_EPSILON 
+                ? FIX_90 
+                : fix16::rad2deg(fix16::abs(fix16::atan(axial_y / axial_x)));
+
+        Fix16 anti_r_scale = (set.anti_dz_square_y_scale == FIX_0) ? set.anti_dz_square : set.anti_dz_square_y_scale;
+        Fix16 anti_dz_c = set.anti_dz_circle;
+
+        if (anti_r_scale > FIX_0 && anti_dz_c > FIX_0)
+        {
+            Fix16 anti_ellip_scale = anti_r_scale / anti_dz_c;
+            Fix16 ellipse_angle = fix16::atan((FIX_1 / anti_ellip_scale) * fix16::tan(fix16::deg2rad(rAngle)));
+            ellipse_angle = (ellipse_angle < FIX_0) ? FIX_ELLIPSE_DEF : ellipse_angle;
+
+            Fix16 ellipse_x = fix16::cos(ellipse_angle);
+            Fix16 ellipse_y = fix16::sqrt(fix16::sq(anti_ellip_scale) * (FIX_1 - fix16::sq(ellipse_x)));
+            anti_dz_c *= fix16::sqrt(fix16::sq(ellipse_x) + fix16::sq(ellipse_y));
+        }
+
+        if (anti_dz_c > FIX_0)
+        {
+            anti_dz_c = anti_dz_c / ((anti_dz_c * (FIX_1 - set.anti_dz_circle / set.dz_outer)) / (anti_dz_c * (FIX_1 - set.anti_dz_square)));
+        }
+
+        if (abs_x > set.axis_restrict && abs_y > set.axis_restrict)
+        {
+            const Fix16 FIX_ANGLE_MAX = set.angle_restrict / 2.0f;
+
+            if (angle > FIX_0 && angle < FIX_ANGLE_MAX)
+            {
+                angle = FIX_0;
+            }
+            if (angle > (FIX_90 - FIX_ANGLE_MAX))
+            {
+                angle = FIX_90;
+            }
+            if (angle > FIX_ANGLE_MAX && angle < (FIX_90 - FIX_ANGLE_MAX))
+            {
+                angle = ((angle - FIX_ANGLE_MAX) * FIX_90) / ((FIX_90 - FIX_ANGLE_MAX) - FIX_ANGLE_MAX);
+            }
+        }
+
+        Fix16 ref_angle = (angle < FIX_EPSILON2) ? FIX_0 : angle;
+        Fix16 diagonal = (angle > FIX_45) ? (((angle - FIX_45) * (-FIX_45)) / FIX_45) + FIX_45 : angle;
+
+        const Fix16 angle_comp = set.angle_restrict / FIX_2;
+
+        if (angle < FIX_90 && angle > FIX_0)
+        {
+            angle = ((angle * ((FIX_90 - angle_comp) - angle_comp)) / FIX_90) + angle_comp;
+        }
+
+        if (axial_x < FIX_0 && axial_y > FIX_0)
+        {
+            angle = -angle;
+        }
+        if (axial_x > FIX_0 && axial_y < FIX_0)
+        {
+            angle = angle - FIX_180;
+        }
+        if (axial_x < FIX_0 && axial_y < FIX_0)
+        {
+            angle = angle + FIX_180;
+        }
+
+        //Deadzone Warp
+        Fix16 out_magnitude = (in_magnitude - set.dz_inner) / (set.anti_dz_outer - set.dz_inner);
+        out_magnitude = pow(out_magnitude, (FIX_1 / set.curve)) * (set.dz_outer - anti_dz_c) + anti_dz_c;
+        out_magnitude = (out_magnitude > set.dz_outer && !set.uncap_radius) ? set.dz_outer : out_magnitude;
+
+    		Fix16 d_scale = (((out_magnitude - anti_dz_c) * (set.diag_scale_max - set.diag_scale_min)) / (set.dz_outer - anti_dz_c)) + set.diag_scale_min;		
+    		Fix16 c_scale = (diagonal * (FIX_1 / fix16::sqrt(FIX_2))) / FIX_45; //Both these lines scale the intensity of the warping
+    		c_scale       = FIX_1 - fix16::sqrt(FIX_1 - c_scale * c_scale);     //based on a circular curve to the perfect diagonal
+    		d_scale       = (c_scale * (d_scale - FIX_1)) / FIX_DIAG_DIVISOR + FIX_1;
+
+    		out_magnitude = out_magnitude * d_scale;
+
+    		//Scaling values for square antideadzone
+    		Fix16 new_x = fix16::cos(fix16::deg2rad(angle)) * out_magnitude;
+    		Fix16 new_y = fix16::sin(fix16::deg2rad(angle)) * out_magnitude;
+    		
+    		//Magic angle wobble fix by user ME.
+    		// if (angle > 45.0 && angle < 225.0) {
+    		// 	newX = inv(Math.sin(deg2rad(angle - 90.0)))*outputMagnitude;
+    		// 	newY = inv(Math.cos(deg2rad(angle - 270.0)))*outputMagnitude;
+    		// }
+    		
+    		//Square antideadzone scaling
+    		Fix16 output_x = fix16::abs(new_x) * (FIX_1 - set.anti_dz_square / set.dz_outer) + set.anti_dz_square;
+    		if (x < FIX_0)
+        {
+            output_x = -output_x;
+        }
+    		if (ref_angle == FIX_90)
+        {
+            output_x = FIX_0;
+        }
+    		
+    		Fix16 output_y = fix16::abs(new_y) * (FIX_1 - anti_r_scale / set.dz_outer) + anti_r_scale;
+    		if (y < FIX_0)
+        {
+            output_y = -output_y;
+        }
+    		if (ref_angle == FIX_0)
+        {
+            output_y = FIX_0;
+        }
+
+        output_x = fix16::clamp(output_x, -FIX_1, FIX_1) * Range::MAX<int16_t>;
+        output_y = fix16::clamp(output_y, -FIX_1, FIX_1) * Range::MAX<int16_t>;
+
+        return { static_cast<int16_t>(fix16_to_int(output_x)), static_cast<int16_t>(fix16_to_int(output_y)) };
+    }
+} // namespace baseline
+
+//fix16::pow with the non integer case rounded correctly
+static Fix16 exact_pow(Fix16 base, Fix16 exponent)
+{
+    if (exponent.value == fix16_from_int(fix16_to_int(exponent.value)) || base.value <= 0)
+    {
+        return fix16::pow(base, exponent);
+    }
+    const double result = std::pow(fix16_to_dbl(base.value), fix16_to_dbl(exponent.value)) * 65536.0;
+    return Fix16(static_cast<fix16_t>(std::min(result + 0.5, static_cast<double>(fix16_maximum))));
+}
+
+//Both pows for every base the old math can hand them, fix16::pow alone would take hours over the full grid.
+//Filled before the workers start and only read after
+static const fix16_t POW_TABLE_MAX = fix16_from_int(4);
+static std::vector<fix16_t> fix16_pow_table_;
+static std::vector<fix16_t> exact_pow_table_;
+static const JoystickShaper* curve_shaper_ = nullptr;
+
+//Base of the last pow call on this thread, -1 if the point never got that far
+static thread_local fix16_t last_base_ = -1;
+
+static void fill_pow_tables(Fix16 exponent)
+{
+    fix16_pow_table_.resize(POW_TABLE_MAX + 1);
+    exact_pow_table_.resize(POW_TABLE_MAX + 1);
+    for (fix16_t base = 0; base <= POW_TABLE_MAX; ++base)
+    {
+        fix16_pow_table_[base] = fix16::pow(Fix16(base), exponent).value;
+        exact_pow_table_[base] = exact_pow(Fix16(base), exponent).value;
+    }
+}
+
+static Fix16 table_fix16_pow(Fix16 base, Fix16 exponent)
+{
+    last_base_ = base.value;
+    return (base.value >= 0 && base.value <= POW_TABLE_MAX) ? Fix16(fix16_pow_table_[base.value]) : fix16::pow(base, exponent);
+}
+
+static Fix16 shaper_pow(Fix16 base, Fix16)
+{
+    return Fix16(curve_shaper_->curve(base.value));
+}
+
+//Worst Q16.16 difference between the compiled curve and a correctly rounded pow
+static int curve_error(const JoystickShaper& shaper)
+{
+    int worst = 0;
+    for (fix16_t base = 0; base <= fix16_from_int(2); ++base)
+    {
+        worst = std::max(worst, std::abs(shaper.curve(base) - exact_pow_table_[base]));
+    }
+    return worst;
+}
+
+struct Profile
+{
+    const char* name;
+    JoystickSettings settings;
+};
+
+static std::vector<Profile> profiles()
+{
+    std::vector<Profile> list;
+    auto add = [&list](const char* name, auto&& edit)
+    {
+        JoystickSettings settings;
+        edit(settings);
+        list.push_back({ name, settings });
+    };
+
+    add("default",          [](JoystickSettings&) {});
+    add("deadzone",         [](JoystickSettings& s) { s.dz_inner = Fix16(0.1f); s.dz_outer = Fix16(0.95f); });
+    add("curve_0.5",        [](JoystickSettings& s) { s.dz_inner = Fix16(0.05f); s.curve = Fix16(0.5f); });
+    add("curve_0.25",       [](JoystickSettings& s) { s.curve = Fix16(0.25f); });
+    add("anti_dz_circle",   [](JoystickSettings& s) { s.anti_dz_circle = Fix16(0.2f); s.dz_inner = Fix16(0.08f); });
+    add("anti_dz_square",   [](JoystickSettings& s) { s.anti_dz_square = Fix16(0.15f); s.dz_inner = Fix16(0.08f); });
+    add("ellipse",          [](JoystickSettings& s) { s.anti_dz_square = Fix16(0.15f); s.anti_dz_circle = Fix16(0.1f); s.dz_inner = Fix16(0.08f); });
+    add("ellipse_y_scale",  [](JoystickSettings& s) { s.anti_dz_circle = Fix16(0.12f); s.anti_dz_square_y_scale = Fix16(0.05f); s.dz_inner = Fix16(0.05f); });
+    add("axis_restrict",    [](JoystickSettings& s) { s.axis_restrict = Fix16(0.1f); s.dz_inner = Fix16(0.05f); });
+    add("angle_restrict",   [](JoystickSettings& s) { s.angle_restrict = Fix16(10.0f); s.dz_inner = Fix16(0.05f); });
+    add("diagonal",         [](JoystickSettings& s) { s.diag_scale_min = Fix16(1.1f); s.diag_scale_max = Fix16(1.3f); s.dz_inner = Fix16(0.05f); });
+    add("outer_cap_invert", [](JoystickSettings& s) { s.anti_dz_outer = Fix16(0.9f); s.uncap_radius = false; s.dz_inner = Fix16(0.05f); s.invert_x = true; s.invert_y = true; });
+    add("curve_1.7",        [](JoystickSettings& s) { s.dz_inner = Fix16(0.05f); s.curve = Fix16(1.7f); });
+    add("curve_0.4",        [](JoystickSettings& s) { s.dz_inner = Fix16(0.05f); s.curve = Fix16(0.4f); });
+    add("curve_0.6",        [](JoystickSettings& s) { s.dz_inner = Fix16(0.05f); s.curve = Fix16(0.6f); });
+    add("mixed",            [](JoystickSettings& s)
+    {
+        s.dz_inner = Fix16(0.1f); s.dz_outer = Fix16(0.98f); s.anti_dz_circle = Fix16(0.1f); s.axis_restrict = Fix16(0.05f);
+        s.angle_restrict = Fix16(6.0f); s.diag_scale_min = Fix16(1.05f); s.diag_scale_max = Fix16(1.2f); s.curve = Fix16(1.4f);
+    });
+    return list;
+}
+
+static int max_diff(const std::pair<int16_t, int16_t>& a, const std::pair<int16_t, int16_t>& b)
+{
+    return std::max(std::abs(a.first - b.first), std::abs(a.second - b.second));
+}
+
+struct Result
+{
+    uint64_t points{0};
+    uint64_t over{0};
+    uint64_t curve_changed{0};
+    int worst{0};
+    int worst_curve_changed{0};
+    int worst_x{0};
+    int worst_y{0};
+    std::chrono::nanoseconds old_time{0};
+    std::chrono::nanoseconds new_time{0};
+
+    void merge(const Result& other)
+    {
+        points += other.points;
+        over += other.over;
+        curve_changed += other.curve_changed;
+        worst_curve_changed = std::max(worst_curve_changed, other.worst_curve_changed);
+        if (other.worst > worst)
+        {
+            worst = other.worst;
+            worst_x = other.worst_x;
+            worst_y = other.worst_y;
+        }
+        old_time += other.old_time;
+        new_time += other.new_time;
+    }
+};
+
+//Every row_step-th row of the grid starting at first_row
+static Result run_rows(const JoystickShaper& shaper, const JoystickSettings& settings, bool exponent_is_int,
+                       const std::vector<int16_t>& axis, size_t first_row, size_t row_step, size_t invert_every)
+{
+    Result result;
+    std::vector<std::pair<int16_t, int16_t>> row_old(axis.size());
+    std::vector<std::pair<int16_t, int16_t>> row_new(axis.size());
+    std::vector<fix16_t> row_base(axis.size());
+
+    for (size_t row = first_row; row < axis.size(); row += row_step)
+    {
+        const int16_t joy_x = axis[row];
+        for (int inv = 0; inv < ((row % invert_every) ? 1 : 2); ++inv)
+        {
+            //A row at a time, so the timing covers more than the clock reads
+            const auto t0 = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < axis.size(); ++i)
+            {
+                last_base_ = -1;
+                row_old[i] = baseline::apply_joystick_settings(joy_x, axis[i], settings, inv, table_fix16_pow);
+                row_base[i] = last_base_;
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < axis.size(); ++i)
+            {
+                row_new[i] = shaper.apply(joy_x, axis[i], inv);
+            }
+            const auto t2 = std::chrono::steady_clock::now();
+            result.old_time += t1 - t0;
+            result.new_time += t2 - t1;
+
+            for (size_t i = 0; i < axis.size(); ++i)
+            {
+                int diff = max_diff(row_old[i], row_new[i]);
+                const fix16_t base = row_base[i];
+                if (!exponent_is_int && base >= 0 && base <= POW_TABLE_MAX && shaper.curve(base) != fix16_pow_table_[base])
+                {
+                    ++result.curve_changed;
+                    result.worst_curve_changed = std::max(result.worst_curve_changed, diff);
+                    diff = max_diff(baseline::apply_joystick_settings(joy_x, axis[i], settings, inv, shaper_pow), row_new[i]);
+                }
+                if (diff > 1)
+                {
+                    ++result.over;
+                    if (diff > result.worst)
+                    {
+                        result.worst = diff;
+                        result.worst_x = joy_x;
+                        result.worst_y = axis[i];
+                    }
+                }
+            }
+            result.points += axis.size();
+        }
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const int stride = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 1;
+    const char* only = (argc > 2) ? argv[2] : nullptr;
+    const size_t invert_every = 61;
+    const unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    int failures = 0;
+
+    //-32768 is the one value whose magnitude has no positive twin
+    std::vector<int16_t> axis{ Range::MIN<int16_t> };
+    for (int32_t value = 0; value < Range::MAX<int16_t>; value += stride)
+    {
+        axis.push_back(static_cast<int16_t>(value));
+    }
+    axis.push_back(Range::MAX<int16_t>);
+
+    std::printf("%-18s %12s %8s %8s %10s %10s %10s %s\n", "profile", "points", "fail", "worst", "old ns", "new ns", "curve off", "curve changed");
+
+    for (const Profile& profile : profiles())
+    {
+        if (only && std::strcmp(only, profile.name) != 0)
+        {
+            continue;
+        }
+        JoystickShaper shaper;
+        shaper.compile(profile.settings);
+
+        const Fix16 exponent = Fix16(1.0f) / profile.settings.curve;
+        const bool exponent_is_int = (exponent.value == fix16_from_int(fix16_to_int(exponent.value)));
+        fill_pow_tables(exponent);
+        const int curve_off = exponent_is_int ? 0 : curve_error(shaper);
+        curve_shaper_ = &shaper;
+
+        std::vector<Result> results(workers);
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < workers; ++w)
+        {
+            threads.emplace_back([&, w]
+            {
+                results[w] = run_rows(shaper, profile.settings, exponent_is_int, axis, w, workers, invert_every);
+            });
+        }
+        Result total;
+        for (unsigned w = 0; w < workers; ++w)
+        {
+            threads[w].join();
+            total.merge(results[w]);
+        }
+
+        std::printf("%-18s %12llu %8llu %8d %10.1f %10.1f %10d",
+                    profile.name, static_cast<unsigned long long>(total.points), static_cast<unsigned long long>(total.over), total.worst,
+                    static_cast<double>(total.old_time.count()) / total.points, static_cast<double>(total.new_time.count()) / total.points, curve_off);
+        if (!exponent_is_int)
+        {
+            std::printf(" %.2f%% of points, max %d LSB from fix16::pow", 100.0 * static_cast<double>(total.curve_changed) / total.points, total.worst_curve_changed);
+        }
+        if (total.over)
+        {
+            std::printf("  FAIL at (%d, %d)", total.worst_x, total.worst_y);
+        }
+        if (curve_off > 1)
+        {
+            std::printf("  FAIL curve");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+        failures += (total.over || curve_off > 1) ? 1 : 0;
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,385 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include <pico/multicore.h>
+
+#include "UserSettings/NVSTool.h"
+#include "UserSettings/UserProfile.h"
+
+#include "stubs.h"
+
+/*  NVSTool against the stubbed flash, NOR semantics with FLASH_PAGE_SIZE pages in FLASH_SECTOR_SIZE sectors.
+    Random batches of UserSettings' keys with power cut at random flash ops, a cut batch must read back
+    either all old or all new after the reboot. Migration from the old page per entry layout is cut at
+    every flash op it makes. With core1 running, flash_safe_execute failing at random ops must refuse the
+    write and leave the old values, never touch flash, and the same batch must store once retried.
+    Fails on a lost, torn or partial value, reports erases per batch.
+    Usage: nvstool_test [batches] */
+
+static constexpr uint32_t NVS_START = PICO_FLASH_SIZE_BYTES - NVS_SECTORS * FLASH_SECTOR_SIZE;
+static constexpr uint32_t MAX_GAMEPADS_STORED = 4;
+static constexpr uint32_t MAX_PROFILES = 8;
+
+//Reboots construct a new NVSTool over whatever is in flash, the way the firmware's static would
+class NVSToolSim
+{
+public:
+    static NVSTool& boot()
+    {
+        alignas(NVSTool) static unsigned char storage[sizeof(NVSTool)];
+        return *new (storage) NVSTool();
+    }
+};
+
+struct Key
+{
+    char name[NVSTool::KEY_LEN_MAX];
+    size_t len;
+    std::vector<uint8_t> value;
+};
+
+static int failures_ = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        std::printf("FAIL: %s\n", what);
+        ++failures_;
+    }
+}
+
+//Same keys and sizes as UserSettings
+static std::vector<Key> make_keys()
+{
+    std::vector<Key> keys;
+    auto add = [&keys](const char* name, size_t len)
+    {
+        Key key{};
+        std::snprintf(key.name, sizeof(key.name), "%s", name);
+        key.len = len;
+        key.value.assign(len, 0);
+        keys.push_back(key);
+    };
+
+    char name[NVSTool::KEY_LEN_MAX];
+    for (uint32_t i = 1; i <= MAX_PROFILES; ++i)
+    {
+        std::snprintf(name, sizeof(name), "profile_%u", i);
+        add(name, sizeof(UserProfile));
+    }
+    for (uint32_t i = 0; i < MAX_GAMEPADS_STORED; ++i)
+    {
+        std::snprintf(name, sizeof(name), "active_id_%u", i);
+        add(name, 1);
+    }
+    add("driver_type", 1);
+    add("init_flag", 1);
+    add("datetime", 21);
+    return keys;
+}
+
+static bool read_back(NVSTool& nvs, const Key& key, std::vector<uint8_t>& value)
+{
+    value.assign(key.len, 0xAA);
+    return nvs.read(key.name, value.data(), value.size());
+}
+
+static uint32_t check_all(NVSTool& nvs, const std::vector<Key>& keys)
+{
+    uint32_t bad = 0;
+    std::vector<uint8_t> value;
+    for (const Key& key : keys)
+    {
+        bad += (!read_back(nvs, key, value) || value != key.value) ? 1 : 0;
+    }
+    return bad;
+}
+
+static bool write_keys(NVSTool& nvs, const std::vector<const Key*>& batch)
+{
+    std::vector<NVSTool::Write> writes;
+    for (const Key* key : batch)
+    {
+        writes.push_back({ key->name, key->value.data(), key->len });
+    }
+    return nvs.write_batch(writes.data(), writes.size());
+}
+
+static void test_power_loss(uint32_t batches)
+{
+    std::mt19937 rng(1);
+    std::vector<Key> keys = make_keys();
+
+    stubs::flash_erase_all();
+    stubs::set_flash_power_loss(-1);
+    NVSTool* nvs = &NVSToolSim::boot();
+
+    std::vector<const Key*> all;
+    for (const Key& key : keys)
+    {
+        all.push_back(&key);
+    }
+    check(write_keys(*nvs, all), "first batch rejected");
+
+    const uint32_t erases_start = stubs::flash_erase_count();
+    const uint32_t programs_start = stubs::flash_program_count();
+    uint32_t power_losses = 0;
+    uint32_t partial = 0;
+    uint32_t torn = 0;
+    uint32_t lost = 0;
+
+    for (uint32_t n = 0; n < batches; ++n)
+    {
+        //1 to 3 distinct keys, new values
+        std::vector<size_t> picked;
+        while (picked.size() < 1 + (rng() % 3))
+        {
+            const size_t i = rng() % keys.size();
+            if (std::find(picked.begin(), picked.end(), i) == picked.end())
+            {
+                picked.push_back(i);
+            }
+        }
+        std::vector<Key> updated;
+        std::vector<const Key*> batch;
+        for (size_t i : picked)
+        {
+            updated.push_back(keys[i]);
+            for (auto& byte : updated.back().value)
+            {
+                byte = static_cast<uint8_t>(rng());
+            }
+            //Old and new must differ to tell them apart after a cut
+            if (updated.back().value == keys[i].value)
+            {
+                updated.back().value[0] ^= 0xFF;
+            }
+        }
+        for (const Key& key : updated)
+        {
+            batch.push_back(&key);
+        }
+
+        const bool cut = (rng() % 10) == 0;
+        stubs::set_flash_power_loss(cut ? static_cast<long>(rng() % 6) : -1);
+        try
+        {
+            check(write_keys(*nvs, batch), "batch rejected");
+            stubs::set_flash_power_loss(-1);
+            for (size_t j = 0; j < picked.size(); ++j)
+            {
+                keys[picked[j]] = updated[j];
+            }
+        }
+        catch (const stubs::PowerLoss&)
+        {
+            ++power_losses;
+            stubs::set_flash_power_loss(-1);
+            nvs = &NVSToolSim::boot();
+
+            uint32_t now_new = 0;
+            uint32_t now_old = 0;
+            std::vector<uint8_t> value;
+            for (size_t j = 0; j < picked.size(); ++j)
+            {
+                const bool found = read_back(*nvs, updated[j], value);
+                if (found && value == updated[j].value)
+                {
+                    ++now_new;
+                }
+                else if (found && value == keys[picked[j]].value)
+                {
+                    ++now_old;
+                }
+                else
+                {
+                    ++torn;
+                }
+            }
+            partial += (now_new && now_old) ? 1 : 0;
+            if (now_new && !now_old)
+            {
+                for (size_t j = 0; j < picked.size(); ++j)
+                {
+                    keys[picked[j]] = updated[j];
+                }
+            }
+        }
+
+        lost += check_all(*nvs, keys);
+        if ((n % 1000) == 999 && n + 1 < batches)
+        {
+            nvs = &NVSToolSim::boot();
+            lost += check_all(*nvs, keys);
+        }
+    }
+
+    const NVSTool::Stats stats = nvs->get_stats();
+    const uint32_t erases = stubs::flash_erase_count() - erases_start;
+    const uint32_t programs = stubs::flash_program_count() - programs_start;
+    std::printf("power loss: %u batches, %u cut, %u partial, %u torn, %u lost\n", batches, power_losses, partial, torn, lost);
+    std::printf("wear:       %.3f erases and %.2f page programs per batch, the page per entry store took 1 and 16 per key\n",
+                static_cast<double>(erases) / batches, static_cast<double>(programs) / batches);
+    std::printf("stats:      %u entries, %u bytes free, since boot %u erases, %u pages, %u blocks, %u sectors collected\n",
+                stats.entries, stats.free_bytes, stats.sector_erases, stats.pages_programmed, stats.blocks_written, stats.sectors_collected);
+
+    check(!partial, "batch partially stored");
+    check(!torn, "value torn by power loss");
+    check(!lost, "value lost");
+    check(stats.entries == keys.size(), "entry count wrong");
+}
+
+//Page per entry layout as the old NVSTool left it: every page programmed, page 0 and unused ones "INVALID"
+static void write_legacy_image(const std::vector<Key>& keys)
+{
+    stubs::flash_erase_all();
+    for (uint32_t page = 0; page < NVS_SECTORS * FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE; ++page)
+    {
+        uint8_t* entry = stub_flash_image + NVS_START + page * FLASH_PAGE_SIZE;
+        std::memset(entry, 0x00, NVSTool::KEY_LEN_MAX);
+        std::strcpy(reinterpret_cast<char*>(entry), "INVALID");
+
+        if (page >= 1 && page <= keys.size())
+        {
+            const Key& key = keys[page - 1];
+            std::memset(entry, 0x00, NVSTool::KEY_LEN_MAX);
+            std::strcpy(reinterpret_cast<char*>(entry), key.name);
+            std::memcpy(entry + NVSTool::KEY_LEN_MAX, key.value.data(), key.len);
+        }
+    }
+}
+
+static void test_migration()
+{
+    std::mt19937 rng(2);
+    std::vector<Key> keys = make_keys();
+    for (Key& key : keys)
+    {
+        for (auto& byte : key.value)
+        {
+            byte = static_cast<uint8_t>(rng());
+        }
+    }
+
+    write_legacy_image(keys);
+    const uint32_t ops_start = stubs::flash_erase_count() + stubs::flash_program_count();
+    NVSTool* nvs = &NVSToolSim::boot();
+    const uint32_t ops = stubs::flash_erase_count() + stubs::flash_program_count() - ops_start;
+    check(check_all(*nvs, keys) == 0, "migrated value lost");
+
+    //Cut at every flash op the migration makes, the reboot after must finish it
+    uint32_t lost = 0;
+    for (uint32_t cut = 0; cut < ops; ++cut)
+    {
+        write_legacy_image(keys);
+        stubs::set_flash_power_loss(cut);
+        try
+        {
+            NVSToolSim::boot();
+        }
+        catch (const stubs::PowerLoss&)
+        {
+        }
+        stubs::set_flash_power_loss(-1);
+
+        nvs = &NVSToolSim::boot();
+        lost += check_all(*nvs, keys);
+        nvs = &NVSToolSim::boot();
+        lost += check_all(*nvs, keys);
+    }
+
+    //Migrated values are stored at the old fixed size, still updatable
+    keys[0].value.assign(keys[0].len, 0x5A);
+    check(write_keys(*nvs, { &keys[0] }), "write after migration rejected");
+    nvs = &NVSToolSim::boot();
+    lost += check_all(*nvs, keys);
+
+    std::printf("migration:  %zu entries in %u flash ops, cut at each, %u lost\n", keys.size(), ops, lost);
+    check(!lost, "value lost migrating");
+}
+
+//Before core1 is launched a failed flash_safe_execute falls back to disabling interrupts, after it the write is refused
+static void test_flash_refused(uint32_t batches)
+{
+    std::mt19937 rng(3);
+    std::vector<Key> keys = make_keys();
+
+    stubs::flash_erase_all();
+    stubs::set_flash_safe_result(PICO_ERROR_NOT_PERMITTED);
+    NVSTool* nvs = &NVSToolSim::boot();
+
+    std::vector<const Key*> all;
+    for (const Key& key : keys)
+    {
+        all.push_back(&key);
+    }
+    check(write_keys(*nvs, all), "write before core1 launched rejected");
+
+    multicore_launch_core1(nullptr);
+    stubs::set_flash_safe_result(PICO_ERROR_TIMEOUT);
+    std::vector<uint8_t> image(stub_flash_image + NVS_START, stub_flash_image + PICO_FLASH_SIZE_BYTES);
+    keys[0].value.assign(keys[0].len, 0x33);
+    check(!write_keys(*nvs, { &keys[0] }), "write accepted while core1 can't be paused");
+    check(std::equal(image.begin(), image.end(), stub_flash_image + NVS_START), "flash written while core1 can't be paused");
+    keys[0].value.assign(keys[0].len, 0x00);
+
+    uint32_t refused = 0;
+    uint32_t stuck = 0;
+    uint32_t partial = 0;
+    uint32_t lost = 0;
+
+    for (uint32_t n = 0; n < batches; ++n)
+    {
+        const size_t i = rng() % keys.size();
+        Key updated = keys[i];
+        updated.value[0] ^= static_cast<uint8_t>(1 + rng() % 255);
+
+        //Refused somewhere inside the batch, then retried once flash can be written again
+        stubs::set_flash_safe_result((rng() % 4) ? PICO_OK : PICO_ERROR_TIMEOUT, rng() % 6);
+        if (!write_keys(*nvs, { &updated }))
+        {
+            ++refused;
+            std::vector<uint8_t> value;
+            partial += (!read_back(*nvs, keys[i], value) || value != keys[i].value) ? 1 : 0;
+
+            stubs::set_flash_safe_result(PICO_OK);
+            stuck += write_keys(*nvs, { &updated }) ? 0 : 1;
+        }
+        keys[i] = updated;
+
+        lost += check_all(*nvs, keys);
+        if ((n % 500) == 499)
+        {
+            stubs::set_flash_safe_result(PICO_OK);
+            nvs = &NVSToolSim::boot();
+            lost += check_all(*nvs, keys);
+        }
+    }
+    stubs::set_flash_safe_result(PICO_OK);
+    multicore_reset_core1();
+
+    std::printf("refused:    %u batches, %u refused, %u failed the retry, %u changed by a refused write, %u lost\n", batches, refused, stuck, partial, lost);
+    check(refused, "no write was refused");
+    check(!stuck, "retry after a refused write rejected");
+    check(!partial, "refused write changed a value");
+    check(!lost, "value lost after a refused write");
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t batches = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 20000;
+
+    test_power_loss(batches);
+    test_migration();
+    test_flash_refused(batches / 4);
+
+    return failures_ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
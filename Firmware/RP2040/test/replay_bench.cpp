@@ -0,0 +1,145 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#include "USBHost/HostDriver/PS4/PS4.h"
+#include "USBHost/HostDriver/PS5/PS5.h"
+#include "USBHost/HostDriver/SwitchPro/SwitchPro.h"
+#include "USBHost/HostDriver/XInput/XboxOne.h"
+#include "USBHost/HostDriver/XInput/Xbox360W.h"
+#include "USBHost/HostDriver/HIDGeneric/HIDGeneric.h"
+#include "USBDevice/DeviceDriver/XInput/XInput.h"
+#include "USBDevice/DeviceDriver/DInput/DInput.h"
+#include "USBDevice/DeviceDriver/PS3/PS3.h"
+#include "USBDevice/DeviceDriver/Switch/Switch.h"
+#include "Descriptors/DInput.h"
+
+#include "stubs.h"
+#include "reports.h"
+
+/*  Replays raw controller reports through HostDriver::process_report -> Gamepad -> DeviceDriver::process,
+    the same path core1 and core0 take on the RP2040, and reports time and heap allocations per report.
+    Fails if the path allocates or produces no device reports.
+    Usage: replay_bench [passes] [max_ns_per_report] */
+
+static std::atomic<uint64_t> allocations_{0};
+
+void* operator new(size_t size)
+{
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+static constexpr uint8_t ADDRESS = 1;
+static constexpr uint8_t INSTANCE = 0;
+static constexpr size_t WARMUP_PASSES = 2;
+
+struct Result
+{
+    double ns_per_report{0};
+    double allocs_per_report{0};
+    uint32_t device_reports{0};
+};
+
+template <typename Host, typename Device, size_t COUNT, size_t LEN>
+static Result replay(const uint8_t (&frames)[COUNT][LEN], size_t passes, const uint8_t* report_desc = nullptr, uint16_t desc_len = 0)
+{
+    static Gamepad gamepad;
+    gamepad.set_profile(UserProfile());
+    gamepad.reset_pad_in();
+
+    Host host(0);
+    Device device;
+    device.initialize();
+    host.initialize(gamepad, ADDRESS, INSTANCE, report_desc, desc_len);
+
+    //Also walks drivers with an init sequence (Switch Pro) through to reporting
+    for (size_t pass = 0; pass < WARMUP_PASSES; ++pass)
+    {
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            host.process_report(gamepad, ADDRESS, INSTANCE, frames[i], LEN);
+            device.process(0, gamepad);
+        }
+    }
+
+    stubs::reset_transfers();
+    const uint64_t allocations = allocations_.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t pass = 0; pass < passes; ++pass)
+    {
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            host.process_report(gamepad, ADDRESS, INSTANCE, frames[i], LEN);
+            device.process(0, gamepad);
+        }
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double reports = static_cast<double>(passes * COUNT);
+
+    Result result;
+    result.ns_per_report = std::chrono::duration<double, std::nano>(elapsed).count() / reports;
+    result.allocs_per_report = static_cast<double>(allocations_.load() - allocations) / reports;
+    result.device_reports = stubs::device_in().count;
+    return result;
+}
+
+static int failures_ = 0;
+
+static void print(const char* capture, const char* device, const Result& result, double max_ns)
+{
+    const bool failed = (result.allocs_per_report > 0) ||
+                        (result.device_reports == 0) ||
+                        (max_ns > 0 && result.ns_per_report > max_ns);
+    std::printf("%-14s %-8s %10.1f %14.3f %12u %s\n",
+                capture, device, result.ns_per_report, result.allocs_per_report, result.device_reports, failed ? "FAIL" : "");
+    failures_ += failed ? 1 : 0;
+}
+
+template <typename Host, size_t COUNT, size_t LEN>
+static void replay_all(const char* capture, const uint8_t (&frames)[COUNT][LEN], size_t passes, double max_ns,
+                       const uint8_t* report_desc = nullptr, uint16_t desc_len = 0)
+{
+    print(capture, "XInput", replay<Host, XInputDevice>(frames, passes, report_desc, desc_len), max_ns);
+    print(capture, "DInput", replay<Host, DInputDevice>(frames, passes, report_desc, desc_len), max_ns);
+    print(capture, "PS3",    replay<Host, PS3Device>(frames, passes, report_desc, desc_len), max_ns);
+    print(capture, "Switch", replay<Host, SwitchDevice>(frames, passes, report_desc, desc_len), max_ns);
+}
+
+int main(int argc, char** argv)
+{
+    const size_t passes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const double max_ns = (argc > 2) ? std::strtod(argv[2], nullptr) : 0;
+
+    std::printf("%-14s %-8s %10s %14s %12s\n", "capture", "device", "ns/report", "allocs/report", "device IN");
+
+    replay_all<PS4Host>("PS4", reports::PS4, passes, max_ns);
+    replay_all<PS5Host>("PS5", reports::PS5, passes, max_ns);
+    replay_all<SwitchProHost>("SwitchPro", reports::SWITCH_PRO, passes, max_ns);
+    replay_all<XboxOneHost>("XboxOne GIP", reports::XBOX_ONE_GIP, passes, max_ns);
+    replay_all<Xbox360WHost>("Xbox360W", reports::XBOX_360W, passes, max_ns);
+    replay_all<HIDHost>("HID generic", reports::HID_GENERIC, passes, max_ns,
+                        DInput::REPORT_DESCRIPTORS, sizeof(DInput::REPORT_DESCRIPTORS));
+
+    return failures_ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
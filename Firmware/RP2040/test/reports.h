@@ -0,0 +1,403 @@
+#ifndef _REPLAY_REPORTS_H_
+#define _REPLAY_REPORTS_H_
+
+#include <cstdint>
+
+/*  Raw IN reports as each controller sends them over USB, full transfer length.
+    Twelve frames per controller: idle, then a stick circle with buttons, dpad and triggers 
+    pressed along the way. Counters, timestamps and IMU fields move like they do on the wire
+    so the host drivers' change masks are exercised. */
+namespace reports
+{
+    //DualShock 4, report 0x01. Buttons[2] carries the report counter, IMU and timestamp change every report
+    static constexpr uint8_t PS4[][64] =
+    {
+        {
+            0x01, 0x80, 0x80, 0x80, 0x80, 0x08, 0x00, 0x00, 0x00, 0x00, 0xE8, 0x03, 0x1B, 0x03, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x88, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xE2, 0x46, 0x9B, 0xAE, 0x28, 0x00, 0x04, 0x00, 0x00, 0xA4, 0x04, 0x1B, 0x04, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x89, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xB9, 0x1D, 0xAE, 0x9B, 0x00, 0x00, 0x08, 0x00, 0x00, 0x60, 0x05, 0x1B, 0x05, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x8A, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x80, 0x0D, 0xB6, 0x80, 0x02, 0x01, 0x0C, 0x00, 0x00, 0x1C, 0x06, 0x1B, 0x06, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x8B, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x46, 0x1D, 0xAE, 0x65, 0x04, 0x02, 0x10, 0x00, 0x00, 0xD8, 0x06, 0x1B, 0x07, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x8C, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x1D, 0x46, 0x9B, 0x51, 0x06, 0x00, 0x14, 0x28, 0x00, 0x94, 0x07, 0x1B, 0x08, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x8D, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x0D, 0x7F, 0x80, 0x4A, 0x48, 0x00, 0x18, 0x78, 0x00, 0x50, 0x08, 0x1B, 0x09, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x8E, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x1D, 0xB9, 0x65, 0x51, 0x88, 0x00, 0x1C, 0xFF, 0x00, 0x0C, 0x09, 0x1B, 0x0A, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x8F, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x46, 0xE2, 0x51, 0x64, 0x18, 0x00, 0x20, 0x00, 0xC8, 0xC8, 0x09, 0x1B, 0x0B, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x90, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x7F, 0xF2, 0x4A, 0x7F, 0x08, 0x20, 0x24, 0x00, 0xFF, 0x84, 0x0A, 0x1B, 0x0C, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x91, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xB9, 0xE2, 0x51, 0x9B, 0x08, 0x10, 0x28, 0x00, 0x00, 0x40, 0x0B, 0x1B, 0x0D, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x92, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xE2, 0xB9, 0x64, 0xAE, 0x08, 0x00, 0x2C, 0x00, 0x00, 0xFC, 0x0B, 0x1B, 0x0E, 0x00, 0xFE,
+            0xFF, 0x01, 0x00, 0x93, 0xFF, 0xAE, 0x1F, 0x9E, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+    };
+
+    //DualSense, report 0x01. Sequence number, IMU and sensor timestamp change every report
+    static constexpr uint8_t PS5[][64] =
+    {
+        {
+            0x01, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0x04, 0x00, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x00, 0x00, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xD7, 0x4D, 0x41, 0xA4, 0x00, 0x00, 0x01, 0x08, 0x01, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0x03, 0x00, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0xE4, 0x0C, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xB2, 0x28, 0x5C, 0xBE, 0x00, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0x02, 0x00, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0xC8, 0x19, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x80, 0x1A, 0x80, 0xC8, 0x00, 0x00, 0x03, 0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0x01, 0x00, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0xAC, 0x26, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x4D, 0x28, 0xA4, 0xBE, 0x3C, 0x00, 0x04, 0x05, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0x00, 0x00, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x90, 0x33, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x28, 0x4D, 0xBE, 0xA4, 0xFF, 0x00, 0x05, 0x07, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xFF, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x74, 0x40, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x1A, 0x7F, 0xC8, 0x80, 0x00, 0x80, 0x06, 0x08, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xFE, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x58, 0x4D, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x28, 0xB2, 0xBE, 0x5C, 0x00, 0xFF, 0x07, 0x08, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xFD, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x3C, 0x5A, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x4D, 0xD7, 0xA4, 0x41, 0x00, 0x00, 0x08, 0x28, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xFC, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x20, 0x67, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0x7F, 0xE5, 0x80, 0x38, 0x00, 0x00, 0x09, 0x48, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xFB, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0x04, 0x74, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xB2, 0xD7, 0x5C, 0x41, 0x00, 0x00, 0x0A, 0x08, 0x20, 0x00, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xFA, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0xE8, 0x80, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x01, 0xD7, 0xB2, 0x41, 0x5B, 0x00, 0x00, 0x0B, 0x08, 0x00, 0x01, 0x00, 0x02, 0x00, 0xFF, 0xFF,
+            0xF9, 0xFF, 0x0C, 0x00, 0xF4, 0x1F, 0x5C, 0xFE, 0xCC, 0x8D, 0xA0, 0x00, 0x0F, 0x80, 0x00, 0x00,
+            0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+    };
+
+    //Switch Pro, full report mode 0x30. Timer and IMU change every report, sticks are 12 bit
+    static constexpr uint8_t SWITCH_PRO[][64] =
+    {
+        {
+            0x30, 0x20, 0x91, 0x00, 0x00, 0x00, 0x00, 0x08, 0x80, 0x00, 0x08, 0x80, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0xFA, 0x0F, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xF8, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0xFB, 0x0F, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x23, 0x91, 0x08, 0x00, 0x00, 0x50, 0xDC, 0xA7, 0x29, 0xC9, 0x5F, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0xFB, 0x0F, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xF9, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0xFC, 0x0F, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x26, 0x91, 0x04, 0x00, 0x00, 0x7D, 0x0A, 0xC5, 0x03, 0x6A, 0x6D, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0xFC, 0x0F, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xFA, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0xFD, 0x0F, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x29, 0x91, 0x00, 0x01, 0x00, 0x00, 0xB8, 0xCF, 0x53, 0x0A, 0x80, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0xFD, 0x0F, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xFB, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0xFE, 0x0F, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x2C, 0x91, 0x00, 0x02, 0x00, 0x82, 0x05, 0xC5, 0x03, 0x9A, 0x92, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0xFE, 0x0F, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xFC, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0xFF, 0x0F, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x2F, 0x91, 0x00, 0x00, 0x01, 0xAF, 0xD3, 0xA7, 0x29, 0x39, 0xA0, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0xFF, 0x0F, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xFD, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x00, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x32, 0x91, 0x40, 0x00, 0x00, 0x05, 0x03, 0x80, 0x00, 0x38, 0xA5, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0x00, 0x10, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xFE, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x01, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x35, 0x91, 0x80, 0x00, 0x00, 0xAF, 0x23, 0x58, 0xD6, 0x36, 0xA0, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0x01, 0x10, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0xFF, 0x0F, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x02, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x38, 0x91, 0x00, 0x10, 0x00, 0x82, 0xF5, 0x3A, 0xFC, 0x95, 0x92, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0x02, 0x10, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0x00, 0x10, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x03, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x3B, 0x91, 0x00, 0x00, 0x02, 0xFF, 0x57, 0x30, 0xAD, 0x05, 0x80, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0x03, 0x10, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0x01, 0x10, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x04, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x3E, 0x91, 0x00, 0x00, 0x40, 0x7D, 0xFA, 0x3A, 0xFC, 0x65, 0x6D, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0x04, 0x10, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0x02, 0x10, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x05, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x30, 0x41, 0x91, 0x00, 0x00, 0x80, 0x50, 0x2C, 0x58, 0xD6, 0xC6, 0x5F, 0x0B, 0x24, 0xFF, 0x0E,
+            0x00, 0x05, 0x10, 0x03, 0x00, 0xFB, 0xFF, 0x02, 0x00, 0x23, 0xFF, 0x0F, 0x00, 0x03, 0x10, 0x02,
+            0x00, 0xFA, 0xFF, 0x02, 0x00, 0x25, 0xFF, 0x0D, 0x00, 0x06, 0x10, 0x04, 0x00, 0xFC, 0xFF, 0x01,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+    };
+
+    //Xbox One, GIP input command 0x20. Header sequence increments every report
+    static constexpr uint8_t XBOX_ONE_GIP[][18] =
+    {
+        {
+            0x20, 0x00, 0x40, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00
+        },
+        {
+            0x20, 0x00, 0x41, 0x0E, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4E, 0x69, 0xCC, 0x3C, 0xE5, 0xDA,
+            0x46, 0x40
+        },
+        {
+            0x20, 0x00, 0x42, 0x0E, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0xCC, 0x3C, 0x4E, 0x69, 0xBA, 0xBF,
+            0x1C, 0x25
+        },
+        {
+            0x20, 0x00, 0x43, 0x0E, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x98, 0x79, 0xC8, 0xB5,
+            0x00, 0x00
+        },
+        {
+            0x20, 0x00, 0x44, 0x0E, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x34, 0xC3, 0x4E, 0x69, 0xBA, 0xBF,
+            0xE5, 0xDA
+        },
+        {
+            0x20, 0x00, 0x45, 0x0E, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0xB2, 0x96, 0xCC, 0x3C, 0xE5, 0xDA,
+            0xBA, 0xBF
+        },
+        {
+            0x20, 0x00, 0x46, 0x0E, 0x00, 0x02, 0x2C, 0x01, 0x00, 0x00, 0x68, 0x86, 0x00, 0x00, 0x00, 0x00,
+            0xC8, 0xB5
+        },
+        {
+            0x20, 0x00, 0x47, 0x0E, 0x00, 0x04, 0xFF, 0x03, 0x00, 0x00, 0xB2, 0x96, 0x34, 0xC3, 0x1B, 0x25,
+            0xBA, 0xBF
+        },
+        {
+            0x20, 0x00, 0x48, 0x0E, 0x04, 0x08, 0x00, 0x00, 0x00, 0x02, 0x34, 0xC3, 0xB2, 0x96, 0x46, 0x40,
+            0xE4, 0xDA
+        },
+        {
+            0x20, 0x00, 0x49, 0x0E, 0x08, 0x10, 0x00, 0x00, 0xFF, 0x03, 0x00, 0x00, 0x68, 0x86, 0x38, 0x4A,
+            0x00, 0x00
+        },
+        {
+            0x20, 0x00, 0x4A, 0x0E, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0xCC, 0x3C, 0xB2, 0x96, 0x46, 0x40,
+            0x1C, 0x25
+        },
+        {
+            0x20, 0x00, 0x4B, 0x0E, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x4E, 0x69, 0x34, 0xC3, 0x1C, 0x25,
+            0x46, 0x40
+        },
+    };
+
+    //Xbox 360 wireless receiver, controller data (00 01 00 F0 00 13)
+    static constexpr uint8_t XBOX_360W[][29] =
+    {
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x01, 0x00, 0x00, 0x00, 0xC3, 0x63, 0x99, 0x39, 0x1D, 0x4C,
+            0x0F, 0xD4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x08, 0x00, 0x00, 0x00, 0x99, 0x39, 0xC3, 0x63, 0xF2, 0x2B,
+            0xE3, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x73, 0x00, 0x00,
+            0x1C, 0xA8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x04, 0x00, 0x00, 0x00, 0x67, 0xC6, 0xC3, 0x63, 0x0F, 0xD4,
+            0xE3, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x10, 0x00, 0x00, 0x00, 0x3D, 0x9C, 0x99, 0x39, 0xE3, 0xB3,
+            0x0F, 0xD4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x20, 0x00, 0x5A, 0x00, 0xCE, 0x8C, 0x00, 0x00, 0x1C, 0xA8,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x00, 0x10, 0xFF, 0x00, 0x3D, 0x9C, 0x67, 0xC6, 0xE3, 0xB3,
+            0xF1, 0x2B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x00, 0x20, 0x00, 0x96, 0x67, 0xC6, 0x3D, 0x9C, 0x0E, 0xD4,
+            0x1D, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x40, 0x01, 0x00, 0xFF, 0x00, 0x00, 0xCE, 0x8C, 0x00, 0x00,
+            0xE4, 0x57, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x80, 0x02, 0x00, 0x00, 0x99, 0x39, 0x3D, 0x9C, 0xF2, 0x2B,
+            0x1D, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+            0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x00, 0x80, 0x00, 0x00, 0xC3, 0x63, 0x67, 0xC6, 0x1D, 0x4C,
+            0xF2, 0x2B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+    };
+
+    //Generic HID gamepad, laid out by DInput::REPORT_DESCRIPTORS
+    static constexpr uint8_t HID_GENERIC[][27] =
+    {
+        {
+            0x00, 0x00, 0x08, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x01, 0x00, 0x08, 0xE2, 0x46, 0xAD, 0xCD, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x02, 0x00, 0x00, 0xB9, 0x1D, 0xCD, 0xAD, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x04, 0x00, 0x02, 0x80, 0x0D, 0xDA, 0x80, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x08, 0x00, 0x04, 0x46, 0x1D, 0xCD, 0x53, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x10, 0x00, 0x06, 0x1D, 0x46, 0xAD, 0x32, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x20, 0x00, 0x08, 0x0D, 0x7F, 0x80, 0x26, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x40, 0x00, 0x08, 0x1D, 0xB9, 0x53, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x80, 0x00, 0x08, 0x46, 0xE2, 0x32, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x00, 0x01, 0x08, 0x7F, 0xF2, 0x26, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x00, 0x02, 0x08, 0xB9, 0xE2, 0x32, 0xAD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0xFF, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+        {
+            0x00, 0x10, 0x08, 0xE2, 0xB9, 0x52, 0xCD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02
+        },
+    };
+} // namespace reports
+
+#endif // _REPLAY_REPORTS_H_
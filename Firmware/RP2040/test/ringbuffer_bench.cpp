@@ -0,0 +1,237 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "RingBuffer.h"
+
+/*  Stress test and throughput for the ESP32's RingBuffer, built here since it's header only. Producer and
+    consumer threads play the two cores. Every word of an item is derived from its sequence number, a
+    consumer that sees two different writes in one item has a torn read. Fails on a torn, lost, duplicated
+    or reordered item, DROP_NEWEST must deliver everything, OVERWRITE_OLDEST only in increasing order.
+    Usage: ringbuffer_bench [items] */
+
+static constexpr size_t RING_SIZE = 64;
+static constexpr size_t BATCH = 16;
+static constexpr uint32_t MIX = 2654435761u;
+
+struct Item
+{
+    uint32_t producer;
+    uint32_t seq;
+    uint32_t check[6];
+};
+
+static Item make_item(uint32_t producer, uint32_t seq)
+{
+    Item item;
+    item.producer = producer;
+    item.seq = seq;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        item.check[i] = (seq + static_cast<uint32_t>(i)) * MIX ^ producer;
+    }
+    return item;
+}
+
+static bool intact(const Item& item)
+{
+    const Item expected = make_item(item.producer, item.seq);
+    return std::equal(std::begin(item.check), std::end(item.check), expected.check);
+}
+
+struct Result
+{
+    uint64_t pushed{0};
+    uint64_t received{0};
+    uint64_t torn{0};
+    uint64_t order{0};
+    uint64_t lost{0};
+    //Pushed per second
+    double mitems_s{0};
+};
+
+static void report(const char* name, const Result& result)
+{
+    std::printf("%-30s %llu pushed, %llu received, %llu torn, %llu out of order, %llu lost, %6.1f Mitems/s\n",
+                name, static_cast<unsigned long long>(result.pushed), static_cast<unsigned long long>(result.received), static_cast<unsigned long long>(result.torn),
+                static_cast<unsigned long long>(result.order), static_cast<unsigned long long>(result.lost), result.mitems_s);
+}
+
+//Producers push 1..items each, retrying when full unless the ring overwrites. The consumer checks every
+//producer's items arrive in increasing order, and with no gaps if nothing may be dropped
+template<typename Ring>
+static Result run(Ring& ring, uint32_t items, uint32_t num_producers, bool batched, bool lossless)
+{
+    std::vector<std::thread> producers;
+    std::vector<uint32_t> last(num_producers, 0);
+    std::atomic<uint32_t> done{0};
+    Result result;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t p = 0; p < num_producers; ++p)
+    {
+        producers.emplace_back([&, p]
+        {
+            for (uint32_t seq = 1; seq <= items; )
+            {
+                if (ring.push(make_item(p, seq)))
+                {
+                    //An overwriting producer never waits, let the consumer in so it's racing it for slots
+                    if (!lossless && (seq % BATCH) == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    ++seq;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    auto consume = [&](const Item& item)
+    {
+        ++result.received;
+        if (!intact(item) || item.producer >= num_producers)
+        {
+            ++result.torn;
+            return;
+        }
+        uint32_t& prev = last[item.producer];
+        if (item.seq <= prev || (lossless && item.seq != prev + 1))
+        {
+            ++result.order;
+        }
+        prev = std::max(prev, item.seq);
+    };
+
+    Item buffer[BATCH];
+    while (true)
+    {
+        //Read before popping, so the producers are known to be finished when the ring comes up empty
+        const bool finished = (done.load() == num_producers);
+        size_t count = 0;
+        if (batched)
+        {
+            count = ring.pop_n(buffer, BATCH);
+        }
+        else if (ring.pop(buffer[0]))
+        {
+            count = 1;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            consume(buffer[i]);
+        }
+        if (!count)
+        {
+            if (finished)
+            {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    for (uint32_t p = 0; p < num_producers; ++p)
+    {
+        //The newest item is never overwritten, the last one pushed must always arrive
+        result.lost += (last[p] != items) ? 1 : 0;
+    }
+    result.pushed = static_cast<uint64_t>(items) * num_producers;
+    if (lossless)
+    {
+        result.lost += result.pushed - result.received;
+    }
+    result.mitems_s = result.pushed / std::chrono::duration<double>(elapsed).count() / 1e6;
+    return result;
+}
+
+static int failures_ = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        std::printf("FAIL: %s\n", what);
+        ++failures_;
+    }
+}
+
+static void check_result(const char* name, const Result& result)
+{
+    report(name, result);
+    check(!result.torn, "torn item");
+    check(!result.order, "item out of order or missing");
+    check(!result.lost, "item lost");
+}
+
+//Single threaded edge cases, full and wrapped rings
+static void test_limits()
+{
+    RingBuffer<uint32_t, 4, RingPolicy::DROP_NEWEST> drop;
+    RingBuffer<uint32_t, 4, RingPolicy::OVERWRITE_OLDEST> overwrite;
+    RingBuffer<uint32_t, 4, RingPolicy::DROP_NEWEST, RingProducers::MULTI> multi;
+    uint32_t value = 0;
+    uint32_t values[8];
+
+    for (uint32_t lap = 0; lap < 3; ++lap)
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            check(drop.push(i) && multi.push(i), "push rejected below capacity");
+        }
+        check(!drop.push(4) && !multi.push(4), "push accepted past capacity");
+        check(drop.size() == 4 && multi.size() == 4, "size wrong when full");
+        check(drop.pop(value) && value == 0 && multi.pop(value) && value == 0, "pop out of order");
+        check(drop.pop_n(values, 8) == 3 && values[2] == 3, "pop_n wrong");
+        check(multi.pop_n(values, 8) == 3 && values[2] == 3, "MULTI pop_n wrong");
+        check(drop.empty() && multi.empty() && !drop.pop(value) && !multi.pop(value), "pop from empty ring");
+    }
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        check(overwrite.push(i), "OVERWRITE_OLDEST push rejected");
+    }
+    check(overwrite.size() == 4, "OVERWRITE_OLDEST size wrong");
+    check(overwrite.pop_n(values, 8) == 4 && values[0] == 6 && values[3] == 9, "OVERWRITE_OLDEST didn't keep the newest");
+    check(overwrite.empty(), "OVERWRITE_OLDEST not empty");
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t items = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+    const uint32_t num_producers = std::max(2u, std::min(3u, std::thread::hardware_concurrency() - 1));
+
+    test_limits();
+
+    static RingBuffer<Item, RING_SIZE, RingPolicy::DROP_NEWEST> drop;
+    check_result("SPSC DROP_NEWEST pop:", run(drop, items, 1, false, true));
+    check_result("SPSC DROP_NEWEST pop_n:", run(drop, items, 1, true, true));
+
+    static RingBuffer<Item, RING_SIZE, RingPolicy::OVERWRITE_OLDEST> overwrite;
+    check_result("SPSC OVERWRITE_OLDEST pop:", run(overwrite, items, 1, false, false));
+    check_result("SPSC OVERWRITE_OLDEST pop_n:", run(overwrite, items, 1, true, false));
+
+    static RingBuffer<Item, RING_SIZE, RingPolicy::DROP_NEWEST, RingProducers::MULTI> multi;
+    check_result("MPSC DROP_NEWEST 1 producer:", run(multi, items, 1, true, true));
+    std::printf("MPSC with %u producers:\n", num_producers);
+    check_result("MPSC DROP_NEWEST pop:", run(multi, items, num_producers, false, true));
+    check_result("MPSC DROP_NEWEST pop_n:", run(multi, items, num_producers, true, true));
+
+    return failures_ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <pico/platform.h>
+
+#include "Gamepad/SeqLock.h"
+#include "Gamepad/Gamepad.h"
+
+/*  Torn read stress test for SeqLock and the Gamepad PadIn/PadOut handoff. One thread plays the host
+    core writing, others play core0 reading. Every field of a written value is derived from one counter,
+    a reader that sees fields from two different writes has a torn read.
+    Usage: seqlock_test [writes] */
+
+static Gamepad::PadIn make_pad_in(uint32_t n)
+{
+    Gamepad::PadIn pad_in;
+    pad_in.dpad = static_cast<uint8_t>(n);
+    pad_in.buttons = static_cast<uint16_t>(n);
+    pad_in.trigger_l = static_cast<uint8_t>(n >> 8);
+    pad_in.trigger_r = static_cast<uint8_t>(n >> 16);
+    pad_in.joystick_lx = static_cast<int16_t>(n);
+    pad_in.joystick_ly = static_cast<int16_t>(~n);
+    pad_in.joystick_rx = static_cast<int16_t>(n >> 16);
+    pad_in.joystick_ry = static_cast<int16_t>(n * 3);
+    for (size_t i = 0; i < sizeof(pad_in.analog); ++i)
+    {
+        pad_in.analog[i] = static_cast<uint8_t>(n + i);
+    }
+    return pad_in;
+}
+
+//Returns the counter a PadIn was made from, or -1 if its fields don't agree
+static int64_t pad_in_counter(const Gamepad::PadIn& pad_in)
+{
+    const uint32_t n = static_cast<uint16_t>(pad_in.joystick_lx) | (static_cast<uint32_t>(static_cast<uint16_t>(pad_in.joystick_rx)) << 16);
+    const Gamepad::PadIn expected = make_pad_in(n);
+    return (Gamepad::changed_fields(expected, pad_in) == 0) ? static_cast<int64_t>(n) : -1;
+}
+
+//Plain SeqLock, several readers against one writer. Readers also check values never go backwards
+static bool test_seqlock(uint32_t writes, unsigned num_readers)
+{
+    SeqLock<Gamepad::PadIn> lock;
+    lock.store(make_pad_in(0));
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> backwards{0};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < num_readers; ++r)
+    {
+        readers.emplace_back([&]
+        {
+            int64_t last = 0;
+            uint64_t count = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                const int64_t n = pad_in_counter(lock.load());
+                if (n < 0)
+                {
+                    torn.fetch_add(1);
+                }
+                else if (n < last)
+                {
+                    backwards.fetch_add(1);
+                }
+                else
+                {
+                    last = n;
+                }
+                ++count;
+            }
+            reads.fetch_add(count);
+        });
+    }
+
+    for (uint32_t n = 1; n <= writes; ++n)
+    {
+        lock.store(make_pad_in(n));
+    }
+    done.store(true);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    const bool final_ok = (pad_in_counter(lock.load()) == writes);
+    std::printf("SeqLock:  %u writes, %llu reads, %llu torn, %llu backwards, final %s\n",
+                writes, static_cast<unsigned long long>(reads.load()), static_cast<unsigned long long>(torn.load()),
+                static_cast<unsigned long long>(backwards.load()), final_ok ? "ok" : "WRONG");
+    return !torn.load() && !backwards.load() && final_ok;
+}
+
+//Gamepad as used by the drivers: the host sets PadIn, the device polls new_pad_in/get_pad_in.
+//The last PadIn must always be picked up, the flag is cleared before the read so it can't be lost.
+//PadOut has two writers (device driver and manage_rumble), each writes rumble_l == rumble_r
+static bool test_gamepad(uint32_t writes)
+{
+    static Gamepad gamepad;
+    std::atomic<bool> done{false};
+    uint64_t torn_in = 0;
+    uint64_t torn_out = 0;
+    uint64_t picked_up = 0;
+    int64_t last = -1;
+
+    //Replaces the all zero PadIn from reset_pad_in, which doesn't decode to a counter
+    gamepad.set_pad_in(make_pad_in(0));
+
+    std::thread host([&]
+    {
+        stub_core_num = 1;
+        for (uint32_t n = 1; n <= writes; ++n)
+        {
+            gamepad.set_pad_in(make_pad_in(n));
+            if ((n & 63) == 0)
+            {
+                Gamepad::PadOut pad_out;
+                pad_out.rumble_l = pad_out.rumble_r = static_cast<uint8_t>(n);
+                gamepad.set_pad_out(pad_out);
+            }
+        }
+        done.store(true);
+    });
+
+    auto poll = [&]
+    {
+        if (gamepad.new_pad_in())
+        {
+            const int64_t n = pad_in_counter(gamepad.get_pad_in());
+            torn_in += (n < 0) ? 1 : 0;
+            last = (n < 0) ? last : n;
+            ++picked_up;
+        }
+        Gamepad::PadOut pad_out = gamepad.peek_pad_out();
+        torn_out += (pad_out.rumble_l != pad_out.rumble_r) ? 1 : 0;
+        pad_out.rumble_l = pad_out.rumble_r = static_cast<uint8_t>(picked_up);
+        gamepad.set_pad_out(pad_out);
+    };
+
+    while (!done.load())
+    {
+        poll();
+    }
+    host.join();
+    poll();
+
+    std::printf("Gamepad:  %u writes, %llu picked up, %llu torn PadIn, %llu torn PadOut, last %lld\n",
+                writes, static_cast<unsigned long long>(picked_up), static_cast<unsigned long long>(torn_in),
+                static_cast<unsigned long long>(torn_out), static_cast<long long>(last));
+    return !torn_in && !torn_out && (last == writes);
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t writes = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 2000000;
+    const unsigned readers = std::max(1u, std::min(3u, std::thread::hardware_concurrency() - 1));
+
+    bool ok = test_seqlock(writes, readers);
+    ok = test_gamepad(writes) && ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,4 @@
+#ifndef _STUB_BSP_BOARD_API_H_
+#define _STUB_BSP_BOARD_API_H_
+
+#endif // _STUB_BSP_BOARD_API_H_
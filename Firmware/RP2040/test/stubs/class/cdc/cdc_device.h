@@ -0,0 +1,6 @@
+#ifndef _STUB_TUSB_CDC_DEVICE_H_
+#define _STUB_TUSB_CDC_DEVICE_H_
+
+#include "tusb.h"
+
+#endif // _STUB_TUSB_CDC_DEVICE_H_
@@ -0,0 +1,26 @@
+#ifndef _STUB_TUSB_HID_DEVICE_H_
+#define _STUB_TUSB_HID_DEVICE_H_
+
+#include "tusb.h"
+
+#define TUD_HID_DESC_LEN (9 + 9 + 7)
+
+#define TUD_HID_DESCRIPTOR(_itfnum, _stridx, _boot_protocol, _report_desc_len, _epin, _epsize, _ep_interval) \
+    9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_HID, (uint8_t)((_boot_protocol) ? (uint8_t)HID_SUBCLASS_BOOT : 0), _boot_protocol, _stridx, \
+    9, HID_DESC_TYPE_HID, U16_TO_U8S_LE(0x0111), 0, 1, HID_DESC_TYPE_REPORT, U16_TO_U8S_LE(_report_desc_len), \
+    7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_epsize), _ep_interval
+
+bool tud_hid_n_ready(uint8_t instance);
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const* report, uint16_t len);
+
+static inline bool tud_hid_ready() { return tud_hid_n_ready(0); }
+static inline bool tud_hid_report(uint8_t report_id, void const* report, uint16_t len) { return tud_hid_n_report(0, report_id, report, len); }
+
+void hidd_init();
+bool hidd_deinit();
+void hidd_reset(uint8_t rhport);
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const* desc_itf, uint16_t max_len);
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const* request);
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes);
+
+#endif // _STUB_TUSB_HID_DEVICE_H_
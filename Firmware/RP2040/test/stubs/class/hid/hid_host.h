@@ -0,0 +1,11 @@
+#ifndef _STUB_TUSB_HID_HOST_H_
+#define _STUB_TUSB_HID_HOST_H_
+
+#include "tusb.h"
+
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx);
+bool tuh_hid_send_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, const void* report, uint16_t len);
+bool tuh_hid_set_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, uint8_t report_type, void* report, uint16_t len);
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx);
+
+#endif // _STUB_TUSB_HID_HOST_H_
@@ -0,0 +1,14 @@
+#ifndef _STUB_TUSB_USBD_H_
+#define _STUB_TUSB_USBD_H_
+
+#include "tusb.h"
+
+bool tud_mounted();
+bool tud_suspended();
+bool tud_remote_wakeup();
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request, void* buffer, uint16_t len);
+bool tud_control_status(uint8_t rhport, tusb_control_request_t const* request);
+
+#include "class/hid/hid_device.h"
+
+#endif // _STUB_TUSB_USBD_H_
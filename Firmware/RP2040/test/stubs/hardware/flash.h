@@ -0,0 +1,20 @@
+#ifndef _STUB_HARDWARE_FLASH_H_
+#define _STUB_HARDWARE_FLASH_H_
+
+#include "pico/types.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#ifndef PICO_FLASH_SIZE_BYTES
+    #define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+//Flash is a RAM image with NOR semantics, programming can only clear bits, see stubs.h
+extern uint8_t stub_flash_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE (reinterpret_cast<uintptr_t>(stub_flash_image))
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#endif // _STUB_HARDWARE_FLASH_H_
@@ -0,0 +1,12 @@
+#ifndef _STUB_HARDWARE_IRQ_H_
+#define _STUB_HARDWARE_IRQ_H_
+
+#include "pico/types.h"
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+
+#endif // _STUB_HARDWARE_IRQ_H_
@@ -0,0 +1,41 @@
+#ifndef _STUB_HARDWARE_SYNC_H_
+#define _STUB_HARDWARE_SYNC_H_
+
+#include <atomic>
+
+#include "pico/types.h"
+
+//Spin locks really exclude, tests run the two cores as threads
+typedef volatile uint32_t spin_lock_t;
+
+spin_lock_t* spin_lock_instance(uint lock_num);
+int spin_lock_claim_unused(bool required);
+
+static inline uint32_t spin_lock_blocking(spin_lock_t* lock)
+{
+    while (__atomic_exchange_n(lock, 1u, __ATOMIC_ACQUIRE))
+    {
+    }
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t* lock, uint32_t saved_irq)
+{
+    __atomic_store_n(lock, 0u, __ATOMIC_RELEASE);
+}
+
+//There are no interrupts to mask on the host, IRQ handlers only run when a test dispatches them
+static inline uint32_t save_and_disable_interrupts() { return 0; }
+static inline void restore_interrupts(uint32_t status) {}
+static inline void restore_interrupts_from_disabled(uint32_t status) {}
+
+//The event latch is shared between the "cores", board_api::wait_for_event sleeps on it on the wall clock
+void stub_sev();
+static inline void __sev() { stub_sev(); }
+static inline void __wfe() {}
+static inline void __wfi() {}
+static inline void __dmb() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+static inline void __mem_fence_acquire() { std::atomic_thread_fence(std::memory_order_acquire); }
+static inline void __mem_fence_release() { std::atomic_thread_fence(std::memory_order_release); }
+
+#endif // _STUB_HARDWARE_SYNC_H_
@@ -0,0 +1,51 @@
+#ifndef _STUB_HARDWARE_TIMER_H_
+#define _STUB_HARDWARE_TIMER_H_
+
+#include "pico/types.h"
+
+//Writing an alarm arms it, like the hardware
+struct stub_alarm_reg_t
+{
+    uint32_t value{0};
+    bool armed{false};
+
+    stub_alarm_reg_t& operator=(uint32_t target)
+    {
+        value = target;
+        armed = true;
+        return *this;
+    }
+    operator uint32_t() const { return value; }
+};
+
+typedef struct
+{
+    io_rw_32 timehw;
+    io_rw_32 timelw;
+    io_rw_32 timehr;
+    io_rw_32 timelr;
+    stub_alarm_reg_t alarm[4];
+    io_rw_32 armed;
+    io_rw_32 timerawh;
+    io_rw_32 timerawl;
+    io_rw_32 dbgpause;
+    io_rw_32 pause;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_rw_32 ints;
+} timer_hw_t;
+
+//Time is simulated, tests move it with stubs::advance_time_us
+extern timer_hw_t* timer_hw;
+
+uint64_t time_us_64();
+static inline uint32_t time_us_32() { return static_cast<uint32_t>(time_us_64()); }
+
+static inline uint timer_hardware_alarm_get_irq_num(timer_hw_t* timer, uint alarm_num) { return alarm_num; }
+static inline uint hardware_alarm_get_irq_num(uint alarm_num) { return alarm_num; }
+
+static inline void hw_set_bits(io_rw_32* addr, uint32_t mask) { *addr = *addr | mask; }
+static inline void hw_clear_bits(io_rw_32* addr, uint32_t mask) { *addr = *addr & ~mask; }
+
+#endif // _STUB_HARDWARE_TIMER_H_
@@ -0,0 +1,32 @@
+#ifndef _STUB_TUSB_USBH_H_
+#define _STUB_TUSB_USBH_H_
+
+#include "tusb.h"
+
+struct tuh_xfer_s;
+typedef struct tuh_xfer_s tuh_xfer_t;
+typedef void (*tuh_xfer_cb_t)(tuh_xfer_t* xfer);
+
+struct tuh_xfer_s
+{
+    uint8_t daddr;
+    uint8_t ep_addr;
+    uint8_t reserved;
+    xfer_result_t result;
+    uint32_t actual_len;
+    union
+    {
+        tusb_control_request_t const* setup;
+        uint32_t buflen;
+    };
+    uint8_t* buffer;
+    tuh_xfer_cb_t complete_cb;
+    uintptr_t user_data;
+};
+
+bool tuh_control_xfer(tuh_xfer_t* xfer);
+void tuh_task();
+bool tuh_mounted(uint8_t daddr);
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t* vid, uint16_t* pid);
+
+#endif // _STUB_TUSB_USBH_H_
@@ -0,0 +1,11 @@
+#ifndef _STUB_PICO_FLASH_H_
+#define _STUB_PICO_FLASH_H_
+
+#include "pico/types.h"
+
+//Result and lockout readiness are set by tests through stubs::set_flash_safe_result
+int flash_safe_execute(void (*func)(void*), void* param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init();
+bool flash_safe_execute_core_deinit();
+
+#endif // _STUB_PICO_FLASH_H_
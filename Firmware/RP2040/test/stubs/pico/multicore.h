@@ -0,0 +1,11 @@
+#ifndef _STUB_PICO_MULTICORE_H_
+#define _STUB_PICO_MULTICORE_H_
+
+#include "pico/types.h"
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1();
+bool multicore_lockout_victim_is_initialized(uint core_num);
+void multicore_lockout_victim_init();
+
+#endif // _STUB_PICO_MULTICORE_H_
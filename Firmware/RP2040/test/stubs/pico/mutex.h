@@ -0,0 +1,20 @@
+#ifndef _STUB_PICO_MUTEX_H_
+#define _STUB_PICO_MUTEX_H_
+
+#include "pico/types.h"
+#include "hardware/sync.h"
+
+typedef struct
+{
+    spin_lock_t lock;
+} mutex_t;
+
+static inline void mutex_init(mutex_t* mtx) { mtx->lock = 0; }
+static inline void mutex_enter_blocking(mutex_t* mtx) { spin_lock_blocking(&mtx->lock); }
+static inline bool mutex_try_enter(mutex_t* mtx, uint32_t* owner_out)
+{
+    return !__atomic_exchange_n(&mtx->lock, 1u, __ATOMIC_ACQUIRE);
+}
+static inline void mutex_exit(mutex_t* mtx) { spin_unlock(&mtx->lock, 0); }
+
+#endif // _STUB_PICO_MUTEX_H_
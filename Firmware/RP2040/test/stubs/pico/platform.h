@@ -0,0 +1,17 @@
+#ifndef _STUB_PICO_PLATFORM_H_
+#define _STUB_PICO_PLATFORM_H_
+
+#include "pico/types.h"
+
+#define __not_in_flash_func(func) func
+#define __time_critical_func(func) func
+#define __no_inline_not_in_flash_func(func) func
+#define __force_inline inline __attribute__((always_inline))
+
+//Set per thread by tests that play the part of core0 and core1
+extern thread_local uint stub_core_num;
+
+static inline uint get_core_num() { return stub_core_num; }
+static inline void tight_loop_contents() {}
+
+#endif // _STUB_PICO_PLATFORM_H_
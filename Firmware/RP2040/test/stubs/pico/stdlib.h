@@ -0,0 +1,9 @@
+#ifndef _STUB_PICO_STDLIB_H_
+#define _STUB_PICO_STDLIB_H_
+
+#include "pico/types.h"
+#include "pico/platform.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+
+#endif // _STUB_PICO_STDLIB_H_
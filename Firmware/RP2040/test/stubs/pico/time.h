@@ -0,0 +1,18 @@
+#ifndef _STUB_PICO_TIME_H_
+#define _STUB_PICO_TIME_H_
+
+#include "pico/types.h"
+#include "hardware/timer.h"
+
+static inline absolute_time_t get_absolute_time() { return time_us_64(); }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return static_cast<uint32_t>(t / 1000); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return time_us_64() + static_cast<uint64_t>(ms) * 1000; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return static_cast<int64_t>(to - from); }
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+static inline void busy_wait_us(uint64_t us) { sleep_us(us); }
+static inline void busy_wait_ms(uint32_t ms) { sleep_ms(ms); }
+
+#endif // _STUB_PICO_TIME_H_
@@ -0,0 +1,17 @@
+#ifndef _STUB_PICO_TYPES_H_
+#define _STUB_PICO_TYPES_H_
+
+#include <cstdint>
+#include <cstddef>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+#define PICO_ERROR_NOT_PERMITTED -4
+
+#endif // _STUB_PICO_TYPES_H_
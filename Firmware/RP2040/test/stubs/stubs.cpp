@@ -0,0 +1,438 @@
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "pico/multicore.h"
+#include "hardware/irq.h"
+#include "hardware/flash.h"
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+#include "class/hid/hid_host.h"
+
+#include "USBHost/HostDriver/XInput/tuh_xinput/tuh_xinput.h"
+#include "USBDevice/DeviceDriver/XInput/tud_xinput/tud_xinput.h"
+#include "USBDevice/DeviceDriver/XboxOG/tud_xid/tud_xid.h"
+#include "Board/board_api.h"
+#include "stubs.h"
+
+thread_local uint stub_core_num = 0;
+
+/* ---- Time and timer IRQs ---- */
+
+static timer_hw_t stub_timer_hw_;
+timer_hw_t* timer_hw = &stub_timer_hw_;
+
+static constexpr uint NUM_IRQS = 32;
+static irq_handler_t irq_handlers_[NUM_IRQS]{};
+static bool irq_enabled_[NUM_IRQS]{};
+static uint64_t time_us_{0};
+static uint64_t irq_max_ns_{0};
+
+uint64_t time_us_64()
+{
+    return time_us_;
+}
+
+void sleep_us(uint64_t us)
+{
+    stubs::advance_time_us(us);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    stubs::advance_time_us(static_cast<uint64_t>(ms) * 1000);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    irq_handlers_[num % NUM_IRQS] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    irq_enabled_[num % NUM_IRQS] = enabled;
+}
+
+bool irq_is_enabled(uint num)
+{
+    return irq_enabled_[num % NUM_IRQS];
+}
+
+void stubs::set_time_us(uint64_t time_us)
+{
+    time_us_ = time_us;
+    stub_timer_hw_.timelr = static_cast<uint32_t>(time_us);
+    stub_timer_hw_.timerawl = static_cast<uint32_t>(time_us);
+    stub_timer_hw_.timehr = static_cast<uint32_t>(time_us >> 32);
+    stub_timer_hw_.timerawh = static_cast<uint32_t>(time_us >> 32);
+    run_timer_irqs();
+}
+
+void stubs::advance_time_us(uint64_t delta_us)
+{
+    set_time_us(time_us_ + delta_us);
+}
+
+//An alarm matches on the low 32 bits, a forced interrupt (INTF) fires regardless
+void stubs::run_timer_irqs()
+{
+    bool fired = true;
+    while (fired)
+    {
+        fired = false;
+        for (uint alarm = 0; alarm < 4; ++alarm)
+        {
+            const uint32_t bit = 1u << alarm;
+            stub_alarm_reg_t& reg = stub_timer_hw_.alarm[alarm];
+
+            if (reg.armed && static_cast<int32_t>(static_cast<uint32_t>(time_us_) - reg.value) >= 0)
+            {
+                reg.armed = false;
+                stub_timer_hw_.intr = stub_timer_hw_.intr | bit;
+            }
+            if (!((stub_timer_hw_.intr | stub_timer_hw_.intf) & bit & stub_timer_hw_.inte) ||
+                !irq_enabled_[alarm] || !irq_handlers_[alarm])
+            {
+                continue;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            irq_handlers_[alarm]();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            irq_max_ns_ = std::max(irq_max_ns_, static_cast<uint64_t>(elapsed.count()));
+            fired = true;
+        }
+    }
+}
+
+uint64_t stubs::timer_irq_max_ns()
+{
+    return irq_max_ns_;
+}
+
+void stubs::reset_timer_irq_stats()
+{
+    irq_max_ns_ = 0;
+}
+
+/* ---- Events ---- */
+
+static std::atomic<bool> event_{false};
+static std::atomic<uint32_t> event_waiters_{0};
+static std::mutex event_mutex_;
+static std::condition_variable event_cv_;
+
+//Only takes the lock when a core is waiting, set_pad_in calls this on every report
+void stub_sev()
+{
+    event_.store(true);
+    if (event_waiters_.load())
+    {
+        std::lock_guard<std::mutex> lock(event_mutex_);
+        event_cv_.notify_all();
+    }
+}
+
+//Like best_effort_wfe_or_timeout, returns at once if an event was signaled since the last wait.
+//Waits on the wall clock, stubbed time doesn't move
+void board_api::wait_for_event(uint32_t timeout_us)
+{
+    if (event_.exchange(false))
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(event_mutex_);
+    event_waiters_.fetch_add(1);
+    event_cv_.wait_for(lock, std::chrono::microseconds(timeout_us), [] { return event_.load(); });
+    event_waiters_.fetch_sub(1);
+    event_.store(false);
+}
+
+/* ---- Spin locks ---- */
+
+static constexpr uint NUM_SPIN_LOCKS = 256;
+static spin_lock_t spin_locks_[NUM_SPIN_LOCKS]{};
+static std::atomic<uint> next_spin_lock_{0};
+
+spin_lock_t* spin_lock_instance(uint lock_num)
+{
+    return &spin_locks_[lock_num % NUM_SPIN_LOCKS];
+}
+
+//Every object that claims a lock gets its own until the pool wraps
+int spin_lock_claim_unused(bool required)
+{
+    return static_cast<int>(next_spin_lock_.fetch_add(1) % NUM_SPIN_LOCKS);
+}
+
+/* ---- Flash ---- */
+
+uint8_t stub_flash_image[PICO_FLASH_SIZE_BYTES];
+
+static long power_loss_ops_{-1};
+static uint32_t erase_count_{0};
+static uint32_t program_count_{0};
+static int flash_safe_result_{PICO_OK};
+static uint32_t flash_safe_ok_calls_{0};
+static bool core1_lockout_ready_{true};
+static bool core1_launched_{false};
+
+static void count_flash_op()
+{
+    if (power_loss_ops_ == 0)
+    {
+        throw stubs::PowerLoss();
+    }
+    if (power_loss_ops_ > 0)
+    {
+        --power_loss_ops_;
+    }
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    if ((flash_offs % FLASH_SECTOR_SIZE) || (count % FLASH_SECTOR_SIZE) || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+    {
+        std::abort();
+    }
+    count_flash_op();
+    ++erase_count_;
+    std::memset(stub_flash_image + flash_offs, 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count)
+{
+    if ((flash_offs % FLASH_PAGE_SIZE) || (count % FLASH_PAGE_SIZE) || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+    {
+        std::abort();
+    }
+    count_flash_op();
+    ++program_count_;
+    for (size_t i = 0; i < count; ++i)
+    {
+        stub_flash_image[flash_offs + i] &= data[i];
+    }
+}
+
+int flash_safe_execute(void (*func)(void*), void* param, uint32_t enter_exit_timeout_ms)
+{
+    if (flash_safe_result_ != PICO_OK)
+    {
+        if (flash_safe_ok_calls_ == 0)
+        {
+            return flash_safe_result_;
+        }
+        --flash_safe_ok_calls_;
+    }
+    func(param);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init()
+{
+    core1_lockout_ready_ = true;
+    return true;
+}
+
+bool flash_safe_execute_core_deinit()
+{
+    core1_lockout_ready_ = false;
+    return true;
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+    core1_launched_ = true;
+}
+
+void multicore_reset_core1()
+{
+    core1_launched_ = false;
+}
+
+bool multicore_lockout_victim_is_initialized(uint core_num)
+{
+    return (core_num == 1) ? core1_lockout_ready_ : true;
+}
+
+void multicore_lockout_victim_init()
+{
+    core1_lockout_ready_ = true;
+}
+
+bool board_api::core1_launched()
+{
+    return core1_launched_;
+}
+
+void stubs::flash_erase_all()
+{
+    std::memset(stub_flash_image, 0xFF, sizeof(stub_flash_image));
+}
+
+void stubs::set_flash_power_loss(long ops_until_power_loss)
+{
+    power_loss_ops_ = ops_until_power_loss;
+}
+
+uint32_t stubs::flash_erase_count()
+{
+    return erase_count_;
+}
+
+uint32_t stubs::flash_program_count()
+{
+    return program_count_;
+}
+
+void stubs::set_flash_safe_result(int result, uint32_t after_calls)
+{
+    flash_safe_result_ = result;
+    flash_safe_ok_calls_ = after_calls;
+}
+
+void stubs::set_core1_lockout_ready(bool ready)
+{
+    core1_lockout_ready_ = ready;
+}
+
+bool stubs::core1_launched()
+{
+    return core1_launched_;
+}
+
+/* ---- TinyUSB ---- */
+
+static stubs::Transfer device_in_[CFG_TUD_HID]{};
+static stubs::Transfer host_out_{};
+static bool device_ready_{true};
+
+static bool record(stubs::Transfer& transfer, const void* report, uint16_t len)
+{
+    transfer.len = std::min(len, static_cast<uint16_t>(transfer.data.size()));
+    std::memcpy(transfer.data.data(), report, transfer.len);
+    ++transfer.count;
+    return true;
+}
+
+const stubs::Transfer& stubs::device_in(uint8_t instance)
+{
+    return device_in_[instance % CFG_TUD_HID];
+}
+
+const stubs::Transfer& stubs::host_out()
+{
+    return host_out_;
+}
+
+void stubs::reset_transfers()
+{
+    for (auto& transfer : device_in_)
+    {
+        transfer = Transfer();
+    }
+    host_out_ = Transfer();
+}
+
+void stubs::set_device_ready(bool ready)
+{
+    device_ready_ = ready;
+}
+
+bool tud_mounted() { return true; }
+bool tud_suspended() { return false; }
+bool tud_remote_wakeup() { return true; }
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request, void* buffer, uint16_t len) { return true; }
+bool tud_control_status(uint8_t rhport, tusb_control_request_t const* request) { return true; }
+
+bool tud_hid_n_ready(uint8_t instance)
+{
+    return device_ready_;
+}
+
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const* report, uint16_t len)
+{
+    return device_ready_ && record(device_in_[instance % CFG_TUD_HID], report, len);
+}
+
+void hidd_init() {}
+bool hidd_deinit() { return true; }
+void hidd_reset(uint8_t rhport) {}
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const* desc_itf, uint16_t max_len) { return 0; }
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const* request) { return true; }
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes) { return true; }
+
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep) { return true; }
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes) { return true; }
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr) { return !device_ready_; }
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr) { return true; }
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr) { return true; }
+
+bool tuh_control_xfer(tuh_xfer_t* xfer) { return true; }
+void tuh_task() {}
+bool tuh_mounted(uint8_t daddr) { return true; }
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t* vid, uint16_t* pid) { *vid = 0; *pid = 0; return true; }
+
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx)
+{
+    return true;
+}
+
+bool tuh_hid_send_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, const void* report, uint16_t len)
+{
+    return record(host_out_, report, len);
+}
+
+bool tuh_hid_set_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, uint8_t report_type, void* report, uint16_t len)
+{
+    return record(host_out_, report, len);
+}
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx)
+{
+    return HID_ITF_PROTOCOL_NONE;
+}
+
+namespace tuh_xinput
+{
+    static usbh_class_driver_t class_driver_{};
+
+    const usbh_class_driver_t* class_driver() { return &class_driver_; }
+    bool send_report(uint8_t address, uint8_t instance, const uint8_t* report, uint16_t len) { return record(host_out_, report, len); }
+    bool receive_report(uint8_t address, uint8_t instance) { return true; }
+    bool set_rumble(uint8_t address, uint8_t instance, uint8_t rumble_l, uint8_t rumble_r, bool block) 
+    { 
+        const uint8_t report[] = { rumble_l, rumble_r };
+        return record(host_out_, report, sizeof(report));
+    }
+    bool set_led(uint8_t address, uint8_t instance, uint8_t led_number, bool block) { return true; }
+    void xbox360_chatpad_init(uint8_t address, uint8_t instance) {}
+    bool xbox360_chatpad_keepalive(uint8_t address, uint8_t instance) { return true; }
+}
+
+namespace tud_xinput
+{
+    static usbd_class_driver_t class_driver_{};
+
+    bool send_report_ready() { return device_ready_; }
+    bool send_report(const uint8_t* report, uint16_t len) { return device_ready_ && record(device_in_[0], report, len); }
+    bool receive_report(uint8_t* report, uint16_t len) { return false; }
+    const usbd_class_driver_t* class_driver() { return &class_driver_; }
+}
+
+namespace tud_xid
+{
+    static usbd_class_driver_t class_driver_{};
+
+    void initialize(tud_xid::Type xid_type) {}
+    const usbd_class_driver_t* class_driver() { return &class_driver_; }
+    uint8_t get_index_by_type(uint8_t type_index, tud_xid::Type xid_type) { return type_index; }
+    bool send_report_ready(uint8_t idx) { return device_ready_; }
+    bool send_report(uint8_t idx, const uint8_t* buffer, uint16_t len) { return device_ready_ && record(device_in_[idx % CFG_TUD_HID], buffer, len); }
+    bool receive_report(uint8_t idx, uint8_t* buffer, uint16_t len) { return false; }
+    bool xremote_rom_available() { return false; }
+}
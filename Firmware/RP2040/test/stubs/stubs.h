@@ -0,0 +1,53 @@
+#ifndef _STUBS_H_
+#define _STUBS_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#include "pico/types.h"
+
+/*  Test side controls for the pico-sdk and TinyUSB stubs. Nothing here allocates,
+    the replay benchmark counts allocations on the translation path. */
+namespace stubs
+{
+    //Time only moves when a test moves it. Due timer alarms fire from advance_time_us,
+    //on the calling thread, the way the IRQ would on the core that armed it
+    void set_time_us(uint64_t time_us);
+    void advance_time_us(uint64_t delta_us);
+    void run_timer_irqs();
+
+    //Longest single timer IRQ handler call so far, wall clock
+    uint64_t timer_irq_max_ns();
+    void reset_timer_irq_stats();
+
+    //Last report each side handed to TinyUSB
+    struct Transfer
+    {
+        uint32_t count{0};
+        uint16_t len{0};
+        std::array<uint8_t, 64> data{};
+    };
+    const Transfer& device_in(uint8_t instance = 0);
+    const Transfer& host_out();
+    void reset_transfers();
+
+    //Endpoint readiness, a busy endpoint rejects reports
+    void set_device_ready(bool ready);
+
+    //Flash. Programming ANDs into the image like NOR, erase sets 0xFF.
+    //After ops_until_power_loss more erase/program calls a flash op throws PowerLoss, -1 never
+    struct PowerLoss {};
+    void flash_erase_all();
+    void set_flash_power_loss(long ops_until_power_loss);
+    uint32_t flash_erase_count();
+    uint32_t flash_program_count();
+
+    //What flash_safe_execute returns once after_calls more calls have succeeded,
+    //and whether core1 has called flash_safe_execute_core_init
+    void set_flash_safe_result(int result, uint32_t after_calls = 0);
+    void set_core1_lockout_ready(bool ready);
+    bool core1_launched();
+}
+
+#endif // _STUBS_H_
@@ -0,0 +1,174 @@
+#ifndef _STUB_TUSB_H_
+#define _STUB_TUSB_H_
+
+/*  Just enough of TinyUSB's common types, descriptor macros and class APIs for the
+    translation code to build on the host. Transfers are recorded by stubs.cpp, see stubs.h */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+//The arm toolchain and SDK headers pull these in for the firmware
+#include <tuple>
+#include <utility>
+
+#include "pico/stdlib.h"
+#include "tusb_option.h"
+
+#define TU_ATTR_WEAK __attribute__((weak))
+#define TU_ATTR_PACKED __attribute__((packed))
+#define TU_ATTR_ALIGNED(x) __attribute__((aligned(x)))
+#define TU_ATTR_UNUSED __attribute__((unused))
+#define TU_ATTR_ALWAYS_INLINE __attribute__((always_inline))
+
+#define TU_BIT(n) (1UL << (n))
+#define TU_U16_HIGH(u16) ((uint8_t)(((u16) >> 8) & 0x00ff))
+#define TU_U16_LOW(u16) ((uint8_t)((u16) & 0x00ff))
+#define U16_TO_U8S_LE(u16) TU_U16_LOW(u16), TU_U16_HIGH(u16)
+#define TU_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define TU_MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define TU_ASSERT(cond, ...) do { if (!(cond)) return __VA_ARGS__; } while (0)
+#define TU_VERIFY(cond, ...) do { if (!(cond)) return __VA_ARGS__; } while (0)
+#define TU_LOG1(...)
+#define TU_LOG2(...)
+
+typedef enum
+{
+    TUSB_DESC_DEVICE = 0x01,
+    TUSB_DESC_CONFIGURATION = 0x02,
+    TUSB_DESC_STRING = 0x03,
+    TUSB_DESC_INTERFACE = 0x04,
+    TUSB_DESC_ENDPOINT = 0x05,
+    TUSB_DESC_DEVICE_QUALIFIER = 0x06,
+    TUSB_DESC_INTERFACE_ASSOCIATION = 0x0B,
+    TUSB_DESC_CS_INTERFACE = 0x24,
+    TUSB_DESC_CS_ENDPOINT = 0x25,
+} tusb_desc_type_t;
+
+typedef enum
+{
+    TUSB_CLASS_UNSPECIFIED = 0,
+    TUSB_CLASS_AUDIO = 1,
+    TUSB_CLASS_CDC = 2,
+    TUSB_CLASS_HID = 3,
+    TUSB_CLASS_CDC_DATA = 10,
+    TUSB_CLASS_MISC = 0xEF,
+    TUSB_CLASS_VENDOR_SPECIFIC = 0xFF,
+} tusb_class_code_t;
+
+typedef enum
+{
+    TUSB_XFER_CONTROL = 0,
+    TUSB_XFER_ISOCHRONOUS,
+    TUSB_XFER_BULK,
+    TUSB_XFER_INTERRUPT
+} tusb_xfer_type_t;
+
+typedef enum
+{
+    TUSB_DIR_OUT = 0,
+    TUSB_DIR_IN = 1,
+    TUSB_DIR_IN_MASK = 0x80
+} tusb_dir_t;
+
+typedef enum
+{
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+    XFER_RESULT_STALLED,
+    XFER_RESULT_TIMEOUT,
+    XFER_RESULT_INVALID
+} xfer_result_t;
+
+enum
+{
+    TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP = TU_BIT(5),
+    TUSB_DESC_CONFIG_ATT_SELF_POWERED = TU_BIT(6),
+};
+
+enum
+{
+    CONTROL_STAGE_IDLE = 0,
+    CONTROL_STAGE_SETUP,
+    CONTROL_STAGE_DATA,
+    CONTROL_STAGE_ACK
+};
+
+enum
+{
+    MISC_SUBCLASS_COMMON = 2,
+    MISC_PROTOCOL_IAD = 1
+};
+
+typedef struct TU_ATTR_PACKED
+{
+    uint8_t  bmRequestType;
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef struct TU_ATTR_PACKED
+{
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED
+{
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint8_t  bNumConfigurations;
+    uint8_t  bReserved;
+} tusb_desc_device_qualifier_t;
+
+typedef struct TU_ATTR_PACKED
+{
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED
+{
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bEndpointAddress;
+    uint8_t  bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t  bInterval;
+} tusb_desc_endpoint_t;
+
+#define TUD_CONFIG_DESC_LEN (9)
+
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+    9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, TU_BIT(7) | _attribute, (_power_ma)/2
+
+#include "class/hid/hid.h"
+#include "device/usbd.h"
+#include "host/usbh.h"
+
+#endif // _STUB_TUSB_H_
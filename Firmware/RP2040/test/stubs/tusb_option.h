@@ -0,0 +1,17 @@
+#ifndef _STUB_TUSB_OPTION_H_
+#define _STUB_TUSB_OPTION_H_
+
+#ifndef CFG_TUSB_DEBUG
+    #define CFG_TUSB_DEBUG 0
+#endif
+#define CFG_TUD_LOG_LEVEL 2
+
+#define CFG_TUD_ENDPOINT0_SIZE 64
+#define CFG_TUD_HID 4
+#define CFG_TUD_HID_EP_BUFSIZE 64
+#define CFG_TUD_CDC 1
+#define CFG_TUH_HID 4
+#define CFG_TUH_HID_EPIN_BUFSIZE 64
+#define CFG_TUH_HID_EPOUT_BUFSIZE 64
+
+#endif // _STUB_TUSB_OPTION_H_
@@ -0,0 +1,257 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <new>
+
+#include "TaskQueue/TaskQueue.h"
+
+#include "stubs.h"
+
+/*  TaskQueue correctness and timing. Time is simulated, due alarms call the registered timer IRQ handler
+    from stubs::advance_time_us the way the hardware would. Reports ns per queue/cancel operation and the
+    longest timer IRQ with every delayed task slot in use. Fails on a missed, duplicated or early task,
+    on any heap allocation, or if the IRQ exceeds the optional limit.
+    Usage: taskqueue_bench [ops] [max_irq_ns] */
+
+static std::atomic<uint64_t> allocations_{0};
+
+void* operator new(size_t size)
+{
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+static constexpr size_t NUM_TIMERS = 16; //TaskQueue::MAX_DELAYED_TASKS
+static constexpr uint64_t MS = 1000;
+
+static uint64_t now_us_ = 0;
+static int failures_ = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        std::printf("FAIL: %s\n", what);
+        ++failures_;
+    }
+}
+
+//Moves simulated time in 1ms steps, running the core0 loop after each like main does
+static void run_for_ms(uint64_t ms)
+{
+    for (uint64_t i = 0; i < ms; ++i)
+    {
+        now_us_ += MS;
+        stubs::advance_time_us(MS);
+        TaskQueue::Core0::process_tasks();
+    }
+}
+
+struct Fired
+{
+    uint32_t count{0};
+    uint64_t first_us{0};
+};
+
+//Random one-shots with cancels against a model, each live task fires once, no earlier than its delay
+static void test_one_shots(uint32_t ops)
+{
+    std::mt19937 rng(1);
+    static Fired fired[NUM_TIMERS];
+    uint32_t ids[NUM_TIMERS]{};
+    uint64_t due_us[NUM_TIMERS]{};
+
+    for (uint32_t op = 0; op < ops; ++op)
+    {
+        const size_t i = rng() % NUM_TIMERS;
+        if (ids[i] == 0)
+        {
+            const uint32_t delay_ms = rng() % 20;
+            ids[i] = TaskQueue::Core0::get_new_task_id();
+            due_us[i] = now_us_ + delay_ms * MS;
+            fired[i] = Fired{};
+            Fired* slot = &fired[i];
+            check(TaskQueue::Core0::queue_delayed_task(ids[i], delay_ms, false, [slot]
+            {
+                if (slot->count++ == 0)
+                {
+                    slot->first_us = now_us_;
+                }
+            }), "queue_delayed_task rejected with a free slot");
+        }
+        else if ((rng() % 4) == 0 && fired[i].count == 0)
+        {
+            TaskQueue::Core0::cancel_delayed_task(ids[i]);
+            ids[i] = 0;
+        }
+        else
+        {
+            run_for_ms(rng() % 3);
+        }
+
+        for (size_t j = 0; j < NUM_TIMERS; ++j)
+        {
+            if (ids[j] && fired[j].count)
+            {
+                check(fired[j].count == 1, "one-shot ran more than once");
+                check(fired[j].first_us >= due_us[j], "one-shot ran early");
+                ids[j] = 0;
+            }
+        }
+    }
+
+    //Drain, anything still pending must fire
+    run_for_ms(20 + NUM_TIMERS);
+    for (size_t j = 0; j < NUM_TIMERS; ++j)
+    {
+        check(!ids[j] || fired[j].count == 1, "one-shot never ran");
+    }
+    std::printf("one-shots:  %u random ops ok\n", ops);
+}
+
+//Every slot due in the same IRQ, more than the ready queue holds. None may be lost
+static void test_burst()
+{
+    static uint32_t runs[NUM_TIMERS + 1];
+    for (auto& run : runs) run = 0;
+
+    for (size_t i = 0; i < NUM_TIMERS; ++i)
+    {
+        uint32_t* run = &runs[i];
+        check(TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), 5, false, [run] { ++*run; }),
+              "queue_delayed_task rejected below capacity");
+    }
+    uint32_t* extra = &runs[NUM_TIMERS];
+    check(!TaskQueue::Core0::queue_delayed_task(TaskQueue::Core0::get_new_task_id(), 5, false, [extra] { ++*extra; }),
+          "queue_delayed_task accepted past capacity");
+
+    stubs::reset_timer_irq_stats();
+    run_for_ms(10);
+
+    for (size_t i = 0; i < NUM_TIMERS; ++i)
+    {
+        check(runs[i] == 1, "burst task lost or repeated");
+    }
+    check(runs[NUM_TIMERS] == 0, "rejected task ran");
+    std::printf("burst:      %zu tasks due at once, worst IRQ %llu ns\n",
+                NUM_TIMERS, static_cast<unsigned long long>(stubs::timer_irq_max_ns()));
+}
+
+//Every slot repeating at 1..16ms. Counts may fall short by the ticks a full ready queue pushed back
+static uint64_t test_repeating(uint64_t duration_ms)
+{
+    static uint32_t runs[NUM_TIMERS];
+    uint32_t ids[NUM_TIMERS];
+
+    for (size_t i = 0; i < NUM_TIMERS; ++i)
+    {
+        runs[i] = 0;
+        ids[i] = TaskQueue::Core0::get_new_task_id();
+        uint32_t* run = &runs[i];
+        check(TaskQueue::Core0::queue_delayed_task(ids[i], static_cast<uint32_t>(i + 1), true, [run] { ++*run; }),
+              "repeating task rejected");
+    }
+
+    stubs::reset_timer_irq_stats();
+    run_for_ms(duration_ms);
+    const uint64_t irq_max_ns = stubs::timer_irq_max_ns();
+
+    for (size_t i = 0; i < NUM_TIMERS; ++i)
+    {
+        TaskQueue::Core0::cancel_delayed_task(ids[i]);
+        const uint64_t expected = duration_ms / (i + 1);
+        check(runs[i] <= expected && runs[i] >= expected - expected / 10, "repeating task count off");
+    }
+
+    //Cancelled, nothing may run anymore
+    const uint32_t run_0 = runs[0];
+    run_for_ms(20);
+    check(runs[0] == run_0, "cancelled repeating task ran");
+
+    std::printf("repeating:  %zu timers for %llu ms, 1ms runs %u, worst IRQ %llu ns\n",
+                NUM_TIMERS, static_cast<unsigned long long>(duration_ms), runs[0],
+                static_cast<unsigned long long>(irq_max_ns));
+    return irq_max_ns;
+}
+
+template <typename Op>
+static double ns_per_op(uint32_t ops, Op op)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        op(i);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+}
+
+static void bench(uint32_t ops)
+{
+    static volatile uint32_t sink = 0;
+
+    const double queue_ns = ns_per_op(ops, [](uint32_t)
+    {
+        TaskQueue::Core0::queue_task([] { sink = sink + 1; });
+        TaskQueue::Core0::process_tasks();
+    });
+    check(sink == ops, "queued tasks lost");
+
+    //Worst case for the heap and id map, every other slot is in use
+    uint32_t ids[NUM_TIMERS - 1];
+    for (auto& id : ids)
+    {
+        id = TaskQueue::Core0::get_new_task_id();
+        TaskQueue::Core0::queue_delayed_task(id, 1000 + (id % 97), false, [] { sink = sink + 1; });
+    }
+    const double delayed_ns = ns_per_op(ops, [](uint32_t i)
+    {
+        const uint32_t id = TaskQueue::Core0::get_new_task_id();
+        TaskQueue::Core0::queue_delayed_task(id, 1 + (i % 500), false, [] { sink = sink + 1; });
+        TaskQueue::Core0::cancel_delayed_task(id);
+    });
+    for (auto id : ids)
+    {
+        TaskQueue::Core0::cancel_delayed_task(id);
+    }
+
+    std::printf("queue_task + process_tasks:          %8.1f ns/op\n", queue_ns);
+    std::printf("queue_delayed_task + cancel (15 in): %8.1f ns/op\n", delayed_ns);
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t ops = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 200000;
+    const uint64_t max_irq_ns = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 0;
+
+    //Constructs the queue and registers its timer IRQ before allocations are counted
+    TaskQueue::Core0::process_tasks();
+    const uint64_t allocations = allocations_.load();
+
+    test_one_shots(ops / 10);
+    test_burst();
+    const uint64_t irq_max_ns = test_repeating(10000);
+    bench(ops);
+
+    check(allocations_.load() == allocations, "TaskQueue allocated");
+    check(max_irq_ns == 0 || irq_max_ns <= max_irq_ns, "timer IRQ over the limit");
+
+    return failures_ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
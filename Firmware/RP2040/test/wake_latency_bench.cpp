@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "TaskQueue/TaskQueue.h"
+#include "Board/board_api.h"
+#include "USBDevice/DeviceDriver/XInput/XInput.h"
+
+#include "stubs.h"
+
+/*  Input to submit latency of the core0 device loop, sleeping 1 ms per pass as the board loops used to
+    against waiting in board_api::wait_for_event for the __sev from Gamepad::set_pad_in. A host thread
+    stands in for core1 and publishes a new PadIn at random points in the loop's cycle, the loop runs the
+    same passes as standard::run and the time from set_pad_in to the report reaching TinyUSB is measured
+    on the wall clock. Fails if waiting for the event isn't faster at the median.
+    Usage: wake_latency_bench [samples] */
+
+using Clock = std::chrono::steady_clock;
+
+enum class Wait { SLEEP_1MS, EVENT };
+
+struct Result
+{
+    double mean_us{0};
+    double p50_us{0};
+    double p99_us{0};
+    double max_us{0};
+};
+
+static Result run(Wait wait, uint32_t samples)
+{
+    static Gamepad gamepad;
+    gamepad.set_profile(UserProfile());
+    gamepad.reset_pad_in();
+
+    XInputDevice device;
+    device.initialize();
+    stubs::reset_transfers();
+    device.process(0, gamepad);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> submits{0};
+    std::atomic<int64_t> submit_ns{0};
+
+    //core0
+    std::thread device_loop([&]
+    {
+        uint32_t sent = stubs::device_in().count;
+        while (!done.load())
+        {
+            TaskQueue::Core0::process_tasks();
+            device.process(0, gamepad);
+
+            if (stubs::device_in().count != sent)
+            {
+                sent = stubs::device_in().count;
+                submit_ns.store(Clock::now().time_since_epoch().count());
+                submits.fetch_add(1);
+            }
+
+            if (wait == Wait::SLEEP_1MS)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            else
+            {
+                board_api::wait_for_event(1000);
+            }
+        }
+    });
+
+    //core1, each report goes out before the next one is published so every latency is one report's
+    stub_core_num = 1;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> gap_us(100, 2900);
+    std::vector<double> latencies;
+    latencies.reserve(samples);
+
+    for (uint32_t i = 0; i < samples; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(gap_us(rng)));
+
+        Gamepad::PadIn pad_in;
+        pad_in.buttons = (i & 1) ? Gamepad::BUTTON_A : Gamepad::BUTTON_B;
+        const uint32_t seen = submits.load();
+        const int64_t start_ns = Clock::now().time_since_epoch().count();
+        gamepad.set_pad_in(pad_in);
+
+        while (submits.load() == seen)
+        {
+            std::this_thread::yield();
+        }
+        latencies.push_back(static_cast<double>(submit_ns.load() - start_ns) / 1000.0);
+    }
+    stub_core_num = 0;
+
+    done.store(true);
+    device_loop.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    Result result;
+    for (double latency : latencies)
+    {
+        result.mean_us += latency;
+    }
+    result.mean_us /= static_cast<double>(latencies.size());
+    result.p50_us = latencies[latencies.size() / 2];
+    result.p99_us = latencies[(latencies.size() * 99) / 100];
+    result.max_us = latencies.back();
+    return result;
+}
+
+static void print(const char* name, const Result& result)
+{
+    std::printf("%-16s %10.1f %10.1f %10.1f %10.1f\n", name, result.mean_us, result.p50_us, result.p99_us, result.max_us);
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t samples = (argc > 1) ? std::max(1ul, std::strtoul(argv[1], nullptr, 10)) : 2000;
+
+    stubs::set_device_ready(true);
+    std::printf("%-16s %10s %10s %10s %10s\n", "wait", "mean us", "p50 us", "p99 us", "max us");
+
+    const Result sleep = run(Wait::SLEEP_1MS, samples);
+    print("sleep_ms(1)", sleep);
+    const Result event = run(Wait::EVENT, samples);
+    print("wait_for_event", event);
+
+    if (event.p50_us >= sleep.p50_us)
+    {
+        std::printf("FAIL: waiting for the event is not faster than sleeping\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+import re
+import sys
+import struct
+import argparse
+
+# Decodes the binary debug log from a Debug build, see Firmware/RP2040/src/Board/ogxm_log.h
+# Needs pyelftools, and pyserial to read from a port:
+#   python ogxm_log_decode.py OGX-Mini-<version>-<board>-Debug.elf --port /dev/ttyUSB0
+#   python ogxm_log_decode.py OGX-Mini-<version>-<board>-Debug.elf --file capture.bin
+
+from elftools.elf.elffile import ELFFile
+
+RECORD_SYNC = 0xA5
+FMT_HEX = 0
+FMT_TEXT = 1
+HEADER = struct.Struct("<BBHII")
+MAX_PAYLOAD = 32
+
+# printf conversion, length modifiers are dropped since every argument is one 32 bit word
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGp%])")
+
+class Image:
+    def __init__(self, elf_path):
+        self.segments = []
+        with open(elf_path, "rb") as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section["sh_type"] == "SHT_PROGBITS" and section["sh_flags"] & 0x2 and section["sh_size"]:
+                    self.segments.append((section["sh_addr"], section.data()))
+
+    def string(self, address):
+        for start, data in self.segments:
+            if start <= address < start + len(data):
+                offset = address - start
+                end = data.find(b"\0", offset)
+                return data[offset:end if end >= 0 else len(data)].decode("utf-8", "replace")
+        return None
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+def format_record(image, fmt_address, payload):
+    if fmt_address == FMT_HEX:
+        return " ".join(f"{b:02x}" for b in payload) + "\n"
+    if fmt_address == FMT_TEXT:
+        # stdio, split into records wherever it went over the payload size
+        return payload.decode("utf-8", "replace")
+
+    fmt = image.string(fmt_address)
+    if fmt is None:
+        return f"<unknown format 0x{fmt_address:08x}>\n"
+
+    args = list(struct.unpack(f"<{len(payload) // 4}I", payload[:len(payload) & ~3]))
+
+    def convert(match):
+        flags, _, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if not args:
+            return match.group(0)
+        word = args.pop(0)
+        if conversion in "di":
+            value = word - (1 << 32) if word & 0x80000000 else word
+            return ("%" + flags + "d") % value
+        if conversion in "ouxX":
+            return ("%" + flags + conversion) % word
+        if conversion == "c":
+            return ("%" + flags + "c") % chr(word & 0xFF)
+        if conversion == "s":
+            string = image.string(word)
+            return ("%" + flags + "s") % (string if string is not None else f"<0x{word:08x}>")
+        if conversion == "p":
+            return f"0x{word:08x}"
+        return ("%" + flags + conversion) % struct.unpack("<f", struct.pack("<I", word))[0]
+
+    return CONVERSION.sub(convert, fmt)
+
+class Decoder:
+    def __init__(self, image, out):
+        self.image = image
+        self.out = out
+        self.buffer = bytearray()
+        self.last_seq = {}
+        self.line_start = True
+
+    def emit(self, core, time_us, text):
+        for line in text.splitlines(keepends=True):
+            if self.line_start:
+                self.out.write(f"[{time_us / 1e6:10.6f}] core{core}: ")
+            self.out.write(line)
+            self.line_start = line.endswith("\n")
+        self.out.flush()
+
+    def feed(self, data):
+        self.buffer += data
+        while self.buffer:
+            if self.buffer[0] != RECORD_SYNC:
+                # Anything that isn't a record, e.g. from a build without the stdio driver, is shown as text
+                end = self.buffer.find(RECORD_SYNC)
+                end = len(self.buffer) if end < 0 else end
+                self.out.write(self.buffer[:end].decode("utf-8", "replace"))
+                del self.buffer[:end]
+                continue
+
+            if len(self.buffer) < HEADER.size:
+                return
+            _, info, seq, time_us, fmt_address = HEADER.unpack_from(self.buffer)
+            length = info & 0x3F
+            record_len = HEADER.size + length + 1
+            if length > MAX_PAYLOAD:
+                self.out.write(chr(self.buffer.pop(0)))
+                continue
+            if len(self.buffer) < record_len:
+                return
+            if crc8(self.buffer[:record_len - 1]) != self.buffer[record_len - 1]:
+                self.out.write(chr(self.buffer.pop(0)))
+                continue
+
+            core = info >> 7
+            payload = bytes(self.buffer[HEADER.size:HEADER.size + length])
+            del self.buffer[:record_len]
+
+            expected = self.last_seq.get(core)
+            if expected is not None and seq != (expected + 1) & 0xFFFF:
+                self.emit(core, time_us, f"<{(seq - expected - 1) & 0xFFFF} records dropped>\n")
+            self.last_seq[core] = seq
+
+            self.emit(core, time_us, format_record(self.image, fmt_address, payload))
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the OGX-Mini binary debug log")
+    parser.add_argument("elf", help="ELF of the running firmware, format strings are read from it")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="Serial port of the debug UART")
+    source.add_argument("--file", help="Raw capture of the debug UART")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    decoder = Decoder(Image(args.elf), sys.stdout)
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            decoder.feed(f.read())
+        return
+
+    import serial
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        while True:
+            data = port.read(256)
+            if data:
+                decoder.feed(data)
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass